@@ -265,6 +265,8 @@ ClassDB::ClassInfo::ClassInfo() {
 	inherits_ptr = NULL;
 	disabled = false;
 	exposed = false;
+	dispatch = NULL;
+	dispatch_used = false;
 }
 
 ClassDB::ClassInfo::~ClassInfo() {
@@ -656,17 +658,98 @@ MethodBind *ClassDB::get_method(StringName p_class, StringName p_name) {
 	OBJTYPE_RLOCK;
 
 	ClassInfo *type = classes.getptr(p_class);
+	if (!type)
+		return NULL;
 
-	while (type) {
+	MethodBind **method = _get_dispatch(type)->methods.getptr(p_name);
+	return method ? *method : NULL;
+}
+
+// Looks the method up without the dispatch tables, for use while the class
+// is still being registered.
+MethodBind *ClassDB::_find_method(ClassInfo *p_class, const StringName &p_name) {
 
-		MethodBind **method = type->method_map.getptr(p_name);
+	for (ClassInfo *check = p_class; check; check = check->inherits_ptr) {
+
+		MethodBind **method = check->method_map.getptr(p_name);
 		if (method && *method)
 			return *method;
-		type = type->inherits_ptr;
 	}
 	return NULL;
 }
 
+ClassDB::ClassDispatch *ClassDB::_get_dispatch(ClassInfo *p_class) {
+
+	// Pairs with the release store below, so the tables are filled before the pointer is seen.
+	ClassDispatch *dispatch = atomic_load_acquire(&p_class->dispatch);
+	if (likely(dispatch && dispatch->version == atomic_load_acquire(&dispatch_version))) {
+		return dispatch;
+	}
+
+	MutexLock dispatch_lock(dispatch_mutex);
+
+	dispatch = p_class->dispatch;
+	if (dispatch && dispatch->version == dispatch_version) {
+		return dispatch; // Built by another thread meanwhile.
+	}
+
+	ClassDispatch *new_dispatch = memnew(ClassDispatch);
+	new_dispatch->version = dispatch_version;
+	new_dispatch->previous = dispatch;
+
+	// Binding to classes no table depends on, like the ones registered
+	// later, then doesn't need to invalidate every table.
+	for (ClassInfo *check = p_class; check && !check->dispatch_used; check = check->inherits_ptr) {
+		check->dispatch_used = true;
+	}
+
+	// Walk up from the class itself, so what is bound closest to it wins. At
+	// each level properties come before constants, as in get_property().
+	for (ClassInfo *check = p_class; check; check = check->inherits_ptr) {
+
+		const StringName *K = NULL;
+		while ((K = check->method_map.next(K))) {
+
+			MethodBind *method = check->method_map[*K];
+			if (method && !new_dispatch->methods.has(*K)) {
+				new_dispatch->methods[*K] = method;
+			}
+		}
+
+		K = NULL;
+		while ((K = check->property_setget.next(K))) {
+
+			PropertyDispatch *pd = new_dispatch->properties.getptr(*K);
+			if (!pd) {
+				PropertyDispatch empty = { NULL, NULL, NULL };
+				pd = &new_dispatch->properties.set(*K, empty)->value();
+			}
+			if (!pd->setget) {
+				pd->setget = check->property_setget.getptr(*K);
+			}
+			if (!pd->getter && !pd->constant) {
+				pd->getter = check->property_setget.getptr(*K);
+			}
+		}
+
+		K = NULL;
+		while ((K = check->constant_map.next(K))) {
+
+			PropertyDispatch *pd = new_dispatch->properties.getptr(*K);
+			if (!pd) {
+				PropertyDispatch empty = { NULL, NULL, NULL };
+				pd = &new_dispatch->properties.set(*K, empty)->value();
+			}
+			if (!pd->getter && !pd->constant) {
+				pd->constant = check->constant_map.getptr(*K);
+			}
+		}
+	}
+
+	atomic_store_release(&p_class->dispatch, new_dispatch);
+	return new_dispatch;
+}
+
 void ClassDB::bind_integer_constant(const StringName &p_class, const StringName &p_enum, const StringName &p_name, int p_constant) {
 
 	OBJTYPE_WLOCK;
@@ -680,7 +763,13 @@ void ClassDB::bind_integer_constant(const StringName &p_class, const StringName
 		ERR_FAIL();
 	}
 
-	type->constant_map[p_name] = p_constant;
+	{
+		// Tables may be built without the class lock, don't let them see the maps mid update.
+		MutexLock dispatch_lock(dispatch_mutex);
+		type->constant_map[p_name] = p_constant;
+		if (type->dispatch_used)
+			dispatch_version++;
+	}
 
 	String enum_name = p_enum;
 	if (enum_name != String()) {
@@ -919,7 +1008,7 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
 
 	MethodBind *mb_set = NULL;
 	if (p_setter) {
-		mb_set = get_method(p_class, p_setter);
+		mb_set = _find_method(type, p_setter);
 #ifdef DEBUG_METHODS_ENABLED
 
 		ERR_FAIL_COND_MSG(!mb_set, "Invalid setter '" + p_class + "::" + p_setter + "' for property '" + p_pinfo.name + "'.");
@@ -932,7 +1021,7 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
 	MethodBind *mb_get = NULL;
 	if (p_getter) {
 
-		mb_get = get_method(p_class, p_getter);
+		mb_get = _find_method(type, p_getter);
 #ifdef DEBUG_METHODS_ENABLED
 
 		ERR_FAIL_COND_MSG(!mb_get, "Invalid getter '" + p_class + "::" + p_getter + "' for property '" + p_pinfo.name + "'.");
@@ -965,7 +1054,13 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
 	psg.index = p_index;
 	psg.type = p_pinfo.type;
 
-	type->property_setget[p_pinfo.name] = psg;
+	{
+		// Tables may be built without the class lock, don't let them see the maps mid update.
+		MutexLock dispatch_lock(dispatch_mutex);
+		type->property_setget[p_pinfo.name] = psg;
+		if (type->dispatch_used)
+			dispatch_version++;
+	}
 }
 
 void ClassDB::set_property_default_value(StringName p_class, const StringName &p_name, const Variant &p_default) {
@@ -1002,9 +1097,9 @@ void ClassDB::get_property_list(StringName p_class, List<PropertyInfo> *p_list,
 bool ClassDB::set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid) {
 
 	ClassInfo *type = classes.getptr(p_object->get_class_name());
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+	if (type) {
+		const PropertyDispatch *pd = _get_dispatch(type)->properties.getptr(p_property);
+		const PropertySetGet *psg = pd ? pd->setget : NULL;
 		if (psg) {
 
 			if (!psg->setter) {
@@ -1039,8 +1134,6 @@ bool ClassDB::set_property(Object *p_object, const StringName &p_property, const
 
 			return true;
 		}
-
-		check = check->inherits_ptr;
 	}
 
 	return false;
@@ -1048,9 +1141,9 @@ bool ClassDB::set_property(Object *p_object, const StringName &p_property, const
 bool ClassDB::get_property(Object *p_object, const StringName &p_property, Variant &r_value) {
 
 	ClassInfo *type = classes.getptr(p_object->get_class_name());
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
+	const PropertyDispatch *pd = type ? _get_dispatch(type)->properties.getptr(p_property) : NULL;
+	if (pd) {
+		const PropertySetGet *psg = pd->getter;
 		if (psg) {
 			if (!psg->getter)
 				return true; //return true but do nothing
@@ -1074,34 +1167,39 @@ bool ClassDB::get_property(Object *p_object, const StringName &p_property, Varia
 			return true;
 		}
 
-		const int *c = check->constant_map.getptr(p_property);
-		if (c) {
+		if (pd->constant) {
 
-			r_value = *c;
+			r_value = *pd->constant;
 			return true;
 		}
-
-		check = check->inherits_ptr;
 	}
 
 	return false;
 }
 
-int ClassDB::get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
+// Resolves the setter and getter set_property() and get_property() would use, for
+// callers that repeat the same access on one class. NULL when the property isn't
+// bound, or when a constant of the same name hides it.
+const ClassDB::PropertySetGet *ClassDB::get_property_setget(const StringName &p_class, const StringName &p_property) {
 
 	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
+	if (!type) {
+		return NULL;
+	}
 
-			if (r_is_valid)
-				*r_is_valid = true;
+	const PropertyDispatch *pd = _get_dispatch(type)->properties.getptr(p_property);
+	return pd ? pd->getter : NULL;
+}
 
-			return psg->index;
-		}
+int ClassDB::get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
 
-		check = check->inherits_ptr;
+	ClassInfo *type = classes.getptr(p_class);
+	const PropertyDispatch *pd = type ? _get_dispatch(type)->properties.getptr(p_property) : NULL;
+	if (pd && pd->setget) {
+		if (r_is_valid)
+			*r_is_valid = true;
+
+		return pd->setget->index;
 	}
 	if (r_is_valid)
 		*r_is_valid = false;
@@ -1112,18 +1210,12 @@ int ClassDB::get_property_index(const StringName &p_class, const StringName &p_p
 Variant::Type ClassDB::get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
 
 	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
-
-			if (r_is_valid)
-				*r_is_valid = true;
+	const PropertyDispatch *pd = type ? _get_dispatch(type)->properties.getptr(p_property) : NULL;
+	if (pd && pd->setget) {
+		if (r_is_valid)
+			*r_is_valid = true;
 
-			return psg->type;
-		}
-
-		check = check->inherits_ptr;
+		return pd->setget->type;
 	}
 	if (r_is_valid)
 		*r_is_valid = false;
@@ -1134,15 +1226,9 @@ Variant::Type ClassDB::get_property_type(const StringName &p_class, const String
 StringName ClassDB::get_property_setter(StringName p_class, const StringName &p_property) {
 
 	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
-
-			return psg->setter;
-		}
-
-		check = check->inherits_ptr;
+	const PropertyDispatch *pd = type ? _get_dispatch(type)->properties.getptr(p_property) : NULL;
+	if (pd && pd->setget) {
+		return pd->setget->setter;
 	}
 
 	return StringName();
@@ -1151,15 +1237,9 @@ StringName ClassDB::get_property_setter(StringName p_class, const StringName &p_
 StringName ClassDB::get_property_getter(StringName p_class, const StringName &p_property) {
 
 	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		const PropertySetGet *psg = check->property_setget.getptr(p_property);
-		if (psg) {
-
-			return psg->getter;
-		}
-
-		check = check->inherits_ptr;
+	const PropertyDispatch *pd = type ? _get_dispatch(type)->properties.getptr(p_property) : NULL;
+	if (pd && pd->setget) {
+		return pd->setget->getter;
 	}
 
 	return StringName();
@@ -1168,17 +1248,14 @@ StringName ClassDB::get_property_getter(StringName p_class, const StringName &p_
 bool ClassDB::has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance) {
 
 	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		if (check->property_setget.has(p_property))
-			return true;
+	if (!type)
+		return false;
 
-		if (p_no_inheritance)
-			break;
-		check = check->inherits_ptr;
-	}
+	if (p_no_inheritance)
+		return type->property_setget.has(p_property);
 
-	return false;
+	const PropertyDispatch *pd = _get_dispatch(type)->properties.getptr(p_property);
+	return pd && pd->setget;
 }
 
 void ClassDB::set_method_flags(StringName p_class, StringName p_method, int p_flags) {
@@ -1194,16 +1271,13 @@ void ClassDB::set_method_flags(StringName p_class, StringName p_method, int p_fl
 bool ClassDB::has_method(StringName p_class, StringName p_method, bool p_no_inheritance) {
 
 	ClassInfo *type = classes.getptr(p_class);
-	ClassInfo *check = type;
-	while (check) {
-		if (check->method_map.has(p_method))
-			return true;
-		if (p_no_inheritance)
-			return false;
-		check = check->inherits_ptr;
-	}
+	if (!type)
+		return false;
 
-	return false;
+	if (p_no_inheritance)
+		return type->method_map.has(p_method);
+
+	return _get_dispatch(type)->methods.has(p_method);
 }
 
 #ifdef DEBUG_METHODS_ENABLED
@@ -1222,7 +1296,7 @@ MethodBind *ClassDB::bind_methodfi(uint32_t p_flags, MethodBind *p_bind, const c
 
 #ifdef DEBUG_ENABLED
 
-	ERR_FAIL_COND_V_MSG(has_method(instance_type, mdname), NULL, "Class " + String(instance_type) + " already has a method " + String(mdname) + ".");
+	ERR_FAIL_COND_V_MSG(_find_method(classes.getptr(instance_type), mdname), NULL, "Class " + String(instance_type) + " already has a method " + String(mdname) + ".");
 #endif
 
 	ClassInfo *type = classes.getptr(instance_type);
@@ -1249,7 +1323,13 @@ MethodBind *ClassDB::bind_methodfi(uint32_t p_flags, MethodBind *p_bind, const c
 	type->method_order.push_back(mdname);
 #endif
 
-	type->method_map[mdname] = p_bind;
+	{
+		// Tables may be built without the class lock, don't let them see the maps mid update.
+		MutexLock dispatch_lock(dispatch_mutex);
+		type->method_map[mdname] = p_bind;
+		if (type->dispatch_used)
+			dispatch_version++;
+	}
 
 	Vector<Variant> defvals;
 
@@ -1430,10 +1510,13 @@ Variant ClassDB::class_get_default_property_value(const StringName &p_class, con
 }
 
 RWLock *ClassDB::lock = NULL;
+uint32_t ClassDB::dispatch_version = 1;
+Mutex *ClassDB::dispatch_mutex = NULL;
 
 void ClassDB::init() {
 
 	lock = RWLock::create();
+	dispatch_mutex = Mutex::create();
 }
 
 void ClassDB::cleanup_defaults() {
@@ -1457,12 +1540,19 @@ void ClassDB::cleanup() {
 
 			memdelete(ti.method_map[*m]);
 		}
+
+		while (ti.dispatch) {
+			ClassDispatch *previous = ti.dispatch->previous;
+			memdelete(ti.dispatch);
+			ti.dispatch = previous;
+		}
 	}
 	classes.clear();
 	resource_base_extensions.clear();
 	compat_classes.clear();
 
 	memdelete(lock);
+	memdelete(dispatch_mutex);
 }
 
 //
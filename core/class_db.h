@@ -110,6 +110,22 @@ public:
 		Variant::Type type;
 	};
 
+	struct PropertyDispatch {
+		const PropertySetGet *setget; // Closest binding, used by set_property().
+		const PropertySetGet *getter; // Used by get_property(), NULL when a constant hides the property.
+		const int *constant;
+	};
+
+	// What a class has bound, merged with what it inherits, so lookups don't
+	// need to walk the hierarchy. Built on first use, and again after more
+	// methods, properties or constants are bound.
+	struct ClassDispatch {
+		uint32_t version;
+		HashMap<StringName, MethodBind *> methods;
+		HashMap<StringName, PropertyDispatch> properties;
+		ClassDispatch *previous; // Replaced tables are kept, as other threads may still be reading them.
+	};
+
 	struct ClassInfo {
 
 		APIType api;
@@ -133,6 +149,8 @@ public:
 		bool disabled;
 		bool exposed;
 		Object *(*creation_func)();
+		ClassDispatch *dispatch;
+		bool dispatch_used; // A dispatch table was built for this class or one inheriting it.
 		ClassInfo();
 		~ClassInfo();
 	};
@@ -157,6 +175,11 @@ public:
 
 	static void _add_class2(const StringName &p_class, const StringName &p_inherits);
 
+	static uint32_t dispatch_version;
+	static Mutex *dispatch_mutex;
+	static ClassDispatch *_get_dispatch(ClassInfo *p_class);
+	static MethodBind *_find_method(ClassInfo *p_class, const StringName &p_name);
+
 	static HashMap<StringName, HashMap<StringName, Variant> > default_values;
 	static Set<StringName> default_values_cached;
 
@@ -338,6 +361,7 @@ public:
 	static void get_property_list(StringName p_class, List<PropertyInfo> *p_list, bool p_no_inheritance = false, const Object *p_validator = NULL);
 	static bool set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid = NULL);
 	static bool get_property(Object *p_object, const StringName &p_property, Variant &r_value);
+	static const PropertySetGet *get_property_setget(const StringName &p_class, const StringName &p_property);
 	static bool has_property(const StringName &p_class, const StringName &p_property, bool p_no_inheritance = false);
 	static int get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid = NULL);
 	static Variant::Type get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid = NULL);
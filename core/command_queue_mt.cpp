@@ -79,12 +79,13 @@ CommandQueueMT::SyncSemaphore *CommandQueueMT::_alloc_sync_sem() {
 
 bool CommandQueueMT::dealloc_one() {
 tryagain:
-	if (dealloc_ptr == write_ptr) {
+	if (dealloc_ptr == alloc_ptr) {
 		// The queue is empty
 		return false;
 	}
 
-	uint32_t size = *(uint32_t *)&command_mem[dealloc_ptr];
+	// The consumer may be clearing the 'in use' bit concurrently in single producer mode.
+	uint32_t size = atomic_load_acquire((volatile uint32_t *)&command_mem[dealloc_ptr]);
 
 	if (size == 0) {
 		// End of command buffer wrap down
@@ -101,11 +102,134 @@ tryagain:
 	return true;
 }
 
+void CommandQueueMT::_push_foreign_and_wait(CommandBase *p_command, uint32_t p_size) {
+
+	SyncSemaphore *ss = _alloc_sync_sem();
+
+	ForeignCommand foreign;
+	foreign.command = p_command;
+	foreign.done = ss;
+	foreign.next = NULL;
+
+	lock();
+	if (foreign_last) {
+		foreign_last->next = &foreign;
+	} else {
+		foreign_first = &foreign;
+	}
+	foreign_last = &foreign;
+	foreign_command_count++;
+	foreign_command_bytes += ((p_size + 8 - 1) & ~(8 - 1)) + 8;
+	atomic_store_release(&foreign_pending, 1);
+	unlock();
+
+	sync->post();
+	ss->sem->wait();
+	ss->in_use = false;
+}
+
+bool CommandQueueMT::_flush_single_producer() {
+
+	// Commands from other threads run after everything the producer published
+	// so far, so they can't overtake commands the producer issued before them.
+	ForeignCommand *foreign = NULL;
+	if (atomic_load_acquire(&foreign_pending)) {
+		lock();
+		foreign = foreign_first;
+		foreign_first = NULL;
+		foreign_last = NULL;
+		foreign_pending = 0;
+		unlock();
+	}
+
+	bool flushed = false;
+	uint32_t end = atomic_load_acquire(&write_ptr);
+
+	while (read_ptr != end) {
+
+		uint32_t size_ptr = read_ptr;
+		uint32_t size = *(uint32_t *)&command_mem[read_ptr] >> 1;
+
+		if (size == 0) {
+			//end of ringbuffer, wrap
+			read_ptr = 0;
+			continue;
+		}
+
+		CommandBase *cmd = reinterpret_cast<CommandBase *>(&command_mem[read_ptr + 8]);
+		read_ptr += size + 8;
+
+		cmd->call();
+		cmd->post();
+		cmd->~CommandBase();
+		// hand the memory back to the producer
+		atomic_store_release((volatile uint32_t *)&command_mem[size_ptr], size << 1);
+		flushed = true;
+	}
+
+	while (foreign) {
+
+		// the pusher may return (and its stack go away) as soon as done is posted
+		ForeignCommand *next = foreign->next;
+		foreign->command->call();
+		foreign->done->sem->post();
+		foreign = next;
+		flushed = true;
+	}
+
+	return flushed;
+}
+
+void CommandQueueMT::set_single_producer(Thread::ID p_producer) {
+
+	ERR_FAIL_COND(!sync);
+	ERR_FAIL_COND(single_producer);
+
+	producer_id = p_producer;
+	single_producer = true;
+}
+
+uint64_t CommandQueueMT::get_command_count() const {
+
+	mutex->lock();
+	uint64_t count = command_count + foreign_command_count;
+	mutex->unlock();
+	return count;
+}
+
+uint64_t CommandQueueMT::get_command_bytes() const {
+
+	mutex->lock();
+	uint64_t bytes = command_bytes + foreign_command_bytes;
+	mutex->unlock();
+	return bytes;
+}
+
+uint64_t CommandQueueMT::get_sync_stall_count() const {
+
+	// every command pushed from a foreign thread blocks its caller
+	mutex->lock();
+	uint64_t stalls = sync_stall_count + foreign_command_count;
+	mutex->unlock();
+	return stalls;
+}
+
 CommandQueueMT::CommandQueueMT(bool p_sync) {
 
 	read_ptr = 0;
 	write_ptr = 0;
+	alloc_ptr = 0;
 	dealloc_ptr = 0;
+	single_producer = false;
+	producer_id = 0;
+	foreign_first = NULL;
+	foreign_last = NULL;
+	foreign_pending = 0;
+	command_count = 0;
+	command_bytes = 0;
+	sync_stall_count = 0;
+	foreign_command_count = 0;
+	foreign_command_bytes = 0;
 	mutex = Mutex::create();
 	command_mem = (uint8_t *)memalloc(COMMAND_MEM_SIZE);
 
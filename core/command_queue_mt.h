@@ -34,6 +34,8 @@
 #include "core/os/memory.h"
 #include "core/os/mutex.h"
 #include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
 #include "core/simple_type.h"
 #include "core/typedefs.h"
 
@@ -228,12 +230,20 @@
 #define DECL_PUSH(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>       \
 	void push(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
+		if (_is_foreign_thread()) {                                          \
+			CMD_TYPE(N) local;                                               \
+			CMD_TYPE(N) *cmd = &local;                                       \
+			cmd->instance = p_instance;                                      \
+			cmd->method = p_method;                                          \
+			SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                             \
+			_push_foreign_and_wait(cmd, sizeof(CMD_TYPE(N)));                \
+			return;                                                          \
+		}                                                                    \
 		CMD_TYPE(N) *cmd = allocate_and_lock<CMD_TYPE(N)>();                 \
 		cmd->instance = p_instance;                                          \
 		cmd->method = p_method;                                              \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                 \
-		unlock();                                                            \
-		if (sync) sync->post();                                              \
+		_commit(false);                                                      \
 	}
 
 #define CMD_RET_TYPE(N) CommandRet##N<T, M, COMMA_SEP_LIST(TYPE_ARG, N) COMMA(N) R>
@@ -241,6 +251,17 @@
 #define DECL_PUSH_AND_RET(N)                                                                   \
 	template <class T, class M, COMMA_SEP_LIST(TYPE_PARAM, N) COMMA(N) class R>                \
 	void push_and_ret(T *p_instance, M p_method, COMMA_SEP_LIST(PARAM, N) COMMA(N) R *r_ret) { \
+		if (_is_foreign_thread()) {                                                            \
+			CMD_RET_TYPE(N) local;                                                             \
+			CMD_RET_TYPE(N) *cmd = &local;                                                     \
+			cmd->instance = p_instance;                                                        \
+			cmd->method = p_method;                                                            \
+			SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                               \
+			cmd->ret = r_ret;                                                                  \
+			cmd->sync_sem = NULL;                                                              \
+			_push_foreign_and_wait(cmd, sizeof(CMD_RET_TYPE(N)));                              \
+			return;                                                                            \
+		}                                                                                      \
 		SyncSemaphore *ss = _alloc_sync_sem();                                                 \
 		CMD_RET_TYPE(N) *cmd = allocate_and_lock<CMD_RET_TYPE(N)>();                           \
 		cmd->instance = p_instance;                                                            \
@@ -248,8 +269,7 @@
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                                   \
 		cmd->ret = r_ret;                                                                      \
 		cmd->sync_sem = ss;                                                                    \
-		unlock();                                                                              \
-		if (sync) sync->post();                                                                \
+		_commit(true);                                                                         \
 		ss->sem->wait();                                                                       \
 		ss->in_use = false;                                                                    \
 	}
@@ -259,14 +279,23 @@
 #define DECL_PUSH_AND_SYNC(N)                                                         \
 	template <class T, class M COMMA(N) COMMA_SEP_LIST(TYPE_PARAM, N)>                \
 	void push_and_sync(T *p_instance, M p_method COMMA(N) COMMA_SEP_LIST(PARAM, N)) { \
+		if (_is_foreign_thread()) {                                                   \
+			CMD_SYNC_TYPE(N) local;                                                   \
+			CMD_SYNC_TYPE(N) *cmd = &local;                                           \
+			cmd->instance = p_instance;                                               \
+			cmd->method = p_method;                                                   \
+			SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                      \
+			cmd->sync_sem = NULL;                                                     \
+			_push_foreign_and_wait(cmd, sizeof(CMD_SYNC_TYPE(N)));                    \
+			return;                                                                   \
+		}                                                                             \
 		SyncSemaphore *ss = _alloc_sync_sem();                                        \
 		CMD_SYNC_TYPE(N) *cmd = allocate_and_lock<CMD_SYNC_TYPE(N)>();                \
 		cmd->instance = p_instance;                                                   \
 		cmd->method = p_method;                                                       \
 		SEMIC_SEP_LIST(CMD_ASSIGN_PARAM, N);                                          \
 		cmd->sync_sem = ss;                                                           \
-		unlock();                                                                     \
-		if (sync) sync->post();                                                       \
+		_commit(true);                                                                \
 		ss->sem->wait();                                                              \
 		ss->in_use = false;                                                           \
 	}
@@ -316,14 +345,40 @@ class CommandQueueMT {
 		SYNC_SEMAPHORES = 8
 	};
 
+	// Commands pushed from other threads while in single producer mode.
+	// They live on the stack of the pushing thread, which waits until they ran.
+	struct ForeignCommand {
+
+		CommandBase *command;
+		SyncSemaphore *done;
+		ForeignCommand *next;
+	};
+
 	uint8_t *command_mem;
-	uint32_t read_ptr;
-	uint32_t write_ptr;
+	uint32_t read_ptr; // Owned by the consumer.
+	volatile uint32_t write_ptr; // End of the commands visible to the consumer.
+	uint32_t alloc_ptr; // End of the commands written by the producer, ahead of write_ptr until a push is committed.
 	uint32_t dealloc_ptr;
 	SyncSemaphore sync_sems[SYNC_SEMAPHORES];
 	Mutex *mutex;
 	Semaphore *sync;
 
+	bool single_producer;
+	Thread::ID producer_id;
+
+	ForeignCommand *foreign_first;
+	ForeignCommand *foreign_last;
+	volatile uint32_t foreign_pending;
+
+	// Written by the producer (under the mutex in locked mode).
+	uint64_t command_count;
+	uint64_t command_bytes;
+	uint64_t sync_stall_count;
+
+	// Written by foreign threads, always under the mutex.
+	uint64_t foreign_command_count;
+	uint64_t foreign_command_bytes;
+
 	template <class T>
 	T *allocate() {
 
@@ -332,9 +387,9 @@ class CommandQueueMT {
 
 	tryagain:
 
-		if (write_ptr < dealloc_ptr) {
+		if (alloc_ptr < dealloc_ptr) {
 			// behind dealloc_ptr, check that there is room
-			if ((dealloc_ptr - write_ptr) <= alloc_size) {
+			if ((dealloc_ptr - alloc_ptr) <= alloc_size) {
 
 				// There is no more room, try to deallocate something
 				if (dealloc_one()) {
@@ -345,10 +400,10 @@ class CommandQueueMT {
 		} else {
 			// ahead of dealloc_ptr, check that there is room
 
-			if ((COMMAND_MEM_SIZE - write_ptr) < alloc_size + sizeof(uint32_t)) {
+			if ((COMMAND_MEM_SIZE - alloc_ptr) < alloc_size + sizeof(uint32_t)) {
 				// no room at the end, wrap down;
 
-				if (dealloc_ptr == 0) { // don't want write_ptr to become dealloc_ptr
+				if (dealloc_ptr == 0) { // don't want alloc_ptr to become dealloc_ptr
 
 					// There is no more room, try to deallocate something
 					if (dealloc_one()) {
@@ -358,12 +413,12 @@ class CommandQueueMT {
 				}
 
 				// if this happens, it's a bug
-				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - write_ptr) < 8, NULL);
+				ERR_FAIL_COND_V((COMMAND_MEM_SIZE - alloc_ptr) < 8, NULL);
 				// zero means, wrap to beginning
 
-				uint32_t *p = (uint32_t *)&command_mem[write_ptr];
+				uint32_t *p = (uint32_t *)&command_mem[alloc_ptr];
 				*p = 0;
-				write_ptr = 0;
+				alloc_ptr = 0;
 				goto tryagain;
 			}
 		}
@@ -371,32 +426,67 @@ class CommandQueueMT {
 		// First bit used to mark if command is still in use (1)
 		// or if it has been destroyed and can be deallocated (0).
 		uint32_t size = (sizeof(T) + 8 - 1) & ~(8 - 1);
-		uint32_t *p = (uint32_t *)&command_mem[write_ptr];
+		uint32_t *p = (uint32_t *)&command_mem[alloc_ptr];
 		*p = (size << 1) | 1;
-		write_ptr += 8;
+		alloc_ptr += 8;
 		// allocate the command
-		T *cmd = memnew_placement(&command_mem[write_ptr], T);
-		write_ptr += size;
+		T *cmd = memnew_placement(&command_mem[alloc_ptr], T);
+		alloc_ptr += size;
+
+		command_count++;
+		command_bytes += size + 8;
 		return cmd;
 	}
 
 	template <class T>
 	T *allocate_and_lock() {
 
-		lock();
+		if (!single_producer) lock();
 		T *ret;
 
 		while ((ret = allocate<T>()) == NULL) {
 
-			unlock();
-			// sleep a little until fetch happened and some room is made
-			wait_for_flush();
-			lock();
+			if (single_producer) {
+				// nothing to unlock, the consumer frees room without the mutex
+				wait_for_flush();
+			} else {
+				unlock();
+				// sleep a little until fetch happened and some room is made
+				wait_for_flush();
+				lock();
+			}
 		}
 
 		return ret;
 	}
 
+	// Makes the allocated commands visible to the consumer, and releases the
+	// lock taken by allocate_and_lock() in locked mode.
+	_FORCE_INLINE_ void _commit(bool p_sync) {
+
+		if (p_sync) sync_stall_count++;
+
+		if (single_producer) {
+			_publish();
+		} else {
+			write_ptr = alloc_ptr;
+			unlock();
+			if (sync) sync->post();
+		}
+	}
+
+	_FORCE_INLINE_ void _publish() {
+
+		if (write_ptr == alloc_ptr) return;
+		atomic_store_release(&write_ptr, alloc_ptr);
+		if (sync) sync->post();
+	}
+
+	_FORCE_INLINE_ bool _is_foreign_thread() const {
+
+		return single_producer && Thread::get_caller_id() != producer_id;
+	}
+
 	bool flush_one(bool p_lock = true) {
 		if (p_lock) lock();
 	tryagain:
@@ -439,6 +529,8 @@ class CommandQueueMT {
 	void wait_for_flush();
 	SyncSemaphore *_alloc_sync_sem();
 	bool dealloc_one();
+	void _push_foreign_and_wait(CommandBase *p_command, uint32_t p_size);
+	bool _flush_single_producer();
 
 public:
 	/* NORMAL PUSH COMMANDS */
@@ -456,11 +548,21 @@ public:
 	void wait_and_flush_one() {
 		ERR_FAIL_COND(!sync);
 		sync->wait();
-		flush_one();
+		if (single_producer) {
+			_flush_single_producer();
+		} else {
+			flush_one();
+		}
 	}
 
 	void flush_all() {
 
+		if (single_producer) {
+			while (_flush_single_producer())
+				;
+			return;
+		}
+
 		//ERR_FAIL_COND(sync);
 		lock();
 		while (flush_one(false))
@@ -468,6 +570,13 @@ public:
 		unlock();
 	}
 
+	void set_single_producer(Thread::ID p_producer);
+	bool is_single_producer() const { return single_producer; }
+
+	uint64_t get_command_count() const;
+	uint64_t get_command_bytes() const;
+	uint64_t get_sync_stall_count() const;
+
 	CommandQueueMT(bool p_sync);
 	~CommandQueueMT();
 };
@@ -0,0 +1,325 @@
+/*************************************************************************/
+/*  local_vector.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef LOCAL_VECTOR_H
+#define LOCAL_VECTOR_H
+
+#include "core/error_macros.h"
+#include "core/os/copymem.h"
+#include "core/os/memory.h"
+#include "core/sort_array.h"
+#include "core/vector.h"
+
+/**
+ * Vector without copy on write, meant for scratch arrays that are built and
+ * discarded inside a function or kept as a member to be reused every frame.
+ * Clearing keeps the memory around, and moving one steals its buffer.
+ *
+ * When INLINE_CAPACITY is not zero, that many elements are stored inside the
+ * object itself and the heap is only used when it grows past them.
+ */
+
+template <class T, uint32_t INLINE_CAPACITY>
+struct LocalVectorInlineStorage {
+	alignas(T) uint8_t data[sizeof(T) * INLINE_CAPACITY];
+
+	_FORCE_INLINE_ T *ptr() { return (T *)data; }
+};
+
+template <class T>
+struct LocalVectorInlineStorage<T, 0> {
+	_FORCE_INLINE_ T *ptr() { return NULL; }
+};
+
+template <class T, uint32_t INLINE_CAPACITY = 0>
+class LocalVector {
+
+	LocalVectorInlineStorage<T, INLINE_CAPACITY> inline_storage;
+	T *data;
+	uint32_t count;
+	uint32_t capacity;
+
+	_FORCE_INLINE_ bool _is_inline() const { return INLINE_CAPACITY > 0 && data == const_cast<LocalVector *>(this)->inline_storage.ptr(); }
+
+	void _reset_to_inline() {
+		data = inline_storage.ptr();
+		capacity = INLINE_CAPACITY;
+	}
+
+	void _realloc(uint32_t p_capacity) {
+
+		T *new_data = (T *)memalloc(p_capacity * sizeof(T));
+		CRASH_COND_MSG(!new_data, "Out of memory");
+
+		if (__has_trivial_copy(T)) {
+			if (count) {
+				copymem((void *)new_data, (const void *)data, count * sizeof(T));
+			}
+		} else {
+			for (uint32_t i = 0; i < count; i++) {
+				memnew_placement(&new_data[i], T(data[i]));
+				data[i].~T();
+			}
+		}
+
+		if (data && !_is_inline()) {
+			memfree(data);
+		}
+
+		data = new_data;
+		capacity = p_capacity;
+	}
+
+	// Takes over the contents of p_from, which is left empty.
+	void _steal(LocalVector &p_from) {
+
+		if (p_from._is_inline()) {
+			// Inline elements can't change owner, so they are moved one by one.
+			_reset_to_inline();
+			for (uint32_t i = 0; i < p_from.count; i++) {
+				memnew_placement(&data[i], T(p_from.data[i]));
+				p_from.data[i].~T();
+			}
+			count = p_from.count;
+		} else {
+			data = p_from.data;
+			count = p_from.count;
+			capacity = p_from.capacity;
+		}
+
+		p_from._reset_to_inline();
+		p_from.count = 0;
+	}
+
+public:
+	_FORCE_INLINE_ T *ptr() { return data; }
+	_FORCE_INLINE_ const T *ptr() const { return data; }
+	_FORCE_INLINE_ uint32_t size() const { return count; }
+	_FORCE_INLINE_ uint32_t get_capacity() const { return capacity; }
+	_FORCE_INLINE_ bool empty() const { return count == 0; }
+
+	_FORCE_INLINE_ void push_back(const T &p_elem) {
+
+		if (unlikely(count == capacity)) {
+			// p_elem may be one of our own elements, copy it before the buffer moves.
+			T elem(p_elem);
+			reserve(capacity ? capacity * 2 : 4);
+			memnew_placement(&data[count++], T(elem));
+			return;
+		}
+
+		if (__has_trivial_copy(T)) {
+			data[count++] = p_elem;
+		} else {
+			memnew_placement(&data[count++], T(p_elem));
+		}
+	}
+
+	void remove(uint32_t p_index) {
+
+		ERR_FAIL_UNSIGNED_INDEX(p_index, count);
+		count--;
+		for (uint32_t i = p_index; i < count; i++) {
+			data[i] = data[i + 1];
+		}
+		if (!__has_trivial_destructor(T)) {
+			data[count].~T();
+		}
+	}
+
+	// Removes by moving the last element in, which is O(1) but does not keep the order.
+	void remove_unordered(uint32_t p_index) {
+
+		ERR_FAIL_UNSIGNED_INDEX(p_index, count);
+		count--;
+		if (count > p_index) {
+			data[p_index] = data[count];
+		}
+		if (!__has_trivial_destructor(T)) {
+			data[count].~T();
+		}
+	}
+
+	void erase(const T &p_val) {
+
+		int64_t idx = find(p_val);
+		if (idx >= 0) {
+			remove(idx);
+		}
+	}
+
+	void invert() {
+
+		for (uint32_t i = 0; i < count / 2; i++) {
+			SWAP(data[i], data[count - i - 1]);
+		}
+	}
+
+	// Destroys the elements but keeps the memory, so the vector can be refilled without allocating.
+	_FORCE_INLINE_ void clear() { resize(0); }
+
+	// Destroys the elements and frees the memory.
+	void reset() {
+
+		clear();
+		if (data && !_is_inline()) {
+			memfree(data);
+		}
+		_reset_to_inline();
+	}
+
+	void reserve(uint32_t p_size) {
+
+		if (p_size > capacity) {
+			_realloc(p_size);
+		}
+	}
+
+	void resize(uint32_t p_size) {
+
+		if (p_size < count) {
+			if (!__has_trivial_destructor(T)) {
+				for (uint32_t i = p_size; i < count; i++) {
+					data[i].~T();
+				}
+			}
+			count = p_size;
+		} else if (p_size > count) {
+			if (p_size > capacity) {
+				_realloc(MAX(p_size, capacity * 2));
+			}
+			if (!__has_trivial_constructor(T)) {
+				for (uint32_t i = count; i < p_size; i++) {
+					memnew_placement(&data[i], T);
+				}
+			}
+			count = p_size;
+		}
+	}
+
+	_FORCE_INLINE_ const T &operator[](uint32_t p_index) const {
+
+		CRASH_BAD_UNSIGNED_INDEX(p_index, count);
+		return data[p_index];
+	}
+
+	_FORCE_INLINE_ T &operator[](uint32_t p_index) {
+
+		CRASH_BAD_UNSIGNED_INDEX(p_index, count);
+		return data[p_index];
+	}
+
+	int64_t find(const T &p_val, uint32_t p_from = 0) const {
+
+		for (uint32_t i = p_from; i < count; i++) {
+			if (data[i] == p_val) {
+				return int64_t(i);
+			}
+		}
+		return -1;
+	}
+
+	template <class C>
+	void sort_custom() {
+
+		if (count < 2) {
+			return;
+		}
+
+		SortArray<T, C> sorter;
+		sorter.sort(data, count);
+	}
+
+	void sort() {
+
+		sort_custom<_DefaultComparator<T> >();
+	}
+
+	operator Vector<T>() const {
+
+		Vector<T> ret;
+		ret.resize(count);
+		T *w = ret.ptrw();
+		for (uint32_t i = 0; i < count; i++) {
+			w[i] = data[i];
+		}
+		return ret;
+	}
+
+	LocalVector &operator=(const LocalVector &p_from) {
+
+		if (this == &p_from) {
+			return *this;
+		}
+
+		resize(p_from.size());
+		for (uint32_t i = 0; i < p_from.count; i++) {
+			data[i] = p_from.data[i];
+		}
+		return *this;
+	}
+
+	LocalVector &operator=(LocalVector &&p_from) {
+
+		if (this == &p_from) {
+			return *this;
+		}
+
+		reset();
+		_steal(p_from);
+		return *this;
+	}
+
+	LocalVector(const LocalVector &p_from) {
+
+		count = 0;
+		_reset_to_inline();
+		*this = p_from;
+	}
+
+	LocalVector(LocalVector &&p_from) {
+
+		count = 0;
+		_steal(p_from);
+	}
+
+	_FORCE_INLINE_ LocalVector() {
+
+		count = 0;
+		_reset_to_inline();
+	}
+
+	_FORCE_INLINE_ ~LocalVector() {
+
+		reset();
+	}
+};
+
+#endif // LOCAL_VECTOR_H
@@ -0,0 +1,183 @@
+/*************************************************************************/
+/*  aabb4.h                                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef AABB4_H
+#define AABB4_H
+
+#include "core/math/aabb.h"
+#include "core/math/plane.h"
+#include "core/math/simd.h"
+
+/**
+ * Four AABBs stored component by component, as centers and half extents, so
+ * they can be tested against a convex shape all at once. Uses SIMD when
+ * available for single precision builds and plain loops otherwise.
+ */
+struct AABB4 {
+
+	real_t center_x[4];
+	real_t center_y[4];
+	real_t center_z[4];
+	real_t extent_x[4];
+	real_t extent_y[4];
+	real_t extent_z[4];
+
+	_FORCE_INLINE_ void set(int p_index, const AABB &p_aabb) {
+
+		Vector3 extent = p_aabb.size * 0.5;
+		Vector3 center = p_aabb.position + extent;
+		center_x[p_index] = center.x;
+		center_y[p_index] = center.y;
+		center_z[p_index] = center.z;
+		extent_x[p_index] = extent.x;
+		extent_y[p_index] = extent.y;
+		extent_z[p_index] = extent.z;
+	}
+
+	// Bit i is set when box i is not fully outside any of the planes, like
+	// AABB::intersects_convex_shape(). Only the first p_count boxes are tested,
+	// and of the first 32 planes only those set in p_plane_mask. If r_inside
+	// is given, it gets the boxes that are inside all of those planes, like
+	// AABB::inside_convex_shape().
+	_FORCE_INLINE_ uint32_t intersects_convex_shape(const Plane *p_planes, int p_plane_count, int p_count = 4, uint32_t p_plane_mask = 0xFFFFFFFF, uint32_t *r_inside = NULL) const;
+};
+
+uint32_t AABB4::intersects_convex_shape(const Plane *p_planes, int p_plane_count, int p_count, uint32_t p_plane_mask, uint32_t *r_inside) const {
+
+	uint32_t count_mask = (1 << p_count) - 1;
+
+#if defined(SIMD_ENABLED) && !defined(REAL_T_IS_DOUBLE)
+
+	SIMDFloat4 cx = simd_load(center_x);
+	SIMDFloat4 cy = simd_load(center_y);
+	SIMDFloat4 cz = simd_load(center_z);
+	SIMDFloat4 ex = simd_load(extent_x);
+	SIMDFloat4 ey = simd_load(extent_y);
+	SIMDFloat4 ez = simd_load(extent_z);
+
+	uint32_t outside = 0;
+	uint32_t crossing = 0;
+
+	for (int i = 0; i < p_plane_count; i++) {
+
+		if (i < 32 && !(p_plane_mask & (1U << i))) {
+			continue;
+		}
+
+		// same points and tests as AABB::intersects_convex_shape() and
+		// AABB::inside_convex_shape(), so results match exactly
+		const Plane &p = p_planes[i];
+		SIMDFloat4 nx = simd_splat(p.normal.x);
+		SIMDFloat4 ny = simd_splat(p.normal.y);
+		SIMDFloat4 nz = simd_splat(p.normal.z);
+		SIMDFloat4 d = simd_splat(p.d);
+
+		SIMDFloat4 x = p.normal.x > 0 ? simd_sub(cx, ex) : simd_add(cx, ex);
+		SIMDFloat4 y = p.normal.y > 0 ? simd_sub(cy, ey) : simd_add(cy, ey);
+		SIMDFloat4 z = p.normal.z > 0 ? simd_sub(cz, ez) : simd_add(cz, ez);
+
+		SIMDFloat4 distance = simd_add(simd_add(simd_mul(x, nx), simd_mul(y, ny)), simd_mul(z, nz));
+		outside |= simd_get_mask(simd_greater(distance, d));
+
+		if (r_inside) {
+			x = p.normal.x < 0 ? simd_sub(cx, ex) : simd_add(cx, ex);
+			y = p.normal.y < 0 ? simd_sub(cy, ey) : simd_add(cy, ey);
+			z = p.normal.z < 0 ? simd_sub(cz, ez) : simd_add(cz, ez);
+
+			distance = simd_add(simd_add(simd_mul(x, nx), simd_mul(y, ny)), simd_mul(z, nz));
+			crossing |= simd_get_mask(simd_greater(distance, d));
+		}
+
+		if ((outside & count_mask) == count_mask) {
+			break;
+		}
+	}
+
+	if (r_inside) {
+		*r_inside = ~crossing & ~outside & count_mask;
+	}
+
+	return ~outside & count_mask;
+
+#else
+
+	uint32_t intersecting = 0;
+	uint32_t inside = 0;
+
+	for (int j = 0; j < p_count; j++) {
+
+		bool outside = false;
+		bool crossing = false;
+
+		for (int i = 0; i < p_plane_count; i++) {
+
+			if (i < 32 && !(p_plane_mask & (1U << i))) {
+				continue;
+			}
+
+			const Plane &p = p_planes[i];
+			Vector3 point(
+					(p.normal.x > 0) ? center_x[j] - extent_x[j] : center_x[j] + extent_x[j],
+					(p.normal.y > 0) ? center_y[j] - extent_y[j] : center_y[j] + extent_y[j],
+					(p.normal.z > 0) ? center_z[j] - extent_z[j] : center_z[j] + extent_z[j]);
+
+			if (p.is_point_over(point)) {
+				outside = true;
+				break;
+			}
+
+			if (r_inside && !crossing) {
+				Vector3 far_point(
+						(p.normal.x < 0) ? center_x[j] - extent_x[j] : center_x[j] + extent_x[j],
+						(p.normal.y < 0) ? center_y[j] - extent_y[j] : center_y[j] + extent_y[j],
+						(p.normal.z < 0) ? center_z[j] - extent_z[j] : center_z[j] + extent_z[j]);
+
+				crossing = p.is_point_over(far_point);
+			}
+		}
+
+		if (!outside) {
+			intersecting |= 1 << j;
+			if (!crossing) {
+				inside |= 1 << j;
+			}
+		}
+	}
+
+	if (r_inside) {
+		*r_inside = inside;
+	}
+
+	return intersecting;
+
+#endif
+}
+
+#endif // AABB4_H
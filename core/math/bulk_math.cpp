@@ -0,0 +1,465 @@
+/*************************************************************************/
+/*  bulk_math.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "bulk_math.h"
+
+#include "core/math/simd.h"
+#include "core/math/transform.h"
+#include "core/math/transform_2d.h"
+#include "core/sort_array.h"
+
+// Element-wise operations, with a SIMD form for float arrays.
+
+struct _BulkAdd {
+	template <class T>
+	static _FORCE_INLINE_ T scalar(T a, T b) { return a + b; }
+#ifdef SIMD_ENABLED
+	static _FORCE_INLINE_ SIMDFloat4 simd(SIMDFloat4 a, SIMDFloat4 b) { return simd_add(a, b); }
+#endif
+};
+
+struct _BulkMultiply {
+	template <class T>
+	static _FORCE_INLINE_ T scalar(T a, T b) { return a * b; }
+#ifdef SIMD_ENABLED
+	static _FORCE_INLINE_ SIMDFloat4 simd(SIMDFloat4 a, SIMDFloat4 b) { return simd_mul(a, b); }
+#endif
+};
+
+struct _BulkMin {
+	template <class T>
+	static _FORCE_INLINE_ T scalar(T a, T b) { return MIN(a, b); }
+#ifdef SIMD_ENABLED
+	static _FORCE_INLINE_ SIMDFloat4 simd(SIMDFloat4 a, SIMDFloat4 b) { return simd_min(a, b); }
+#endif
+};
+
+struct _BulkMax {
+	template <class T>
+	static _FORCE_INLINE_ T scalar(T a, T b) { return MAX(a, b); }
+#ifdef SIMD_ENABLED
+	static _FORCE_INLINE_ SIMDFloat4 simd(SIMDFloat4 a, SIMDFloat4 b) { return simd_max(a, b); }
+#endif
+};
+
+struct _BulkMultiplyAdd {
+	template <class T>
+	static _FORCE_INLINE_ T scalar(T a, T b, T c) { return a * b + c; }
+#ifdef SIMD_ENABLED
+	static _FORCE_INLINE_ SIMDFloat4 simd(SIMDFloat4 a, SIMDFloat4 b, SIMDFloat4 c) { return simd_add(simd_mul(a, b), c); }
+#endif
+};
+
+struct _BulkLerp {
+	template <class T>
+	static _FORCE_INLINE_ T scalar(T a, T b, T c) { return a + (b - a) * c; }
+#ifdef SIMD_ENABLED
+	static _FORCE_INLINE_ SIMDFloat4 simd(SIMDFloat4 a, SIMDFloat4 b, SIMDFloat4 c) { return simd_add(a, simd_mul(simd_sub(b, a), c)); }
+#endif
+};
+
+struct _BulkClamp {
+	template <class T>
+	static _FORCE_INLINE_ T scalar(T a, T b, T c) { return CLAMP(a, b, c); }
+#ifdef SIMD_ENABLED
+	static _FORCE_INLINE_ SIMDFloat4 simd(SIMDFloat4 a, SIMDFloat4 b, SIMDFloat4 c) { return simd_min(simd_max(a, b), c); }
+#endif
+};
+
+// The SIMD loops handle as much of the array as they can and return where the
+// scalar loops take over. Single element operands are repeated over a block
+// of 12 floats, which is a whole number of elements for every width and
+// fills three registers.
+
+enum {
+	BULK_BLOCK = 12
+};
+
+template <class Op, class T>
+static _FORCE_INLINE_ int _binary_simd(T *p_array, int p_size, int p_width, const BulkMath::Operand<T> &p_b) {
+	return 0;
+}
+
+template <class Op, class T>
+static _FORCE_INLINE_ int _ternary_simd(T *p_array, int p_size, int p_width, const BulkMath::Operand<T> &p_b, const BulkMath::Operand<T> &p_c) {
+	return 0;
+}
+
+#ifdef SIMD_ENABLED
+
+struct _BulkSIMDOperand {
+
+	float block[BULK_BLOCK];
+	SIMDFloat4 reg[3];
+	const float *ptr;
+
+	_FORCE_INLINE_ SIMDFloat4 get(int p_index, int p_part) const {
+		return ptr ? simd_load(ptr + p_index + p_part * 4) : reg[p_part];
+	}
+
+	_BulkSIMDOperand(const BulkMath::Operand<float> &p_operand, int p_width) {
+		if (p_operand.array) {
+			ptr = p_operand.ptr;
+			return;
+		}
+
+		ptr = NULL;
+		for (int i = 0; i < BULK_BLOCK; i++) {
+			block[i] = p_operand.ptr[i % p_width];
+		}
+		for (int i = 0; i < 3; i++) {
+			reg[i] = simd_load(block + i * 4);
+		}
+	}
+};
+
+template <class Op>
+static int _binary_simd(float *p_array, int p_size, int p_width, const BulkMath::Operand<float> &p_b) {
+
+	_BulkSIMDOperand b(p_b, p_width);
+
+	int i = 0;
+	for (; i + BULK_BLOCK <= p_size; i += BULK_BLOCK) {
+		for (int j = 0; j < 3; j++) {
+			float *ptr = p_array + i + j * 4;
+			simd_store(ptr, Op::simd(simd_load(ptr), b.get(i, j)));
+		}
+	}
+	return i;
+}
+
+template <class Op>
+static int _ternary_simd(float *p_array, int p_size, int p_width, const BulkMath::Operand<float> &p_b, const BulkMath::Operand<float> &p_c) {
+
+	_BulkSIMDOperand b(p_b, p_width);
+	_BulkSIMDOperand c(p_c, p_width);
+
+	int i = 0;
+	for (; i + BULK_BLOCK <= p_size; i += BULK_BLOCK) {
+		for (int j = 0; j < 3; j++) {
+			float *ptr = p_array + i + j * 4;
+			simd_store(ptr, Op::simd(simd_load(ptr), b.get(i, j), c.get(i, j)));
+		}
+	}
+	return i;
+}
+
+#endif
+
+template <class Op, class T>
+static void _binary(T *p_array, int p_count, int p_width, const BulkMath::Operand<T> &p_b) {
+
+	int size = p_count * p_width;
+	int i = _binary_simd<Op>(p_array, size, p_width, p_b);
+
+	if (p_b.array) {
+		for (; i < size; i++) {
+			p_array[i] = Op::scalar(p_array[i], p_b.ptr[i]);
+		}
+	} else {
+		for (; i < size; i++) {
+			p_array[i] = Op::scalar(p_array[i], p_b.ptr[i % p_width]);
+		}
+	}
+}
+
+template <class Op, class T>
+static void _ternary(T *p_array, int p_count, int p_width, const BulkMath::Operand<T> &p_b, const BulkMath::Operand<T> &p_c) {
+
+	int size = p_count * p_width;
+	int i = _ternary_simd<Op>(p_array, size, p_width, p_b, p_c);
+
+	for (; i < size; i++) {
+		T b = p_b.array ? p_b.ptr[i] : p_b.ptr[i % p_width];
+		T c = p_c.array ? p_c.ptr[i] : p_c.ptr[i % p_width];
+		p_array[i] = Op::scalar(p_array[i], b, c);
+	}
+}
+
+// Reductions keep one partial result per lane, folded into the element
+// components at the end.
+
+template <class Op, class T, class S>
+static _FORCE_INLINE_ int _reduce_simd(const T *p_array, int p_size, int p_width, S *r_result) {
+	return 0;
+}
+
+#ifdef SIMD_ENABLED
+
+template <class Op>
+static int _reduce_simd(const float *p_array, int p_size, int p_width, float *r_result) {
+
+	if (p_size < BULK_BLOCK) {
+		return 0;
+	}
+
+	SIMDFloat4 acc[3];
+	for (int j = 0; j < 3; j++) {
+		acc[j] = simd_load(p_array + j * 4);
+	}
+
+	int i = BULK_BLOCK;
+	for (; i + BULK_BLOCK <= p_size; i += BULK_BLOCK) {
+		for (int j = 0; j < 3; j++) {
+			acc[j] = Op::simd(acc[j], simd_load(p_array + i + j * 4));
+		}
+	}
+
+	float lanes[BULK_BLOCK];
+	for (int j = 0; j < 3; j++) {
+		simd_store(lanes + j * 4, acc[j]);
+	}
+	for (int j = 0; j < p_width; j++) {
+		r_result[j] = lanes[j];
+	}
+	for (int j = p_width; j < BULK_BLOCK; j++) {
+		r_result[j % p_width] = Op::scalar(r_result[j % p_width], lanes[j]);
+	}
+	return i;
+}
+
+#endif
+
+template <class Op, class T, class S>
+static void _reduce(const T *p_array, int p_count, int p_width, S *r_result) {
+
+	int size = p_count * p_width;
+	int i = _reduce_simd<Op>(p_array, size, p_width, r_result);
+
+	if (i == 0) {
+		for (int j = 0; j < p_width; j++) {
+			r_result[j] = p_array[j];
+		}
+		i = p_width;
+	}
+
+	for (; i < size; i++) {
+		r_result[i % p_width] = Op::template scalar<S>(r_result[i % p_width], p_array[i]);
+	}
+}
+
+template <class T>
+void BulkMath::add(T *p_array, int p_count, int p_width, const Operand<T> &p_value) {
+	_binary<_BulkAdd>(p_array, p_count, p_width, p_value);
+}
+
+template <class T>
+void BulkMath::multiply(T *p_array, int p_count, int p_width, const Operand<T> &p_value) {
+	_binary<_BulkMultiply>(p_array, p_count, p_width, p_value);
+}
+
+template <class T>
+void BulkMath::multiply_add(T *p_array, int p_count, int p_width, const Operand<T> &p_multiplier, const Operand<T> &p_addend) {
+	_ternary<_BulkMultiplyAdd>(p_array, p_count, p_width, p_multiplier, p_addend);
+}
+
+template <class T>
+void BulkMath::clamp(T *p_array, int p_count, int p_width, const Operand<T> &p_min, const Operand<T> &p_max) {
+	_ternary<_BulkClamp>(p_array, p_count, p_width, p_min, p_max);
+}
+
+template <class T>
+void BulkMath::lerp(T *p_array, int p_count, int p_width, const Operand<T> &p_to, T p_weight) {
+	T weight[4] = { p_weight, p_weight, p_weight, p_weight };
+	_ternary<_BulkLerp>(p_array, p_count, p_width, p_to, Operand<T>(weight, false));
+}
+
+template <class T, class S>
+void BulkMath::sum(const T *p_array, int p_count, int p_width, S *r_sum) {
+
+	if (p_count == 0) {
+		for (int j = 0; j < p_width; j++) {
+			r_sum[j] = 0;
+		}
+		return;
+	}
+	_reduce<_BulkAdd>(p_array, p_count, p_width, r_sum);
+}
+
+template <class T>
+void BulkMath::min(const T *p_array, int p_count, int p_width, T *r_min) {
+
+	ERR_FAIL_COND(p_count == 0);
+	_reduce<_BulkMin>(p_array, p_count, p_width, r_min);
+}
+
+template <class T>
+void BulkMath::max(const T *p_array, int p_count, int p_width, T *r_max) {
+
+	ERR_FAIL_COND(p_count == 0);
+	_reduce<_BulkMax>(p_array, p_count, p_width, r_max);
+}
+
+template <class T>
+struct _BulkLess {
+	// NaNs (the only values not equal to themselves) go last.
+	_FORCE_INLINE_ bool operator()(T a, T b) const { return a < b || (b != b && a == a); }
+};
+
+template <class T>
+struct _BulkIndexLess {
+	const T *values;
+	_FORCE_INLINE_ bool operator()(int a, int b) const {
+		_BulkLess<T> less;
+		if (less(values[a], values[b])) {
+			return true;
+		}
+		return !less(values[b], values[a]) && a < b;
+	}
+};
+
+template <class T>
+void BulkMath::sort(T *p_array, int p_count) {
+
+	SortArray<T, _BulkLess<T> > sorter;
+	sorter.sort(p_array, p_count);
+}
+
+template <class T>
+void BulkMath::argsort(const T *p_array, int p_count, int *r_indices) {
+
+	for (int i = 0; i < p_count; i++) {
+		r_indices[i] = i;
+	}
+
+	SortArray<int, _BulkIndexLess<T> > sorter;
+	sorter.compare.values = p_array;
+	sorter.sort(r_indices, p_count);
+}
+
+#define BULK_MATH_INSTANCE(m_type)                                                                                                                               \
+	template void BulkMath::add<m_type>(m_type *, int, int, const Operand<m_type> &);                                                                            \
+	template void BulkMath::multiply<m_type>(m_type *, int, int, const Operand<m_type> &);                                                                       \
+	template void BulkMath::multiply_add<m_type>(m_type *, int, int, const Operand<m_type> &, const Operand<m_type> &);                                          \
+	template void BulkMath::clamp<m_type>(m_type *, int, int, const Operand<m_type> &, const Operand<m_type> &);                                                 \
+	template void BulkMath::min<m_type>(const m_type *, int, int, m_type *);                                                                                     \
+	template void BulkMath::max<m_type>(const m_type *, int, int, m_type *);                                                                                     \
+	template void BulkMath::sort<m_type>(m_type *, int);                                                                                                         \
+	template void BulkMath::argsort<m_type>(const m_type *, int, int *);
+
+BULK_MATH_INSTANCE(float)
+BULK_MATH_INSTANCE(double)
+BULK_MATH_INSTANCE(int)
+
+template void BulkMath::lerp<float>(float *, int, int, const Operand<float> &, float);
+template void BulkMath::lerp<double>(double *, int, int, const Operand<double> &, double);
+template void BulkMath::sum<float, float>(const float *, int, int, float *);
+template void BulkMath::sum<double, double>(const double *, int, int, double *);
+template void BulkMath::sum<int, int64_t>(const int *, int, int, int64_t *);
+
+// Transforms read whole elements before writing them, so they work in place.
+
+void BulkMath::transform(const Vector2 *p_src, Vector2 *p_dst, int p_count, const Transform2D &p_xform) {
+
+	int i = 0;
+
+#if defined(SIMD_SSE2_ENABLED) && !defined(REAL_T_IS_DOUBLE)
+	// Two points per register.
+	const float *src = (const float *)p_src;
+	float *dst = (float *)p_dst;
+	const Vector2 *e = p_xform.elements;
+	__m128 cx = _mm_setr_ps(e[0].x, e[0].y, e[0].x, e[0].y);
+	__m128 cy = _mm_setr_ps(e[1].x, e[1].y, e[1].x, e[1].y);
+	__m128 origin = _mm_setr_ps(e[2].x, e[2].y, e[2].x, e[2].y);
+
+	for (; i + 2 <= p_count; i += 2) {
+		__m128 v = _mm_loadu_ps(src + i * 2);
+		__m128 x = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+		__m128 y = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+		_mm_storeu_ps(dst + i * 2, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, cx), _mm_mul_ps(y, cy)), origin));
+	}
+#elif defined(SIMD_NEON_ENABLED) && !defined(REAL_T_IS_DOUBLE)
+	// Four points at a time, split into x and y registers.
+	const float *src = (const float *)p_src;
+	float *dst = (float *)p_dst;
+	const Vector2 *e = p_xform.elements;
+
+	for (; i + 4 <= p_count; i += 4) {
+		float32x4x2_t v = vld2q_f32(src + i * 2);
+		float32x4x2_t r;
+		r.val[0] = vaddq_f32(vaddq_f32(vmulq_n_f32(v.val[0], e[0].x), vmulq_n_f32(v.val[1], e[1].x)), vdupq_n_f32(e[2].x));
+		r.val[1] = vaddq_f32(vaddq_f32(vmulq_n_f32(v.val[0], e[0].y), vmulq_n_f32(v.val[1], e[1].y)), vdupq_n_f32(e[2].y));
+		vst2q_f32(dst + i * 2, r);
+	}
+#endif
+
+	for (; i < p_count; i++) {
+		p_dst[i] = p_xform.xform(p_src[i]);
+	}
+}
+
+void BulkMath::transform(const Vector3 *p_src, Vector3 *p_dst, int p_count, const Transform &p_xform) {
+
+	int i = 0;
+
+#if defined(SIMD_ENABLED) && !defined(REAL_T_IS_DOUBLE)
+	// Four points at a time, as separate x, y and z registers.
+	const float *src = (const float *)p_src;
+	float *dst = (float *)p_dst;
+	const Vector3 *rows = p_xform.basis.elements;
+	const Vector3 &o = p_xform.origin;
+
+	for (; i + 4 <= p_count; i += 4) {
+#ifdef SIMD_SSE2_ENABLED
+		// a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+		__m128 a = _mm_loadu_ps(src + i * 3);
+		__m128 b = _mm_loadu_ps(src + i * 3 + 4);
+		__m128 c = _mm_loadu_ps(src + i * 3 + 8);
+		__m128 x = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		__m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+#else
+		float32x4x3_t v = vld3q_f32(src + i * 3);
+		float32x4_t x = v.val[0];
+		float32x4_t y = v.val[1];
+		float32x4_t z = v.val[2];
+#endif
+		SIMDFloat4 r[3];
+		for (int j = 0; j < 3; j++) {
+			r[j] = simd_add(simd_add(simd_add(simd_mul(x, simd_splat(rows[j].x)), simd_mul(y, simd_splat(rows[j].y))), simd_mul(z, simd_splat(rows[j].z))), simd_splat(o[j]));
+		}
+#ifdef SIMD_SSE2_ENABLED
+		_mm_storeu_ps(dst + i * 3, _mm_shuffle_ps(_mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(dst + i * 3 + 4, _mm_shuffle_ps(_mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(r[0], r[1], _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps(dst + i * 3 + 8, _mm_shuffle_ps(_mm_shuffle_ps(r[2], r[0], _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(r[1], r[2], _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+#else
+		float32x4x3_t out;
+		out.val[0] = r[0];
+		out.val[1] = r[1];
+		out.val[2] = r[2];
+		vst3q_f32(dst + i * 3, out);
+#endif
+	}
+#endif
+
+	for (; i < p_count; i++) {
+		p_dst[i] = p_xform.xform(p_src[i]);
+	}
+}
@@ -0,0 +1,93 @@
+/*************************************************************************/
+/*  bulk_math.h                                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BULK_MATH_H
+#define BULK_MATH_H
+
+#include "core/typedefs.h"
+
+class Transform;
+class Transform2D;
+struct Vector2;
+struct Vector3;
+
+// Arithmetic over whole arrays, used by the math methods of the pool arrays.
+//
+// An array holds p_count elements of p_width (1 to 4) consecutive components,
+// so a PoolVector3Array is an array of real_t with a width of 3. Operands are
+// either arrays of the same size or a single element used for every element.
+// Float arrays use SIMD when available (see simd.h); results may differ in
+// the last bits from the scalar code.
+class BulkMath {
+public:
+	template <class T>
+	struct Operand {
+		const T *ptr;
+		bool array;
+
+		Operand(const T *p_ptr, bool p_array) :
+				ptr(p_ptr),
+				array(p_array) {}
+	};
+
+	// In place, for float, double and int arrays.
+	template <class T>
+	static void add(T *p_array, int p_count, int p_width, const Operand<T> &p_value);
+	template <class T>
+	static void multiply(T *p_array, int p_count, int p_width, const Operand<T> &p_value);
+	template <class T>
+	static void multiply_add(T *p_array, int p_count, int p_width, const Operand<T> &p_multiplier, const Operand<T> &p_addend);
+	template <class T>
+	static void clamp(T *p_array, int p_count, int p_width, const Operand<T> &p_min, const Operand<T> &p_max);
+	// Float and double arrays only.
+	template <class T>
+	static void lerp(T *p_array, int p_count, int p_width, const Operand<T> &p_to, T p_weight);
+
+	// Component-wise reductions, writing p_width values. min() and max()
+	// need at least one element. Int sums are returned as int64_t.
+	template <class T, class S>
+	static void sum(const T *p_array, int p_count, int p_width, S *r_sum);
+	template <class T>
+	static void min(const T *p_array, int p_count, int p_width, T *r_min);
+	template <class T>
+	static void max(const T *p_array, int p_count, int p_width, T *r_max);
+
+	// Ascending, NaNs last. argsort() keeps equal values in index order.
+	template <class T>
+	static void sort(T *p_array, int p_count);
+	template <class T>
+	static void argsort(const T *p_array, int p_count, int *r_indices);
+
+	// p_src and p_dst may be the same array.
+	static void transform(const Vector2 *p_src, Vector2 *p_dst, int p_count, const Transform2D &p_xform);
+	static void transform(const Vector3 *p_src, Vector3 *p_dst, int p_count, const Transform &p_xform);
+};
+
+#endif // BULK_MATH_H
@@ -0,0 +1,845 @@
+/*************************************************************************/
+/*  bvh.h                                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BVH_H
+#define BVH_H
+
+#include "core/local_vector.h"
+#include "core/math/aabb.h"
+#include "core/math/aabb4.h"
+#include "core/math/bvh_tree.h"
+#include "core/math/plane.h"
+#include "core/math/vector3.h"
+#include "core/vector.h"
+
+typedef uint32_t BVHElementID;
+
+#define BVH_ELEMENT_INVALID_ID 0
+
+/**
+ * Dynamic bounding volume hierarchy, a drop-in replacement for Octree.
+ *
+ * Elements are kept in BVHTrees. They start in a static tree, which holds
+ * their exact bounds, and move to a dynamic tree the first time they are
+ * moved. Leaves in the dynamic trees are enlarged by a margin, so most moves
+ * only change the element and leave the tree alone.
+ *
+ * Pairable elements have trees of their own, as elements that aren't
+ * pairable only need to search those for pairs. Nodes keep the union of the
+ * types and pairing masks of the elements below them, so culls with a mask
+ * and pair searches skip whole subtrees. Pairs are only searched for the
+ * element that is created, moved or changed.
+ */
+template <class T, bool use_pairs = false>
+class BVH {
+public:
+	typedef void *(*PairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int);
+	typedef void (*UnpairCallback)(void *, BVHElementID, T *, int, BVHElementID, T *, int, void *);
+
+private:
+	enum {
+		TREE_STATIC,
+		TREE_DYNAMIC,
+		TREE_PAIRABLE_STATIC,
+		TREE_PAIRABLE_DYNAMIC,
+		TREE_MAX
+	};
+
+	enum {
+		MAX_TRACKED_PLANES = 32 // planes a convex cull can mark as passed for a whole subtree
+	};
+
+	struct NodeMasks {
+
+		// Unions over the elements in the subtree.
+		uint32_t types;
+		uint32_t masks;
+
+		_FORCE_INLINE_ void merge(const NodeMasks &p_a, const NodeMasks &p_b) {
+			types = p_a.types | p_b.types;
+			masks = p_a.masks | p_b.masks;
+		}
+	};
+
+	typedef BVHTree<AABB, NodeMasks> Tree;
+	typedef typename Tree::Node Node;
+
+	enum {
+		NODE_NULL = Tree::NODE_NULL
+	};
+
+	struct Element {
+
+		T *userdata;
+		int subindex;
+		bool alive;
+		bool pairable;
+		bool dynamic;
+		uint32_t pairable_type;
+		uint32_t pairable_mask;
+
+		AABB aabb;
+		uint32_t tree; // tree the leaf is in
+		uint32_t leaf; // NODE_NULL while not in a tree, as elements without surface aren't
+		uint32_t last_pass;
+
+		LocalVector<uint32_t> pairs;
+
+		Element() {
+			userdata = NULL;
+			subindex = 0;
+			alive = false;
+			pairable = false;
+			dynamic = false;
+			pairable_type = 0;
+			pairable_mask = 0;
+			tree = TREE_STATIC;
+			leaf = NODE_NULL;
+			last_pass = 0;
+		}
+	};
+
+	struct Pair {
+
+		BVHElementID A;
+		BVHElementID B;
+		uint32_t A_index; // position in the pair list of A
+		uint32_t B_index; // position in the pair list of B
+		void *ud;
+	};
+
+	LocalVector<Element> elements;
+	LocalVector<BVHElementID> free_elements;
+	LocalVector<Pair> pairs;
+	LocalVector<uint32_t> free_pairs;
+	Tree trees[TREE_MAX];
+
+	PairCallback pair_callback;
+	UnpairCallback unpair_callback;
+	void *pair_callback_userdata;
+	void *unpair_callback_userdata;
+
+	uint32_t pass;
+	int element_count;
+	int pair_count;
+
+	_FORCE_INLINE_ Element &_get_element(BVHElementID p_id) { return elements[p_id - 1]; }
+
+	// Margin for leaves in the dynamic trees, so elements can move a bit
+	// before their leaf has to change.
+	static _FORCE_INLINE_ AABB _get_fat_aabb(const AABB &p_aabb) {
+		return p_aabb.grow(p_aabb.get_longest_axis_size() * 0.25);
+	}
+
+	void _insert_element(BVHElementID p_id);
+	void _remove_element(BVHElementID p_id);
+	static NodeMasks _get_masks(const Element &p_element);
+
+	void _pair(BVHElementID p_A, BVHElementID p_B);
+	void _unpair(uint32_t p_pair);
+	void _unpair_all(BVHElementID p_id);
+	void _remove_pair_ref(BVHElementID p_id, uint32_t p_index);
+	void _update_pairs(BVHElementID p_id);
+
+	// Pairs the element with the ones it overlaps in a tree.
+	struct _PairSearch {
+		BVH *bvh;
+		BVHElementID id;
+		const Element *element;
+
+		_FORCE_INLINE_ bool test(const Node &p_node) const {
+			return ((p_node.types & element->pairable_mask) || (p_node.masks & element->pairable_type)) && p_node.aabb.intersects_inclusive(element->aabb);
+		}
+
+		bool leaf(BVHElementID p_other) {
+			Element &other = bvh->_get_element(p_other);
+
+			if (p_other == id || other.last_pass == bvh->pass || (other.userdata == element->userdata && element->userdata)) {
+				return true;
+			}
+
+			if (!(other.pairable_type & element->pairable_mask) && !(element->pairable_type & other.pairable_mask)) {
+				return true;
+			}
+
+			if (element->aabb.intersects_inclusive(other.aabb)) {
+				other.last_pass = bvh->pass;
+				bvh->_pair(id, p_other);
+			}
+			return true;
+		}
+	};
+
+	struct _CullAABB {
+		const AABB &aabb;
+		_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return aabb.intersects_inclusive(p_aabb); }
+		_CullAABB(const AABB &p_aabb) :
+				aabb(p_aabb) {}
+	};
+
+	struct _CullSegment {
+		const Vector3 &from;
+		const Vector3 &to;
+		_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+		_CullSegment(const Vector3 &p_from, const Vector3 &p_to) :
+				from(p_from),
+				to(p_to) {}
+	};
+
+	struct _CullPoint {
+		const Vector3 &point;
+		_FORCE_INLINE_ bool operator()(const AABB &p_aabb) const { return p_aabb.has_point(point); }
+		_CullPoint(const Vector3 &p_point) :
+				point(p_point) {}
+	};
+
+	// Gathers the elements passing the test C in a tree.
+	template <class C>
+	struct _Cull {
+		const BVH *bvh;
+		const C &test_aabb;
+		uint32_t mask;
+		T **result_array;
+		int *subindex_array;
+		int result_max;
+		int result_count;
+
+		_FORCE_INLINE_ bool test(const Node &p_node) const {
+			if (use_pairs && !(p_node.types & mask)) {
+				return false;
+			}
+			return p_node.is_leaf() || test_aabb(p_node.aabb); // leaves are tested with the exact bounds
+		}
+
+		bool leaf(BVHElementID p_element) {
+			const Element &e = bvh->elements[p_element - 1];
+			if (!test_aabb(e.aabb)) {
+				return true;
+			}
+
+			if (result_count == result_max) {
+				return false;
+			}
+
+			result_array[result_count] = e.userdata;
+			if (subindex_array) {
+				subindex_array[result_count] = e.subindex;
+			}
+			result_count++;
+			return true;
+		}
+
+		_Cull(const BVH *p_bvh, const C &p_test) :
+				bvh(p_bvh),
+				test_aabb(p_test) {}
+	};
+
+	template <class C>
+	int _cull(const C &p_test, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const;
+	int _cull_convex(uint32_t p_tree, uint32_t p_node, const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask) const;
+
+public:
+	// Disjoint parts of the trees, so a cull can be split in jobs.
+	struct Subtree {
+		uint32_t tree;
+		uint32_t node;
+	};
+
+	BVHElementID create(T *p_userdata, const AABB &p_aabb = AABB(), int p_subindex = 0, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t pairable_mask = 1);
+	void move(BVHElementID p_id, const AABB &p_aabb);
+	void set_pairable(BVHElementID p_id, bool p_pairable = false, uint32_t p_pairable_type = 0, uint32_t pairable_mask = 1);
+	void erase(BVHElementID p_id);
+
+	bool is_pairable(BVHElementID p_id) const;
+	T *get(BVHElementID p_id) const;
+	int get_subindex(BVHElementID p_id) const;
+
+	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_convex(const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+
+	int cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF) const;
+
+	// Splits the trees in up to p_max subtrees, always opening the tallest
+	// one. Culling every subtree in order finds what a whole cull finds.
+	void get_subtrees(LocalVector<Subtree> &r_subtrees, int p_max) const;
+	int cull_convex(const Subtree &p_subtree, const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF) const;
+
+	void set_pair_callback(PairCallback p_callback, void *p_userdata);
+	void set_unpair_callback(UnpairCallback p_callback, void *p_userdata);
+
+	int get_elem_count() const { return element_count; }
+	int get_pair_count() const { return pair_count; }
+	BVH();
+};
+
+/* PRIVATE FUNCTIONS */
+
+template <class T, bool use_pairs>
+typename BVH<T, use_pairs>::NodeMasks BVH<T, use_pairs>::_get_masks(const Element &p_element) {
+
+	NodeMasks masks;
+	masks.types = p_element.pairable_type;
+	masks.masks = p_element.pairable_mask;
+	return masks;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_insert_element(BVHElementID p_id) {
+
+	Element &e = _get_element(p_id);
+	e.tree = (e.dynamic ? TREE_DYNAMIC : TREE_STATIC) + (use_pairs && e.pairable ? TREE_PAIRABLE_STATIC : 0);
+	e.leaf = trees[e.tree].insert(e.dynamic ? _get_fat_aabb(e.aabb) : e.aabb, p_id, _get_masks(e));
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_remove_element(BVHElementID p_id) {
+
+	Element &e = _get_element(p_id);
+	trees[e.tree].remove(e.leaf);
+	e.leaf = NODE_NULL;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_pair(BVHElementID p_A, BVHElementID p_B) {
+
+	uint32_t index;
+	if (free_pairs.size()) {
+		index = free_pairs[free_pairs.size() - 1];
+		free_pairs.resize(free_pairs.size() - 1);
+	} else {
+		index = pairs.size();
+		pairs.push_back(Pair());
+	}
+
+	Element &A = _get_element(p_A);
+	Element &B = _get_element(p_B);
+
+	Pair &pair = pairs[index];
+	pair.A = p_A;
+	pair.B = p_B;
+	pair.A_index = A.pairs.size();
+	pair.B_index = B.pairs.size();
+	pair.ud = NULL;
+	A.pairs.push_back(index);
+	B.pairs.push_back(index);
+
+	pair_count++;
+
+	if (pair_callback) {
+		void *ud = pair_callback(pair_callback_userdata, p_A, A.userdata, A.subindex, p_B, B.userdata, B.subindex);
+		pairs[index].ud = ud;
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_remove_pair_ref(BVHElementID p_id, uint32_t p_index) {
+
+	LocalVector<uint32_t> &list = _get_element(p_id).pairs;
+
+	uint32_t last = list[list.size() - 1];
+	list[p_index] = last;
+	list.resize(list.size() - 1);
+
+	if (p_index < list.size()) {
+		Pair &moved = pairs[last];
+		if (moved.A == p_id) {
+			moved.A_index = p_index;
+		} else {
+			moved.B_index = p_index;
+		}
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_unpair(uint32_t p_pair) {
+
+	const Pair pair = pairs[p_pair];
+
+	_remove_pair_ref(pair.A, pair.A_index);
+	_remove_pair_ref(pair.B, pair.B_index);
+	free_pairs.push_back(p_pair);
+
+	pair_count--;
+
+	if (unpair_callback) {
+		const Element &A = _get_element(pair.A);
+		const Element &B = _get_element(pair.B);
+		unpair_callback(unpair_callback_userdata, pair.A, A.userdata, A.subindex, pair.B, B.userdata, B.subindex, pair.ud);
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_unpair_all(BVHElementID p_id) {
+
+	const LocalVector<uint32_t> &list = _get_element(p_id).pairs;
+	while (list.size()) {
+		_unpair(list[list.size() - 1]);
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::_update_pairs(BVHElementID p_id) {
+
+	pass++;
+
+	// Drop the pairs that stopped overlapping and mark the others, so they
+	// are not paired again below.
+	Element &e = _get_element(p_id);
+	for (int i = int(e.pairs.size()) - 1; i >= 0; i--) {
+
+		const Pair &pair = pairs[e.pairs[i]];
+		Element &other = _get_element(pair.A == p_id ? pair.B : pair.A);
+
+		if (e.leaf != NODE_NULL && other.leaf != NODE_NULL && e.aabb.intersects_inclusive(other.aabb)) {
+			other.last_pass = pass;
+		} else {
+			_unpair(e.pairs[i]);
+		}
+	}
+
+	if (e.leaf == NODE_NULL) {
+		return;
+	}
+
+	_PairSearch search;
+	search.bvh = this;
+	search.id = p_id;
+	search.element = &e;
+
+	// Elements only pair when at least one of them is pairable.
+	for (int t = e.pairable ? 0 : int(TREE_PAIRABLE_STATIC); t < TREE_MAX; t++) {
+		trees[t].cull(trees[t].get_root(), search);
+	}
+}
+
+template <class T, bool use_pairs>
+template <class C>
+int BVH<T, use_pairs>::_cull(const C &p_test, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	_Cull<C> cull(this, p_test);
+	cull.mask = p_mask;
+	cull.result_array = p_result_array;
+	cull.subindex_array = p_subindex_array;
+	cull.result_max = p_result_max;
+	cull.result_count = 0;
+
+	for (int t = 0; t < TREE_MAX && cull.result_count < p_result_max; t++) {
+		trees[t].cull(trees[t].get_root(), cull);
+	}
+
+	return cull.result_count;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::_cull_convex(uint32_t p_tree, uint32_t p_node, const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask) const {
+
+	// Each entry carries the planes its node may still cross. Once a node is
+	// inside all of them, everything below it is accepted without testing.
+	struct Entry {
+		uint32_t node;
+		uint32_t plane_mask;
+	};
+
+	uint32_t all_planes = p_convex_count >= MAX_TRACKED_PLANES ? 0xFFFFFFFF : (1 << p_convex_count) - 1;
+
+	const Tree &tree = trees[p_tree];
+	int result_count = 0;
+	LocalVector<Entry, 64> stack;
+
+	Entry root = { p_node, all_planes };
+	stack.push_back(root);
+
+	// Nodes are tested four at a time, against all the planes any of them may
+	// still cross. Testing planes a node is already inside of doesn't change
+	// the result.
+	AABB4 batch;
+	Entry batch_entries[4];
+
+	while (stack.size()) {
+
+		int batch_count = 0;
+		uint32_t batch_planes = 0;
+
+		while (batch_count < 4 && stack.size()) {
+
+			Entry entry = stack[stack.size() - 1];
+			stack.resize(stack.size() - 1);
+
+			const Node &node = tree.get_node(entry.node);
+
+			if (use_pairs && !(node.types & p_mask)) {
+				continue;
+			}
+
+			if (entry.plane_mask) {
+				batch.set(batch_count, node.is_leaf() ? elements[node.element - 1].aabb : node.aabb);
+				batch_entries[batch_count++] = entry;
+				batch_planes |= entry.plane_mask;
+				continue;
+			}
+
+			if (!node.is_leaf()) {
+				Entry child = { node.children[0], 0 };
+				stack.push_back(child);
+				child.node = node.children[1];
+				stack.push_back(child);
+				continue;
+			}
+
+			if (result_count == p_result_max) {
+				return result_count;
+			}
+
+			p_result_array[result_count++] = elements[node.element - 1].userdata;
+		}
+
+		uint32_t inside = 0;
+		uint32_t intersecting = batch_count ? batch.intersects_convex_shape(p_convex, p_convex_count, batch_count, batch_planes, &inside) : 0;
+
+		for (int i = 0; i < batch_count; i++) {
+
+			if (!(intersecting & (1 << i))) {
+				continue;
+			}
+
+			const Node &node = tree.get_node(batch_entries[i].node);
+
+			if (!node.is_leaf()) {
+				Entry child = { node.children[0], (inside & (1 << i)) ? 0 : batch_entries[i].plane_mask };
+				stack.push_back(child);
+				child.node = node.children[1];
+				stack.push_back(child);
+				continue;
+			}
+
+			if (result_count == p_result_max) {
+				return result_count;
+			}
+
+			p_result_array[result_count++] = elements[node.element - 1].userdata;
+		}
+	}
+
+	return result_count;
+}
+
+/* PUBLIC FUNCTIONS */
+
+template <class T, bool use_pairs>
+BVHElementID BVH<T, use_pairs>::create(T *p_userdata, const AABB &p_aabb, int p_subindex, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+// check for AABB validity
+#ifdef DEBUG_ENABLED
+	ERR_FAIL_COND_V(p_aabb.position.x > 1e15 || p_aabb.position.x < -1e15, 0);
+	ERR_FAIL_COND_V(p_aabb.position.y > 1e15 || p_aabb.position.y < -1e15, 0);
+	ERR_FAIL_COND_V(p_aabb.position.z > 1e15 || p_aabb.position.z < -1e15, 0);
+	ERR_FAIL_COND_V(p_aabb.size.x > 1e15 || p_aabb.size.x < 0.0, 0);
+	ERR_FAIL_COND_V(p_aabb.size.y > 1e15 || p_aabb.size.y < 0.0, 0);
+	ERR_FAIL_COND_V(p_aabb.size.z > 1e15 || p_aabb.size.z < 0.0, 0);
+	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.x), 0);
+	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.y), 0);
+	ERR_FAIL_COND_V(Math::is_nan(p_aabb.size.z), 0);
+#endif
+
+	BVHElementID id;
+	if (free_elements.size()) {
+		id = free_elements[free_elements.size() - 1];
+		free_elements.resize(free_elements.size() - 1);
+	} else {
+		elements.push_back(Element());
+		id = elements.size();
+	}
+
+	Element &e = _get_element(id);
+	e.userdata = p_userdata;
+	e.subindex = p_subindex;
+	e.alive = true;
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+	e.dynamic = false;
+	e.aabb = p_aabb;
+	e.leaf = NODE_NULL;
+
+	element_count++;
+
+	if (!p_aabb.has_no_surface()) {
+		_insert_element(id);
+		if (use_pairs) {
+			_update_pairs(id);
+		}
+	}
+
+	return id;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::move(BVHElementID p_id, const AABB &p_aabb) {
+
+#ifdef DEBUG_ENABLED
+	// check for AABB validity
+	ERR_FAIL_COND(p_aabb.position.x > 1e15 || p_aabb.position.x < -1e15);
+	ERR_FAIL_COND(p_aabb.position.y > 1e15 || p_aabb.position.y < -1e15);
+	ERR_FAIL_COND(p_aabb.position.z > 1e15 || p_aabb.position.z < -1e15);
+	ERR_FAIL_COND(p_aabb.size.x > 1e15 || p_aabb.size.x < 0.0);
+	ERR_FAIL_COND(p_aabb.size.y > 1e15 || p_aabb.size.y < 0.0);
+	ERR_FAIL_COND(p_aabb.size.z > 1e15 || p_aabb.size.z < 0.0);
+	ERR_FAIL_COND(Math::is_nan(p_aabb.size.x));
+	ERR_FAIL_COND(Math::is_nan(p_aabb.size.y));
+	ERR_FAIL_COND(Math::is_nan(p_aabb.size.z));
+#endif
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size() || !_get_element(p_id).alive);
+	Element &e = _get_element(p_id);
+
+	if (e.aabb == p_aabb) {
+		return;
+	}
+
+	e.aabb = p_aabb;
+
+	if (p_aabb.has_no_surface()) {
+		if (e.leaf != NODE_NULL) {
+			_remove_element(p_id);
+		}
+	} else if (e.leaf == NODE_NULL) {
+		_insert_element(p_id);
+	} else if (!e.dynamic) {
+		// Moved after creation, from now on it's treated as dynamic.
+		_remove_element(p_id);
+		e.dynamic = true;
+		_insert_element(p_id);
+	} else if (!trees[e.tree].get_node(e.leaf).aabb.encloses(p_aabb)) {
+		trees[e.tree].move(e.leaf, _get_fat_aabb(p_aabb));
+	}
+
+	if (use_pairs) {
+		_update_pairs(p_id);
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::set_pairable(BVHElementID p_id, bool p_pairable, uint32_t p_pairable_type, uint32_t p_pairable_mask) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size() || !_get_element(p_id).alive);
+	Element &e = _get_element(p_id);
+
+	if (p_pairable == e.pairable && e.pairable_type == p_pairable_type && e.pairable_mask == p_pairable_mask)
+		return; // no changes, return
+
+	if (use_pairs) {
+		_unpair_all(p_id);
+	}
+
+	bool tree_changed = use_pairs && p_pairable != e.pairable;
+
+	e.pairable = p_pairable;
+	e.pairable_type = p_pairable_type;
+	e.pairable_mask = p_pairable_mask;
+
+	if (e.leaf != NODE_NULL) {
+		if (tree_changed) {
+			_remove_element(p_id);
+			_insert_element(p_id);
+		} else {
+			trees[e.tree].set_data(e.leaf, _get_masks(e));
+		}
+
+		if (use_pairs) {
+			_update_pairs(p_id);
+		}
+	}
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::erase(BVHElementID p_id) {
+
+	ERR_FAIL_COND(p_id == 0 || p_id > elements.size() || !_get_element(p_id).alive);
+
+	if (use_pairs) {
+		_unpair_all(p_id);
+	}
+
+	Element &e = _get_element(p_id);
+	if (e.leaf != NODE_NULL) {
+		_remove_element(p_id);
+	}
+
+	e.alive = false;
+	e.userdata = NULL;
+	e.pairs.reset();
+	free_elements.push_back(p_id);
+
+	element_count--;
+}
+
+template <class T, bool use_pairs>
+bool BVH<T, use_pairs>::is_pairable(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].alive, false);
+	return elements[p_id - 1].pairable;
+}
+
+template <class T, bool use_pairs>
+T *BVH<T, use_pairs>::get(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].alive, NULL);
+	return elements[p_id - 1].userdata;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::get_subindex(BVHElementID p_id) const {
+
+	ERR_FAIL_COND_V(p_id == 0 || p_id > elements.size() || !elements[p_id - 1].alive, -1);
+	return elements[p_id - 1].subindex;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask) const {
+
+	return cull_convex(p_convex.ptr(), p_convex.size(), p_result_array, p_result_max, p_mask);
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_convex(const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask) const {
+
+	if (!p_convex_count) {
+		return 0;
+	}
+
+	int result_count = 0;
+
+	for (int t = 0; t < TREE_MAX; t++) {
+
+		if (trees[t].get_root() == NODE_NULL) {
+			continue;
+		}
+
+		result_count += _cull_convex(t, trees[t].get_root(), p_convex, p_convex_count, p_result_array + result_count, p_result_max - result_count, p_mask);
+	}
+
+	return result_count;
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	return _cull(_CullAABB(p_aabb), p_result_array, p_result_max, p_subindex_array, p_mask);
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	return _cull(_CullSegment(p_from, p_to), p_result_array, p_result_max, p_subindex_array, p_mask);
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_point(const Vector3 &p_point, T **p_result_array, int p_result_max, int *p_subindex_array, uint32_t p_mask) const {
+
+	return _cull(_CullPoint(p_point), p_result_array, p_result_max, p_subindex_array, p_mask);
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::get_subtrees(LocalVector<Subtree> &r_subtrees, int p_max) const {
+
+	r_subtrees.clear();
+
+	for (int t = 0; t < TREE_MAX; t++) {
+
+		if (trees[t].get_root() != NODE_NULL) {
+			Subtree subtree = { (uint32_t)t, trees[t].get_root() };
+			r_subtrees.push_back(subtree);
+		}
+	}
+
+	while ((int)r_subtrees.size() < p_max) {
+
+		int tallest = -1;
+		int tallest_height = 0;
+
+		for (uint32_t i = 0; i < r_subtrees.size(); i++) {
+
+			int height = trees[r_subtrees[i].tree].get_node(r_subtrees[i].node).height;
+			if (height > tallest_height) {
+				tallest = i;
+				tallest_height = height;
+			}
+		}
+
+		if (tallest == -1) {
+			break; // only leaves left
+		}
+
+		Subtree &subtree = r_subtrees[tallest];
+		const Node &node = trees[subtree.tree].get_node(subtree.node);
+		Subtree second = { subtree.tree, node.children[1] };
+		subtree.node = node.children[0];
+		r_subtrees.push_back(second);
+	}
+}
+
+template <class T, bool use_pairs>
+int BVH<T, use_pairs>::cull_convex(const Subtree &p_subtree, const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask) const {
+
+	if (!p_convex_count) {
+		return 0;
+	}
+
+	return _cull_convex(p_subtree.tree, p_subtree.node, p_convex, p_convex_count, p_result_array, p_result_max, p_mask);
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::set_pair_callback(PairCallback p_callback, void *p_userdata) {
+
+	pair_callback = p_callback;
+	pair_callback_userdata = p_userdata;
+}
+
+template <class T, bool use_pairs>
+void BVH<T, use_pairs>::set_unpair_callback(UnpairCallback p_callback, void *p_userdata) {
+
+	unpair_callback = p_callback;
+	unpair_callback_userdata = p_userdata;
+}
+
+template <class T, bool use_pairs>
+BVH<T, use_pairs>::BVH() {
+
+	pair_callback = NULL;
+	unpair_callback = NULL;
+	pair_callback_userdata = NULL;
+	unpair_callback_userdata = NULL;
+	pass = 0;
+	element_count = 0;
+	pair_count = 0;
+}
+
+#endif // BVH_H
@@ -0,0 +1,489 @@
+/*************************************************************************/
+/*  bvh_tree.h                                                           */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BVH_TREE_H
+#define BVH_TREE_H
+
+#include "core/local_vector.h"
+#include "core/math/aabb.h"
+#include "core/math/rect2.h"
+
+// Per node data for trees that don't need any.
+struct BVHTreeNoData {
+
+	_FORCE_INLINE_ void merge(const BVHTreeNoData &p_a, const BVHTreeNoData &p_b) {}
+};
+
+/**
+ * Self-balancing AABB tree, shared by the BVH of the visual server
+ * scenarios and the BVH broadphases of the 2D and 3D physics servers.
+ *
+ * B is the bounds type, AABB or Rect2. Leaves are placed by the surface area
+ * heuristic (the perimeter in 2D). They hold the index of an element owned
+ * by the user, and the bounds they were given, which may be fattened so
+ * small moves don't touch the tree.
+ *
+ * By default the tree is kept height balanced, which makes inserts cheap,
+ * and a leaf that moves a little grows its ancestors in place. That suits
+ * the scenarios, where most instances never move. DYNAMIC trees, where many
+ * leaves move every frame, rotate nodes to lower their surface area instead
+ * and reinsert a leaf as soon as it leaves its parent, which costs more per
+ * insert but keeps the tree tight for pair searches.
+ *
+ * D is extra data merged from the leaves up to the root, such as the union
+ * of the types below a node, so culls can skip whole subtrees. It must
+ * provide merge(a, b), which sets it from the data of both children.
+ */
+template <class B, class D = BVHTreeNoData, bool DYNAMIC = false>
+class BVHTree {
+public:
+	enum {
+		NODE_NULL = 0xFFFFFFFF
+	};
+
+	struct Node : public D {
+
+		B aabb;
+		uint32_t parent; // next free node while unused
+		uint32_t children[2]; // NODE_NULL for leaves
+		uint32_t element; // leaves only
+		int height; // 0 for leaves
+
+		_FORCE_INLINE_ bool is_leaf() const { return children[0] == NODE_NULL; }
+	};
+
+private:
+	LocalVector<Node> nodes;
+	uint32_t root;
+	uint32_t free_node;
+
+	static _FORCE_INLINE_ real_t _get_cost(const AABB &p_aabb) {
+		return p_aabb.size.x * p_aabb.size.y + p_aabb.size.y * p_aabb.size.z + p_aabb.size.z * p_aabb.size.x;
+	}
+
+	static _FORCE_INLINE_ real_t _get_cost(const Rect2 &p_rect) {
+		return p_rect.size.x + p_rect.size.y;
+	}
+
+	uint32_t _alloc_node();
+	void _free_node(uint32_t p_node);
+	void _update_node(uint32_t p_node);
+	uint32_t _balance(uint32_t p_node);
+	void _rotate(uint32_t p_node);
+	void _refit(uint32_t p_node);
+	void _insert_leaf(uint32_t p_leaf);
+	void _remove_leaf(uint32_t p_leaf);
+	bool _refit_leaf(uint32_t p_leaf, const B &p_aabb);
+
+public:
+	// Returns the leaf of the element, which stays the same until it's removed.
+	uint32_t insert(const B &p_aabb, uint32_t p_element, const D &p_data = D());
+	void move(uint32_t p_leaf, const B &p_aabb);
+	void set_data(uint32_t p_leaf, const D &p_data);
+	void remove(uint32_t p_leaf);
+
+	_FORCE_INLINE_ uint32_t get_root() const { return root; }
+	_FORCE_INLINE_ const Node &get_node(uint32_t p_node) const { return nodes[p_node]; }
+
+	// Walks the subtree below p_node depth first. Nodes are only entered
+	// while p_cull.test(node) is true, and p_cull.leaf(element) is called for
+	// the leaves that pass it, the walk stops as soon as that returns false.
+	template <class C>
+	void cull(uint32_t p_node, C &p_cull) const;
+
+	BVHTree();
+};
+
+/* PRIVATE FUNCTIONS */
+
+template <class B, class D, bool DYNAMIC>
+uint32_t BVHTree<B, D, DYNAMIC>::_alloc_node() {
+
+	if (free_node != NODE_NULL) {
+		uint32_t node = free_node;
+		free_node = nodes[node].parent;
+		return node;
+	}
+
+	nodes.push_back(Node());
+	return nodes.size() - 1;
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::_free_node(uint32_t p_node) {
+
+	nodes[p_node].parent = free_node;
+	free_node = p_node;
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::_update_node(uint32_t p_node) {
+
+	Node &node = nodes[p_node];
+	const Node &a = nodes[node.children[0]];
+	const Node &b = nodes[node.children[1]];
+
+	node.aabb = a.aabb.merge(b.aabb);
+	node.height = 1 + MAX(a.height, b.height);
+	node.merge(a, b);
+}
+
+// Rotates the taller grandchild up when the subtree is out of balance,
+// returns the node now at the top of the subtree.
+template <class B, class D, bool DYNAMIC>
+uint32_t BVHTree<B, D, DYNAMIC>::_balance(uint32_t p_node) {
+
+	Node *n = nodes.ptr();
+	Node &a = n[p_node];
+
+	if (a.is_leaf() || a.height < 2) {
+		return p_node;
+	}
+
+	int balance = n[a.children[1]].height - n[a.children[0]].height;
+	if (balance >= -1 && balance <= 1) {
+		return p_node;
+	}
+
+	// Side of the taller child, which takes the place of this node.
+	int side = balance > 1 ? 1 : 0;
+	uint32_t up = a.children[side];
+	Node &u = n[up];
+
+	u.parent = a.parent;
+	a.parent = up;
+	if (u.parent != NODE_NULL) {
+		Node &parent = n[u.parent];
+		parent.children[parent.children[0] == p_node ? 0 : 1] = up;
+	} else {
+		root = up;
+	}
+
+	// The taller grandchild stays under the raised node, the other one
+	// replaces it under this node.
+	uint32_t f = u.children[0];
+	uint32_t g = u.children[1];
+	if (n[f].height < n[g].height) {
+		SWAP(f, g);
+	}
+
+	u.children[0] = p_node;
+	u.children[1] = f;
+	a.children[side] = g;
+	n[g].parent = p_node;
+
+	_update_node(p_node);
+	_update_node(up);
+
+	return up;
+}
+
+// Swaps a child with a grandchild on the other side when that lowers the
+// cost of the other side, which keeps the tree tight as leaves move around.
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::_rotate(uint32_t p_node) {
+
+	Node *n = nodes.ptr();
+	Node &a = n[p_node];
+
+	if (a.height < 2) {
+		return;
+	}
+
+	uint32_t ib = a.children[0];
+	uint32_t ic = a.children[1];
+	const Node &b = n[ib];
+	const Node &c = n[ic];
+
+	real_t best_gain = 0;
+	uint32_t child = NODE_NULL;
+	uint32_t grand_child = NODE_NULL;
+
+	if (!c.is_leaf()) {
+		real_t cost = _get_cost(c.aabb);
+		for (int i = 0; i < 2; i++) {
+			real_t gain = cost - _get_cost(b.aabb.merge(n[c.children[1 - i]].aabb));
+			if (gain > best_gain) {
+				best_gain = gain;
+				child = ib;
+				grand_child = c.children[i];
+			}
+		}
+	}
+
+	if (!b.is_leaf()) {
+		real_t cost = _get_cost(b.aabb);
+		for (int i = 0; i < 2; i++) {
+			real_t gain = cost - _get_cost(c.aabb.merge(n[b.children[1 - i]].aabb));
+			if (gain > best_gain) {
+				best_gain = gain;
+				child = ic;
+				grand_child = b.children[i];
+			}
+		}
+	}
+
+	if (child == NODE_NULL) {
+		return;
+	}
+
+	uint32_t ip = n[grand_child].parent;
+	Node &p = n[ip];
+
+	a.children[a.children[0] == child ? 0 : 1] = grand_child;
+	n[grand_child].parent = p_node;
+	p.children[p.children[0] == grand_child ? 0 : 1] = child;
+	n[child].parent = ip;
+
+	_update_node(ip);
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::_refit(uint32_t p_node) {
+
+	while (p_node != NODE_NULL) {
+		if (DYNAMIC) {
+			_rotate(p_node);
+			_update_node(p_node);
+		} else {
+			_update_node(p_node);
+			p_node = _balance(p_node);
+		}
+		p_node = nodes[p_node].parent;
+	}
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::_insert_leaf(uint32_t p_leaf) {
+
+	if (root == NODE_NULL) {
+		root = p_leaf;
+		nodes[p_leaf].parent = NODE_NULL;
+		return;
+	}
+
+	// Find the cheapest sibling by surface area, going down while placing
+	// the leaf further below costs less than pairing it with the current node.
+	const B leaf_aabb = nodes[p_leaf].aabb;
+	uint32_t sibling = root;
+
+	while (!nodes[sibling].is_leaf()) {
+
+		const Node &node = nodes[sibling];
+
+		real_t combined = _get_cost(node.aabb.merge(leaf_aabb));
+		real_t cost = 2.0 * combined;
+		real_t inheritance_cost = 2.0 * (combined - _get_cost(node.aabb));
+
+		real_t child_cost[2];
+		for (int i = 0; i < 2; i++) {
+			const Node &child = nodes[node.children[i]];
+			child_cost[i] = _get_cost(child.aabb.merge(leaf_aabb)) + inheritance_cost;
+			if (!child.is_leaf()) {
+				child_cost[i] -= _get_cost(child.aabb);
+			}
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1]) {
+			break;
+		}
+
+		sibling = node.children[child_cost[1] < child_cost[0] ? 1 : 0];
+	}
+
+	uint32_t old_parent = nodes[sibling].parent;
+	uint32_t new_parent = _alloc_node();
+
+	Node &parent = nodes[new_parent];
+	parent.parent = old_parent;
+	parent.children[0] = sibling;
+	parent.children[1] = p_leaf;
+	parent.element = 0;
+	nodes[sibling].parent = new_parent;
+	nodes[p_leaf].parent = new_parent;
+
+	if (old_parent != NODE_NULL) {
+		Node &grand_parent = nodes[old_parent];
+		grand_parent.children[grand_parent.children[0] == sibling ? 0 : 1] = new_parent;
+	} else {
+		root = new_parent;
+	}
+
+	_refit(new_parent);
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::_remove_leaf(uint32_t p_leaf) {
+
+	if (p_leaf == root) {
+		root = NODE_NULL;
+		return;
+	}
+
+	uint32_t parent = nodes[p_leaf].parent;
+	const Node &p = nodes[parent];
+	uint32_t grand_parent = p.parent;
+	uint32_t sibling = p.children[p.children[0] == p_leaf ? 1 : 0];
+
+	nodes[sibling].parent = grand_parent;
+	_free_node(parent);
+
+	if (grand_parent != NODE_NULL) {
+		Node &g = nodes[grand_parent];
+		g.children[g.children[0] == parent ? 0 : 1] = sibling;
+		_refit(grand_parent);
+	} else {
+		root = sibling;
+	}
+}
+
+// Changes the leaf in place and refits its ancestors, as long as it stays
+// inside its parent (dynamic trees) or doesn't make its parent much larger.
+// Otherwise the leaf has moved away from its neighbours and is better
+// reinserted, so it's left untouched.
+template <class B, class D, bool DYNAMIC>
+bool BVHTree<B, D, DYNAMIC>::_refit_leaf(uint32_t p_leaf, const B &p_aabb) {
+
+	uint32_t parent = nodes[p_leaf].parent;
+
+	if (parent != NODE_NULL) {
+		const Node &p = nodes[parent];
+		if (DYNAMIC) {
+			if (!p.aabb.encloses(p_aabb)) {
+				return false;
+			}
+		} else {
+			const Node &sibling = nodes[p.children[p.children[0] == p_leaf ? 1 : 0]];
+			if (_get_cost(sibling.aabb.merge(p_aabb)) > _get_cost(p.aabb) * 2.0) {
+				return false;
+			}
+		}
+	}
+
+	nodes[p_leaf].aabb = p_aabb;
+
+	while (parent != NODE_NULL) {
+		Node &node = nodes[parent];
+		B aabb = nodes[node.children[0]].aabb.merge(nodes[node.children[1]].aabb);
+		if (aabb == node.aabb) {
+			break; // nothing changes further up
+		}
+		node.aabb = aabb;
+		parent = node.parent;
+	}
+
+	return true;
+}
+
+/* PUBLIC FUNCTIONS */
+
+template <class B, class D, bool DYNAMIC>
+uint32_t BVHTree<B, D, DYNAMIC>::insert(const B &p_aabb, uint32_t p_element, const D &p_data) {
+
+	uint32_t leaf = _alloc_node();
+
+	Node &node = nodes[leaf];
+	static_cast<D &>(node) = p_data;
+	node.aabb = p_aabb;
+	node.children[0] = NODE_NULL;
+	node.children[1] = NODE_NULL;
+	node.element = p_element;
+	node.height = 0;
+
+	_insert_leaf(leaf);
+	return leaf;
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::move(uint32_t p_leaf, const B &p_aabb) {
+
+	if (!_refit_leaf(p_leaf, p_aabb)) {
+		_remove_leaf(p_leaf);
+		nodes[p_leaf].aabb = p_aabb;
+		_insert_leaf(p_leaf);
+	}
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::set_data(uint32_t p_leaf, const D &p_data) {
+
+	static_cast<D &>(nodes[p_leaf]) = p_data;
+	for (uint32_t node = nodes[p_leaf].parent; node != NODE_NULL; node = nodes[node].parent) {
+		_update_node(node);
+	}
+}
+
+template <class B, class D, bool DYNAMIC>
+void BVHTree<B, D, DYNAMIC>::remove(uint32_t p_leaf) {
+
+	_remove_leaf(p_leaf);
+	_free_node(p_leaf);
+}
+
+template <class B, class D, bool DYNAMIC>
+template <class C>
+void BVHTree<B, D, DYNAMIC>::cull(uint32_t p_node, C &p_cull) const {
+
+	if (p_node == NODE_NULL) {
+		return;
+	}
+
+	LocalVector<uint32_t, 64> stack;
+	stack.push_back(p_node);
+
+	while (stack.size()) {
+
+		const Node &node = nodes[stack[stack.size() - 1]];
+		stack.resize(stack.size() - 1);
+
+		if (!p_cull.test(node)) {
+			continue;
+		}
+
+		if (!node.is_leaf()) {
+			stack.push_back(node.children[0]);
+			stack.push_back(node.children[1]);
+			continue;
+		}
+
+		if (!p_cull.leaf(node.element)) {
+			return;
+		}
+	}
+}
+
+template <class B, class D, bool DYNAMIC>
+BVHTree<B, D, DYNAMIC>::BVHTree() {
+
+	root = NODE_NULL;
+	free_node = NODE_NULL;
+}
+
+#endif // BVH_TREE_H
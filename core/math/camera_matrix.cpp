@@ -279,7 +279,8 @@ void CameraMatrix::get_viewport_size(real_t &r_width, real_t &r_height) const {
 
 bool CameraMatrix::get_endpoints(const Transform &p_transform, Vector3 *p_8points) const {
 
-	Vector<Plane> planes = get_projection_planes(Transform());
+	LocalVector<Plane, 6> planes;
+	get_projection_planes(Transform(), planes);
 	const Planes intersections[8][3] = {
 		{ PLANE_FAR, PLANE_LEFT, PLANE_TOP },
 		{ PLANE_FAR, PLANE_LEFT, PLANE_BOTTOM },
@@ -304,13 +305,20 @@ bool CameraMatrix::get_endpoints(const Transform &p_transform, Vector3 *p_8point
 
 Vector<Plane> CameraMatrix::get_projection_planes(const Transform &p_transform) const {
 
+	LocalVector<Plane, 6> planes;
+	get_projection_planes(p_transform, planes);
+	return planes;
+}
+
+void CameraMatrix::get_projection_planes(const Transform &p_transform, LocalVector<Plane, 6> &r_planes) const {
+
 	/** Fast Plane Extraction from combined modelview/projection matrices.
 	 * References:
 	 * https://web.archive.org/web/20011221205252/http://www.markmorley.com/opengl/frustumculling.html
 	 * https://web.archive.org/web/20061020020112/http://www2.ravensoft.com/users/ggribb/plane%20extraction.pdf
 	 */
 
-	Vector<Plane> planes;
+	r_planes.clear();
 
 	const real_t *matrix = (const real_t *)this->matrix;
 
@@ -325,7 +333,7 @@ Vector<Plane> CameraMatrix::get_projection_planes(const Transform &p_transform)
 	new_plane.normal = -new_plane.normal;
 	new_plane.normalize();
 
-	planes.push_back(p_transform.xform(new_plane));
+	r_planes.push_back(p_transform.xform(new_plane));
 
 	///////--- Far Plane ---///////
 	new_plane = Plane(matrix[3] - matrix[2],
@@ -336,7 +344,7 @@ Vector<Plane> CameraMatrix::get_projection_planes(const Transform &p_transform)
 	new_plane.normal = -new_plane.normal;
 	new_plane.normalize();
 
-	planes.push_back(p_transform.xform(new_plane));
+	r_planes.push_back(p_transform.xform(new_plane));
 
 	///////--- Left Plane ---///////
 	new_plane = Plane(matrix[3] + matrix[0],
@@ -347,7 +355,7 @@ Vector<Plane> CameraMatrix::get_projection_planes(const Transform &p_transform)
 	new_plane.normal = -new_plane.normal;
 	new_plane.normalize();
 
-	planes.push_back(p_transform.xform(new_plane));
+	r_planes.push_back(p_transform.xform(new_plane));
 
 	///////--- Top Plane ---///////
 	new_plane = Plane(matrix[3] - matrix[1],
@@ -358,7 +366,7 @@ Vector<Plane> CameraMatrix::get_projection_planes(const Transform &p_transform)
 	new_plane.normal = -new_plane.normal;
 	new_plane.normalize();
 
-	planes.push_back(p_transform.xform(new_plane));
+	r_planes.push_back(p_transform.xform(new_plane));
 
 	///////--- Right Plane ---///////
 	new_plane = Plane(matrix[3] - matrix[0],
@@ -369,7 +377,7 @@ Vector<Plane> CameraMatrix::get_projection_planes(const Transform &p_transform)
 	new_plane.normal = -new_plane.normal;
 	new_plane.normalize();
 
-	planes.push_back(p_transform.xform(new_plane));
+	r_planes.push_back(p_transform.xform(new_plane));
 
 	///////--- Bottom Plane ---///////
 	new_plane = Plane(matrix[3] + matrix[1],
@@ -380,9 +388,7 @@ Vector<Plane> CameraMatrix::get_projection_planes(const Transform &p_transform)
 	new_plane.normal = -new_plane.normal;
 	new_plane.normalize();
 
-	planes.push_back(p_transform.xform(new_plane));
-
-	return planes;
+	r_planes.push_back(p_transform.xform(new_plane));
 }
 
 CameraMatrix CameraMatrix::inverse() const {
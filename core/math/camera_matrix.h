@@ -31,6 +31,7 @@
 #ifndef CAMERA_MATRIX_H
 #define CAMERA_MATRIX_H
 
+#include "core/local_vector.h"
 #include "core/math/rect2.h"
 #include "core/math/transform.h"
 
@@ -71,6 +72,8 @@ struct CameraMatrix {
 	bool is_orthogonal() const;
 
 	Vector<Plane> get_projection_planes(const Transform &p_transform) const;
+	// Same as above, but without allocating; used by the per frame culling code.
+	void get_projection_planes(const Transform &p_transform, LocalVector<Plane, 6> &r_planes) const;
 
 	bool get_endpoints(const Transform &p_transform, Vector3 *p_8points) const;
 	void get_viewport_size(real_t &r_width, real_t &r_height) const;
@@ -35,6 +35,7 @@
 #include "core/map.h"
 #include "core/math/aabb.h"
 #include "core/math/vector3.h"
+#include "core/oa_hash_map.h"
 #include "core/print_string.h"
 #include "core/variant.h"
 
@@ -98,6 +99,14 @@ private:
 		_FORCE_INLINE_ PairKey() {}
 	};
 
+	struct PairKeyHasher {
+		static _FORCE_INLINE_ uint32_t hash(const PairKey &p_key) { return hash_one_uint64(p_key.key); }
+	};
+
+	struct PairKeyComparator {
+		static _FORCE_INLINE_ bool compare(const PairKey &p_lhs, const PairKey &p_rhs) { return p_lhs.key == p_rhs.key; }
+	};
+
 	struct Element;
 
 	struct Octant {
@@ -185,7 +194,9 @@ private:
 	};
 
 	typedef Map<OctreeElementID, Element, Comparator<OctreeElementID>, AL> ElementMap;
-	typedef Map<PairKey, PairData, Comparator<PairKey>, AL> PairMap;
+	// Pairs are looked up on every move, so they are hashed. PairData is allocated
+	// separately because the elements keep pointers to it in their pair_list.
+	typedef OAHashMap<PairKey, PairData *, PairKeyHasher, PairKeyComparator> PairMap;
 	ElementMap element_map;
 	PairMap pair_map;
 
@@ -236,18 +247,19 @@ private:
 			return; // none can pair with none
 
 		PairKey key(p_A->_id, p_B->_id);
-		typename PairMap::Element *E = pair_map.find(key);
+		PairData **E = pair_map.lookup_ptr(key);
 
 		if (!E) {
 
-			PairData pdata;
-			pdata.refcount = 1;
-			pdata.A = p_A;
-			pdata.B = p_B;
-			pdata.intersect = false;
-			E = pair_map.insert(key, pdata);
-			E->get().eA = p_A->pair_list.push_back(&E->get());
-			E->get().eB = p_B->pair_list.push_back(&E->get());
+			PairData *pdata = memnew_allocator(PairData, AL);
+			pdata->refcount = 1;
+			pdata->A = p_A;
+			pdata->B = p_B;
+			pdata->intersect = false;
+			pdata->ud = NULL;
+			pair_map.insert(key, pdata);
+			pdata->eA = p_A->pair_list.push_back(pdata);
+			pdata->eB = p_B->pair_list.push_back(pdata);
 
 			/*
 			if (pair_callback)
@@ -255,7 +267,7 @@ private:
 			*/
 		} else {
 
-			E->get().refcount++;
+			(*E)->refcount++;
 		}
 	}
 
@@ -265,32 +277,34 @@ private:
 			return;
 
 		PairKey key(p_A->_id, p_B->_id);
-		typename PairMap::Element *E = pair_map.find(key);
+		PairData **E = pair_map.lookup_ptr(key);
 		if (!E) {
 			return; // no pair
 		}
 
-		E->get().refcount--;
+		PairData *pdata = *E;
+		pdata->refcount--;
 
-		if (E->get().refcount == 0) {
+		if (pdata->refcount == 0) {
 			// bye pair
 
-			if (E->get().intersect) {
+			if (pdata->intersect) {
 				if (unpair_callback) {
-					unpair_callback(pair_callback_userdata, p_A->_id, p_A->userdata, p_A->subindex, p_B->_id, p_B->userdata, p_B->subindex, E->get().ud);
+					unpair_callback(pair_callback_userdata, p_A->_id, p_A->userdata, p_A->subindex, p_B->_id, p_B->userdata, p_B->subindex, pdata->ud);
 				}
 
 				pair_count--;
 			}
 
-			if (p_A == E->get().B) {
+			if (p_A == pdata->B) {
 				//may be reaching inverted
 				SWAP(p_A, p_B);
 			}
 
-			p_A->pair_list.erase(E->get().eA);
-			p_B->pair_list.erase(E->get().eB);
-			pair_map.erase(E);
+			p_A->pair_list.erase(pdata->eA);
+			p_B->pair_list.erase(pdata->eB);
+			pair_map.remove(key);
+			memdelete_allocator<PairData, AL>(pdata);
 		}
 	}
 
@@ -377,6 +391,7 @@ public:
 	int get_subindex(OctreeElementID p_id) const;
 
 	int cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
+	int cull_convex(const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask = 0xFFFFFFFF);
 	int cull_aabb(const AABB &p_aabb, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
 	int cull_segment(const Vector3 &p_from, const Vector3 &p_to, T **p_result_array, int p_result_max, int *p_subindex_array = NULL, uint32_t p_mask = 0xFFFFFFFF);
 
@@ -388,7 +403,13 @@ public:
 	int get_octant_count() const { return octant_count; }
 	int get_pair_count() const { return pair_count; }
 	Octree(real_t p_unit_size = 1.0);
-	~Octree() { _remove_tree(root); }
+	~Octree() {
+		_remove_tree(root);
+
+		for (typename PairMap::Iterator it = pair_map.iter(); it.valid; it = pair_map.next_iter(it)) {
+			memdelete_allocator<PairData, AL>(*it.value);
+		}
+	}
 };
 
 /* PRIVATE FUNCTIONS */
@@ -1288,14 +1309,20 @@ void Octree<T, use_pairs, AL>::_cull_point(Octant *p_octant, const Vector3 &p_po
 template <class T, bool use_pairs, class AL>
 int Octree<T, use_pairs, AL>::cull_convex(const Vector<Plane> &p_convex, T **p_result_array, int p_result_max, uint32_t p_mask) {
 
+	return cull_convex(p_convex.ptr(), p_convex.size(), p_result_array, p_result_max, p_mask);
+}
+
+template <class T, bool use_pairs, class AL>
+int Octree<T, use_pairs, AL>::cull_convex(const Plane *p_convex, int p_convex_count, T **p_result_array, int p_result_max, uint32_t p_mask) {
+
 	if (!root)
 		return 0;
 
 	int result_count = 0;
 	pass++;
 	_CullConvexData cdata;
-	cdata.planes = &p_convex[0];
-	cdata.plane_count = p_convex.size();
+	cdata.planes = p_convex;
+	cdata.plane_count = p_convex_count;
 	cdata.result_array = p_result_array;
 	cdata.result_max = p_result_max;
 	cdata.result_idx = &result_count;
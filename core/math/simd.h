@@ -0,0 +1,95 @@
+/*************************************************************************/
+/*  simd.h                                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "core/typedefs.h"
+
+// Minimal wrapper over four-wide float SIMD registers, for the few hot loops
+// that are written with intrinsics. SSE2 is always there on x86_64 and NEON
+// on arm64; other targets (or builds defining NO_SIMD) leave SIMD_ENABLED
+// undefined and must use the scalar code path.
+
+#if !defined(NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SIMD_SSE2_ENABLED
+#define SIMD_ENABLED
+#include <emmintrin.h>
+#elif !defined(NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define SIMD_NEON_ENABLED
+#define SIMD_ENABLED
+#include <arm_neon.h>
+#endif
+
+#ifdef SIMD_SSE2_ENABLED
+
+typedef __m128 SIMDFloat4;
+
+_FORCE_INLINE_ SIMDFloat4 simd_load(const float *p_ptr) { return _mm_loadu_ps(p_ptr); }
+_FORCE_INLINE_ void simd_store(float *p_ptr, SIMDFloat4 p_value) { _mm_storeu_ps(p_ptr, p_value); }
+_FORCE_INLINE_ SIMDFloat4 simd_splat(float p_value) { return _mm_set1_ps(p_value); }
+_FORCE_INLINE_ SIMDFloat4 simd_add(SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_add_ps(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_sub(SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_sub_ps(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_mul(SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_mul_ps(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_min(SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_min_ps(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_max(SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_max_ps(p_a, p_b); }
+// Comparisons set every bit of the lanes where they hold, and
+// simd_get_mask() gathers one bit per lane (lane 0 in bit 0).
+_FORCE_INLINE_ SIMDFloat4 simd_greater(SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_cmpgt_ps(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_or(SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_or_ps(p_a, p_b); }
+_FORCE_INLINE_ int simd_get_mask(SIMDFloat4 p_value) { return _mm_movemask_ps(p_value); }
+// Takes the lanes of p_a where p_mask is set and those of p_b elsewhere.
+_FORCE_INLINE_ SIMDFloat4 simd_select(SIMDFloat4 p_mask, SIMDFloat4 p_a, SIMDFloat4 p_b) { return _mm_or_ps(_mm_and_ps(p_mask, p_a), _mm_andnot_ps(p_mask, p_b)); }
+
+#elif defined(SIMD_NEON_ENABLED)
+
+typedef float32x4_t SIMDFloat4;
+
+_FORCE_INLINE_ SIMDFloat4 simd_load(const float *p_ptr) { return vld1q_f32(p_ptr); }
+_FORCE_INLINE_ void simd_store(float *p_ptr, SIMDFloat4 p_value) { vst1q_f32(p_ptr, p_value); }
+_FORCE_INLINE_ SIMDFloat4 simd_splat(float p_value) { return vdupq_n_f32(p_value); }
+_FORCE_INLINE_ SIMDFloat4 simd_add(SIMDFloat4 p_a, SIMDFloat4 p_b) { return vaddq_f32(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_sub(SIMDFloat4 p_a, SIMDFloat4 p_b) { return vsubq_f32(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_mul(SIMDFloat4 p_a, SIMDFloat4 p_b) { return vmulq_f32(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_min(SIMDFloat4 p_a, SIMDFloat4 p_b) { return vminq_f32(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_max(SIMDFloat4 p_a, SIMDFloat4 p_b) { return vmaxq_f32(p_a, p_b); }
+_FORCE_INLINE_ SIMDFloat4 simd_greater(SIMDFloat4 p_a, SIMDFloat4 p_b) { return vreinterpretq_f32_u32(vcgtq_f32(p_a, p_b)); }
+_FORCE_INLINE_ SIMDFloat4 simd_or(SIMDFloat4 p_a, SIMDFloat4 p_b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(p_a), vreinterpretq_u32_f32(p_b))); }
+_FORCE_INLINE_ int simd_get_mask(SIMDFloat4 p_value) {
+	static const int32_t shifts[4] = { 0, 1, 2, 3 };
+	uint32x4_t bits = vshlq_u32(vshrq_n_u32(vreinterpretq_u32_f32(p_value), 31), vld1q_s32(shifts));
+	uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+	return vget_lane_u32(vpadd_u32(sum, sum), 0);
+}
+_FORCE_INLINE_ SIMDFloat4 simd_select(SIMDFloat4 p_mask, SIMDFloat4 p_a, SIMDFloat4 p_b) { return vbslq_f32(vreinterpretq_u32_f32(p_mask), p_a, p_b); }
+
+#endif
+
+#endif // SIMD_H
@@ -33,6 +33,7 @@
 
 #include "core/math/aabb.h"
 #include "core/math/basis.h"
+#include "core/math/bulk_math.h"
 #include "core/math/plane.h"
 #include "core/pool_vector.h"
 
@@ -218,9 +219,7 @@ PoolVector<Vector3> Transform::xform(const PoolVector<Vector3> &p_array) const {
 	PoolVector<Vector3>::Read r = p_array.read();
 	PoolVector<Vector3>::Write w = array.write();
 
-	for (int i = 0; i < p_array.size(); ++i) {
-		w[i] = xform(r[i]);
-	}
+	BulkMath::transform(r.ptr(), w.ptr(), p_array.size(), *this);
 	return array;
 }
 
@@ -31,6 +31,7 @@
 #ifndef TRANSFORM_2D_H
 #define TRANSFORM_2D_H
 
+#include "core/math/bulk_math.h"
 #include "core/math/rect2.h" // also includes vector2, math_funcs, and ustring
 #include "core/pool_vector.h"
 
@@ -211,9 +212,7 @@ PoolVector<Vector2> Transform2D::xform(const PoolVector<Vector2> &p_array) const
 	PoolVector<Vector2>::Read r = p_array.read();
 	PoolVector<Vector2>::Write w = array.write();
 
-	for (int i = 0; i < p_array.size(); ++i) {
-		w[i] = xform(r[i]);
-	}
+	BulkMath::transform(r.ptr(), w.ptr(), p_array.size(), *this);
 	return array;
 }
 
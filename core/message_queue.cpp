@@ -31,6 +31,7 @@
 #include "message_queue.h"
 
 #include "core/project_settings.h"
+#include "core/safe_refcount.h"
 #include "core/script_language.h"
 
 MessageQueue *MessageQueue::singleton = NULL;
@@ -40,22 +41,193 @@ MessageQueue *MessageQueue::get_singleton() {
 	return singleton;
 }
 
-Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
+void MessageQueue::_init_staging_buffer(StagingBuffer *p_staging) {
+
+	p_staging->mutex = Mutex::create();
+	p_staging->first = NULL;
+	p_staging->last = NULL;
+	p_staging->spare = NULL;
+	p_staging->spare_count = 0;
+	p_staging->used = 0;
+}
+
+void MessageQueue::_free_staging_buffer(StagingBuffer *p_staging) {
+
+	for (Page *page = p_staging->first; page;) {
+
+		uint32_t read_pos = 0;
+		while (read_pos < page->used) {
+			Message *message = (Message *)(page->get_data() + read_pos);
+			read_pos += _get_message_size(message);
+			_destroy_message(message);
+		}
+
+		Page *next = page->next;
+		memfree(page);
+		page = next;
+	}
+
+	while (p_staging->spare) {
+		Page *next = p_staging->spare->next;
+		memfree(p_staging->spare);
+		p_staging->spare = next;
+	}
+
+	memdelete(p_staging->mutex);
+	p_staging->mutex = NULL;
+}
+
+MessageQueue::StagingBuffer *MessageQueue::_get_staging_buffer() {
+
+	Thread::ID id = Thread::get_caller_id();
+	if (id == 0) {
+		return &shared_staging; // No thread support.
+	}
+
+	// Lock-free lookup, IDs are only ever written once.
+	uint32_t start = id % MAX_STAGING_BUFFERS;
+	for (uint32_t i = 0; i < MAX_STAGING_BUFFERS; i++) {
+
+		StagingBuffer *staging = &staging_buffers[(start + i) % MAX_STAGING_BUFFERS];
+		Thread::ID staging_id = atomic_load_acquire(&staging->thread_id);
+		if (staging_id == id) {
+			return staging;
+		}
+		if (staging_id == 0) {
+			break;
+		}
+	}
+
+	// First message from this thread.
+	MutexLock lock(staging_mutex);
+
+	for (uint32_t i = 0; i < MAX_STAGING_BUFFERS; i++) {
+
+		StagingBuffer *staging = &staging_buffers[(start + i) % MAX_STAGING_BUFFERS];
+		if (staging->thread_id == id) {
+			return staging;
+		}
+		if (staging->thread_id == 0) {
+			_init_staging_buffer(staging);
+			atomic_store_release(&staging->thread_id, id); // Publish once initialized.
+			staging_buffer_count++;
+			return staging;
+		}
+	}
+
+	return &shared_staging;
+}
+
+uint8_t *MessageQueue::_staging_alloc(StagingBuffer *p_staging, uint32_t p_size) {
+
+	Page *page = p_staging->last;
+
+	if (!page || page->used + p_size > page->size) {
+
+		if (p_staging->spare && p_size <= p_staging->spare->size) {
+			page = p_staging->spare;
+			p_staging->spare = page->next;
+			p_staging->spare_count--;
+		} else {
+			uint32_t size = MAX((uint32_t)STAGING_PAGE_SIZE, p_size);
+			page = (Page *)memalloc(sizeof(Page) + size);
+			page->size = size;
+		}
+
+		page->next = NULL;
+		page->used = 0;
+
+		if (p_staging->last) {
+			p_staging->last->next = page;
+		} else {
+			p_staging->first = page;
+		}
+		p_staging->last = page;
+	}
+
+	uint8_t *ptr = page->get_data() + page->used;
+	page->used += p_size;
+	p_staging->used += p_size;
+	return ptr;
+}
 
-	_THREAD_SAFE_METHOD_
+void MessageQueue::_recycle_pages(StagingBuffer *p_staging, Page *p_pages) {
+
+	MutexLock lock(p_staging->mutex);
+
+	while (p_pages) {
+
+		Page *next = p_pages->next;
+
+		if (p_pages->size == STAGING_PAGE_SIZE && p_staging->spare_count < STAGING_MAX_SPARE_PAGES) {
+			p_pages->next = p_staging->spare;
+			p_staging->spare = p_pages;
+			p_staging->spare_count++;
+		} else {
+			memfree(p_pages);
+		}
+
+		p_pages = next;
+	}
+}
+
+// Returns room for a message of p_size bytes, or NULL if the queue is full.
+// Either way, _unlock_message() must be called afterwards.
+uint8_t *MessageQueue::_lock_message(uint32_t p_size, StagingBuffer **r_staging) {
+
+	if (use_staging) {
+
+		StagingBuffer *staging = _get_staging_buffer();
+		if (staging->mutex->try_lock() != OK) {
+			atomic_increment(&contention_count);
+			staging->mutex->lock();
+		}
+
+		*r_staging = staging;
+		return _staging_alloc(staging, p_size);
+	}
+
+	*r_staging = NULL;
+
+	_THREAD_SAFE_LOCK_
+
+	if ((buffer_end + p_size) >= buffer_size) {
+		return NULL;
+	}
+
+	uint8_t *ptr = &buffer[buffer_end];
+	buffer_end += p_size;
+	return ptr;
+}
+
+void MessageQueue::_unlock_message(StagingBuffer *p_staging) {
+
+	if (p_staging) {
+		p_staging->mutex->unlock();
+		return;
+	}
+
+	_THREAD_SAFE_UNLOCK_
+}
+
+Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
 
 	int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	StagingBuffer *staging;
+	uint8_t *ptr = _lock_message(room_needed, &staging);
+
+	if (!ptr) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
 		print_line("Failed method: " + type + ":" + p_method + " target ID: " + itos(p_id));
 		statistics();
+		_unlock_message(staging);
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(ptr, Message);
 	msg->args = p_argcount;
 	msg->instance_id = p_id;
 	msg->target = p_method;
@@ -63,15 +235,17 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, const V
 	if (p_show_error)
 		msg->type |= FLAG_SHOW_ERROR;
 
-	buffer_end += sizeof(Message);
+	ptr += sizeof(Message);
 
 	for (int i = 0; i < p_argcount; i++) {
 
-		Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-		buffer_end += sizeof(Variant);
+		Variant *v = memnew_placement(ptr, Variant);
+		ptr += sizeof(Variant);
 		*v = *p_args[i];
 	}
 
+	_unlock_message(staging);
+
 	return OK;
 }
 
@@ -92,56 +266,61 @@ Error MessageQueue::push_call(ObjectID p_id, const StringName &p_method, VARIANT
 
 Error MessageQueue::push_set(ObjectID p_id, const StringName &p_prop, const Variant &p_value) {
 
-	_THREAD_SAFE_METHOD_
-
 	uint8_t room_needed = sizeof(Message) + sizeof(Variant);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	StagingBuffer *staging;
+	uint8_t *ptr = _lock_message(room_needed, &staging);
+
+	if (!ptr) {
 		String type;
 		if (ObjectDB::get_instance(p_id))
 			type = ObjectDB::get_instance(p_id)->get_class();
 		print_line("Failed set: " + type + ":" + p_prop + " target ID: " + itos(p_id));
 		statistics();
+		_unlock_message(staging);
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(ptr, Message);
 	msg->args = 1;
 	msg->instance_id = p_id;
 	msg->target = p_prop;
 	msg->type = TYPE_SET;
 
-	buffer_end += sizeof(Message);
+	ptr += sizeof(Message);
 
-	Variant *v = memnew_placement(&buffer[buffer_end], Variant);
-	buffer_end += sizeof(Variant);
+	Variant *v = memnew_placement(ptr, Variant);
 	*v = p_value;
 
+	_unlock_message(staging);
+
 	return OK;
 }
 
 Error MessageQueue::push_notification(ObjectID p_id, int p_notification) {
 
-	_THREAD_SAFE_METHOD_
-
 	ERR_FAIL_COND_V(p_notification < 0, ERR_INVALID_PARAMETER);
 
 	uint8_t room_needed = sizeof(Message);
 
-	if ((buffer_end + room_needed) >= buffer_size) {
+	StagingBuffer *staging;
+	uint8_t *ptr = _lock_message(room_needed, &staging);
+
+	if (!ptr) {
 		print_line("Failed notification: " + itos(p_notification) + " target ID: " + itos(p_id));
 		statistics();
+		_unlock_message(staging);
 		ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'message_queue_size_kb' in project settings.");
 	}
 
-	Message *msg = memnew_placement(&buffer[buffer_end], Message);
+	Message *msg = memnew_placement(ptr, Message);
 
 	msg->type = TYPE_NOTIFICATION;
 	msg->instance_id = p_id;
 	//msg->target;
 	msg->notification = p_notification;
 
-	buffer_end += sizeof(Message);
+	_unlock_message(staging);
 
 	return OK;
 }
@@ -229,6 +408,11 @@ void MessageQueue::statistics() {
 	for (Map<int, int>::Element *E = notify_count.front(); E; E = E->next()) {
 		print_line("NOTIFY " + itos(E->key()) + ": " + itos(E->get()));
 	}
+
+	if (use_staging) {
+		print_line("STAGING BUFFERS: " + itos(staging_buffer_count));
+		print_line("STAGING CONTENTION: " + itos(contention_count));
+	}
 }
 
 int MessageQueue::get_max_buffer_usage() const {
@@ -236,6 +420,16 @@ int MessageQueue::get_max_buffer_usage() const {
 	return buffer_max_used;
 }
 
+int MessageQueue::get_contention_count() const {
+
+	return contention_count;
+}
+
+bool MessageQueue::is_using_staging() const {
+
+	return use_staging;
+}
+
 void MessageQueue::_call_function(Object *p_target, const StringName &p_func, const Variant *p_args, int p_argcount, bool p_show_error) {
 
 	const Variant **argptrs = NULL;
@@ -254,73 +448,147 @@ void MessageQueue::_call_function(Object *p_target, const StringName &p_func, co
 	}
 }
 
-void MessageQueue::flush() {
+void MessageQueue::_execute_message(Message *p_message) {
 
-	if (buffer_end > buffer_max_used) {
-		buffer_max_used = buffer_end;
-	}
+	Object *target = ObjectDB::get_instance(p_message->instance_id);
 
-	uint32_t read_pos = 0;
+	if (target != NULL) {
 
-	//using reverse locking strategy
-	_THREAD_SAFE_LOCK_
+		switch (p_message->type & FLAG_MASK) {
+			case TYPE_CALL: {
 
-	ERR_FAIL_COND(flushing); //already flushing, you did something odd
-	flushing = true;
+				Variant *args = (Variant *)(p_message + 1);
 
-	while (read_pos < buffer_end) {
+				// messages don't expect a return value
 
-		//lock on each iteration, so a call can re-add itself to the message queue
+				_call_function(target, p_message->target, args, p_message->args, p_message->type & FLAG_SHOW_ERROR);
 
-		Message *message = (Message *)&buffer[read_pos];
+			} break;
+			case TYPE_NOTIFICATION: {
 
-		uint32_t advance = sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			advance += sizeof(Variant) * message->args;
+				// messages don't expect a return value
+				target->notification(p_message->notification);
 
-		//pre-advance so this function is reentrant
-		read_pos += advance;
+			} break;
+			case TYPE_SET: {
 
-		_THREAD_SAFE_UNLOCK_
+				Variant *arg = (Variant *)(p_message + 1);
+				// messages don't expect a return value
+				target->set(p_message->target, *arg);
 
-		Object *target = ObjectDB::get_instance(message->instance_id);
+			} break;
+		}
+	}
+}
 
-		if (target != NULL) {
+void MessageQueue::_destroy_message(Message *p_message) {
 
-			switch (message->type & FLAG_MASK) {
-				case TYPE_CALL: {
+	if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
+		Variant *args = (Variant *)(p_message + 1);
+		for (int i = 0; i < p_message->args; i++) {
+			args[i].~Variant();
+		}
+	}
 
-					Variant *args = (Variant *)(message + 1);
+	p_message->~Message();
+}
 
-					// messages don't expect a return value
+void MessageQueue::_flush_staging() {
 
-					_call_function(target, message->target, args, message->args, message->type & FLAG_SHOW_ERROR);
+	ERR_FAIL_COND(flushing); //already flushing, you did something odd
+	flushing = true;
 
-				} break;
-				case TYPE_NOTIFICATION: {
+	Page *pages[MAX_STAGING_BUFFERS + 1];
+	StagingBuffer *owners[MAX_STAGING_BUFFERS + 1];
 
-					// messages don't expect a return value
-					target->notification(message->notification);
+	// Messages pushed while flushing are run in another pass, like in the single buffer mode.
+	while (true) {
 
-				} break;
-				case TYPE_SET: {
+		int count = 0;
+		uint32_t used = 0;
 
-					Variant *arg = (Variant *)(message + 1);
-					// messages don't expect a return value
-					target->set(message->target, *arg);
+		for (int i = 0; i <= MAX_STAGING_BUFFERS; i++) {
 
-				} break;
+			StagingBuffer *staging = i < MAX_STAGING_BUFFERS ? &staging_buffers[i] : &shared_staging;
+			if (staging != &shared_staging && atomic_load_acquire(&staging->thread_id) == 0) {
+				continue;
+			}
+
+			staging->mutex->lock();
+			Page *first = staging->first;
+			used += staging->used;
+			staging->first = NULL;
+			staging->last = NULL;
+			staging->used = 0;
+			staging->mutex->unlock();
+
+			if (first) {
+				pages[count] = first;
+				owners[count] = staging;
+				count++;
 			}
 		}
 
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			Variant *args = (Variant *)(message + 1);
-			for (int i = 0; i < message->args; i++) {
-				args[i].~Variant();
+		if (count == 0) {
+			break;
+		}
+
+		if (used > buffer_max_used) {
+			buffer_max_used = used;
+		}
+
+		for (int i = 0; i < count; i++) {
+
+			for (Page *page = pages[i]; page; page = page->next) {
+
+				uint32_t read_pos = 0;
+				while (read_pos < page->used) {
+					Message *message = (Message *)(page->get_data() + read_pos);
+					read_pos += _get_message_size(message);
+					_execute_message(message);
+					_destroy_message(message);
+				}
 			}
+
+			_recycle_pages(owners[i], pages[i]);
 		}
+	}
+
+	flushing = false;
+}
+
+void MessageQueue::flush() {
+
+	if (use_staging) {
+		_flush_staging();
+		return;
+	}
+
+	if (buffer_end > buffer_max_used) {
+		buffer_max_used = buffer_end;
+	}
+
+	uint32_t read_pos = 0;
 
-		message->~Message();
+	//using reverse locking strategy
+	_THREAD_SAFE_LOCK_
+
+	ERR_FAIL_COND(flushing); //already flushing, you did something odd
+	flushing = true;
+
+	while (read_pos < buffer_end) {
+
+		//lock on each iteration, so a call can re-add itself to the message queue
+
+		Message *message = (Message *)&buffer[read_pos];
+
+		//pre-advance so this function is reentrant
+		read_pos += _get_message_size(message);
+
+		_THREAD_SAFE_UNLOCK_
+
+		_execute_message(message);
+		_destroy_message(message);
 
 		_THREAD_SAFE_LOCK_
 	}
@@ -346,7 +614,27 @@ MessageQueue::MessageQueue() {
 	buffer_size = GLOBAL_DEF_RST("memory/limits/message_queue/max_size_kb", DEFAULT_QUEUE_SIZE_KB);
 	ProjectSettings::get_singleton()->set_custom_property_info("memory/limits/message_queue/max_size_kb", PropertyInfo(Variant::INT, "memory/limits/message_queue/max_size_kb", PROPERTY_HINT_RANGE, "0,2048,1,or_greater"));
 	buffer_size *= 1024;
-	buffer = memnew_arr(uint8_t, buffer_size);
+
+	use_staging = GLOBAL_DEF_RST("memory/limits/message_queue/per_thread_staging", false);
+	staging_mutex = NULL;
+	staging_buffer_count = 0;
+	contention_count = 0;
+
+	for (int i = 0; i < MAX_STAGING_BUFFERS; i++) {
+		staging_buffers[i].thread_id = 0;
+		staging_buffers[i].mutex = NULL;
+	}
+	shared_staging.thread_id = 0;
+	shared_staging.mutex = NULL;
+
+	if (use_staging) {
+		staging_mutex = Mutex::create();
+		_init_staging_buffer(&shared_staging);
+		buffer = NULL;
+		buffer_size = 0;
+	} else {
+		buffer = memnew_arr(uint8_t, buffer_size);
+	}
 }
 
 MessageQueue::~MessageQueue() {
@@ -356,19 +644,22 @@ MessageQueue::~MessageQueue() {
 	while (read_pos < buffer_end) {
 
 		Message *message = (Message *)&buffer[read_pos];
-		Variant *args = (Variant *)(message + 1);
-		int argc = message->args;
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION) {
-			for (int i = 0; i < argc; i++)
-				args[i].~Variant();
-		}
-		message->~Message();
+		read_pos += _get_message_size(message);
+		_destroy_message(message);
+	}
 
-		read_pos += sizeof(Message);
-		if ((message->type & FLAG_MASK) != TYPE_NOTIFICATION)
-			read_pos += sizeof(Variant) * message->args;
+	if (use_staging) {
+		for (int i = 0; i < MAX_STAGING_BUFFERS; i++) {
+			if (atomic_load_acquire(&staging_buffers[i].thread_id) != 0) {
+				_free_staging_buffer(&staging_buffers[i]);
+			}
+		}
+		_free_staging_buffer(&shared_staging);
+		memdelete(staging_mutex);
 	}
 
 	singleton = NULL;
-	memdelete_arr(buffer);
+	if (buffer) {
+		memdelete_arr(buffer);
+	}
 }
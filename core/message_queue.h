@@ -32,6 +32,7 @@
 #define MESSAGE_QUEUE_H
 
 #include "core/object.h"
+#include "core/os/thread.h"
 #include "core/os/thread_safe.h"
 
 class MessageQueue {
@@ -40,7 +41,10 @@ class MessageQueue {
 
 	enum {
 
-		DEFAULT_QUEUE_SIZE_KB = 1024
+		DEFAULT_QUEUE_SIZE_KB = 1024,
+		STAGING_PAGE_SIZE = 16 * 1024,
+		STAGING_MAX_SPARE_PAGES = 4,
+		MAX_STAGING_BUFFERS = 64
 	};
 
 	enum {
@@ -68,7 +72,62 @@ class MessageQueue {
 	uint32_t buffer_max_used;
 	uint32_t buffer_size;
 
+	/* Per thread staging mode.
+	 *
+	 * Every producer thread gets its own list of pages, so pushing messages
+	 * only locks a mutex that nobody else uses, except flush() when it takes
+	 * the pages. Pages are added as needed, so this mode never runs out of
+	 * space. Messages from a given thread run in the order they were pushed,
+	 * but there's no ordering between threads.
+	 */
+
+	struct Page {
+
+		Page *next;
+		uint32_t used;
+		uint32_t size;
+
+		_FORCE_INLINE_ uint8_t *get_data() { return (uint8_t *)(this + 1); }
+	};
+
+	struct StagingBuffer {
+
+		volatile Thread::ID thread_id; // 0 while unused, only set once, with a release store after the rest is initialized.
+		Mutex *mutex;
+		Page *first;
+		Page *last;
+		Page *spare;
+		uint32_t spare_count;
+		uint32_t used;
+	};
+
+	bool use_staging;
+	StagingBuffer staging_buffers[MAX_STAGING_BUFFERS];
+	StagingBuffer shared_staging; // Used by threads that can't get a buffer of their own.
+	Mutex *staging_mutex; // Guards the registration of new threads.
+	uint32_t staging_buffer_count;
+	uint32_t contention_count;
+
+	void _init_staging_buffer(StagingBuffer *p_staging);
+	void _free_staging_buffer(StagingBuffer *p_staging);
+	StagingBuffer *_get_staging_buffer();
+	uint8_t *_staging_alloc(StagingBuffer *p_staging, uint32_t p_size);
+	void _recycle_pages(StagingBuffer *p_staging, Page *p_pages);
+
+	uint8_t *_lock_message(uint32_t p_size, StagingBuffer **r_staging);
+	void _unlock_message(StagingBuffer *p_staging);
+
+	_FORCE_INLINE_ static uint32_t _get_message_size(const Message *p_message) {
+		uint32_t size = sizeof(Message);
+		if ((p_message->type & FLAG_MASK) != TYPE_NOTIFICATION)
+			size += sizeof(Variant) * p_message->args;
+		return size;
+	}
+
 	void _call_function(Object *p_target, const StringName &p_func, const Variant *p_args, int p_argcount, bool p_show_error);
+	void _execute_message(Message *p_message);
+	void _destroy_message(Message *p_message);
+	void _flush_staging();
 
 	static MessageQueue *singleton;
 
@@ -92,6 +151,8 @@ public:
 	bool is_flushing() const;
 
 	int get_max_buffer_usage() const;
+	int get_contention_count() const;
+	bool is_using_staging() const;
 
 	MessageQueue();
 	~MessageQueue();
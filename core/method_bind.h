@@ -42,6 +42,12 @@
 #define DEBUG_METHODS_ENABLED
 #endif
 
+// Argument types are also kept when ptrcall is available, so callers can
+// check that the arguments they hold can be passed without conversion.
+#if defined(DEBUG_METHODS_ENABLED) || defined(PTRCALL_ENABLED)
+#define METHOD_BIND_ARGUMENT_TYPES_ENABLED
+#endif
+
 #include "core/type_info.h"
 
 enum MethodFlags {
@@ -217,16 +223,20 @@ class MethodBind {
 	bool _returns;
 
 protected:
-#ifdef DEBUG_METHODS_ENABLED
+#ifdef METHOD_BIND_ARGUMENT_TYPES_ENABLED
 	Variant::Type *argument_types;
+#endif
+#ifdef DEBUG_METHODS_ENABLED
 	Vector<StringName> arg_names;
 #endif
 	void _set_const(bool p_const);
 	void _set_returns(bool p_returns);
-#ifdef DEBUG_METHODS_ENABLED
+#ifdef METHOD_BIND_ARGUMENT_TYPES_ENABLED
 	virtual Variant::Type _gen_argument_type(int p_arg) const = 0;
-	virtual PropertyInfo _gen_argument_type_info(int p_arg) const = 0;
 	void _generate_argument_types(int p_count);
+#endif
+#ifdef DEBUG_METHODS_ENABLED
+	virtual PropertyInfo _gen_argument_type_info(int p_arg) const = 0;
 
 #endif
 	void set_argument_count(int p_count) { argument_count = p_count; }
@@ -255,7 +265,7 @@ public:
 			return default_arguments[idx];
 	}
 
-#ifdef DEBUG_METHODS_ENABLED
+#ifdef METHOD_BIND_ARGUMENT_TYPES_ENABLED
 
 	_FORCE_INLINE_ Variant::Type get_argument_type(int p_argument) const {
 
@@ -263,6 +273,9 @@ public:
 		return argument_types[p_argument + 1];
 	}
 
+#endif
+#ifdef DEBUG_METHODS_ENABLED
+
 	PropertyInfo get_argument_info(int p_argument) const;
 	PropertyInfo get_return_info() const;
 
@@ -331,7 +344,7 @@ public:
 		return GodotTypeInfo::METADATA_NONE;
 	}
 
-#else
+#elif defined(METHOD_BIND_ARGUMENT_TYPES_ENABLED)
 
 	virtual Variant::Type _gen_argument_type(int p_arg) const {
 		return Variant::NIL;
@@ -44,7 +44,10 @@
  * improve the performance and to avoid infinite loops in rare cases.
  *
  * The entries are stored inplace, so huge keys or values might fill cache lines
- * a lot faster.
+ * a lot faster. Pointers to values are invalidated by insertions and removals.
+ *
+ * The capacity is always a power of two, and the storage is only allocated on
+ * the first insertion, so empty maps are cheap to keep around.
  */
 template <class TKey, class TValue,
 		class Hasher = HashMapHasherDefault,
@@ -61,9 +64,12 @@ private:
 	uint32_t num_elements;
 
 	static const uint32_t EMPTY_HASH = 0;
+	static const uint32_t MIN_CAPACITY = 4;
 
 	_FORCE_INLINE_ uint32_t _hash(const TKey &p_key) const {
-		uint32_t hash = Hasher::hash(p_key);
+		// Mix the bits, as positions are taken from the lowest ones and many
+		// hashers return the key itself.
+		uint32_t hash = hash_fmix32(Hasher::hash(p_key));
 
 		if (hash == EMPTY_HASH) {
 			hash = EMPTY_HASH + 1;
@@ -73,8 +79,8 @@ private:
 	}
 
 	_FORCE_INLINE_ uint32_t _get_probe_length(uint32_t p_pos, uint32_t p_hash) const {
-		uint32_t original_pos = p_hash % capacity;
-		return (p_pos - original_pos + capacity) % capacity;
+		uint32_t original_pos = p_hash & (capacity - 1);
+		return (p_pos - original_pos) & (capacity - 1);
 	}
 
 	_FORCE_INLINE_ void _construct(uint32_t p_pos, uint32_t p_hash, const TKey &p_key, const TValue &p_value) {
@@ -86,8 +92,12 @@ private:
 	}
 
 	bool _lookup_pos(const TKey &p_key, uint32_t &r_pos) const {
+		if (num_elements == 0) {
+			return false;
+		}
+
 		uint32_t hash = _hash(p_key);
-		uint32_t pos = hash % capacity;
+		uint32_t pos = hash & (capacity - 1);
 		uint32_t distance = 0;
 
 		while (42) {
@@ -104,16 +114,17 @@ private:
 				return true;
 			}
 
-			pos = (pos + 1) % capacity;
+			pos = (pos + 1) & (capacity - 1);
 			distance++;
 		}
 	}
 
-	void _insert_with_hash(uint32_t p_hash, const TKey &p_key, const TValue &p_value) {
+	uint32_t _insert_with_hash(uint32_t p_hash, const TKey &p_key, const TValue &p_value) {
 
 		uint32_t hash = p_hash;
 		uint32_t distance = 0;
-		uint32_t pos = hash % capacity;
+		uint32_t pos = hash & (capacity - 1);
+		uint32_t inserted_pos = capacity; // Where p_key ends up, it may be moved by later swaps.
 
 		TKey key = p_key;
 		TValue value = p_value;
@@ -122,7 +133,7 @@ private:
 			if (hashes[pos] == EMPTY_HASH) {
 				_construct(pos, hash, key, value);
 
-				return;
+				return inserted_pos == capacity ? pos : inserted_pos;
 			}
 
 			// not an empty slot, let's check the probing length of the existing one
@@ -132,29 +143,41 @@ private:
 				SWAP(key, keys[pos]);
 				SWAP(value, values[pos]);
 				distance = existing_probe_len;
+				if (inserted_pos == capacity) {
+					inserted_pos = pos;
+				}
 			}
 
-			pos = (pos + 1) % capacity;
+			pos = (pos + 1) & (capacity - 1);
 			distance++;
 		}
 	}
 
+	void _allocate(uint32_t p_capacity) {
+
+		capacity = p_capacity;
+		keys = memnew_arr(TKey, capacity);
+		values = memnew_arr(TValue, capacity);
+		hashes = memnew_arr(uint32_t, capacity);
+
+		for (uint32_t i = 0; i < capacity; i++) {
+			hashes[i] = EMPTY_HASH;
+		}
+	}
+
 	void _resize_and_rehash(uint32_t p_new_capacity) {
 
 		uint32_t old_capacity = capacity;
-		capacity = p_new_capacity;
 
 		TKey *old_keys = keys;
 		TValue *old_values = values;
 		uint32_t *old_hashes = hashes;
 
 		num_elements = 0;
-		keys = memnew_arr(TKey, capacity);
-		values = memnew_arr(TValue, capacity);
-		hashes = memnew_arr(uint32_t, capacity);
+		_allocate(next_power_of_2(MAX(p_new_capacity, MIN_CAPACITY)));
 
-		for (uint32_t i = 0; i < capacity; i++) {
-			hashes[i] = 0;
+		if (!old_hashes) {
+			return;
 		}
 
 		for (uint32_t i = 0; i < old_capacity; i++) {
@@ -174,6 +197,18 @@ private:
 		_resize_and_rehash(capacity * 2);
 	}
 
+	// Makes room for one more element, returns the hash of p_key.
+	_FORCE_INLINE_ uint32_t _prepare_insert(const TKey &p_key) {
+
+		if (!hashes) {
+			_resize_and_rehash(capacity);
+		} else if (num_elements + 1 > 0.9 * capacity) {
+			_resize_and_rehash();
+		}
+
+		return _hash(p_key);
+	}
+
 public:
 	_FORCE_INLINE_ uint32_t get_capacity() const { return capacity; }
 	_FORCE_INLINE_ uint32_t get_num_elements() const { return num_elements; }
@@ -184,6 +219,10 @@ public:
 
 	void clear() {
 
+		if (!hashes) {
+			return;
+		}
+
 		for (uint32_t i = 0; i < capacity; i++) {
 
 			if (hashes[i] == EMPTY_HASH) {
@@ -200,11 +239,7 @@ public:
 
 	void insert(const TKey &p_key, const TValue &p_value) {
 
-		if (num_elements + 1 > 0.9 * capacity) {
-			_resize_and_rehash();
-		}
-
-		uint32_t hash = _hash(p_key);
+		uint32_t hash = _prepare_insert(p_key);
 
 		_insert_with_hash(hash, p_key, p_value);
 	}
@@ -240,6 +275,33 @@ public:
 		return false;
 	}
 
+	/**
+	 * returns a pointer to the value, or NULL if the key is not there.
+	 *
+	 * The pointer is only valid until the next insertion or removal.
+	 */
+	_FORCE_INLINE_ TValue *lookup_ptr(const TKey &p_key) const {
+		uint32_t pos = 0;
+		if (_lookup_pos(p_key, pos)) {
+			return &values[pos];
+		}
+		return NULL;
+	}
+
+	/**
+	 * returns a pointer to the value of p_key, inserting p_default first if
+	 * the key is not there yet. Saves a second lookup compared to has() + insert().
+	 */
+	TValue *lookup_or_insert(const TKey &p_key, const TValue &p_default) {
+		uint32_t pos = 0;
+		if (_lookup_pos(p_key, pos)) {
+			return &values[pos];
+		}
+
+		uint32_t hash = _prepare_insert(p_key);
+		return &values[_insert_with_hash(hash, p_key, p_default)];
+	}
+
 	_FORCE_INLINE_ bool has(const TKey &p_key) const {
 		uint32_t _pos = 0;
 		return _lookup_pos(p_key, _pos);
@@ -253,14 +315,14 @@ public:
 			return;
 		}
 
-		uint32_t next_pos = (pos + 1) % capacity;
+		uint32_t next_pos = (pos + 1) & (capacity - 1);
 		while (hashes[next_pos] != EMPTY_HASH &&
 				_get_probe_length(next_pos, hashes[next_pos]) != 0) {
 			SWAP(hashes[next_pos], hashes[pos]);
 			SWAP(keys[next_pos], keys[pos]);
 			SWAP(values[next_pos], values[pos]);
 			pos = next_pos;
-			next_pos = (pos + 1) % capacity;
+			next_pos = (pos + 1) & (capacity - 1);
 		}
 
 		hashes[pos] = EMPTY_HASH;
@@ -312,6 +374,10 @@ public:
 		it.key = NULL;
 		it.value = NULL;
 
+		if (!hashes) {
+			return it;
+		}
+
 		for (uint32_t i = it.pos; i < capacity; i++) {
 			it.pos = i + 1;
 
@@ -333,20 +399,21 @@ public:
 
 	OAHashMap(uint32_t p_initial_capacity = 64) {
 
-		capacity = p_initial_capacity;
+		// Only allocated on the first insertion.
+		capacity = next_power_of_2(MAX(p_initial_capacity, MIN_CAPACITY));
 		num_elements = 0;
 
-		keys = memnew_arr(TKey, p_initial_capacity);
-		values = memnew_arr(TValue, p_initial_capacity);
-		hashes = memnew_arr(uint32_t, p_initial_capacity);
-
-		for (uint32_t i = 0; i < p_initial_capacity; i++) {
-			hashes[i] = EMPTY_HASH;
-		}
+		keys = NULL;
+		values = NULL;
+		hashes = NULL;
 	}
 
 	~OAHashMap() {
 
+		if (!hashes) {
+			return;
+		}
+
 		memdelete_arr(keys);
 		memdelete_arr(values);
 		memdelete_arr(hashes);
@@ -0,0 +1,386 @@
+/*************************************************************************/
+/*  oa_ordered_hash_map.h                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef OA_ORDERED_HASH_MAP_H
+#define OA_ORDERED_HASH_MAP_H
+
+#include "core/hashfuncs.h"
+#include "core/math/math_funcs.h"
+#include "core/os/memory.h"
+
+/**
+ * An open addressing hash map that iterates its elements in insertion order,
+ * like OrderedHashMap, without allocating a node per element.
+ *
+ * Keys and values are stored in a dense array in insertion order, and a Robin
+ * Hood index (hash and position in the dense array) is used to find them.
+ * Removed elements leave a hole in the dense array until it grows again, so
+ * removing during iteration is safe and keeps the order. Pointers to values
+ * stay valid until an insertion makes the dense array grow.
+ */
+template <class TKey, class TValue,
+		class Hasher = HashMapHasherDefault,
+		class Comparator = HashMapComparatorDefault<TKey> >
+class OAOrderedHashMap {
+
+	struct Entry {
+		TKey key;
+		TValue value;
+		Entry(const TKey &p_key, const TValue &p_value) :
+				key(p_key),
+				value(p_value) {}
+	};
+
+	Entry *entries;
+	uint32_t *entry_hashes; // EMPTY_HASH for removed entries.
+	uint32_t entry_count; // Used positions, including holes.
+	uint32_t entry_capacity;
+
+	uint32_t *index_hashes;
+	uint32_t *index_entries;
+	uint32_t index_capacity; // Power of two, at least twice entry_capacity.
+
+	uint32_t num_elements;
+
+	static const uint32_t EMPTY_HASH = 0;
+	static const uint32_t MIN_CAPACITY = 4;
+
+	_FORCE_INLINE_ uint32_t _hash(const TKey &p_key) const {
+		uint32_t hash = hash_fmix32(Hasher::hash(p_key));
+
+		if (hash == EMPTY_HASH) {
+			hash = EMPTY_HASH + 1;
+		}
+
+		return hash;
+	}
+
+	_FORCE_INLINE_ uint32_t _get_probe_length(uint32_t p_pos, uint32_t p_hash) const {
+		uint32_t original_pos = p_hash & (index_capacity - 1);
+		return (p_pos - original_pos) & (index_capacity - 1);
+	}
+
+	bool _lookup_slot(const TKey &p_key, uint32_t p_hash, uint32_t &r_slot) const {
+		if (num_elements == 0) {
+			return false;
+		}
+
+		uint32_t pos = p_hash & (index_capacity - 1);
+		uint32_t distance = 0;
+
+		while (42) {
+			if (index_hashes[pos] == EMPTY_HASH) {
+				return false;
+			}
+
+			if (distance > _get_probe_length(pos, index_hashes[pos])) {
+				return false;
+			}
+
+			if (index_hashes[pos] == p_hash && Comparator::compare(entries[index_entries[pos]].key, p_key)) {
+				r_slot = pos;
+				return true;
+			}
+
+			pos = (pos + 1) & (index_capacity - 1);
+			distance++;
+		}
+	}
+
+	void _index_insert(uint32_t p_hash, uint32_t p_entry) {
+
+		uint32_t hash = p_hash;
+		uint32_t entry = p_entry;
+		uint32_t distance = 0;
+		uint32_t pos = hash & (index_capacity - 1);
+
+		while (42) {
+			if (index_hashes[pos] == EMPTY_HASH) {
+				index_hashes[pos] = hash;
+				index_entries[pos] = entry;
+				return;
+			}
+
+			uint32_t existing_probe_len = _get_probe_length(pos, index_hashes[pos]);
+			if (existing_probe_len < distance) {
+				SWAP(hash, index_hashes[pos]);
+				SWAP(entry, index_entries[pos]);
+				distance = existing_probe_len;
+			}
+
+			pos = (pos + 1) & (index_capacity - 1);
+			distance++;
+		}
+	}
+
+	// Moves the live entries, in order, to arrays of p_new_capacity and rebuilds the index.
+	void _rehash(uint32_t p_new_capacity) {
+
+		Entry *old_entries = entries;
+		uint32_t *old_entry_hashes = entry_hashes;
+		uint32_t old_entry_count = entry_count;
+
+		entry_capacity = p_new_capacity;
+		entries = (Entry *)memalloc(sizeof(Entry) * entry_capacity);
+		entry_hashes = memnew_arr(uint32_t, entry_capacity);
+		entry_count = 0;
+
+		for (uint32_t i = 0; i < old_entry_count; i++) {
+			if (old_entry_hashes[i] == EMPTY_HASH) {
+				continue;
+			}
+			memnew_placement(&entries[entry_count], Entry(old_entries[i].key, old_entries[i].value));
+			entry_hashes[entry_count] = old_entry_hashes[i];
+			entry_count++;
+			old_entries[i].~Entry();
+		}
+
+		if (old_entries) {
+			memfree(old_entries);
+			memdelete_arr(old_entry_hashes);
+		}
+
+		if (index_hashes) {
+			memdelete_arr(index_hashes);
+			memdelete_arr(index_entries);
+		}
+
+		index_capacity = next_power_of_2(entry_capacity * 2);
+		index_hashes = memnew_arr(uint32_t, index_capacity);
+		index_entries = memnew_arr(uint32_t, index_capacity);
+		for (uint32_t i = 0; i < index_capacity; i++) {
+			index_hashes[i] = EMPTY_HASH;
+		}
+
+		for (uint32_t i = 0; i < entry_count; i++) {
+			_index_insert(entry_hashes[i], i);
+		}
+	}
+
+	void _insert_with_hash(uint32_t p_hash, const TKey &p_key, const TValue &p_value) {
+
+		if (!entries) {
+			_rehash(entry_capacity);
+		} else if (entry_count == entry_capacity) {
+			// Reuse the holes if there are many, grow otherwise.
+			_rehash(num_elements <= entry_capacity / 2 ? entry_capacity : entry_capacity * 2);
+		}
+
+		memnew_placement(&entries[entry_count], Entry(p_key, p_value));
+		entry_hashes[entry_count] = p_hash;
+		_index_insert(p_hash, entry_count);
+		entry_count++;
+		num_elements++;
+	}
+
+public:
+	_FORCE_INLINE_ uint32_t get_capacity() const { return entry_capacity; }
+	_FORCE_INLINE_ uint32_t get_num_elements() const { return num_elements; }
+
+	bool empty() const {
+		return num_elements == 0;
+	}
+
+	void clear() {
+
+		for (uint32_t i = 0; i < entry_count; i++) {
+			if (entry_hashes[i] != EMPTY_HASH) {
+				entries[i].~Entry();
+				entry_hashes[i] = EMPTY_HASH;
+			}
+		}
+		for (uint32_t i = 0; i < index_capacity; i++) {
+			index_hashes[i] = EMPTY_HASH;
+		}
+
+		entry_count = 0;
+		num_elements = 0;
+	}
+
+	void insert(const TKey &p_key, const TValue &p_value) {
+
+		_insert_with_hash(_hash(p_key), p_key, p_value);
+	}
+
+	void set(const TKey &p_key, const TValue &p_data) {
+		uint32_t hash = _hash(p_key);
+		uint32_t slot = 0;
+
+		if (_lookup_slot(p_key, hash, slot)) {
+			entries[index_entries[slot]].value = p_data;
+		} else {
+			_insert_with_hash(hash, p_key, p_data);
+		}
+	}
+
+	bool lookup(const TKey &p_key, TValue &r_data) const {
+		uint32_t slot = 0;
+
+		if (_lookup_slot(p_key, _hash(p_key), slot)) {
+			r_data = entries[index_entries[slot]].value;
+			return true;
+		}
+
+		return false;
+	}
+
+	_FORCE_INLINE_ TValue *lookup_ptr(const TKey &p_key) const {
+		uint32_t slot = 0;
+
+		if (_lookup_slot(p_key, _hash(p_key), slot)) {
+			return &entries[index_entries[slot]].value;
+		}
+
+		return NULL;
+	}
+
+	_FORCE_INLINE_ bool has(const TKey &p_key) const {
+		uint32_t slot = 0;
+		return _lookup_slot(p_key, _hash(p_key), slot);
+	}
+
+	void remove(const TKey &p_key) {
+		uint32_t slot = 0;
+
+		if (!_lookup_slot(p_key, _hash(p_key), slot)) {
+			return;
+		}
+
+		uint32_t entry = index_entries[slot];
+		entries[entry].~Entry();
+		entry_hashes[entry] = EMPTY_HASH;
+
+		// Trailing holes can be reused right away.
+		while (entry_count > 0 && entry_hashes[entry_count - 1] == EMPTY_HASH) {
+			entry_count--;
+		}
+
+		// Backward shift deletion in the index.
+		uint32_t pos = slot;
+		uint32_t next_pos = (pos + 1) & (index_capacity - 1);
+		while (index_hashes[next_pos] != EMPTY_HASH &&
+				_get_probe_length(next_pos, index_hashes[next_pos]) != 0) {
+			SWAP(index_hashes[next_pos], index_hashes[pos]);
+			SWAP(index_entries[next_pos], index_entries[pos]);
+			pos = next_pos;
+			next_pos = (pos + 1) & (index_capacity - 1);
+		}
+
+		index_hashes[pos] = EMPTY_HASH;
+
+		num_elements--;
+	}
+
+	void reserve(uint32_t p_new_capacity) {
+		ERR_FAIL_COND(p_new_capacity < entry_capacity);
+		_rehash(next_power_of_2(p_new_capacity));
+	}
+
+	struct Iterator {
+		bool valid;
+
+		const TKey *key;
+		TValue *value;
+
+	private:
+		uint32_t pos;
+		friend class OAOrderedHashMap;
+	};
+
+	Iterator iter() const {
+		Iterator it;
+
+		it.valid = true;
+		it.pos = 0;
+
+		return next_iter(it);
+	}
+
+	Iterator next_iter(const Iterator &p_iter) const {
+
+		if (!p_iter.valid) {
+			return p_iter;
+		}
+
+		Iterator it;
+		it.valid = false;
+		it.pos = p_iter.pos;
+		it.key = NULL;
+		it.value = NULL;
+
+		for (uint32_t i = it.pos; i < entry_count; i++) {
+			it.pos = i + 1;
+
+			if (entry_hashes[i] == EMPTY_HASH) {
+				continue;
+			}
+
+			it.valid = true;
+			it.key = &entries[i].key;
+			it.value = &entries[i].value;
+			return it;
+		}
+
+		return it;
+	}
+
+	OAOrderedHashMap(const OAOrderedHashMap &) = delete;
+	OAOrderedHashMap &operator=(const OAOrderedHashMap &) = delete;
+
+	OAOrderedHashMap(uint32_t p_initial_capacity = 8) {
+
+		// Only allocated on the first insertion.
+		entries = NULL;
+		entry_hashes = NULL;
+		entry_count = 0;
+		entry_capacity = next_power_of_2(MAX(p_initial_capacity, MIN_CAPACITY));
+
+		index_hashes = NULL;
+		index_entries = NULL;
+		index_capacity = 0;
+
+		num_elements = 0;
+	}
+
+	~OAOrderedHashMap() {
+
+		if (!entries) {
+			return;
+		}
+
+		clear();
+		memfree(entries);
+		memdelete_arr(entry_hashes);
+		memdelete_arr(index_hashes);
+		memdelete_arr(index_entries);
+	}
+};
+
+#endif // OA_ORDERED_HASH_MAP_H
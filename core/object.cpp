@@ -41,19 +41,6 @@
 
 #ifdef DEBUG_ENABLED
 
-struct _ObjectDebugLock {
-
-	Object *obj;
-
-	_ObjectDebugLock(Object *p_obj) {
-		obj = p_obj;
-		obj->_lock_index.ref();
-	}
-	~_ObjectDebugLock() {
-		obj->_lock_index.unref();
-	}
-};
-
 #define OBJ_DEBUG_LOCK _ObjectDebugLock _debug_lock(this);
 
 #else
@@ -1169,21 +1156,23 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 	List<_ObjectSignalDisconnectData> disconnect_data;
 
 	//copy on write will ensure that disconnecting the signal or even deleting the object will not affect the signal calling.
-	//this happens automatically and will not change the performance of calling.
-	//awesome, isn't it?
-	VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
+	//the snapshot must stay const, as non-const access would make it copy the connections on every emit.
+	const VMap<Signal::Target, Signal::Slot> slot_map = s->slot_map;
 
 	int ssize = slot_map.size();
 
 	OBJ_DEBUG_LOCK
 
+	// Arguments plus binds, on the stack unless there are many.
+	const Variant *bind_stack[16];
 	Vector<const Variant *> bind_mem;
 
 	Error err = OK;
 
 	for (int i = 0; i < ssize; i++) {
 
-		const Connection &c = slot_map.getv(i).conn;
+		const Signal::Slot &slot = slot_map.getv(i);
+		const Connection &c = slot.conn;
 
 		Object *target;
 #ifdef DEBUG_ENABLED
@@ -1198,24 +1187,38 @@ Error Object::emit_signal(const StringName &p_name, const Variant **p_args, int
 
 		if (c.binds.size()) {
 			//handle binds
-			bind_mem.resize(p_argcount + c.binds.size());
+			argc = p_argcount + c.binds.size();
+
+			const Variant **bind_args = bind_stack;
+			if (argc > (int)(sizeof(bind_stack) / sizeof(bind_stack[0]))) {
+				bind_mem.resize(argc);
+				bind_args = bind_mem.ptrw();
+			}
 
 			for (int j = 0; j < p_argcount; j++) {
-				bind_mem.write[j] = p_args[j];
+				bind_args[j] = p_args[j];
 			}
 			for (int j = 0; j < c.binds.size(); j++) {
-				bind_mem.write[p_argcount + j] = &c.binds[j];
+				bind_args[p_argcount + j] = &c.binds[j];
 			}
 
-			args = (const Variant **)bind_mem.ptr();
-			argc = bind_mem.size();
+			args = bind_args;
 		}
 
 		if (c.flags & CONNECT_DEFERRED) {
 			MessageQueue::get_singleton()->push_call(target->get_instance_id(), c.method, args, argc, true);
 		} else {
 			Variant::CallError ce;
-			target->call(c.method, args, argc, ce);
+			if (slot.method && !target->script_instance) {
+				// Native method, no need for Object::call() to look it up again.
+#ifdef DEBUG_ENABLED
+				_ObjectDebugLock target_lock(target);
+#endif
+				ce.error = Variant::CallError::CALL_OK; // Like Object::call(), not all binds set it.
+				slot.method->call(target, args, argc, ce);
+			} else {
+				target->call(c.method, args, argc, ce);
+			}
 
 			if (ce.error != Variant::CallError::CALL_OK) {
 #ifdef DEBUG_ENABLED
@@ -1476,6 +1479,7 @@ Error Object::connect(const StringName &p_signal, Object *p_to_object, const Str
 	conn.binds = p_binds;
 	slot.conn = conn;
 	slot.cE = p_to_object->connections.push_back(conn);
+	slot.method = ClassDB::get_method(p_to_object->get_class_name(), p_to_method);
 	if (p_flags & CONNECT_REFERENCE_COUNTED) {
 		slot.reference_count = 1;
 	}
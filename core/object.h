@@ -397,6 +397,7 @@ public:                                                        \
 private:
 
 class ScriptInstance;
+class MethodBind;
 typedef uint64_t ObjectID;
 
 class Object {
@@ -460,7 +461,12 @@ private:
 			int reference_count;
 			Connection conn;
 			List<Connection>::Element *cE;
-			Slot() { reference_count = 0; }
+			MethodBind *method; // Called directly when the target has no script, NULL to use Object::call().
+			Slot() {
+				reference_count = 0;
+				cE = NULL;
+				method = NULL;
+			}
 		};
 
 		MethodInfo user;
@@ -757,6 +763,25 @@ public:
 bool predelete_handler(Object *p_object);
 void postinitialize_handler(Object *p_object);
 
+#ifdef DEBUG_ENABLED
+
+// Held while calling into an object, so it can't be freed from inside its own call.
+// Callers that resolve and invoke methods themselves use it to keep the same checks as Object::call().
+struct _ObjectDebugLock {
+
+	Object *obj;
+
+	_ObjectDebugLock(Object *p_obj) {
+		obj = p_obj;
+		obj->_lock_index.ref();
+	}
+	~_ObjectDebugLock() {
+		obj->_lock_index.unref();
+	}
+};
+
+#endif
+
 class ObjectDB {
 
 	struct ObjectPtrHash {
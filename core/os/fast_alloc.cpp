@@ -0,0 +1,474 @@
+/*************************************************************************/
+/*  fast_alloc.cpp                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "fast_alloc.h"
+
+#ifdef FAST_ALLOC_ENABLED
+
+#include "core/os/copymem.h"
+#include "core/safe_refcount.h"
+
+#include <stdlib.h>
+
+enum {
+	SPAN_SHIFT = 16,
+	SPAN_SIZE = 1 << SPAN_SHIFT,
+	SPANS_PER_CHUNK = 16,
+	SPAN_HEADER_SIZE = 16,
+	SPAN_MAP_BITS = 16, // Covers 48 bits of address space, with SPAN_SHIFT.
+	SPAN_MAP_SIZE = 1 << SPAN_MAP_BITS,
+	MAX_SMALL_SIZE = 512,
+	SIZE_CLASS_COUNT = 16,
+	BIG_HEADER_SIZE = 16,
+};
+
+static const uint32_t size_class_sizes[SIZE_CLASS_COUNT] = {
+	16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512
+};
+
+// Indexed by the size rounded up to 16 bytes, divided by 16.
+static const uint8_t size_class_lookup[MAX_SMALL_SIZE / 16 + 1] = {
+	0, 0, 1, 2, 3, 4, 5, 6, 7,
+	8, 8, 9, 9, 10, 10, 11, 11,
+	12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15
+};
+
+struct FastAllocSpinLock {
+
+	volatile uint32_t locked;
+
+	_FORCE_INLINE_ void lock() {
+		while (true) {
+			while (locked) {
+				// wait until it looks free before trying, so the cache line isn't hammered
+			}
+			if (atomic_increment(&locked) == 1) {
+				return;
+			}
+			atomic_decrement(&locked);
+		}
+	}
+
+	_FORCE_INLINE_ void unlock() {
+		atomic_decrement(&locked);
+	}
+};
+
+struct FastAllocThreadCache;
+
+struct FastAllocSpan {
+
+	FastAllocThreadCache *owner;
+	uint32_t size_class;
+	uint32_t block_size;
+};
+
+struct FastAllocThreadCache {
+
+	void *free_list[SIZE_CLASS_COUNT];
+	uint8_t *bump[SIZE_CLASS_COUNT];
+	uint8_t *bump_end[SIZE_CLASS_COUNT];
+
+	// Blocks freed by other threads.
+	FastAllocSpinLock remote_lock;
+	void *volatile remote_list;
+	uint64_t remote_freed;
+
+	// Only touched by the owner thread.
+	uint64_t allocated;
+	uint64_t freed;
+
+	FastAllocThreadCache *next_cache;
+	FastAllocThreadCache *next_abandoned;
+};
+
+// Guards the span map, the chunk being split in spans and the cache lists.
+static FastAllocSpinLock global_lock = { 0 };
+static FastAllocThreadCache *all_caches = NULL;
+static FastAllocThreadCache *abandoned_caches = NULL;
+static uint8_t *chunk_next = NULL;
+static uint8_t *chunk_end = NULL;
+static bool spans_failed = false;
+
+// One byte per span sized page of address space, non zero for the pages holding a span.
+static volatile uintptr_t span_map[SPAN_MAP_SIZE];
+
+static volatile uint64_t big_usage = 0;
+static volatile uint64_t reserved_bytes = 0;
+static volatile uint64_t thread_cache_count = 0;
+
+struct FastAllocThreadCacheReleaser {
+	~FastAllocThreadCacheReleaser();
+};
+
+static thread_local FastAllocThreadCache *thread_cache = NULL;
+static thread_local bool thread_cache_released = false;
+static thread_local FastAllocThreadCacheReleaser thread_cache_releaser;
+
+FastAllocThreadCacheReleaser::~FastAllocThreadCacheReleaser() {
+
+	thread_cache_released = true;
+	if (!thread_cache) {
+		return;
+	}
+
+	// Keep the cache (and its spans) for the next thread that needs one.
+	global_lock.lock();
+	thread_cache->next_abandoned = abandoned_caches;
+	abandoned_caches = thread_cache;
+	global_lock.unlock();
+
+	thread_cache = NULL;
+}
+
+static FastAllocThreadCache *_create_thread_cache() {
+
+	if (thread_cache_released) {
+		// Allocating while the thread exits, leave it to malloc.
+		return NULL;
+	}
+
+	global_lock.lock();
+	FastAllocThreadCache *cache = abandoned_caches;
+	if (cache) {
+		abandoned_caches = cache->next_abandoned;
+	}
+	global_lock.unlock();
+
+	if (!cache) {
+		cache = (FastAllocThreadCache *)calloc(1, sizeof(FastAllocThreadCache));
+		if (!cache) {
+			return NULL;
+		}
+
+		global_lock.lock();
+		cache->next_cache = all_caches;
+		all_caches = cache;
+		global_lock.unlock();
+
+		atomic_increment(&thread_cache_count);
+	}
+
+	// Make sure the cache goes back to the abandoned list when the thread ends.
+	(void)&thread_cache_releaser;
+	thread_cache = cache;
+	return cache;
+}
+
+static _FORCE_INLINE_ FastAllocThreadCache *_get_thread_cache() {
+
+	FastAllocThreadCache *cache = thread_cache;
+	if (likely(cache)) {
+		return cache;
+	}
+	return _create_thread_cache();
+}
+
+static _FORCE_INLINE_ bool _is_span(const void *p_memory) {
+
+	uint64_t page = (uint64_t)(uintptr_t)p_memory >> SPAN_SHIFT;
+	if (page >> (SPAN_MAP_BITS * 2)) {
+		return false;
+	}
+
+	const uint8_t *leaf = (const uint8_t *)atomic_load_acquire(&span_map[page >> SPAN_MAP_BITS]);
+	return leaf && leaf[page & (SPAN_MAP_SIZE - 1)];
+}
+
+static _FORCE_INLINE_ FastAllocSpan *_get_span(const void *p_memory) {
+
+	return (FastAllocSpan *)((uintptr_t)p_memory & ~(uintptr_t)(SPAN_SIZE - 1));
+}
+
+// Must be called with global_lock held.
+static bool _register_span(uint8_t *p_span) {
+
+	uint64_t page = (uint64_t)(uintptr_t)p_span >> SPAN_SHIFT;
+	if (page >> (SPAN_MAP_BITS * 2)) {
+		return false;
+	}
+
+	uint8_t *leaf = (uint8_t *)span_map[page >> SPAN_MAP_BITS];
+	if (!leaf) {
+		leaf = (uint8_t *)calloc(SPAN_MAP_SIZE, 1);
+		if (!leaf) {
+			return false;
+		}
+		atomic_store_release(&span_map[page >> SPAN_MAP_BITS], (uintptr_t)leaf);
+	}
+
+	leaf[page & (SPAN_MAP_SIZE - 1)] = 1;
+	return true;
+}
+
+// Must be called with global_lock held, only for spans that were registered.
+static void _unregister_span(uint8_t *p_span) {
+
+	uint64_t page = (uint64_t)(uintptr_t)p_span >> SPAN_SHIFT;
+	uint8_t *leaf = (uint8_t *)span_map[page >> SPAN_MAP_BITS];
+	leaf[page & (SPAN_MAP_SIZE - 1)] = 0;
+}
+
+static uint8_t *_alloc_span() {
+
+	global_lock.lock();
+
+	if (chunk_next == chunk_end) {
+
+		if (spans_failed) {
+			global_lock.unlock();
+			return NULL;
+		}
+
+		// One extra span, to be able to align them.
+		uint8_t *chunk = (uint8_t *)malloc(SPAN_SIZE * (SPANS_PER_CHUNK + 1));
+		if (!chunk) {
+			global_lock.unlock();
+			return NULL;
+		}
+
+		uint8_t *first = (uint8_t *)(((uintptr_t)chunk + SPAN_SIZE - 1) & ~(uintptr_t)(SPAN_SIZE - 1));
+		for (int i = 0; i < SPANS_PER_CHUNK; i++) {
+			if (!_register_span(first + i * SPAN_SIZE)) {
+				// Out of what the span map covers, don't try again. The chunk goes back to
+				// malloc, which may hand it out again, so its spans must not stay marked.
+				for (int j = 0; j < i; j++) {
+					_unregister_span(first + j * SPAN_SIZE);
+				}
+				spans_failed = true;
+				global_lock.unlock();
+				::free(chunk);
+				return NULL;
+			}
+		}
+
+		chunk_next = first;
+		chunk_end = first + SPAN_SIZE * SPANS_PER_CHUNK;
+		atomic_add(&reserved_bytes, (uint64_t)SPAN_SIZE * (SPANS_PER_CHUNK + 1));
+	}
+
+	uint8_t *span = chunk_next;
+	chunk_next += SPAN_SIZE;
+
+	global_lock.unlock();
+
+	return span;
+}
+
+static void _drain_remote_frees(FastAllocThreadCache *p_cache) {
+
+	p_cache->remote_lock.lock();
+	void *block = p_cache->remote_list;
+	p_cache->remote_list = NULL;
+	p_cache->remote_lock.unlock();
+
+	while (block) {
+		void *next = *(void **)block;
+		uint32_t size_class = _get_span(block)->size_class;
+		*(void **)block = p_cache->free_list[size_class];
+		p_cache->free_list[size_class] = block;
+		block = next;
+	}
+}
+
+static void *_alloc_small_slow(FastAllocThreadCache *p_cache, uint32_t p_size_class) {
+
+	uint32_t block_size = size_class_sizes[p_size_class];
+
+	if (p_cache->remote_list) {
+		_drain_remote_frees(p_cache);
+
+		void *block = p_cache->free_list[p_size_class];
+		if (block) {
+			p_cache->free_list[p_size_class] = *(void **)block;
+			p_cache->allocated += block_size;
+			return block;
+		}
+	}
+
+	if (p_cache->bump[p_size_class] + block_size > p_cache->bump_end[p_size_class]) {
+
+		uint8_t *span_mem = _alloc_span();
+		if (!span_mem) {
+			return NULL;
+		}
+
+		FastAllocSpan *span = (FastAllocSpan *)span_mem;
+		span->owner = p_cache;
+		span->size_class = p_size_class;
+		span->block_size = block_size;
+
+		p_cache->bump[p_size_class] = span_mem + SPAN_HEADER_SIZE;
+		p_cache->bump_end[p_size_class] = span_mem + SPAN_SIZE;
+	}
+
+	void *block = p_cache->bump[p_size_class];
+	p_cache->bump[p_size_class] += block_size;
+	p_cache->allocated += block_size;
+	return block;
+}
+
+static void *_alloc_big(size_t p_bytes) {
+
+	uint8_t *mem = (uint8_t *)malloc(p_bytes + BIG_HEADER_SIZE);
+	if (!mem) {
+		return NULL;
+	}
+
+	*(uint64_t *)mem = p_bytes;
+	atomic_add(&big_usage, (uint64_t)p_bytes);
+	return mem + BIG_HEADER_SIZE;
+}
+
+void *FastAlloc::alloc(size_t p_bytes) {
+
+	if (p_bytes <= MAX_SMALL_SIZE) {
+
+		FastAllocThreadCache *cache = _get_thread_cache();
+		if (likely(cache)) {
+
+			uint32_t size_class = size_class_lookup[(p_bytes + 15) >> 4];
+			void *block = cache->free_list[size_class];
+			if (likely(block)) {
+				cache->free_list[size_class] = *(void **)block;
+				cache->allocated += size_class_sizes[size_class];
+				return block;
+			}
+
+			block = _alloc_small_slow(cache, size_class);
+			if (block) {
+				return block;
+			}
+		}
+	}
+
+	return _alloc_big(p_bytes);
+}
+
+void FastAlloc::free(void *p_memory) {
+
+	if (!p_memory) {
+		return;
+	}
+
+	if (_is_span(p_memory)) {
+
+		FastAllocSpan *span = _get_span(p_memory);
+		FastAllocThreadCache *owner = span->owner;
+
+		if (owner == thread_cache) {
+			*(void **)p_memory = owner->free_list[span->size_class];
+			owner->free_list[span->size_class] = p_memory;
+			owner->freed += span->block_size;
+		} else {
+			// Return to owner, it takes it back when it runs out of blocks.
+			owner->remote_lock.lock();
+			*(void **)p_memory = owner->remote_list;
+			owner->remote_list = p_memory;
+			owner->remote_freed += span->block_size;
+			owner->remote_lock.unlock();
+		}
+		return;
+	}
+
+	uint8_t *mem = (uint8_t *)p_memory - BIG_HEADER_SIZE;
+	atomic_sub(&big_usage, *(uint64_t *)mem);
+	::free(mem);
+}
+
+void *FastAlloc::realloc(void *p_memory, size_t p_bytes) {
+
+	if (!p_memory) {
+		return alloc(p_bytes);
+	}
+
+	if (p_bytes == 0) {
+		free(p_memory);
+		return NULL;
+	}
+
+	if (_is_span(p_memory)) {
+
+		uint32_t block_size = _get_span(p_memory)->block_size;
+		if (p_bytes <= block_size) {
+			return p_memory;
+		}
+
+		void *new_memory = alloc(p_bytes);
+		if (!new_memory) {
+			return NULL;
+		}
+		copymem(new_memory, p_memory, block_size);
+		free(p_memory);
+		return new_memory;
+	}
+
+	uint8_t *mem = (uint8_t *)p_memory - BIG_HEADER_SIZE;
+	uint64_t old_bytes = *(uint64_t *)mem;
+
+	mem = (uint8_t *)::realloc(mem, p_bytes + BIG_HEADER_SIZE);
+	if (!mem) {
+		return NULL;
+	}
+
+	*(uint64_t *)mem = p_bytes;
+	if (p_bytes > old_bytes) {
+		atomic_add(&big_usage, (uint64_t)(p_bytes - old_bytes));
+	} else {
+		atomic_sub(&big_usage, (uint64_t)(old_bytes - p_bytes));
+	}
+	return mem + BIG_HEADER_SIZE;
+}
+
+uint64_t FastAlloc::get_usage() {
+
+	uint64_t usage = big_usage;
+
+	global_lock.lock();
+	for (FastAllocThreadCache *cache = all_caches; cache; cache = cache->next_cache) {
+		// Not synchronized with the owners, good enough for statistics.
+		usage += cache->allocated - cache->freed - cache->remote_freed;
+	}
+	global_lock.unlock();
+
+	return usage;
+}
+
+uint64_t FastAlloc::get_reserved() {
+
+	return reserved_bytes + big_usage;
+}
+
+uint64_t FastAlloc::get_thread_cache_count() {
+
+	return thread_cache_count;
+}
+
+#endif // FAST_ALLOC_ENABLED
@@ -0,0 +1,71 @@
+/*************************************************************************/
+/*  fast_alloc.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef FAST_ALLOC_H
+#define FAST_ALLOC_H
+
+#include "core/typedefs.h"
+
+#include <stddef.h>
+
+#ifdef FAST_ALLOC_ENABLED
+
+/**
+ * @class FastAlloc
+ * Size class allocator with per thread caches, used under Memory::alloc_static()
+ * when building with use_fast_alloc=yes.
+ *
+ * Small blocks are carved out of 64 KiB aligned spans, each span holding blocks of
+ * a single size class and belonging to the thread cache that created it. Blocks
+ * freed by the owner thread go straight back to its free lists, blocks freed by
+ * another thread are handed back to the owner through a small locked list, which
+ * the owner drains when it runs out of blocks. Caches of exited threads are
+ * adopted by the next thread that needs one. Spans are never given back to the
+ * system.
+ *
+ * Bigger blocks use malloc() with a 16 bytes header keeping their size.
+ *
+ * Locks are spin locks, as this has to work before the OS layer (and Mutex) is up.
+ */
+
+class FastAlloc {
+public:
+	static void *alloc(size_t p_bytes);
+	static void *realloc(void *p_memory, size_t p_bytes);
+	static void free(void *p_memory);
+
+	static uint64_t get_usage(); // Bytes handed out, rounded up to the size class.
+	static uint64_t get_reserved(); // Bytes taken from the system for spans, plus big blocks.
+	static uint64_t get_thread_cache_count();
+};
+
+#endif // FAST_ALLOC_ENABLED
+
+#endif // FAST_ALLOC_H
@@ -34,9 +34,37 @@
 #include "core/os/copymem.h"
 #include "core/safe_refcount.h"
 
+#ifdef FAST_ALLOC_ENABLED
+#include "core/os/fast_alloc.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 
+static _FORCE_INLINE_ void *_system_malloc(size_t p_bytes) {
+#ifdef FAST_ALLOC_ENABLED
+	return FastAlloc::alloc(p_bytes);
+#else
+	return malloc(p_bytes);
+#endif
+}
+
+static _FORCE_INLINE_ void *_system_realloc(void *p_memory, size_t p_bytes) {
+#ifdef FAST_ALLOC_ENABLED
+	return FastAlloc::realloc(p_memory, p_bytes);
+#else
+	return realloc(p_memory, p_bytes);
+#endif
+}
+
+static _FORCE_INLINE_ void _system_free(void *p_memory) {
+#ifdef FAST_ALLOC_ENABLED
+	FastAlloc::free(p_memory);
+#else
+	free(p_memory);
+#endif
+}
+
 void *operator new(size_t p_size, const char *p_description) {
 
 	return Memory::alloc_static(p_size, false);
@@ -79,7 +107,7 @@ void *Memory::alloc_static(size_t p_bytes, bool p_pad_align) {
 	bool prepad = p_pad_align;
 #endif
 
-	void *mem = malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
+	void *mem = _system_malloc(p_bytes + (prepad ? PAD_ALIGN : 0));
 
 	ERR_FAIL_COND_V(!mem, NULL);
 
@@ -129,12 +157,12 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 #endif
 
 		if (p_bytes == 0) {
-			free(mem);
+			_system_free(mem);
 			return NULL;
 		} else {
 			*s = p_bytes;
 
-			mem = (uint8_t *)realloc(mem, p_bytes + PAD_ALIGN);
+			mem = (uint8_t *)_system_realloc(mem, p_bytes + PAD_ALIGN);
 			ERR_FAIL_COND_V(!mem, NULL);
 
 			s = (uint64_t *)mem;
@@ -145,7 +173,7 @@ void *Memory::realloc_static(void *p_memory, size_t p_bytes, bool p_pad_align) {
 		}
 	} else {
 
-		mem = (uint8_t *)realloc(mem, p_bytes);
+		mem = (uint8_t *)_system_realloc(mem, p_bytes);
 
 		ERR_FAIL_COND_V(mem == NULL && p_bytes > 0, NULL);
 
@@ -175,10 +203,10 @@ void Memory::free_static(void *p_ptr, bool p_pad_align) {
 		atomic_sub(&mem_usage, *s);
 #endif
 
-		free(mem);
+		_system_free(mem);
 	} else {
 
-		free(mem);
+		_system_free(mem);
 	}
 }
 
@@ -190,6 +218,8 @@ uint64_t Memory::get_mem_available() {
 uint64_t Memory::get_mem_usage() {
 #ifdef DEBUG_ENABLED
 	return mem_usage;
+#elif defined(FAST_ALLOC_ENABLED)
+	return FastAlloc::get_usage();
 #else
 	return 0;
 #endif
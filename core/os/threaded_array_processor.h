@@ -31,16 +31,10 @@
 #ifndef THREADED_ARRAY_PROCESSOR_H
 #define THREADED_ARRAY_PROCESSOR_H
 
-#include "core/os/mutex.h"
-#include "core/os/os.h"
-#include "core/os/thread.h"
-#include "core/os/thread_safe.h"
-#include "core/safe_refcount.h"
+#include "core/os/worker_thread_pool.h"
 
 template <class C, class U>
 struct ThreadArrayProcessData {
-	uint32_t elements;
-	uint32_t index;
 	C *instance;
 	U userdata;
 	void (C::*method)(uint32_t, U);
@@ -50,20 +44,16 @@ struct ThreadArrayProcessData {
 	}
 };
 
-#ifndef NO_THREADS
-
 template <class T>
-void process_array_thread(void *ud) {
+void process_array_element(void *ud, uint32_t p_index) {
 
 	T &data = *(T *)ud;
-	while (true) {
-		uint32_t index = atomic_increment(&data.index);
-		if (index >= data.elements)
-			break;
-		data.process(index);
-	}
+	data.process(p_index);
 }
 
+// Runs p_method for every index in [0, p_elements) on the shared WorkerThreadPool.
+// The calling thread takes part in the work and returns once all elements are done.
+
 template <class C, class M, class U>
 void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
 
@@ -71,40 +61,17 @@ void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_us
 	data.method = p_method;
 	data.instance = p_instance;
 	data.userdata = p_userdata;
-	data.index = 0;
-	data.elements = p_elements;
-	data.process(data.index); //process first, let threads increment for next
-
-	Vector<Thread *> threads;
-
-	threads.resize(OS::get_singleton()->get_processor_count());
 
-	for (int i = 0; i < threads.size(); i++) {
-		threads.write[i] = Thread::create(process_array_thread<ThreadArrayProcessData<C, U> >, &data);
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (!pool) {
+		for (uint32_t i = 0; i < p_elements; i++) {
+			data.process(i);
+		}
+		return;
 	}
 
-	for (int i = 0; i < threads.size(); i++) {
-		Thread::wait_to_finish(threads[i]);
-		memdelete(threads[i]);
-	}
-}
-
-#else
-
-template <class C, class M, class U>
-void thread_process_array(uint32_t p_elements, C *p_instance, M p_method, U p_userdata) {
-
-	ThreadArrayProcessData<C, U> data;
-	data.method = p_method;
-	data.instance = p_instance;
-	data.userdata = p_userdata;
-	data.index = 0;
-	data.elements = p_elements;
-	for (uint32_t i = 0; i < p_elements; i++) {
-		data.process(i);
-	}
+	WorkerThreadPool::TaskID group = pool->add_native_group_task(process_array_element<ThreadArrayProcessData<C, U> >, &data, p_elements);
+	pool->wait_for_task_completion(group);
 }
 
-#endif
-
 #endif // THREADED_ARRAY_PROCESSOR_H
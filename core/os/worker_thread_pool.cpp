@@ -0,0 +1,535 @@
+/*************************************************************************/
+/*  worker_thread_pool.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/safe_refcount.h"
+
+WorkerThreadPool *WorkerThreadPool::singleton = NULL;
+
+/* TASK DEQUE */
+
+void WorkerThreadPool::TaskDeque::push_back(Task *p_task) {
+
+	MutexLock lock(mutex);
+
+	if (count == (uint32_t)ring.size()) {
+		// Grow, unwrapping the ring so head starts at zero again.
+		Vector<Task *> new_ring;
+		new_ring.resize(MAX(16, ring.size() * 2));
+		for (uint32_t i = 0; i < count; i++) {
+			new_ring.write[i] = ring[(head + i) % ring.size()];
+		}
+		ring = new_ring;
+		head = 0;
+	}
+
+	ring.write[(head + count) % ring.size()] = p_task;
+	count++;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::pop_back() {
+
+	MutexLock lock(mutex);
+
+	if (count == 0)
+		return NULL;
+
+	count--;
+	return ring[(head + count) % ring.size()];
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::TaskDeque::pop_front() {
+
+	MutexLock lock(mutex);
+
+	if (count == 0)
+		return NULL;
+
+	Task *task = ring[head];
+	head = (head + 1) % ring.size();
+	count--;
+	return task;
+}
+
+/* ALLOCATION */
+
+WorkerThreadPool::Work *WorkerThreadPool::_alloc_work() {
+
+	MutexLock lock(mutex);
+
+	Work *work;
+	if (free_works) {
+		work = free_works;
+		free_works = work->next_free;
+	} else {
+		work = memnew(Work);
+		work->done_semaphore = Semaphore::create();
+	}
+
+	work->id = INVALID_TASK_ID;
+	work->group = false;
+	work->queued = false;
+	work->completed = false;
+	work->waiting = false;
+	work->native_func = NULL;
+	work->native_group_func = NULL;
+	work->userdata = NULL;
+	work->template_userdata = NULL;
+	work->elements = 0;
+	work->index = 0;
+	work->slices = 1;
+	work->finished = 0;
+	work->pending_dependencies = 0;
+	work->next_free = NULL;
+
+	return work;
+}
+
+// The pool mutex must be held for the three functions below.
+
+void WorkerThreadPool::_free_work(Work *p_work) {
+
+	if (p_work->template_userdata) {
+		memdelete(p_work->template_userdata);
+		p_work->template_userdata = NULL;
+	}
+	p_work->dependents.clear();
+	p_work->next_free = free_works;
+	free_works = p_work;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_alloc_task(Work *p_work) {
+
+	Task *task;
+	if (free_tasks) {
+		task = free_tasks;
+		free_tasks = task->next_free;
+	} else {
+		task = memnew(Task);
+	}
+	task->work = p_work;
+	task->next_free = NULL;
+	return task;
+}
+
+void WorkerThreadPool::_free_task(Task *p_task) {
+
+	p_task->work = NULL;
+	p_task->next_free = free_tasks;
+	free_tasks = p_task;
+}
+
+/* SCHEDULING */
+
+int WorkerThreadPool::_get_thread_index_for(Thread::ID p_id) const {
+
+	for (int i = 0; i < thread_count; i++) {
+		if (threads[i].id == p_id)
+			return i;
+	}
+	return -1;
+}
+
+int WorkerThreadPool::get_thread_index() const {
+
+	if (thread_count == 0)
+		return -1;
+	return _get_thread_index_for(Thread::get_caller_id());
+}
+
+void WorkerThreadPool::_queue_work(Work *p_work) {
+
+	// Pool mutex must be held.
+	p_work->queued = true;
+
+	if (thread_count == 0) {
+		for (uint32_t i = 0; i < p_work->slices; i++) {
+			external_queue.push_back(_alloc_task(p_work));
+		}
+		return;
+	}
+
+	int caller = get_thread_index();
+
+	for (uint32_t i = 0; i < p_work->slices; i++) {
+		int target;
+		if (caller >= 0 && i == 0) {
+			// Keep the first slice local, it's the most likely to be cache-hot.
+			target = caller;
+		} else {
+			target = next_deque % thread_count;
+			next_deque++;
+		}
+		threads[target].deque.push_back(_alloc_task(p_work));
+		work_available->post();
+	}
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::_add_work(Work *p_work, const Vector<TaskID> &p_dependencies) {
+
+	MutexLock lock(mutex);
+
+	p_work->id = ++last_id;
+	works.set(p_work->id, p_work);
+
+	for (int i = 0; i < p_dependencies.size(); i++) {
+		Work **dep = works.getptr(p_dependencies[i]);
+		// Unknown IDs were already waited for, so they are complete.
+		if (dep && !(*dep)->completed) {
+			(*dep)->dependents.push_back(p_work);
+			p_work->pending_dependencies++;
+		}
+	}
+
+	if (p_work->pending_dependencies == 0) {
+		_queue_work(p_work);
+	}
+
+	return p_work->id;
+}
+
+WorkerThreadPool::Task *WorkerThreadPool::_pop_task(int p_thread_index) {
+
+	if (thread_count == 0)
+		return external_queue.pop_back();
+
+	if (p_thread_index >= 0) {
+		Task *task = threads[p_thread_index].deque.pop_back();
+		if (task)
+			return task;
+	}
+
+	// Steal, starting at the next deque so thieves don't all hit the same one.
+	int count = thread_count;
+	int from = p_thread_index >= 0 ? p_thread_index + 1 : 0;
+	for (int i = 0; i < count; i++) {
+		int victim = (from + i) % count;
+		if (victim == p_thread_index)
+			continue;
+		Task *task = threads[victim].deque.pop_front();
+		if (task)
+			return task;
+	}
+
+	return NULL;
+}
+
+void WorkerThreadPool::_run_task(Task *p_task) {
+
+	Work *work = p_task->work;
+
+	mutex->lock();
+	_free_task(p_task);
+	mutex->unlock();
+
+	if (work->group) {
+		uint32_t ran = _run_group_elements(work);
+		_finish_group(work, ran + 1); // the slice itself returned too
+	} else {
+		if (work->template_userdata) {
+			work->template_userdata->callback();
+		} else {
+			work->native_func(work->userdata);
+		}
+		_complete_work(work);
+	}
+}
+
+// Runs elements of a group until none are left to hand out, returns how many it ran.
+uint32_t WorkerThreadPool::_run_group_elements(Work *p_work) {
+
+	uint32_t ran = 0;
+	while (true) {
+		uint32_t index = atomic_increment(&p_work->index) - 1;
+		if (index >= p_work->elements)
+			break;
+		p_work->run_index(index);
+		ran++;
+	}
+	return ran;
+}
+
+void WorkerThreadPool::_finish_group(Work *p_work, uint32_t p_amount) {
+
+	if (!p_amount)
+		return;
+
+	// Once the last finisher gets here the work may be completed and recycled,
+	// so only the one that brings the count to the total touches it after the add.
+	uint32_t total = p_work->elements + p_work->slices;
+	if (atomic_add(&p_work->finished, p_amount) == total) {
+		_complete_work(p_work);
+	}
+}
+
+void WorkerThreadPool::_complete_work(Work *p_work) {
+
+	MutexLock lock(mutex);
+
+	p_work->completed = true;
+
+	for (int i = 0; i < p_work->dependents.size(); i++) {
+		Work *dependent = p_work->dependents[i];
+		dependent->pending_dependencies--;
+		if (dependent->pending_dependencies == 0) {
+			_queue_work(dependent);
+		}
+	}
+	p_work->dependents.clear();
+
+	if (p_work->waiting) {
+		p_work->done_semaphore->post();
+	}
+}
+
+void WorkerThreadPool::_thread_function(void *p_user) {
+
+	ThreadData *thread_data = (ThreadData *)p_user;
+	WorkerThreadPool *pool = thread_data->pool;
+
+	thread_data->id = Thread::get_caller_id();
+	pool->startup_semaphore->post();
+
+	while (true) {
+		pool->work_available->wait();
+		if (pool->exit_threads)
+			break;
+
+		Task *task = pool->_pop_task(thread_data->index);
+		while (task) {
+			pool->_run_task(task);
+			task = pool->_pop_task(thread_data->index);
+		}
+	}
+}
+
+/* PUBLIC API */
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_native_task(NativeTaskFunc p_func, void *p_userdata, const Vector<TaskID> &p_dependencies) {
+
+	ERR_FAIL_COND_V(!p_func, INVALID_TASK_ID);
+
+	Work *work = _alloc_work();
+	work->native_func = p_func;
+	work->userdata = p_userdata;
+	return _add_work(work, p_dependencies);
+}
+
+WorkerThreadPool::TaskID WorkerThreadPool::add_native_group_task(NativeGroupTaskFunc p_func, void *p_userdata, uint32_t p_elements, int p_slices, const Vector<TaskID> &p_dependencies) {
+
+	ERR_FAIL_COND_V(!p_func, INVALID_TASK_ID);
+
+	Work *work = _alloc_work();
+	work->group = true;
+	work->native_group_func = p_func;
+	work->userdata = p_userdata;
+	work->elements = p_elements;
+	work->slices = p_slices < 0 ? MAX(1, thread_count) : MAX(1, p_slices);
+	return _add_work(work, p_dependencies);
+}
+
+bool WorkerThreadPool::is_task_completed(TaskID p_task) const {
+
+	MutexLock lock(mutex);
+
+	const Work *const *work = works.getptr(p_task);
+	ERR_FAIL_COND_V_MSG(!work, false, "Invalid task ID, or the task was already waited for.");
+	return (*work)->completed;
+}
+
+void WorkerThreadPool::wait_for_task_completion(TaskID p_task) {
+
+	mutex->lock();
+	Work **work_ptr = works.getptr(p_task);
+	if (!work_ptr) {
+		mutex->unlock();
+		ERR_FAIL_MSG("Invalid task ID, or the task was already waited for.");
+	}
+	Work *work = *work_ptr;
+	if (work->waiting) {
+		mutex->unlock();
+		ERR_FAIL_MSG("Task is already being waited for by another thread.");
+	}
+	mutex->unlock();
+
+	int thread_index = get_thread_index();
+
+	// Help instead of blocking, running the awaited group first and then anything queued.
+	while (true) {
+
+		mutex->lock();
+		bool completed = work->completed;
+		bool queued = work->queued;
+		mutex->unlock();
+
+		if (completed)
+			break;
+
+		if (work->group && queued) {
+			// Elements run here count like the ones run by slices, so the group can't
+			// complete (and start its dependents) while one of them is still running.
+			_finish_group(work, _run_group_elements(work));
+		}
+
+		Task *task = _pop_task(thread_index);
+		if (task) {
+			_run_task(task);
+			continue;
+		}
+
+		mutex->lock();
+		if (work->completed) {
+			mutex->unlock();
+			break;
+		}
+		work->waiting = true;
+		mutex->unlock();
+
+		work->done_semaphore->wait();
+		break;
+	}
+
+	MutexLock lock(mutex);
+	works.erase(p_task);
+	_free_work(work);
+}
+
+void WorkerThreadPool::init(int p_thread_count) {
+
+	ERR_FAIL_COND(mutex);
+
+#ifdef NO_THREADS
+	p_thread_count = 0;
+#else
+	if (p_thread_count < 0) {
+		p_thread_count = OS::get_singleton()->get_processor_count();
+	}
+#endif
+
+	mutex = Mutex::create();
+	work_available = Semaphore::create();
+	startup_semaphore = Semaphore::create();
+	external_queue.mutex = Mutex::create();
+	exit_threads = false;
+
+	thread_count = p_thread_count;
+	if (thread_count > 0) {
+		threads = memnew_arr(ThreadData, thread_count);
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		ThreadData &thread_data = threads[i];
+		thread_data.pool = this;
+		thread_data.index = i;
+		thread_data.deque.mutex = Mutex::create();
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		threads[i].thread = Thread::create(_thread_function, &threads[i]);
+	}
+
+	// Thread IDs are only known once each thread runs, wait for all of them.
+	for (int i = 0; i < thread_count; i++) {
+		startup_semaphore->wait();
+	}
+
+	print_verbose("WorkerThreadPool: Started " + itos(thread_count) + " worker threads.");
+}
+
+void WorkerThreadPool::finish() {
+
+	if (!mutex)
+		return; // Never initialized.
+
+	exit_threads = true;
+	for (int i = 0; i < thread_count; i++) {
+		work_available->post();
+	}
+
+	for (int i = 0; i < thread_count; i++) {
+		Thread::wait_to_finish(threads[i].thread);
+		memdelete(threads[i].thread);
+		memdelete(threads[i].deque.mutex);
+	}
+	if (threads) {
+		memdelete_arr(threads);
+		threads = NULL;
+	}
+	thread_count = 0;
+
+	if (works.size()) {
+		WARN_PRINTS("WorkerThreadPool: " + itos(works.size()) + " tasks were never waited for.");
+	}
+
+	while (free_works) {
+		Work *work = free_works;
+		free_works = work->next_free;
+		memdelete(work->done_semaphore);
+		memdelete(work);
+	}
+
+	while (free_tasks) {
+		Task *task = free_tasks;
+		free_tasks = task->next_free;
+		memdelete(task);
+	}
+
+	memdelete(external_queue.mutex);
+	external_queue.mutex = NULL;
+	memdelete(startup_semaphore);
+	startup_semaphore = NULL;
+	memdelete(work_available);
+	work_available = NULL;
+	memdelete(mutex);
+	mutex = NULL;
+}
+
+WorkerThreadPool::WorkerThreadPool() {
+
+	singleton = this;
+	threads = NULL;
+	thread_count = 0;
+	mutex = NULL;
+	work_available = NULL;
+	startup_semaphore = NULL;
+	last_id = 0;
+	next_deque = 0;
+	exit_threads = false;
+	free_works = NULL;
+	free_tasks = NULL;
+}
+
+WorkerThreadPool::~WorkerThreadPool() {
+
+	finish();
+	singleton = NULL;
+}
@@ -0,0 +1,250 @@
+/*************************************************************************/
+/*  worker_thread_pool.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef WORKER_THREAD_POOL_H
+#define WORKER_THREAD_POOL_H
+
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/vector.h"
+
+/**
+ * @class WorkerThreadPool
+ * Persistent pool of worker threads shared by the whole engine.
+ *
+ * Every worker owns a deque of pending tasks. Workers pop from the back of
+ * their own deque and, when it runs dry, steal from the front of the other
+ * deques. Tasks submitted from outside the pool are spread round-robin over
+ * the worker deques.
+ *
+ * Group tasks run a function over a range of indices, split in as many slices
+ * as requested (one per worker by default). Any task or group can depend on
+ * previously submitted tasks or groups, and will only be queued once all of
+ * them have completed.
+ *
+ * Every task and group must be waited for exactly once with
+ * wait_for_task_completion(), which is what releases it. While waiting, the
+ * calling thread helps running queued work, so waiting from inside a task is
+ * safe and a pool without threads (NO_THREADS builds) runs everything inline.
+ */
+
+class WorkerThreadPool {
+public:
+	typedef int64_t TaskID;
+
+	enum {
+		INVALID_TASK_ID = -1
+	};
+
+	typedef void (*NativeTaskFunc)(void *p_userdata);
+	typedef void (*NativeGroupTaskFunc)(void *p_userdata, uint32_t p_index);
+
+private:
+	struct BaseTemplateUserdata {
+		virtual void callback() {}
+		virtual void callback_indexed(uint32_t p_index) {}
+		virtual ~BaseTemplateUserdata() {}
+	};
+
+	template <class C, class M, class U>
+	struct TaskUserData : public BaseTemplateUserdata {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void callback() {
+			(instance->*method)(userdata);
+		}
+	};
+
+	template <class C, class M, class U>
+	struct GroupUserData : public BaseTemplateUserdata {
+		C *instance;
+		M method;
+		U userdata;
+		virtual void callback_indexed(uint32_t p_index) {
+			(instance->*method)(p_index, userdata);
+		}
+	};
+
+	struct Work;
+
+	struct Task {
+		Work *work;
+		Task *next_free;
+	};
+
+	struct Work {
+		TaskID id;
+		bool group;
+		bool queued;
+		bool completed;
+		bool waiting;
+
+		NativeTaskFunc native_func;
+		NativeGroupTaskFunc native_group_func;
+		void *userdata;
+		BaseTemplateUserdata *template_userdata;
+
+		// Group only, index is handed out atomically to the slices.
+		uint32_t elements;
+		uint32_t index;
+		uint32_t slices;
+		// Counts finished elements plus returned slices. The work completes when it
+		// reaches elements + slices, so no element is still running and no slice task
+		// still points to it.
+		uint32_t finished;
+
+		uint32_t pending_dependencies;
+		Vector<Work *> dependents;
+
+		Semaphore *done_semaphore;
+		Work *next_free;
+
+		void run_index(uint32_t p_index) {
+			if (template_userdata) {
+				template_userdata->callback_indexed(p_index);
+			} else {
+				native_group_func(userdata, p_index);
+			}
+		}
+	};
+
+	struct TaskDeque {
+		Mutex *mutex;
+		Vector<Task *> ring;
+		uint32_t head;
+		uint32_t count;
+
+		void push_back(Task *p_task);
+		Task *pop_back();
+		Task *pop_front();
+
+		TaskDeque() {
+			mutex = NULL;
+			head = 0;
+			count = 0;
+		}
+	};
+
+	struct ThreadData {
+		WorkerThreadPool *pool;
+		int index;
+		Thread *thread;
+		Thread::ID id;
+		TaskDeque deque;
+		ThreadData() {
+			pool = NULL;
+			index = -1;
+			thread = NULL;
+			id = 0;
+		}
+	};
+
+	static WorkerThreadPool *singleton;
+
+	ThreadData *threads;
+	int thread_count;
+	TaskDeque external_queue; // Used only when there are no worker threads.
+
+	Mutex *mutex; // Guards works, free lists, dependencies and completion.
+	Semaphore *work_available;
+	Semaphore *startup_semaphore;
+	HashMap<TaskID, Work *> works;
+	TaskID last_id;
+	uint32_t next_deque;
+	bool exit_threads;
+
+	Work *free_works;
+	Task *free_tasks;
+
+	static void _thread_function(void *p_user);
+
+	int _get_thread_index_for(Thread::ID p_id) const;
+
+	Work *_alloc_work();
+	void _free_work(Work *p_work);
+	Task *_alloc_task(Work *p_work);
+	void _free_task(Task *p_task);
+
+	TaskID _add_work(Work *p_work, const Vector<TaskID> &p_dependencies);
+	void _queue_work(Work *p_work);
+	Task *_pop_task(int p_thread_index);
+	void _run_task(Task *p_task);
+	void _complete_work(Work *p_work);
+	uint32_t _run_group_elements(Work *p_work);
+	void _finish_group(Work *p_work, uint32_t p_amount);
+
+public:
+	TaskID add_native_task(NativeTaskFunc p_func, void *p_userdata, const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+	TaskID add_native_group_task(NativeGroupTaskFunc p_func, void *p_userdata, uint32_t p_elements, int p_slices = -1, const Vector<TaskID> &p_dependencies = Vector<TaskID>());
+
+	template <class C, class M, class U>
+	TaskID add_template_task(C *p_instance, M p_method, U p_userdata, const Vector<TaskID> &p_dependencies = Vector<TaskID>()) {
+		TaskUserData<C, M, U> *ud = memnew((TaskUserData<C, M, U>));
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+		Work *work = _alloc_work();
+		work->template_userdata = ud;
+		return _add_work(work, p_dependencies);
+	}
+
+	template <class C, class M, class U>
+	TaskID add_template_group_task(C *p_instance, M p_method, U p_userdata, uint32_t p_elements, int p_slices = -1, const Vector<TaskID> &p_dependencies = Vector<TaskID>()) {
+		GroupUserData<C, M, U> *ud = memnew((GroupUserData<C, M, U>));
+		ud->instance = p_instance;
+		ud->method = p_method;
+		ud->userdata = p_userdata;
+		Work *work = _alloc_work();
+		work->group = true;
+		work->template_userdata = ud;
+		work->elements = p_elements;
+		work->slices = p_slices < 0 ? MAX(1, thread_count) : MAX(1, p_slices);
+		return _add_work(work, p_dependencies);
+	}
+
+	bool is_task_completed(TaskID p_task) const;
+	void wait_for_task_completion(TaskID p_task);
+
+	int get_thread_count() const { return thread_count; }
+	int get_thread_index() const; // -1 when not called from a pool thread.
+
+	static WorkerThreadPool *get_singleton() { return singleton; }
+
+	void init(int p_thread_count = -1);
+	void finish();
+
+	WorkerThreadPool();
+	~WorkerThreadPool();
+};
+
+#endif // WORKER_THREAD_POOL_H
@@ -541,8 +541,10 @@ Error PoolVector<T>::resize(int p_size) {
 		alloc->pool_id = POOL_ALLOCATOR_INVALID_ID;
 		MemoryPool::alloc_mutex->unlock();
 
-	} else {
+	} else if (alloc->refcount.get() == 1) {
 
+		// Shared allocations are copied before resizing, so only locks on
+		// our own copy get in the way.
 		ERR_FAIL_COND_V_MSG(alloc->lock > 0, ERR_LOCKED, "Can't resize PoolVector if locked."); //can't resize if locked!
 	}
 
@@ -0,0 +1,114 @@
+/*************************************************************************/
+/*  radix_sort.h                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef RADIX_SORT_H
+#define RADIX_SORT_H
+
+#include "core/typedefs.h"
+
+template <class T>
+struct _DefaultRadixKey {
+
+	_FORCE_INLINE_ uint64_t operator()(const T &p_value) const { return uint64_t(p_value); }
+};
+
+/**
+ * Stable least significant digit radix sort on a 64 bits key, extracted from each
+ * element by KeyGetter. Unlike SortArray it needs a scratch buffer as big as the
+ * array, but its cost grows linearly with the element count. Digits that are the
+ * same for every element are skipped, so keys that only use a few of their bits
+ * take few passes.
+ */
+
+template <class T, class KeyGetter = _DefaultRadixKey<T> >
+class RadixSort {
+
+	enum {
+		DIGIT_BITS = 8,
+		DIGIT_COUNT = 1 << DIGIT_BITS,
+		DIGIT_MASK = DIGIT_COUNT - 1,
+		PASS_COUNT = 64 / DIGIT_BITS
+	};
+
+public:
+	KeyGetter get_key;
+
+	// p_tmp must have room for p_len elements, the result is always left in p_array.
+	void sort(T *p_array, int p_len, T *p_tmp) const {
+
+		if (p_len < 2) {
+			return;
+		}
+
+		// Count all digits at once, so the keys are read a single time before the passes.
+		uint32_t histograms[PASS_COUNT][DIGIT_COUNT] = {};
+
+		for (int i = 0; i < p_len; i++) {
+			uint64_t key = get_key(p_array[i]);
+			for (int j = 0; j < PASS_COUNT; j++) {
+				histograms[j][(key >> (j * DIGIT_BITS)) & DIGIT_MASK]++;
+			}
+		}
+
+		T *src = p_array;
+		T *dst = p_tmp;
+
+		for (int j = 0; j < PASS_COUNT; j++) {
+
+			int shift = j * DIGIT_BITS;
+			uint32_t *offsets = histograms[j];
+
+			if (offsets[(get_key(src[0]) >> shift) & DIGIT_MASK] == uint32_t(p_len)) {
+				continue; // all elements share this digit, order would not change
+			}
+
+			uint32_t sum = 0;
+			for (int k = 0; k < DIGIT_COUNT; k++) {
+				uint32_t count = offsets[k];
+				offsets[k] = sum;
+				sum += count;
+			}
+
+			for (int i = 0; i < p_len; i++) {
+				dst[offsets[(get_key(src[i]) >> shift) & DIGIT_MASK]++] = src[i];
+			}
+
+			SWAP(src, dst);
+		}
+
+		if (src != p_array) {
+			for (int i = 0; i < p_len; i++) {
+				p_array[i] = src[i];
+			}
+		}
+	}
+};
+
+#endif // RADIX_SORT_H
@@ -368,7 +368,7 @@ struct PtrToArg<const RefPtr &> {
 
 #endif // PTRCALL_ENABLED
 
-#ifdef DEBUG_METHODS_ENABLED
+#ifdef METHOD_BIND_ARGUMENT_TYPES_ENABLED
 
 template <class T>
 struct GetTypeInfo<Ref<T> > {
@@ -390,6 +390,6 @@ struct GetTypeInfo<const Ref<T> &> {
 	}
 };
 
-#endif // DEBUG_METHODS_ENABLED
+#endif // METHOD_BIND_ARGUMENT_TYPES_ENABLED
 
 #endif // REFERENCE_H
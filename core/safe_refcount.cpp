@@ -143,6 +143,14 @@ uint32_t atomic_exchange_if_greater(volatile uint32_t *pw, volatile uint32_t val
 	return _atomic_exchange_if_greater_impl(pw, val);
 }
 
+uint32_t atomic_load_acquire(volatile uint32_t *pw) {
+	return InterlockedCompareExchange((LONG volatile *)pw, 0, 0);
+}
+
+void atomic_store_release(volatile uint32_t *pw, uint32_t val) {
+	InterlockedExchange((LONG volatile *)pw, val);
+}
+
 uint64_t atomic_conditional_increment(volatile uint64_t *pw) {
 	return _atomic_conditional_increment_impl(pw);
 }
@@ -166,4 +174,20 @@ uint64_t atomic_add(volatile uint64_t *pw, volatile uint64_t val) {
 uint64_t atomic_exchange_if_greater(volatile uint64_t *pw, volatile uint64_t val) {
 	return _atomic_exchange_if_greater_impl(pw, val);
 }
+
+uint64_t atomic_load_acquire(volatile uint64_t *pw) {
+	return InterlockedCompareExchange64((LONGLONG volatile *)pw, 0, 0);
+}
+
+void atomic_store_release(volatile uint64_t *pw, uint64_t val) {
+	InterlockedExchange64((LONGLONG volatile *)pw, val);
+}
+
+void *atomic_load_acquire(void *volatile *pw) {
+	return InterlockedCompareExchangePointer(pw, NULL, NULL);
+}
+
+void atomic_store_release(void *volatile *pw, void *val) {
+	InterlockedExchangePointer(pw, val);
+}
 #endif
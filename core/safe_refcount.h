@@ -93,6 +93,18 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	return *pw;
 }
 
+template <class T>
+static _ALWAYS_INLINE_ T atomic_load_acquire(volatile T *pw) {
+
+	return *pw;
+}
+
+template <class T, class V>
+static _ALWAYS_INLINE_ void atomic_store_release(volatile T *pw, V val) {
+
+	*pw = val;
+}
+
 #elif defined(__GNUC__)
 
 /* Implementation for GCC & Clang */
@@ -148,6 +160,20 @@ static _ALWAYS_INLINE_ T atomic_exchange_if_greater(volatile T *pw, volatile V v
 	}
 }
 
+// Acquire/release pairs, for publishing data between a single producer and a single consumer.
+
+template <class T>
+static _ALWAYS_INLINE_ T atomic_load_acquire(volatile T *pw) {
+
+	return __atomic_load_n(pw, __ATOMIC_ACQUIRE);
+}
+
+template <class T, class V>
+static _ALWAYS_INLINE_ void atomic_store_release(volatile T *pw, V val) {
+
+	__atomic_store_n(pw, (T)val, __ATOMIC_RELEASE);
+}
+
 #elif defined(_MSC_VER)
 // For MSVC use a separate compilation unit to prevent windows.h from polluting
 // the global namespace.
@@ -157,6 +183,8 @@ uint32_t atomic_increment(volatile uint32_t *pw);
 uint32_t atomic_sub(volatile uint32_t *pw, volatile uint32_t val);
 uint32_t atomic_add(volatile uint32_t *pw, volatile uint32_t val);
 uint32_t atomic_exchange_if_greater(volatile uint32_t *pw, volatile uint32_t val);
+uint32_t atomic_load_acquire(volatile uint32_t *pw);
+void atomic_store_release(volatile uint32_t *pw, uint32_t val);
 
 uint64_t atomic_conditional_increment(volatile uint64_t *pw);
 uint64_t atomic_decrement(volatile uint64_t *pw);
@@ -164,6 +192,21 @@ uint64_t atomic_increment(volatile uint64_t *pw);
 uint64_t atomic_sub(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_add(volatile uint64_t *pw, volatile uint64_t val);
 uint64_t atomic_exchange_if_greater(volatile uint64_t *pw, volatile uint64_t val);
+uint64_t atomic_load_acquire(volatile uint64_t *pw);
+void atomic_store_release(volatile uint64_t *pw, uint64_t val);
+
+void *atomic_load_acquire(void *volatile *pw);
+void atomic_store_release(void *volatile *pw, void *val);
+
+template <class T>
+static _ALWAYS_INLINE_ T *atomic_load_acquire(T *volatile *pw) {
+	return (T *)atomic_load_acquire((void *volatile *)pw);
+}
+
+template <class T, class V>
+static _ALWAYS_INLINE_ void atomic_store_release(T *volatile *pw, V val) {
+	atomic_store_release((void *volatile *)pw, (void *)(T *)val);
+}
 
 #else
 //no threads supported?
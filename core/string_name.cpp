@@ -39,7 +39,7 @@ StaticCString StaticCString::create(const char *p_ptr) {
 	return scs;
 }
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+StringName::_Shard StringName::_shards[STRING_TABLE_SHARDS];
 
 StringName _scs_create(const char *p_chr) {
 
@@ -47,49 +47,161 @@ StringName _scs_create(const char *p_chr) {
 }
 
 bool StringName::configured = false;
-Mutex *StringName::lock = NULL;
 
 void StringName::setup() {
 
-	lock = Mutex::create();
-
 	ERR_FAIL_COND(configured);
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
 
-		_table[i] = NULL;
+		_Shard &shard = _shards[i];
+		shard.lock = Mutex::create(false);
+		shard.table = memnew_arr(_Data *, STRING_TABLE_SHARD_MIN_LEN);
+		for (int j = 0; j < STRING_TABLE_SHARD_MIN_LEN; j++) {
+			shard.table[j] = NULL;
+		}
+		shard.mask = STRING_TABLE_SHARD_MIN_LEN - 1;
+		shard.count = 0;
 	}
 	configured = true;
 }
 
 void StringName::cleanup() {
 
-	lock->lock();
-
 	int lost_strings = 0;
-	for (int i = 0; i < STRING_TABLE_LEN; i++) {
+	for (int i = 0; i < STRING_TABLE_SHARDS; i++) {
+
+		_Shard &shard = _shards[i];
+		shard.lock->lock();
 
-		while (_table[i]) {
+		for (uint32_t j = 0; j <= shard.mask; j++) {
 
-			_Data *d = _table[i];
-			lost_strings++;
-			if (OS::get_singleton()->is_stdout_verbose()) {
-				if (d->cname) {
-					print_line("Orphan StringName: " + String(d->cname));
-				} else {
-					print_line("Orphan StringName: " + String(d->name));
+			while (shard.table[j]) {
+
+				_Data *d = shard.table[j];
+				lost_strings++;
+				if (OS::get_singleton()->is_stdout_verbose()) {
+					if (d->cname) {
+						print_line("Orphan StringName: " + String(d->cname));
+					} else {
+						print_line("Orphan StringName: " + String(d->name));
+					}
 				}
-			}
 
-			_table[i] = _table[i]->next;
-			memdelete(d);
+				shard.table[j] = shard.table[j]->next;
+				memdelete(d);
+			}
 		}
+
+		memdelete_arr(shard.table);
+		shard.table = NULL;
+		shard.lock->unlock();
+
+		memdelete(shard.lock);
+		shard.lock = NULL;
 	}
 	if (lost_strings) {
 		print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
 	}
-	lock->unlock();
+}
+
+void StringName::_grow(_Shard &p_shard) {
+
+	uint32_t new_len = (p_shard.mask + 1) * 2;
+	_Data **new_table = memnew_arr(_Data *, new_len);
+	for (uint32_t i = 0; i < new_len; i++) {
+		new_table[i] = NULL;
+	}
+
+	for (uint32_t i = 0; i <= p_shard.mask; i++) {
+
+		_Data *d = p_shard.table[i];
+		while (d) {
+
+			_Data *next = d->next;
+			d->idx = d->hash & (new_len - 1);
+			d->prev = NULL;
+			d->next = new_table[d->idx];
+			if (d->next) {
+				d->next->prev = d;
+			}
+			new_table[d->idx] = d;
+			d = next;
+		}
+	}
 
-	memdelete(lock);
+	memdelete_arr(p_shard.table);
+	p_shard.table = new_table;
+	p_shard.mask = new_len - 1;
+}
+
+// Returns the entry for p_name with a new reference, or NULL. Entries whose
+// last reference is being released can't be revived and are skipped, unref()
+// removes them once it gets the shard lock.
+template <class T>
+StringName::_Data *StringName::_find(const _Shard &p_shard, uint32_t p_hash, const T &p_name) {
+
+	_Data *d = p_shard.table[p_hash & p_shard.mask];
+
+	while (d) {
+
+		// compare hash first
+		if (d->hash == p_hash && d->get_name() == p_name && d->refcount.ref()) {
+			return d;
+		}
+		d = d->next;
+	}
+
+	return NULL;
+}
+
+template <class T>
+StringName::_Data *StringName::_intern(const T &p_name, uint32_t p_hash, const char *p_cname) {
+
+	_Shard &shard = _get_shard(p_hash);
+
+	MutexLock lock(shard.lock);
+
+	_Data *d = _find(shard, p_hash, p_name);
+	if (d) {
+		return d;
+	}
+
+	if (shard.count > shard.mask) {
+		_grow(shard);
+	}
+
+	d = memnew(_Data);
+	if (p_cname) {
+		d->cname = p_cname;
+	} else {
+		d->name = p_name;
+	}
+	d->refcount.init();
+	d->hash = p_hash;
+	d->idx = p_hash & shard.mask;
+	d->next = shard.table[d->idx];
+	d->prev = NULL;
+	if (d->next) {
+		d->next->prev = d;
+	}
+	shard.table[d->idx] = d;
+	shard.count++;
+
+	return d;
+}
+
+template <class T>
+StringName StringName::_search(const T &p_name, uint32_t p_hash) {
+
+	_Shard &shard = _get_shard(p_hash);
+	MutexLock lock(shard.lock);
+
+	_Data *d = _find(shard, p_hash, p_name);
+	if (d) {
+		return StringName(d);
+	}
+
+	return StringName(); //does not exist
 }
 
 void StringName::unref() {
@@ -98,22 +210,25 @@ void StringName::unref() {
 
 	if (_data && _data->refcount.unref()) {
 
-		lock->lock();
+		_Shard &shard = _get_shard(_data->hash);
+		shard.lock->lock();
 
 		if (_data->prev) {
 			_data->prev->next = _data->next;
 		} else {
-			if (_table[_data->idx] != _data) {
+			if (shard.table[_data->idx] != _data) {
 				ERR_PRINT("BUG!");
 			}
-			_table[_data->idx] = _data->next;
+			shard.table[_data->idx] = _data->next;
 		}
 
 		if (_data->next) {
 			_data->next->prev = _data->prev;
 		}
+		shard.count--;
+		shard.lock->unlock();
+
 		memdelete(_data);
-		lock->unlock();
 	}
 
 	_data = NULL;
@@ -184,43 +299,7 @@ StringName::StringName(const char *p_name) {
 	if (!p_name || p_name[0] == 0)
 		return; //empty, ignore
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(p_name, String::hash(p_name), NULL);
 }
 
 StringName::StringName(const StaticCString &p_static_string) {
@@ -231,43 +310,7 @@ StringName::StringName(const StaticCString &p_static_string) {
 
 	ERR_FAIL_COND(!p_static_string.ptr || !p_static_string.ptr[0]);
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_static_string.ptr);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_static_string.ptr)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = p_static_string.ptr;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(p_static_string.ptr, String::hash(p_static_string.ptr), p_static_string.ptr);
 }
 
 StringName::StringName(const String &p_name) {
@@ -279,42 +322,7 @@ StringName::StringName(const String &p_name) {
 	if (p_name == String())
 		return;
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_data = _table[idx];
-
-	while (_data) {
-
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data) {
-		if (_data->refcount.ref()) {
-			// exists
-			lock->unlock();
-			return;
-		}
-	}
-
-	_data = memnew(_Data);
-	_data->name = p_name;
-	_data->refcount.init();
-	_data->hash = hash;
-	_data->idx = idx;
-	_data->cname = NULL;
-	_data->next = _table[idx];
-	_data->prev = NULL;
-	if (_table[idx])
-		_table[idx]->prev = _data;
-	_table[idx] = _data;
-
-	lock->unlock();
+	_data = _intern(p_name, p_name.hash(), NULL);
 }
 
 StringName StringName::search(const char *p_name) {
@@ -325,30 +333,7 @@ StringName StringName::search(const char *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-
-		return StringName(_data);
-	}
-
-	lock->unlock();
-	return StringName(); //does not exist
+	return _search(p_name, String::hash(p_name));
 }
 
 StringName StringName::search(const CharType *p_name) {
@@ -359,57 +344,14 @@ StringName StringName::search(const CharType *p_name) {
 	if (!p_name[0])
 		return StringName();
 
-	lock->lock();
-
-	uint32_t hash = String::hash(p_name);
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && _data->get_name() == p_name)
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
-	}
-
-	lock->unlock();
-	return StringName(); //does not exist
+	return _search(p_name, String::hash(p_name));
 }
+
 StringName StringName::search(const String &p_name) {
 
 	ERR_FAIL_COND_V(p_name == "", StringName());
 
-	lock->lock();
-
-	uint32_t hash = p_name.hash();
-
-	uint32_t idx = hash & STRING_TABLE_MASK;
-
-	_Data *_data = _table[idx];
-
-	while (_data) {
-
-		// compare hash first
-		if (_data->hash == hash && p_name == _data->get_name())
-			break;
-		_data = _data->next;
-	}
-
-	if (_data && _data->refcount.ref()) {
-		lock->unlock();
-		return StringName(_data);
-	}
-
-	lock->unlock();
-	return StringName(); //does not exist
+	return _search(p_name, p_name.hash());
 }
 
 StringName::StringName() {
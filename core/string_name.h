@@ -45,9 +45,11 @@ class StringName {
 
 	enum {
 
-		STRING_TABLE_BITS = 12,
-		STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-		STRING_TABLE_MASK = STRING_TABLE_LEN - 1
+		// The table is split in shards, picked from the hash, each with its
+		// own lock and a bucket array that grows as names are added.
+		STRING_TABLE_SHARD_BITS = 6,
+		STRING_TABLE_SHARDS = 1 << STRING_TABLE_SHARD_BITS,
+		STRING_TABLE_SHARD_MIN_LEN = 64
 	};
 
 	struct _Data {
@@ -68,7 +70,27 @@ class StringName {
 		}
 	};
 
-	static _Data *_table[STRING_TABLE_LEN];
+	struct _Shard {
+		Mutex *lock;
+		_Data **table;
+		uint32_t mask;
+		uint32_t count;
+	};
+
+	static _Shard _shards[STRING_TABLE_SHARDS];
+
+	static _FORCE_INLINE_ _Shard &_get_shard(uint32_t p_hash) {
+		// The high bits of String::hash() are poorly distributed for short
+		// names, so mix them (Fibonacci hashing) before picking the shard.
+		return _shards[(p_hash * 2654435761U) >> (32 - STRING_TABLE_SHARD_BITS)];
+	}
+	static void _grow(_Shard &p_shard);
+	template <class T>
+	static _Data *_find(const _Shard &p_shard, uint32_t p_hash, const T &p_name);
+	template <class T>
+	static _Data *_intern(const T &p_name, uint32_t p_hash, const char *p_cname);
+	template <class T>
+	static StringName _search(const T &p_name, uint32_t p_hash);
 
 	_Data *_data;
 
@@ -82,7 +104,6 @@ class StringName {
 	friend void register_core_types();
 	friend void unregister_core_types();
 
-	static Mutex *lock;
 	static void setup();
 	static void cleanup();
 	static bool configured;
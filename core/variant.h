@@ -120,6 +120,7 @@ public:
 
 private:
 	friend struct _VariantCall;
+	friend class VariantInternal;
 	// Variant takes 20 bytes when real_t is float, and 36 if double
 	// it only allocates extra memory for aabb/matrix.
 
@@ -375,6 +376,12 @@ public:
 	static Vector<StringName> get_method_argument_names(Variant::Type p_type, const StringName &p_method);
 	static bool is_method_const(Variant::Type p_type, const StringName &p_method);
 
+	// A builtin type method resolved once, so callers repeating the same call skip the lookup by name.
+	struct BuiltInMethod;
+	static const BuiltInMethod *get_builtin_method(Variant::Type p_type, const StringName &p_method);
+	// Only valid when this variant has the type the method was resolved for.
+	void call_builtin_method(const BuiltInMethod *p_method, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error);
+
 	void set_named(const StringName &p_index, const Variant &p_value, bool *r_valid = NULL);
 	Variant get_named(const StringName &p_index, bool *r_valid = NULL) const;
 
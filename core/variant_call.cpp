@@ -34,6 +34,7 @@
 #include "core/core_string_names.h"
 #include "core/crypto/crypto_core.h"
 #include "core/io/compression.h"
+#include "core/math/bulk_math.h"
 #include "core/object.h"
 #include "core/os/os.h"
 #include "core/script_language.h"
@@ -717,6 +718,230 @@ struct _VariantCall {
 	VCALL_LOCALMEM1(PoolColorArray, append_array);
 	VCALL_LOCALMEM0(PoolColorArray, invert);
 
+	// Math over whole pool arrays (see BulkMath). Operands may be a number,
+	// an element or an array of the same type and size; results are written
+	// in place.
+	template <class T, class E, int W, Variant::Type ELEMENT_TYPE, Variant::Type ARRAY_TYPE, class S>
+	struct PoolBulk {
+
+		struct Value {
+			T value[4];
+			PoolVector<E> array;
+			typename PoolVector<E>::Read read;
+			bool is_array;
+			bool valid;
+
+			BulkMath::Operand<T> operand() const {
+				return is_array ? BulkMath::Operand<T>((const T *)read.ptr(), true) : BulkMath::Operand<T>(value, false);
+			}
+
+			Value(const Variant &p_value, int p_size) {
+				is_array = false;
+				valid = false;
+
+				if (p_value.type == Variant::INT || p_value.type == Variant::REAL) {
+					T v = p_value;
+					for (int i = 0; i < W; i++) {
+						value[i] = v;
+					}
+				} else if (p_value.type == ELEMENT_TYPE) {
+					const E e = p_value;
+					const T *components = (const T *)&e;
+					for (int i = 0; i < W; i++) {
+						value[i] = components[i];
+					}
+				} else if (p_value.type == ARRAY_TYPE) {
+					array = p_value;
+					ERR_FAIL_COND_MSG(array.size() != p_size, "Array sizes don't match.");
+					read = array.read();
+					is_array = true;
+				} else {
+					ERR_FAIL_MSG("Expected a number, an element or an array of the same type, got " + Variant::get_type_name(p_value.type) + ".");
+				}
+				valid = true;
+			}
+		};
+
+		template <class V>
+		static Variant make_element(const V *p_components) {
+			if (W == 1) {
+				return Variant(p_components[0]);
+			}
+			E e;
+			T *components = (T *)&e;
+			for (int i = 0; i < W; i++) {
+				components[i] = p_components[i];
+			}
+			return e;
+		}
+
+		static void add(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			PoolVector<E> *self = reinterpret_cast<PoolVector<E> *>(p_self._data._mem);
+			Value value(*p_args[0], self->size());
+			if (value.valid) {
+				typename PoolVector<E>::Write w = self->write();
+				BulkMath::add((T *)w.ptr(), self->size(), W, value.operand());
+			}
+		}
+
+		static void multiply(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			PoolVector<E> *self = reinterpret_cast<PoolVector<E> *>(p_self._data._mem);
+			Value value(*p_args[0], self->size());
+			if (value.valid) {
+				typename PoolVector<E>::Write w = self->write();
+				BulkMath::multiply((T *)w.ptr(), self->size(), W, value.operand());
+			}
+		}
+
+		static void multiply_add(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			PoolVector<E> *self = reinterpret_cast<PoolVector<E> *>(p_self._data._mem);
+			Value multiplier(*p_args[0], self->size());
+			Value addend(*p_args[1], self->size());
+			if (multiplier.valid && addend.valid) {
+				typename PoolVector<E>::Write w = self->write();
+				BulkMath::multiply_add((T *)w.ptr(), self->size(), W, multiplier.operand(), addend.operand());
+			}
+		}
+
+		static void clamp(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			PoolVector<E> *self = reinterpret_cast<PoolVector<E> *>(p_self._data._mem);
+			Value min(*p_args[0], self->size());
+			Value max(*p_args[1], self->size());
+			if (min.valid && max.valid) {
+				typename PoolVector<E>::Write w = self->write();
+				BulkMath::clamp((T *)w.ptr(), self->size(), W, min.operand(), max.operand());
+			}
+		}
+
+		static void lerp(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			PoolVector<E> *self = reinterpret_cast<PoolVector<E> *>(p_self._data._mem);
+			Value to(*p_args[0], self->size());
+			if (to.valid) {
+				typename PoolVector<E>::Write w = self->write();
+				BulkMath::lerp((T *)w.ptr(), self->size(), W, to.operand(), T(*p_args[1]));
+			}
+		}
+
+		static void sum(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			const PoolVector<E> *self = reinterpret_cast<const PoolVector<E> *>(p_self._data._mem);
+			typename PoolVector<E>::Read r = self->read();
+			S result[4];
+			BulkMath::sum((const T *)r.ptr(), self->size(), W, result);
+			r_ret = make_element(result);
+		}
+
+		static void min(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			const PoolVector<E> *self = reinterpret_cast<const PoolVector<E> *>(p_self._data._mem);
+			if (self->size() == 0) {
+				r_ret = Variant();
+				return;
+			}
+			typename PoolVector<E>::Read r = self->read();
+			T result[4];
+			BulkMath::min((const T *)r.ptr(), self->size(), W, result);
+			r_ret = make_element(result);
+		}
+
+		static void max(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			const PoolVector<E> *self = reinterpret_cast<const PoolVector<E> *>(p_self._data._mem);
+			if (self->size() == 0) {
+				r_ret = Variant();
+				return;
+			}
+			typename PoolVector<E>::Read r = self->read();
+			T result[4];
+			BulkMath::max((const T *)r.ptr(), self->size(), W, result);
+			r_ret = make_element(result);
+		}
+
+		static void sort(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			PoolVector<E> *self = reinterpret_cast<PoolVector<E> *>(p_self._data._mem);
+			typename PoolVector<E>::Write w = self->write();
+			BulkMath::sort((T *)w.ptr(), self->size());
+		}
+
+		static void argsort(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+			const PoolVector<E> *self = reinterpret_cast<const PoolVector<E> *>(p_self._data._mem);
+			PoolVector<int> indices;
+			indices.resize(self->size());
+			{
+				typename PoolVector<E>::Read r = self->read();
+				PoolVector<int>::Write w = indices.write();
+				BulkMath::argsort((const T *)r.ptr(), self->size(), w.ptr());
+			}
+			r_ret = indices;
+		}
+	};
+
+	typedef PoolBulk<int, int, 1, Variant::INT, Variant::POOL_INT_ARRAY, int64_t> PoolIntArrayBulk;
+	typedef PoolBulk<real_t, real_t, 1, Variant::REAL, Variant::POOL_REAL_ARRAY, real_t> PoolRealArrayBulk;
+	typedef PoolBulk<real_t, Vector2, 2, Variant::VECTOR2, Variant::POOL_VECTOR2_ARRAY, real_t> PoolVector2ArrayBulk;
+	typedef PoolBulk<real_t, Vector3, 3, Variant::VECTOR3, Variant::POOL_VECTOR3_ARRAY, real_t> PoolVector3ArrayBulk;
+	typedef PoolBulk<float, Color, 4, Variant::COLOR, Variant::POOL_COLOR_ARRAY, float> PoolColorArrayBulk;
+
+#define VCALL_POOL_BULK(m_type, m_method) \
+	static void _call_##m_type##_##m_method(Variant &r_ret, Variant &p_self, const Variant **p_args) { m_type##Bulk::m_method(r_ret, p_self, p_args); }
+
+	VCALL_POOL_BULK(PoolIntArray, add);
+	VCALL_POOL_BULK(PoolIntArray, multiply);
+	VCALL_POOL_BULK(PoolIntArray, multiply_add);
+	VCALL_POOL_BULK(PoolIntArray, clamp);
+	VCALL_POOL_BULK(PoolIntArray, sum);
+	VCALL_POOL_BULK(PoolIntArray, min);
+	VCALL_POOL_BULK(PoolIntArray, max);
+	VCALL_POOL_BULK(PoolIntArray, sort);
+	VCALL_POOL_BULK(PoolIntArray, argsort);
+
+	VCALL_POOL_BULK(PoolRealArray, add);
+	VCALL_POOL_BULK(PoolRealArray, multiply);
+	VCALL_POOL_BULK(PoolRealArray, multiply_add);
+	VCALL_POOL_BULK(PoolRealArray, clamp);
+	VCALL_POOL_BULK(PoolRealArray, lerp);
+	VCALL_POOL_BULK(PoolRealArray, sum);
+	VCALL_POOL_BULK(PoolRealArray, min);
+	VCALL_POOL_BULK(PoolRealArray, max);
+	VCALL_POOL_BULK(PoolRealArray, sort);
+	VCALL_POOL_BULK(PoolRealArray, argsort);
+
+	VCALL_POOL_BULK(PoolVector2Array, add);
+	VCALL_POOL_BULK(PoolVector2Array, multiply);
+	VCALL_POOL_BULK(PoolVector2Array, multiply_add);
+	VCALL_POOL_BULK(PoolVector2Array, clamp);
+	VCALL_POOL_BULK(PoolVector2Array, lerp);
+	VCALL_POOL_BULK(PoolVector2Array, sum);
+	VCALL_POOL_BULK(PoolVector2Array, min);
+	VCALL_POOL_BULK(PoolVector2Array, max);
+
+	VCALL_POOL_BULK(PoolVector3Array, add);
+	VCALL_POOL_BULK(PoolVector3Array, multiply);
+	VCALL_POOL_BULK(PoolVector3Array, multiply_add);
+	VCALL_POOL_BULK(PoolVector3Array, clamp);
+	VCALL_POOL_BULK(PoolVector3Array, lerp);
+	VCALL_POOL_BULK(PoolVector3Array, sum);
+	VCALL_POOL_BULK(PoolVector3Array, min);
+	VCALL_POOL_BULK(PoolVector3Array, max);
+
+	VCALL_POOL_BULK(PoolColorArray, add);
+	VCALL_POOL_BULK(PoolColorArray, multiply);
+	VCALL_POOL_BULK(PoolColorArray, multiply_add);
+	VCALL_POOL_BULK(PoolColorArray, clamp);
+	VCALL_POOL_BULK(PoolColorArray, lerp);
+	VCALL_POOL_BULK(PoolColorArray, sum);
+	VCALL_POOL_BULK(PoolColorArray, min);
+	VCALL_POOL_BULK(PoolColorArray, max);
+
+	static void _call_PoolVector2Array_transform(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+		PoolVector2Array *self = reinterpret_cast<PoolVector2Array *>(p_self._data._mem);
+		PoolVector2Array::Write w = self->write();
+		BulkMath::transform(w.ptr(), w.ptr(), self->size(), p_args[0]->operator Transform2D());
+	}
+
+	static void _call_PoolVector3Array_transform(Variant &r_ret, Variant &p_self, const Variant **p_args) {
+		PoolVector3Array *self = reinterpret_cast<PoolVector3Array *>(p_self._data._mem);
+		PoolVector3Array::Write w = self->write();
+		BulkMath::transform(w.ptr(), w.ptr(), self->size(), p_args[0]->operator Transform());
+	}
+
 #define VCALL_PTR0(m_type, m_method) \
 	static void _call_##m_type##_##m_method(Variant &r_ret, Variant &p_self, const Variant **p_args) { reinterpret_cast<m_type *>(p_self._data._ptr)->m_method(); }
 #define VCALL_PTR0R(m_type, m_method) \
@@ -1132,6 +1357,34 @@ void Variant::call_ptr(const StringName &p_method, const Variant **p_args, int p
 		*r_ret = ret;
 }
 
+const Variant::BuiltInMethod *Variant::get_builtin_method(Variant::Type p_type, const StringName &p_method) {
+
+	ERR_FAIL_INDEX_V(p_type, VARIANT_MAX, NULL);
+	if (p_type == OBJECT) {
+		return NULL;
+	}
+
+	Map<StringName, _VariantCall::FuncData>::Element *E = _VariantCall::type_funcs[p_type].functions.find(p_method);
+	if (!E) {
+		return NULL;
+	}
+
+	return reinterpret_cast<const BuiltInMethod *>(&E->get());
+}
+
+void Variant::call_builtin_method(const BuiltInMethod *p_method, const Variant **p_args, int p_argcount, Variant *r_ret, CallError &r_error) {
+
+	_VariantCall::FuncData *funcdata = const_cast<_VariantCall::FuncData *>(reinterpret_cast<const _VariantCall::FuncData *>(p_method));
+
+	r_error.error = Variant::CallError::CALL_OK;
+
+	Variant ret;
+	funcdata->call(ret, *this, p_args, p_argcount, r_error);
+
+	if (r_error.error == Variant::CallError::CALL_OK && r_ret)
+		*r_ret = ret;
+}
+
 #define VCALL(m_type, m_method) _VariantCall::_call_##m_type##_##m_method
 
 Variant Variant::construct(const Variant::Type p_type, const Variant **p_args, int p_argcount, CallError &r_error, bool p_strict) {
@@ -1831,6 +2084,15 @@ void register_variant_methods() {
 	ADDFUNC2R(POOL_INT_ARRAY, INT, PoolIntArray, insert, INT, "idx", INT, "integer", varray());
 	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, resize, INT, "idx", varray());
 	ADDFUNC0(POOL_INT_ARRAY, NIL, PoolIntArray, invert, varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, add, NIL, "value", varray());
+	ADDFUNC1(POOL_INT_ARRAY, NIL, PoolIntArray, multiply, NIL, "value", varray());
+	ADDFUNC2(POOL_INT_ARRAY, NIL, PoolIntArray, multiply_add, NIL, "multiplier", NIL, "addend", varray());
+	ADDFUNC2(POOL_INT_ARRAY, NIL, PoolIntArray, clamp, NIL, "min", NIL, "max", varray());
+	ADDFUNC0R(POOL_INT_ARRAY, INT, PoolIntArray, sum, varray());
+	ADDFUNC0R(POOL_INT_ARRAY, NIL, PoolIntArray, min, varray());
+	ADDFUNC0R(POOL_INT_ARRAY, NIL, PoolIntArray, max, varray());
+	ADDFUNC0(POOL_INT_ARRAY, NIL, PoolIntArray, sort, varray());
+	ADDFUNC0R(POOL_INT_ARRAY, POOL_INT_ARRAY, PoolIntArray, argsort, varray());
 
 	ADDFUNC0R(POOL_REAL_ARRAY, INT, PoolRealArray, size, varray());
 	ADDFUNC0R(POOL_REAL_ARRAY, BOOL, PoolRealArray, empty, varray());
@@ -1842,6 +2104,16 @@ void register_variant_methods() {
 	ADDFUNC2R(POOL_REAL_ARRAY, INT, PoolRealArray, insert, INT, "idx", REAL, "value", varray());
 	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, resize, INT, "idx", varray());
 	ADDFUNC0(POOL_REAL_ARRAY, NIL, PoolRealArray, invert, varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, add, NIL, "value", varray());
+	ADDFUNC1(POOL_REAL_ARRAY, NIL, PoolRealArray, multiply, NIL, "value", varray());
+	ADDFUNC2(POOL_REAL_ARRAY, NIL, PoolRealArray, multiply_add, NIL, "multiplier", NIL, "addend", varray());
+	ADDFUNC2(POOL_REAL_ARRAY, NIL, PoolRealArray, clamp, NIL, "min", NIL, "max", varray());
+	ADDFUNC2(POOL_REAL_ARRAY, NIL, PoolRealArray, lerp, NIL, "to", REAL, "weight", varray());
+	ADDFUNC0R(POOL_REAL_ARRAY, REAL, PoolRealArray, sum, varray());
+	ADDFUNC0R(POOL_REAL_ARRAY, NIL, PoolRealArray, min, varray());
+	ADDFUNC0R(POOL_REAL_ARRAY, NIL, PoolRealArray, max, varray());
+	ADDFUNC0(POOL_REAL_ARRAY, NIL, PoolRealArray, sort, varray());
+	ADDFUNC0R(POOL_REAL_ARRAY, POOL_INT_ARRAY, PoolRealArray, argsort, varray());
 
 	ADDFUNC0R(POOL_STRING_ARRAY, INT, PoolStringArray, size, varray());
 	ADDFUNC0R(POOL_STRING_ARRAY, BOOL, PoolStringArray, empty, varray());
@@ -1865,6 +2137,15 @@ void register_variant_methods() {
 	ADDFUNC2R(POOL_VECTOR2_ARRAY, INT, PoolVector2Array, insert, INT, "idx", VECTOR2, "vector2", varray());
 	ADDFUNC1(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, resize, INT, "idx", varray());
 	ADDFUNC0(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, invert, varray());
+	ADDFUNC1(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, add, NIL, "value", varray());
+	ADDFUNC1(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, multiply, NIL, "value", varray());
+	ADDFUNC2(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, multiply_add, NIL, "multiplier", NIL, "addend", varray());
+	ADDFUNC2(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, clamp, NIL, "min", NIL, "max", varray());
+	ADDFUNC2(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, lerp, NIL, "to", REAL, "weight", varray());
+	ADDFUNC0R(POOL_VECTOR2_ARRAY, VECTOR2, PoolVector2Array, sum, varray());
+	ADDFUNC0R(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, min, varray());
+	ADDFUNC0R(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, max, varray());
+	ADDFUNC1(POOL_VECTOR2_ARRAY, NIL, PoolVector2Array, transform, TRANSFORM2D, "transform", varray());
 
 	ADDFUNC0R(POOL_VECTOR3_ARRAY, INT, PoolVector3Array, size, varray());
 	ADDFUNC0R(POOL_VECTOR3_ARRAY, BOOL, PoolVector3Array, empty, varray());
@@ -1876,6 +2157,15 @@ void register_variant_methods() {
 	ADDFUNC2R(POOL_VECTOR3_ARRAY, INT, PoolVector3Array, insert, INT, "idx", VECTOR3, "vector3", varray());
 	ADDFUNC1(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, resize, INT, "idx", varray());
 	ADDFUNC0(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, invert, varray());
+	ADDFUNC1(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, add, NIL, "value", varray());
+	ADDFUNC1(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, multiply, NIL, "value", varray());
+	ADDFUNC2(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, multiply_add, NIL, "multiplier", NIL, "addend", varray());
+	ADDFUNC2(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, clamp, NIL, "min", NIL, "max", varray());
+	ADDFUNC2(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, lerp, NIL, "to", REAL, "weight", varray());
+	ADDFUNC0R(POOL_VECTOR3_ARRAY, VECTOR3, PoolVector3Array, sum, varray());
+	ADDFUNC0R(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, min, varray());
+	ADDFUNC0R(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, max, varray());
+	ADDFUNC1(POOL_VECTOR3_ARRAY, NIL, PoolVector3Array, transform, TRANSFORM, "transform", varray());
 
 	ADDFUNC0R(POOL_COLOR_ARRAY, INT, PoolColorArray, size, varray());
 	ADDFUNC0R(POOL_COLOR_ARRAY, BOOL, PoolColorArray, empty, varray());
@@ -1887,6 +2177,14 @@ void register_variant_methods() {
 	ADDFUNC2R(POOL_COLOR_ARRAY, INT, PoolColorArray, insert, INT, "idx", COLOR, "color", varray());
 	ADDFUNC1(POOL_COLOR_ARRAY, NIL, PoolColorArray, resize, INT, "idx", varray());
 	ADDFUNC0(POOL_COLOR_ARRAY, NIL, PoolColorArray, invert, varray());
+	ADDFUNC1(POOL_COLOR_ARRAY, NIL, PoolColorArray, add, NIL, "value", varray());
+	ADDFUNC1(POOL_COLOR_ARRAY, NIL, PoolColorArray, multiply, NIL, "value", varray());
+	ADDFUNC2(POOL_COLOR_ARRAY, NIL, PoolColorArray, multiply_add, NIL, "multiplier", NIL, "addend", varray());
+	ADDFUNC2(POOL_COLOR_ARRAY, NIL, PoolColorArray, clamp, NIL, "min", NIL, "max", varray());
+	ADDFUNC2(POOL_COLOR_ARRAY, NIL, PoolColorArray, lerp, NIL, "to", REAL, "weight", varray());
+	ADDFUNC0R(POOL_COLOR_ARRAY, COLOR, PoolColorArray, sum, varray());
+	ADDFUNC0R(POOL_COLOR_ARRAY, NIL, PoolColorArray, min, varray());
+	ADDFUNC0R(POOL_COLOR_ARRAY, NIL, PoolColorArray, max, varray());
 
 	//pointerbased
 
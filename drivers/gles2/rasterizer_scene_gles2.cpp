@@ -1378,6 +1378,7 @@ bool RasterizerSceneGLES2::_setup_material(RasterizerStorageGLES2::Material *p_m
 	for (int i = 0; i < tc; i++) {
 
 		glActiveTexture(GL_TEXTURE0 + i);
+		storage->info.render.texture_bind_count++;
 
 		RasterizerStorageGLES2::Texture *t = storage->texture_owner.getornull(textures[i].second);
 
@@ -1440,6 +1441,7 @@ void RasterizerSceneGLES2::_setup_geometry(RenderList::Element *p_element, Raste
 			RasterizerStorageGLES2::Surface *s = static_cast<RasterizerStorageGLES2::Surface *>(p_element->geometry);
 
 			glBindBuffer(GL_ARRAY_BUFFER, s->vertex_id);
+			storage->info.render.vertex_array_bind_count++;
 
 			if (s->index_array_len > 0) {
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s->index_id);
@@ -1473,6 +1475,7 @@ void RasterizerSceneGLES2::_setup_geometry(RenderList::Element *p_element, Raste
 					//use float texture workflow
 					glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 1);
 					glBindTexture(GL_TEXTURE_2D, p_skeleton->tex_id);
+					storage->info.render.texture_bind_count++;
 				} else {
 					//use transform buffer workflow
 					ERR_FAIL_COND(p_skeleton->use_2d);
@@ -1602,6 +1605,7 @@ void RasterizerSceneGLES2::_setup_geometry(RenderList::Element *p_element, Raste
 			RasterizerStorageGLES2::Surface *s = static_cast<RasterizerStorageGLES2::Surface *>(p_element->geometry);
 
 			glBindBuffer(GL_ARRAY_BUFFER, s->vertex_id);
+			storage->info.render.vertex_array_bind_count++;
 
 			if (s->index_array_len > 0) {
 				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s->index_id);
@@ -1751,6 +1755,7 @@ void RasterizerSceneGLES2::_render_geometry(RenderList::Element *p_element) {
 			bool restore_tex = false;
 
 			glBindBuffer(GL_ARRAY_BUFFER, state.immediate_buffer);
+			storage->info.render.vertex_array_bind_count++;
 
 			for (const List<RasterizerStorageGLES2::Immediate::Chunk>::Element *E = im->chunks.front(); E; E = E->next()) {
 				const RasterizerStorageGLES2::Immediate::Chunk &c = E->get();
@@ -2415,10 +2420,12 @@ void RasterizerSceneGLES2::_render_render_list(RenderList::Element **p_elements,
 				if (refprobe_1 != NULL && refprobe_1 != prev_refprobe_1) {
 					glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 5);
 					glBindTexture(GL_TEXTURE_CUBE_MAP, refprobe_1->cubemap);
+					storage->info.render.texture_bind_count++;
 				}
 				if (refprobe_2 != NULL && refprobe_2 != prev_refprobe_2) {
 					glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 6);
 					glBindTexture(GL_TEXTURE_CUBE_MAP, refprobe_2->cubemap);
+					storage->info.render.texture_bind_count++;
 				}
 				rebind = true;
 				rebind_reflection = true;
@@ -2449,6 +2456,7 @@ void RasterizerSceneGLES2::_render_render_list(RenderList::Element **p_elements,
 				if (lightmap != NULL) {
 					glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 4);
 					glBindTexture(GL_TEXTURE_2D, lightmap->tex_id);
+					storage->info.render.texture_bind_count++;
 				}
 				rebind = true;
 				rebind_lightmap = true;
@@ -34,6 +34,7 @@
 /* Must come before shaders or the Windows build fails... */
 #include "rasterizer_storage_gles2.h"
 
+#include "core/radix_sort.h"
 #include "shaders/cube_to_dp.glsl.gen.h"
 #include "shaders/effect_blur.glsl.gen.h"
 #include "shaders/scene.glsl.gen.h"
@@ -563,7 +564,8 @@ public:
 		enum {
 			MAX_LIGHTS = 255,
 			MAX_REFLECTION_PROBES = 255,
-			DEFAULT_MAX_ELEMENTS = 65536
+			DEFAULT_MAX_ELEMENTS = 65536,
+			RADIX_SORT_THRESHOLD = 2048
 		};
 
 		int max_elements;
@@ -612,6 +614,7 @@ public:
 
 		Element *base_elements;
 		Element **elements;
+		Element **sort_buffer; // scratch space for the radix sort
 
 		int element_count;
 		int alpha_element_count;
@@ -633,13 +636,31 @@ public:
 			}
 		};
 
-		void sort_by_key(bool p_alpha) {
-			SortArray<Element *, SortByKey> sorter;
+		struct SortKey {
+			_FORCE_INLINE_ uint64_t operator()(const Element *A) const {
+				return A->sort_key;
+			}
+		};
 
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
+		struct DepthKey {
+			_FORCE_INLINE_ uint64_t operator()(const Element *A) const {
+				return A->depth_key;
+			}
+		};
+
+		void sort_by_key(bool p_alpha) {
+			Element **base = p_alpha ? &elements[max_elements - alpha_element_count] : elements;
+			int count = p_alpha ? alpha_element_count : element_count;
+
+			if (count >= RADIX_SORT_THRESHOLD) {
+				// the radix sort is stable, so sorting by the least significant key first gives the same order as SortByKey
+				RadixSort<Element *, SortKey> key_sorter;
+				key_sorter.sort(base, count, sort_buffer);
+				RadixSort<Element *, DepthKey> depth_sorter;
+				depth_sorter.sort(base, count, sort_buffer);
 			} else {
-				sorter.sort(elements, element_count);
+				SortArray<Element *, SortByKey> sorter;
+				sorter.sort(base, count);
 			}
 		}
 
@@ -708,6 +729,7 @@ public:
 
 			elements = memnew_arr(Element *, max_elements);
 			base_elements = memnew_arr(Element, max_elements);
+			sort_buffer = memnew_arr(Element *, max_elements);
 
 			for (int i = 0; i < max_elements; i++) {
 				elements[i] = &base_elements[i];
@@ -721,6 +743,7 @@ public:
 		~RenderList() {
 			memdelete_arr(elements);
 			memdelete_arr(base_elements);
+			memdelete_arr(sort_buffer);
 		}
 	};
 
@@ -5722,6 +5722,9 @@ void RasterizerStorageGLES2::render_info_end_capture() {
 	info.snap.surface_switch_count = info.render.surface_switch_count - info.snap.surface_switch_count;
 	info.snap.shader_rebind_count = info.render.shader_rebind_count - info.snap.shader_rebind_count;
 	info.snap.vertices_count = info.render.vertices_count - info.snap.vertices_count;
+	info.snap.vertex_array_bind_count = info.render.vertex_array_bind_count - info.snap.vertex_array_bind_count;
+	info.snap.texture_bind_count = info.render.texture_bind_count - info.snap.texture_bind_count;
+	info.snap.instancing_merge_count = info.render.instancing_merge_count - info.snap.instancing_merge_count;
 }
 
 int RasterizerStorageGLES2::get_captured_render_info(VS::RenderInfo p_info) {
@@ -5765,6 +5768,12 @@ int RasterizerStorageGLES2::get_render_info(VS::RenderInfo p_info) {
 			return info.render_final.surface_switch_count;
 		case VS::INFO_DRAW_CALLS_IN_FRAME:
 			return info.render_final.draw_call_count;
+		case VS::INFO_VERTEX_ARRAY_CHANGES_IN_FRAME:
+			return info.render_final.vertex_array_bind_count;
+		case VS::INFO_TEXTURE_CHANGES_IN_FRAME:
+			return info.render_final.texture_bind_count;
+		case VS::INFO_INSTANCING_MERGES_IN_FRAME:
+			return info.render_final.instancing_merge_count;
 		case VS::INFO_USAGE_VIDEO_MEM_TOTAL:
 			return 0; //no idea
 		case VS::INFO_VIDEO_MEM_USED:
@@ -149,6 +149,9 @@ public:
 			uint32_t surface_switch_count;
 			uint32_t shader_rebind_count;
 			uint32_t vertices_count;
+			uint32_t vertex_array_bind_count;
+			uint32_t texture_bind_count;
+			uint32_t instancing_merge_count;
 
 			void reset() {
 				object_count = 0;
@@ -157,6 +160,9 @@ public:
 				surface_switch_count = 0;
 				shader_rebind_count = 0;
 				vertices_count = 0;
+				vertex_array_bind_count = 0;
+				texture_bind_count = 0;
+				instancing_merge_count = 0;
 			}
 		} render, render_final, snap;
 
@@ -1300,6 +1300,7 @@ bool RasterizerSceneGLES3::_setup_material(RasterizerStorageGLES3::Material *p_m
 		}
 
 		glBindTexture(target, tex);
+		storage->info.render.texture_bind_count++;
 
 		if (t && storage->config.srgb_decode_supported) {
 			//if SRGB decode extension is present, simply switch the texture to whathever is needed
@@ -1373,6 +1374,8 @@ void RasterizerSceneGLES3::_setup_geometry(RenderList::Element *e, const Transfo
 				glBindVertexArray(s->array_id); // everything is so easy nowadays
 			}
 
+			storage->info.render.vertex_array_bind_count++;
+
 		} break;
 
 		case VS::INSTANCE_MULTIMESH: {
@@ -1389,6 +1392,8 @@ void RasterizerSceneGLES3::_setup_geometry(RenderList::Element *e, const Transfo
 				glBindVertexArray(s->instancing_array_id); // use the instancing array ID
 			}
 
+			storage->info.render.vertex_array_bind_count++;
+
 			glBindBuffer(GL_ARRAY_BUFFER, multi_mesh->buffer); //modify the buffer
 
 			int stride = (multi_mesh->xform_floats + multi_mesh->color_floats + multi_mesh->custom_data_floats) * 4;
@@ -1518,6 +1523,8 @@ void RasterizerSceneGLES3::_setup_geometry(RenderList::Element *e, const Transfo
 				glBindBuffer(GL_ARRAY_BUFFER, particles->particle_buffers[0]); //modify the buffer
 			}
 
+			storage->info.render.vertex_array_bind_count++;
+
 			int stride = sizeof(float) * 4 * 6;
 
 			//transform
@@ -1597,6 +1604,10 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 			if (amount == -1) {
 				amount = multi_mesh->size;
 			}
+
+			if (amount > 1) {
+				storage->info.render.instancing_merge_count += amount - 1;
+			}
 #ifdef DEBUG_ENABLED
 
 			if (state.debug_draw == VS::VIEWPORT_DEBUG_DRAW_WIREFRAME && s->array_wireframe_id) {
@@ -1630,6 +1641,7 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 
 			glBindBuffer(GL_ARRAY_BUFFER, state.immediate_buffer);
 			glBindVertexArray(state.immediate_array);
+			storage->info.render.vertex_array_bind_count++;
 
 			for (const List<RasterizerStorageGLES3::Immediate::Chunk>::Element *E = im->chunks.front(); E; E = E->next()) {
 
@@ -1764,6 +1776,8 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 				int split = int(Math::ceil(particles->phase * particles->amount));
 
 				if (amount - split > 0) {
+					storage->info.render.instancing_merge_count += amount - split - 1;
+
 					glEnableVertexAttribArray(8); //xform x
 					glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, stride, CAST_INT_TO_UCHAR_PTR(stride * split + sizeof(float) * 4 * 3));
 					glVertexAttribDivisor(8, 1);
@@ -1802,6 +1816,8 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 				}
 
 				if (split > 0) {
+					storage->info.render.instancing_merge_count += split - 1;
+
 					glEnableVertexAttribArray(8); //xform x
 					glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, stride, CAST_INT_TO_UCHAR_PTR(sizeof(float) * 4 * 3));
 					glVertexAttribDivisor(8, 1);
@@ -1841,6 +1857,10 @@ void RasterizerSceneGLES3::_render_geometry(RenderList::Element *e) {
 
 			} else {
 
+				if (amount > 1) {
+					storage->info.render.instancing_merge_count += amount - 1;
+				}
+
 #ifdef DEBUG_ENABLED
 
 				if (state.debug_draw == VS::VIEWPORT_DEBUG_DRAW_WIREFRAME && s->array_wireframe_id) {
@@ -1947,6 +1967,7 @@ void RasterizerSceneGLES3::_setup_light(RenderList::Element *e, const Transform
 		float bias_scale = e->instance->baked_light ? 1 : 0;
 		glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 9);
 		glBindTexture(GL_TEXTURE_3D, gipi->tex_cache);
+		storage->info.render.texture_bind_count++;
 		state.scene_shader.set_uniform(SceneShaderGLES3::GI_PROBE_XFORM1, gipi->transform_to_data * p_view_transform);
 		state.scene_shader.set_uniform(SceneShaderGLES3::GI_PROBE_BOUNDS1, gipi->bounds);
 		state.scene_shader.set_uniform(SceneShaderGLES3::GI_PROBE_MULTIPLIER1, gipi->probe ? gipi->probe->dynamic_range * gipi->probe->energy : 0.0);
@@ -1960,6 +1981,7 @@ void RasterizerSceneGLES3::_setup_light(RenderList::Element *e, const Transform
 
 			glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 10);
 			glBindTexture(GL_TEXTURE_3D, gipi2->tex_cache);
+			storage->info.render.texture_bind_count++;
 			state.scene_shader.set_uniform(SceneShaderGLES3::GI_PROBE_XFORM2, gipi2->transform_to_data * p_view_transform);
 			state.scene_shader.set_uniform(SceneShaderGLES3::GI_PROBE_BOUNDS2, gipi2->bounds);
 			state.scene_shader.set_uniform(SceneShaderGLES3::GI_PROBE_CELL_SIZE2, gipi2->cell_size_cache);
@@ -1984,6 +2006,7 @@ void RasterizerSceneGLES3::_setup_light(RenderList::Element *e, const Transform
 		if (lightmap && capture) {
 			glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 9);
 			glBindTexture(GL_TEXTURE_2D, lightmap->tex_id);
+			storage->info.render.texture_bind_count++;
 			state.scene_shader.set_uniform(SceneShaderGLES3::LIGHTMAP_ENERGY, capture->energy);
 		}
 	}
@@ -2235,6 +2258,7 @@ void RasterizerSceneGLES3::_render_list(RenderList::Element **p_elements, int p_
 			if (skeleton) {
 				glActiveTexture(GL_TEXTURE0 + storage->config.max_texture_image_units - 1);
 				glBindTexture(GL_TEXTURE_2D, skeleton->texture);
+				storage->info.render.texture_bind_count++;
 			}
 		}
 
@@ -34,6 +34,7 @@
 /* Must come before shaders or the Windows build fails... */
 #include "rasterizer_storage_gles3.h"
 
+#include "core/radix_sort.h"
 #include "drivers/gles3/shaders/cube_to_dp.glsl.gen.h"
 #include "drivers/gles3/shaders/effect_blur.glsl.gen.h"
 #include "drivers/gles3/shaders/exposure.glsl.gen.h"
@@ -671,6 +672,7 @@ public:
 			MAX_DIRECTIONAL_LIGHTS = 16,
 			DEFAULT_MAX_LIGHTS = 4096,
 			DEFAULT_MAX_REFLECTIONS = 1024,
+			RADIX_SORT_THRESHOLD = 2048,
 
 			SORT_KEY_PRIORITY_SHIFT = 56,
 			SORT_KEY_PRIORITY_MASK = 0xFF,
@@ -719,14 +721,14 @@ public:
 		int element_count;
 		int alpha_element_count;
 
+		Element **sort_buffer; // scratch space for the radix sort
+
 		void clear() {
 
 			element_count = 0;
 			alpha_element_count = 0;
 		}
 
-		//should eventually be replaced by radix
-
 		struct SortByKey {
 
 			_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const {
@@ -734,13 +736,24 @@ public:
 			}
 		};
 
+		struct SortKey {
+
+			_FORCE_INLINE_ uint64_t operator()(const Element *A) const {
+				return A->sort_key;
+			}
+		};
+
 		void sort_by_key(bool p_alpha) {
 
-			SortArray<Element *, SortByKey> sorter;
-			if (p_alpha) {
-				sorter.sort(&elements[max_elements - alpha_element_count], alpha_element_count);
+			Element **base = p_alpha ? &elements[max_elements - alpha_element_count] : elements;
+			int count = p_alpha ? alpha_element_count : element_count;
+
+			if (count >= RADIX_SORT_THRESHOLD) {
+				RadixSort<Element *, SortKey> sorter;
+				sorter.sort(base, count, sort_buffer);
 			} else {
-				sorter.sort(elements, element_count);
+				SortArray<Element *, SortByKey> sorter;
+				sorter.sort(base, count);
 			}
 		}
 
@@ -808,6 +821,7 @@ public:
 			alpha_element_count = 0;
 			elements = memnew_arr(Element *, max_elements);
 			base_elements = memnew_arr(Element, max_elements);
+			sort_buffer = memnew_arr(Element *, max_elements);
 			for (int i = 0; i < max_elements; i++)
 				elements[i] = &base_elements[i]; // assign elements
 		}
@@ -822,6 +836,7 @@ public:
 		~RenderList() {
 			memdelete_arr(elements);
 			memdelete_arr(base_elements);
+			memdelete_arr(sort_buffer);
 		}
 	};
 
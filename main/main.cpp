@@ -41,6 +41,7 @@
 #include "core/message_queue.h"
 #include "core/os/dir_access.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 #include "core/project_settings.h"
 #include "core/register_core_types.h"
 #include "core/script_debugger_local.h"
@@ -95,6 +96,7 @@ static ZipArchive *zip_packed_data = NULL;
 static FileAccessNetworkClient *file_access_network_client = NULL;
 static ScriptDebugger *script_debugger = NULL;
 static MessageQueue *message_queue = NULL;
+static WorkerThreadPool *worker_thread_pool = NULL;
 
 // Initialized in setup2()
 static AudioServer *audio_server = NULL;
@@ -279,6 +281,10 @@ void Main::print_help(const char *p_binary) {
 	OS::get_singleton()->print("  --disable-crash-handler          Disable crash handler when supported by the platform code.\n");
 	OS::get_singleton()->print("  --fixed-fps <fps>                Force a fixed number of frames per second. This setting disables real-time synchronization.\n");
 	OS::get_singleton()->print("  --print-fps                      Print the frames per second to the stdout.\n");
+#ifdef DEBUG_ENABLED
+	OS::get_singleton()->print("  --gdscript-sample-profile <file> Sample GDScript call stacks and write them on exit, as collapsed stacks or as a Chrome trace if <file> ends with .json.\n");
+	OS::get_singleton()->print("  --gdscript-sample-rate <hz>      Sampling rate for --gdscript-sample-profile (default 1000).\n");
+#endif
 	OS::get_singleton()->print("\n");
 
 	OS::get_singleton()->print("Standalone tools:\n");
@@ -1130,6 +1136,11 @@ Error Main::setup(const char *execpath, int argc, char *argv[], bool p_second_ph
 
 	message_queue = memnew(MessageQueue);
 
+	GLOBAL_DEF("threading/worker_pool/max_threads", -1);
+	ProjectSettings::get_singleton()->set_custom_property_info("threading/worker_pool/max_threads", PropertyInfo(Variant::INT, "threading/worker_pool/max_threads", PROPERTY_HINT_RANGE, "-1,128,1,or_greater"));
+	worker_thread_pool = memnew(WorkerThreadPool);
+	worker_thread_pool->init(GLOBAL_GET("threading/worker_pool/max_threads"));
+
 	if (p_second_phase)
 		return setup2();
 
@@ -1425,6 +1436,8 @@ bool Main::start() {
 				script = args[i + 1];
 			} else if (args[i] == "--test") {
 				test = args[i + 1];
+			} else if (args[i] == "--gdscript-sample-profile" || args[i] == "--gdscript-sample-rate") {
+				// Handled by the GDScript module.
 #ifdef TOOLS_ENABLED
 			} else if (args[i] == "--doctool") {
 				doc_tool = args[i + 1];
@@ -2174,6 +2187,10 @@ void Main::cleanup() {
 	OS::get_singleton()->finalize();
 	finalize_physics();
 
+	if (worker_thread_pool) {
+		memdelete(worker_thread_pool);
+	}
+
 	if (packed_data)
 		memdelete(packed_data);
 	if (file_access_network_client)
@@ -74,6 +74,9 @@ void Performance::_bind_methods() {
 	BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
 	BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
 	BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+	BIND_ENUM_CONSTANT(RENDER_VERTEX_ARRAY_CHANGES_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_TEXTURE_CHANGES_IN_FRAME);
+	BIND_ENUM_CONSTANT(RENDER_INSTANCING_MERGES_IN_FRAME);
 
 	BIND_ENUM_CONSTANT(MONITOR_MAX);
 }
@@ -120,6 +123,9 @@ String Performance::get_monitor_name(Monitor p_monitor) const {
 		"physics_3d/collision_pairs",
 		"physics_3d/islands",
 		"audio/output_latency",
+		"raster/vertex_array_changes",
+		"raster/texture_changes",
+		"raster/instancing_merges",
 
 	};
 
@@ -158,6 +164,9 @@ float Performance::get_monitor(Monitor p_monitor) const {
 		case PHYSICS_3D_COLLISION_PAIRS: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_COLLISION_PAIRS);
 		case PHYSICS_3D_ISLAND_COUNT: return PhysicsServer::get_singleton()->get_process_info(PhysicsServer::INFO_ISLAND_COUNT);
 		case AUDIO_OUTPUT_LATENCY: return AudioServer::get_singleton()->get_output_latency();
+		case RENDER_VERTEX_ARRAY_CHANGES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_VERTEX_ARRAY_CHANGES_IN_FRAME);
+		case RENDER_TEXTURE_CHANGES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_TEXTURE_CHANGES_IN_FRAME);
+		case RENDER_INSTANCING_MERGES_IN_FRAME: return VS::get_singleton()->get_render_info(VS::INFO_INSTANCING_MERGES_IN_FRAME);
 
 		default: {
 		}
@@ -200,6 +209,9 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_QUANTITY,
 		MONITOR_TYPE_TIME,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
+		MONITOR_TYPE_QUANTITY,
 
 	};
 
@@ -81,6 +81,9 @@ public:
 		PHYSICS_3D_ISLAND_COUNT,
 		//physics
 		AUDIO_OUTPUT_LATENCY,
+		RENDER_VERTEX_ARRAY_CHANGES_IN_FRAME,
+		RENDER_TEXTURE_CHANGES_IN_FRAME,
+		RENDER_INSTANCING_MERGES_IN_FRAME,
 		MONITOR_MAX
 	};
 
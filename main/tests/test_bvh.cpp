@@ -0,0 +1,425 @@
+/*************************************************************************/
+/*  test_bvh.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_bvh.h"
+
+#include "core/math/bvh.h"
+#include "core/math/bvh_tree.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/octree.h"
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/sort_array.h"
+
+namespace TestBVH {
+
+enum {
+	GEOMETRY_TYPE = 1 << 0,
+	LIGHT_TYPE = 1 << 1,
+	MOVE_FRAMES = 10,
+	CULL_VIEWS = 20,
+	MAX_CULL = 65536
+};
+
+struct Item {
+	int index;
+};
+
+struct ItemSort {
+	_FORCE_INLINE_ bool operator()(const Item *p_a, const Item *p_b) const { return p_a->index < p_b->index; }
+};
+
+struct Scene {
+	Vector<Item> items;
+	Vector<AABB> aabbs;
+	Vector<bool> lights;
+	Vector<Vector<Plane> > views;
+	int moving;
+};
+
+struct Result {
+	uint64_t create_usec;
+	uint64_t first_move_usec; // moves instances out of the static tree of the BVH
+	uint64_t move_usec;
+	uint64_t cull_usec;
+	int pairs;
+	Vector<int> culled; // sorted item indices per view, each view starting with -1
+	bool split_culls_match;
+};
+
+// Boxes spread over a volume that grows with the instance count, with one
+// light in a hundred. A tenth of the instances move every frame.
+static void _make_scene(Scene &r_scene, int p_count) {
+
+	RandomPCG rng(p_count);
+	real_t extent = Math::pow(real_t(p_count), real_t(1.0 / 3.0)) * 8.0;
+
+	r_scene.items.resize(p_count);
+	r_scene.aabbs.resize(p_count);
+	r_scene.lights.resize(p_count);
+	r_scene.moving = p_count / 10;
+
+	for (int i = 0; i < p_count; i++) {
+
+		bool light = (i % 100) == 99;
+		Vector3 position(rng.randf() * extent, rng.randf() * extent * 0.25, rng.randf() * extent);
+		real_t size = light ? 8.0 + rng.randf() * 8.0 : 0.5 + rng.randf() * 1.5;
+
+		r_scene.items.write[i].index = i;
+		r_scene.aabbs.write[i] = AABB(position - Vector3(size, size, size) * 0.5, Vector3(size, size, size));
+		r_scene.lights.write[i] = light;
+	}
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 16.0 / 9.0, 0.05, 100);
+
+	for (int i = 0; i < CULL_VIEWS; i++) {
+
+		Transform camera;
+		camera.origin = Vector3(rng.randf() * extent, extent * 0.125, rng.randf() * extent);
+		camera.basis.rotate(Vector3(0, 1, 0), rng.randf() * Math_PI * 2.0);
+		r_scene.views.push_back(projection.get_projection_planes(camera));
+	}
+}
+
+// Tests every instance, to check the results of the trees against.
+static void _brute_force(const Scene &p_scene, Result &r_result) {
+
+	int count = p_scene.items.size();
+
+	r_result.pairs = 0;
+	for (int i = 0; i < count; i++) {
+		if (!p_scene.lights[i]) {
+			continue;
+		}
+		for (int j = 0; j < count; j++) {
+			if (!p_scene.lights[j] && p_scene.aabbs[i].intersects_inclusive(p_scene.aabbs[j])) {
+				r_result.pairs++;
+			}
+		}
+	}
+
+	r_result.culled.clear();
+	for (int i = 0; i < p_scene.views.size(); i++) {
+		r_result.culled.push_back(-1);
+		for (int j = 0; j < count; j++) {
+			if (p_scene.aabbs[j].intersects_convex_shape(p_scene.views[i].ptr(), p_scene.views[i].size())) {
+				r_result.culled.push_back(j);
+			}
+		}
+	}
+}
+
+template <class S>
+static bool _check_split_culls(S &p_tree, const Scene &p_scene) {
+	return true;
+}
+
+// Culling the subtrees one by one, as _prepare_scene() does on the worker
+// pool, must find the same instances as a single cull.
+static bool _check_split_culls(BVH<Item, true> &p_bvh, const Scene &p_scene) {
+
+	LocalVector<BVH<Item, true>::Subtree> subtrees;
+	p_bvh.get_subtrees(subtrees, 32);
+
+	Item **whole = memnew_arr(Item *, MAX_CULL);
+	Item **split = memnew_arr(Item *, MAX_CULL);
+	bool match = true;
+
+	for (int i = 0; match && i < p_scene.views.size(); i++) {
+
+		int whole_count = p_bvh.cull_convex(p_scene.views[i], whole, MAX_CULL);
+		int split_count = 0;
+		for (uint32_t j = 0; j < subtrees.size(); j++) {
+			split_count += p_bvh.cull_convex(subtrees[j], p_scene.views[i].ptr(), p_scene.views[i].size(), split + split_count, MAX_CULL - split_count);
+		}
+
+		SortArray<Item *, ItemSort> sorter;
+		sorter.sort(whole, whole_count);
+		sorter.sort(split, split_count);
+		match = whole_count == split_count;
+		for (int j = 0; match && j < whole_count; j++) {
+			match = whole[j] == split[j];
+		}
+	}
+
+	memdelete_arr(whole);
+	memdelete_arr(split);
+	return match;
+}
+
+template <class S>
+static void _run(S &p_tree, Scene &p_scene, Result &r_result) {
+
+	int count = p_scene.items.size();
+	Vector<uint32_t> ids;
+	ids.resize(count);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < count; i++) {
+		bool light = p_scene.lights[i];
+		ids.write[i] = p_tree.create(&p_scene.items.write[i], p_scene.aabbs[i], 0, light, light ? LIGHT_TYPE : GEOMETRY_TYPE, light ? GEOMETRY_TYPE : 0);
+	}
+	r_result.create_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	// Same sequence of moves for every tree.
+	RandomPCG rng(count + 1);
+	r_result.move_usec = 0;
+	for (int f = 0; f <= MOVE_FRAMES; f++) {
+
+		from = OS::get_singleton()->get_ticks_usec();
+		for (int i = 0; i < p_scene.moving; i++) {
+			AABB &aabb = p_scene.aabbs.write[i];
+			aabb.position += Vector3(rng.randf() - 0.5, 0, rng.randf() - 0.5) * 0.5;
+			p_tree.move(ids[i], aabb);
+		}
+		uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+
+		if (f == 0) {
+			r_result.first_move_usec = usec;
+		} else {
+			r_result.move_usec += usec;
+		}
+	}
+	r_result.move_usec /= MOVE_FRAMES;
+	r_result.pairs = p_tree.get_pair_count();
+
+	Item **culled = memnew_arr(Item *, MAX_CULL);
+	r_result.culled.clear();
+
+	// What _prepare_scene() does with the camera frustum of every view.
+	uint64_t cull_usec = 0;
+	for (int i = 0; i < p_scene.views.size(); i++) {
+
+		from = OS::get_singleton()->get_ticks_usec();
+		int culled_count = p_tree.cull_convex(p_scene.views[i], culled, MAX_CULL);
+		cull_usec += OS::get_singleton()->get_ticks_usec() - from;
+
+		SortArray<Item *, ItemSort> sorter;
+		sorter.sort(culled, culled_count);
+		r_result.culled.push_back(-1);
+		for (int j = 0; j < culled_count; j++) {
+			r_result.culled.push_back(culled[j]->index);
+		}
+	}
+	r_result.cull_usec = cull_usec / p_scene.views.size();
+
+	memdelete_arr(culled);
+
+	r_result.split_culls_match = _check_split_culls(p_tree, p_scene);
+
+	for (int i = 0; i < count; i++) {
+		p_tree.erase(ids[i]);
+	}
+}
+
+static bool _bench(int p_count) {
+
+	// Moves change the scene, so each tree gets its own copy.
+	Scene octree_scene;
+	Scene bvh_scene;
+	_make_scene(octree_scene, p_count);
+	_make_scene(bvh_scene, p_count);
+
+	Result octree_result;
+	Result bvh_result;
+	{
+		Octree<Item, true> octree;
+		_run(octree, octree_scene, octree_result);
+	}
+	{
+		BVH<Item, true> bvh;
+		_run(bvh, bvh_scene, bvh_result);
+	}
+
+	Result expected;
+	_brute_force(bvh_scene, expected);
+
+	bool pass = expected.pairs == bvh_result.pairs && bvh_result.split_culls_match && expected.culled.size() == bvh_result.culled.size();
+	for (int i = 0; pass && i < bvh_result.culled.size(); i++) {
+		pass = expected.culled[i] == bvh_result.culled[i];
+	}
+
+	OS::get_singleton()->print("%d instances, %d moving, %d pairs\n", p_count, bvh_scene.moving, bvh_result.pairs);
+	OS::get_singleton()->print("\toctree: create %7d usec, first move %6d usec, move %6d usec/frame, cull %5d usec/view\n", int(octree_result.create_usec), int(octree_result.first_move_usec), int(octree_result.move_usec), int(octree_result.cull_usec));
+	OS::get_singleton()->print("\tbvh:    create %7d usec, first move %6d usec, move %6d usec/frame, cull %5d usec/view\t%s\n", int(bvh_result.create_usec), int(bvh_result.first_move_usec), int(bvh_result.move_usec), int(bvh_result.cull_usec), pass ? "PASS" : "FAILED");
+
+	return pass;
+}
+
+struct TreeMask {
+	uint32_t mask;
+
+	void merge(const TreeMask &p_a, const TreeMask &p_b) { mask = p_a.mask | p_b.mask; }
+};
+
+static void _random_bounds(RandomPCG &p_rng, AABB &r_aabb) {
+
+	r_aabb.position = Vector3(p_rng.randf(), p_rng.randf(), p_rng.randf()) * 100;
+	r_aabb.size = Vector3(p_rng.randf(), p_rng.randf(), p_rng.randf()) * 5;
+}
+
+static void _random_bounds(RandomPCG &p_rng, Rect2 &r_rect) {
+
+	r_rect.position = Vector2(p_rng.randf(), p_rng.randf()) * 100;
+	r_rect.size = Vector2(p_rng.randf(), p_rng.randf()) * 5;
+}
+
+template <class T, class B>
+struct TreeCull {
+	B bounds;
+	Vector<int> result;
+
+	bool test(const typename T::Node &p_node) const { return p_node.aabb.intersects(bounds); }
+	bool leaf(uint32_t p_element) {
+		result.push_back(p_element);
+		return true;
+	}
+};
+
+// Checks that every node encloses exactly its children and carries their
+// height and masks, returns the number of leaves below it or -1.
+template <class T>
+static int _check_tree_node(const T &p_tree, uint32_t p_node, uint32_t p_parent, const Vector<uint32_t> &p_leaves) {
+
+	const typename T::Node &node = p_tree.get_node(p_node);
+	if (node.parent != p_parent) {
+		return -1;
+	}
+
+	if (node.is_leaf()) {
+		bool valid = node.height == 0 && int(node.element) < p_leaves.size() && p_leaves[node.element] == p_node;
+		return valid ? 1 : -1;
+	}
+
+	const typename T::Node &a = p_tree.get_node(node.children[0]);
+	const typename T::Node &b = p_tree.get_node(node.children[1]);
+	if (!(node.aabb == a.aabb.merge(b.aabb)) || node.height != 1 + MAX(a.height, b.height) || node.mask != (a.mask | b.mask)) {
+		return -1;
+	}
+
+	int count_a = _check_tree_node(p_tree, node.children[0], p_node, p_leaves);
+	int count_b = _check_tree_node(p_tree, node.children[1], p_node, p_leaves);
+	return count_a < 0 || count_b < 0 ? -1 : count_a + count_b;
+}
+
+// Inserts, moves and removes random bounds, then checks the tree structure
+// and its culls against a brute force search.
+template <class B, bool DYNAMIC>
+static bool _test_tree(const char *p_name) {
+
+	typedef BVHTree<B, TreeMask, DYNAMIC> Tree;
+
+	RandomPCG rng(1234);
+	Tree tree;
+	Vector<B> bounds;
+	Vector<uint32_t> leaves; // NODE_NULL once removed
+
+	for (int i = 0; i < 2000; i++) {
+		B b;
+		_random_bounds(rng, b);
+		TreeMask mask;
+		mask.mask = 1 << (i % 8);
+		bounds.push_back(b);
+		leaves.push_back(tree.insert(b, i, mask));
+	}
+
+	for (int frame = 0; frame < 20; frame++) {
+		for (int i = 0; i < bounds.size(); i++) {
+			if (leaves[i] == Tree::NODE_NULL || rng.rand() % 4) {
+				continue;
+			}
+			B b = bounds[i];
+			B from;
+			B to;
+			_random_bounds(rng, from);
+			_random_bounds(rng, to);
+			// Mostly small moves, refit in place, and a few teleports.
+			b.position += (to.position - from.position) * (rng.rand() % 16 ? 0.01 : 0.5);
+			bounds.write[i] = b;
+			tree.move(leaves[i], b);
+		}
+		for (int i = frame; i < bounds.size(); i += 97) {
+			if (leaves[i] != Tree::NODE_NULL) {
+				tree.remove(leaves[i]);
+				leaves.write[i] = Tree::NODE_NULL;
+			}
+		}
+	}
+
+	int live = 0;
+	for (int i = 0; i < leaves.size(); i++) {
+		live += leaves[i] != Tree::NODE_NULL ? 1 : 0;
+	}
+
+	bool pass = _check_tree_node(tree, tree.get_root(), Tree::NODE_NULL, leaves) == live;
+
+	for (int i = 0; pass && i < 50; i++) {
+		TreeCull<Tree, B> cull;
+		_random_bounds(rng, cull.bounds);
+		cull.bounds.size *= 4;
+		tree.cull(tree.get_root(), cull);
+
+		int expected = 0;
+		for (int j = 0; j < bounds.size(); j++) {
+			if (leaves[j] != Tree::NODE_NULL && bounds[j].intersects(cull.bounds)) {
+				expected++;
+			}
+		}
+		pass = cull.result.size() == expected;
+	}
+
+	OS::get_singleton()->print("BVHTree %s: %d leaves, height %d\t%s\n", p_name, live, tree.get_node(tree.get_root()).height, pass ? "PASS" : "FAILED");
+
+	return pass;
+}
+
+MainLoop *test() {
+
+	int counts[] = { 10000, 100000 };
+
+	int passed = 0;
+	int count = 0;
+	for (int i = 0; i < 2; i++) {
+		passed += _bench(counts[i]) ? 1 : 0;
+		count++;
+	}
+
+	passed += _test_tree<AABB, false>("AABB") ? 1 : 0;
+	passed += _test_tree<AABB, true>("AABB, dynamic") ? 1 : 0;
+	passed += _test_tree<Rect2, false>("Rect2") ? 1 : 0;
+	passed += _test_tree<Rect2, true>("Rect2, dynamic") ? 1 : 0;
+	count += 4;
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestBVH
@@ -0,0 +1,238 @@
+/*************************************************************************/
+/*  test_class_db.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_class_db.h"
+
+#include "core/class_db.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+
+namespace TestClassDB {
+
+// Tests for the flattened dispatch tables, and for their invalidation when
+// something is bound to a class after a table was built for it.
+
+class DispatchTestBase : public Object {
+
+	GDCLASS(DispatchTestBase, Object);
+
+	int value;
+	int late_value;
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("get_kind"), &DispatchTestBase::get_kind);
+		ClassDB::bind_method(D_METHOD("set_value", "value"), &DispatchTestBase::set_value);
+		ClassDB::bind_method(D_METHOD("get_value"), &DispatchTestBase::get_value);
+
+		ADD_PROPERTY(PropertyInfo(Variant::INT, "value"), "set_value", "get_value");
+	}
+
+public:
+	String get_kind() const { return "base"; }
+	void set_value(int p_value) { value = p_value; }
+	int get_value() const { return value; }
+
+	// Bound by the tests, after the tables exist.
+	int get_late() const { return 42; }
+	void set_late_value(int p_value) { late_value = p_value; }
+	int get_late_value() const { return late_value; }
+
+	DispatchTestBase() {
+		value = 0;
+		late_value = 0;
+	}
+};
+
+class DispatchTestDerived : public DispatchTestBase {
+
+	GDCLASS(DispatchTestDerived, DispatchTestBase);
+
+protected:
+	static void _bind_methods() {
+
+		ClassDB::bind_method(D_METHOD("get_derived_kind"), &DispatchTestDerived::get_derived_kind);
+	}
+
+public:
+	String get_derived_kind() const { return "derived"; }
+};
+
+static bool _test_inherited_lookup() {
+
+	MethodBind *base_get = ClassDB::get_method("DispatchTestBase", "get_value");
+	MethodBind *derived_get = ClassDB::get_method("DispatchTestDerived", "get_value");
+	MethodBind *derived_only = ClassDB::get_method("DispatchTestBase", "get_derived_kind");
+
+	DispatchTestDerived *object = memnew(DispatchTestDerived);
+	object->set("value", 5);
+	bool ok = base_get && base_get == derived_get && !derived_only;
+	ok = ok && String(object->call("get_kind")) == "base" && String(object->call("get_derived_kind")) == "derived" && int(object->get("value")) == 5;
+	ok = ok && ClassDB::has_property("DispatchTestDerived", "value") && !ClassDB::has_property("DispatchTestDerived", "value", true);
+	memdelete(object);
+
+	return ok;
+}
+
+static bool _test_late_method() {
+
+	// Builds the tables, which must not keep answering no.
+	bool before = ClassDB::has_method("DispatchTestDerived", "get_late");
+
+	ClassDB::bind_method(D_METHOD("get_late"), &DispatchTestBase::get_late);
+
+	DispatchTestDerived *object = memnew(DispatchTestDerived);
+	bool ok = !before && ClassDB::has_method("DispatchTestDerived", "get_late") && int(object->call("get_late")) == 42;
+	memdelete(object);
+
+	return ok;
+}
+
+static bool _test_late_property() {
+
+	DispatchTestDerived *object = memnew(DispatchTestDerived);
+
+	Variant value;
+	bool before = ClassDB::get_property(object, "late_value", value);
+
+	ClassDB::bind_method(D_METHOD("set_late_value", "value"), &DispatchTestBase::set_late_value);
+	ClassDB::bind_method(D_METHOD("get_late_value"), &DispatchTestBase::get_late_value);
+	ClassDB::add_property("DispatchTestBase", PropertyInfo(Variant::INT, "late_value"), "set_late_value", "get_late_value");
+
+	bool valid = false;
+	bool set = ClassDB::set_property(object, "late_value", 7, &valid);
+	bool got = ClassDB::get_property(object, "late_value", value);
+
+	bool ok = !before && set && valid && got && int(value) == 7 && object->get_late_value() == 7;
+	memdelete(object);
+
+	return ok;
+}
+
+static bool _test_late_constant() {
+
+	DispatchTestDerived *object = memnew(DispatchTestDerived);
+
+	Variant value;
+	bool before = ClassDB::get_property(object, "LATE_CONSTANT", value);
+
+	ClassDB::bind_integer_constant("DispatchTestBase", StringName(), "LATE_CONSTANT", 3);
+
+	bool got = ClassDB::get_property(object, "LATE_CONSTANT", value);
+	bool ok = !before && got && int(value) == 3;
+	memdelete(object);
+
+	return ok;
+}
+
+// Lookups from other threads while methods keep being bound, which both rebuilds
+// the tables and publishes them to threads that take the lock free path.
+
+enum {
+	CONCURRENT_THREADS = 4,
+	CONCURRENT_BINDS = 200,
+};
+
+static uint32_t binds_done = 0;
+static CharString concurrent_names[CONCURRENT_BINDS]; // D_METHOD keeps the pointer
+static uint32_t lookup_failures = 0;
+
+static void _lookup_thread(void *p_userdata) {
+
+	while (atomic_load_acquire(&binds_done) < CONCURRENT_BINDS) {
+		if (!ClassDB::get_method("DispatchTestDerived", "get_value") || !ClassDB::has_method("DispatchTestDerived", "get_kind")) {
+			atomic_increment(&lookup_failures);
+		}
+	}
+}
+
+static bool _test_concurrent_lookup() {
+
+	Thread *threads[CONCURRENT_THREADS];
+	for (int i = 0; i < CONCURRENT_THREADS; i++) {
+		threads[i] = Thread::create(_lookup_thread, NULL);
+	}
+
+	for (int i = 0; i < CONCURRENT_BINDS; i++) {
+		concurrent_names[i] = ("get_concurrent_" + itos(i)).utf8();
+		ClassDB::bind_method(D_METHOD(concurrent_names[i].get_data()), &DispatchTestBase::get_late);
+		atomic_increment(&binds_done);
+	}
+
+	for (int i = 0; i < CONCURRENT_THREADS; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+
+	bool ok = lookup_failures == 0;
+	for (int i = 0; i < CONCURRENT_BINDS; i++) {
+		ok = ok && ClassDB::has_method("DispatchTestDerived", "get_concurrent_" + itos(i));
+	}
+	return ok;
+}
+
+typedef bool (*TestFunc)(void);
+
+struct TestCase {
+	TestFunc func;
+	const char *name;
+};
+
+static const TestCase test_cases[] = {
+	{ _test_inherited_lookup, "inherited lookup" },
+	{ _test_late_method, "method bound after the tables were built" },
+	{ _test_late_property, "property bound after the tables were built" },
+	{ _test_late_constant, "constant bound after the tables were built" },
+	{ _test_concurrent_lookup, "lookups while binding from another thread" },
+	{ NULL, NULL }
+};
+
+MainLoop *test() {
+
+	ClassDB::register_class<DispatchTestBase>();
+	ClassDB::register_class<DispatchTestDerived>();
+
+	int passed = 0;
+	int count = 0;
+
+	for (int i = 0; test_cases[i].func; i++) {
+		bool pass = test_cases[i].func();
+		OS::get_singleton()->print("%s\t%s\n", test_cases[i].name, pass ? "PASS" : "FAILED");
+		passed += pass ? 1 : 0;
+		count++;
+	}
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestClassDB
@@ -881,6 +881,12 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 					txt += " for-loop " + DADDR(4) + " in " + DADDR(2) + " counter " + DADDR(1) + " end " + itos(code[ip + 3]);
 					incr += 5;
 
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_RELEASE: {
+
+					txt += " for-release " + itos(code[ip + 1]);
+					incr += 2;
+
 				} break;
 				case GDScriptFunction::OPCODE_LINE: {
 
@@ -891,6 +897,45 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 						txt = "";
 					incr += 2;
 				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_INT: {
+
+					txt += " typed-int";
+					incr += 1;
+				} break;
+				case GDScriptFunction::OPCODE_OPERATOR_REAL: {
+
+					txt += " typed-real";
+					incr += 1;
+				} break;
+				case GDScriptFunction::OPCODE_GET_NAMED_VECTOR: {
+
+					txt += " typed-vector-component ";
+					txt += itos(code[ip + 1]);
+					incr += 2;
+				} break;
+				case GDScriptFunction::OPCODE_GET_ARRAY: {
+
+					txt += " typed-array";
+					incr += 1;
+				} break;
+				case GDScriptFunction::OPCODE_CALL_BUILTIN_TYPE: {
+
+					txt += " typed-builtin-method ";
+					txt += itos(code[ip + 1]);
+					incr += 2;
+				} break;
+				case GDScriptFunction::OPCODE_ITERATE_TYPED: {
+
+					txt += " typed-for ";
+					txt += itos(code[ip + 1]);
+					incr += 2;
+				} break;
+				case GDScriptFunction::OPCODE_INLINE_CACHE: {
+
+					txt += " inline-cache ";
+					txt += itos(code[ip + 1]);
+					incr += 2;
+				} break;
 				case GDScriptFunction::OPCODE_END: {
 
 					txt += " end";
@@ -917,8 +962,215 @@ static void _disassemble_class(const Ref<GDScript> &p_class, const Vector<String
 	}
 }
 
+// Inline caches. The call sites of one script see receivers change under
+// them, and must give the same results the generic instructions would.
+
+static const char *inline_cache_caller =
+		"extends Reference\n"
+		"func call_value(o):\n"
+		"\treturn o.get_value()\n"
+		"func get_member(o):\n"
+		"\treturn o.value\n"
+		"func call_class(o):\n"
+		"\treturn o.get_class()\n";
+
+// Native receivers of the same size, so one can take the address of the
+// other once it's freed.
+class InlineCacheTestA : public Reference {
+
+	GDCLASS(InlineCacheTestA, Reference);
+
+protected:
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("get_value"), &InlineCacheTestA::get_value);
+	}
+
+public:
+	String get_value() const { return "native a"; }
+};
+
+class InlineCacheTestB : public Reference {
+
+	GDCLASS(InlineCacheTestB, Reference);
+
+protected:
+	static void _bind_methods() {
+		ClassDB::bind_method(D_METHOD("get_value"), &InlineCacheTestB::get_value);
+	}
+
+public:
+	String get_value() const { return "native b"; }
+};
+
+static Ref<GDScript> _make_script(const String &p_code) {
+
+	Ref<GDScript> script;
+	script.instance();
+	script->set_source_code(p_code);
+	if (script->reload() != OK) {
+		return Ref<GDScript>();
+	}
+	return script;
+}
+
+static Variant _new_instance(Ref<GDScript> p_script) {
+
+	Variant::CallError ce;
+	return p_script->_new(NULL, 0, ce);
+}
+
+static bool _check_call(const Variant &p_caller, const StringName &p_method, const Variant &p_receiver, const Variant &p_expected, const String &p_what) {
+
+	// Twice, once to fill the cache and once to hit it.
+	for (int i = 0; i < 2; i++) {
+		Object *caller = p_caller;
+		Variant result = caller->call(p_method, p_receiver);
+		if (result != p_expected) {
+			OS::get_singleton()->print("%s: got %s, expected %s\n", p_what.utf8().get_data(), String(result).utf8().get_data(), String(p_expected).utf8().get_data());
+			return false;
+		}
+	}
+	return true;
+}
+
+// Reloading moves members to new indices and replaces the functions.
+static bool _test_inline_cache_reload(const Variant &p_caller) {
+
+	Ref<GDScript> script = _make_script("extends Reference\nvar value = \"a\"\nfunc get_value():\n\treturn \"a\"\n");
+	ERR_FAIL_COND_V(script.is_null(), false);
+	Variant receiver = _new_instance(script);
+
+	bool pass = true;
+	pass = _check_call(p_caller, "call_value", receiver, "a", "call before reload") && pass;
+	pass = _check_call(p_caller, "get_member", receiver, "a", "member before reload") && pass;
+
+	script->set_source_code("extends Reference\nvar extra = \"x\"\nvar value = \"a\"\nfunc get_value():\n\treturn \"reloaded\"\n");
+	ERR_FAIL_COND_V(script->reload(true) != OK, false);
+
+	pass = _check_call(p_caller, "call_value", receiver, "reloaded", "call after reload") && pass;
+	pass = _check_call(p_caller, "get_member", receiver, "a", "member after reload") && pass;
+	return pass;
+}
+
+// Receivers and their scripts are freed, and new ones often take their
+// addresses, which caches must not mistake for the old ones.
+static bool _test_inline_cache_free(const Variant &p_caller) {
+
+	bool pass = true;
+	const void *last_script = NULL;
+	const void *last_receiver = NULL;
+	int reused = 0;
+
+	for (int i = 0; i < 16; i++) {
+
+		Ref<GDScript> script = _make_script("extends Object\nvar value = " + itos(i) + "\nfunc get_value():\n\treturn " + itos(i) + "\n");
+		ERR_FAIL_COND_V(script.is_null(), false);
+		Object *receiver = _new_instance(script);
+		ERR_FAIL_COND_V(!receiver, false);
+
+		if (script.ptr() == last_script || receiver == last_receiver) {
+			reused++;
+		}
+		last_script = script.ptr();
+		last_receiver = receiver;
+
+		pass = _check_call(p_caller, "call_value", receiver, i, "call on receiver " + itos(i)) && pass;
+		pass = _check_call(p_caller, "get_member", receiver, i, "member of receiver " + itos(i)) && pass;
+
+		memdelete(receiver);
+	}
+
+	for (int i = 0; i < 16; i++) {
+
+		Ref<Reference> receiver;
+		if (i % 2) {
+			receiver = Ref<Reference>(memnew(InlineCacheTestB));
+		} else {
+			receiver = Ref<Reference>(memnew(InlineCacheTestA));
+		}
+
+		if (receiver.ptr() == last_receiver) {
+			reused++;
+		}
+		last_receiver = receiver.ptr();
+
+		pass = _check_call(p_caller, "call_value", receiver, i % 2 ? "native b" : "native a", "call on native receiver " + itos(i)) && pass;
+	}
+
+	OS::get_singleton()->print("%d of 32 receivers or scripts reused the last address\n", reused);
+	return pass;
+}
+
+// More receiver types than a cache has entries, taking turns at the same sites.
+static bool _test_inline_cache_receivers(const Variant &p_caller) {
+
+	Ref<GDScript> script_a = _make_script("extends Reference\nvar value = \"a\"\nfunc get_class():\n\treturn \"A\"\nfunc get_value():\n\treturn \"a\"\n");
+	Ref<GDScript> script_b = _make_script("extends Reference\nvar pad = 0\nvar value = \"b\"\nfunc get_class():\n\treturn \"B\"\nfunc get_value():\n\treturn \"b\"\n");
+	Ref<GDScript> script_c = _make_script("extends Reference\nvar pad = 0\nvar pad2 = 0\nvar value = \"c\"\nfunc get_value():\n\treturn \"c\"\n");
+	ERR_FAIL_COND_V(script_a.is_null() || script_b.is_null() || script_c.is_null(), false);
+
+	Ref<Reference> native_reference;
+	native_reference.instance();
+	Object *native_object = memnew(Object);
+
+	Variant receivers[5] = { _new_instance(script_a), _new_instance(script_b), _new_instance(script_c), native_reference, native_object };
+	const char *classes[5] = { "A", "B", "Reference", "Reference", "Object" };
+	const char *values[3] = { "a", "b", "c" };
+
+	bool pass = true;
+	for (int round = 0; round < 3; round++) {
+		for (int j = 0; j < 5; j++) {
+			int i = (j * (round + 1)) % 5;
+			pass = _check_call(p_caller, "call_class", receivers[i], classes[i], "class of receiver " + itos(i)) && pass;
+			if (i < 3) {
+				pass = _check_call(p_caller, "call_value", receivers[i], values[i], "call on receiver " + itos(i)) && pass;
+				pass = _check_call(p_caller, "get_member", receivers[i], values[i], "member of receiver " + itos(i)) && pass;
+			}
+		}
+	}
+
+	memdelete(native_object);
+	return pass;
+}
+
+static MainLoop *_test_inline_cache() {
+
+	ClassDB::register_class<InlineCacheTestA>();
+	ClassDB::register_class<InlineCacheTestB>();
+
+	Ref<GDScript> caller_script = _make_script(inline_cache_caller);
+	ERR_FAIL_COND_V(caller_script.is_null(), NULL);
+	Variant caller = _new_instance(caller_script);
+
+	int count = 0;
+	int passed = 0;
+
+	bool pass = _test_inline_cache_reload(caller);
+	OS::get_singleton()->print("Script reload\t%s\n", pass ? "PASS" : "FAILED");
+	passed += pass ? 1 : 0;
+	count++;
+
+	pass = _test_inline_cache_free(caller);
+	OS::get_singleton()->print("Freed receivers and scripts\t%s\n", pass ? "PASS" : "FAILED");
+	passed += pass ? 1 : 0;
+	count++;
+
+	pass = _test_inline_cache_receivers(caller);
+	OS::get_singleton()->print("Changing receiver types\t%s\n", pass ? "PASS" : "FAILED");
+	passed += pass ? 1 : 0;
+	count++;
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+
 MainLoop *test(TestType p_type) {
 
+	if (p_type == TEST_INLINE_CACHE) {
+		return _test_inline_cache();
+	}
+
 	List<String> cmdlargs = OS::get_singleton()->get_cmdline_args();
 
 	if (cmdlargs.empty()) {
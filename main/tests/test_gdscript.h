@@ -40,6 +40,7 @@ enum TestType {
 	TEST_PARSER,
 	TEST_COMPILER,
 	TEST_BYTECODE,
+	TEST_INLINE_CACHE,
 };
 
 MainLoop *test(TestType p_type);
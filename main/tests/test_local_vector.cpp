@@ -0,0 +1,184 @@
+/*************************************************************************/
+/*  test_local_vector.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_local_vector.h"
+
+#include "core/local_vector.h"
+#include "core/os/os.h"
+#include "core/ustring.h"
+
+namespace TestLocalVector {
+
+bool test_push_back_and_remove() {
+	LocalVector<int> vector;
+	for (int i = 0; i < 100; i++) {
+		vector.push_back(i);
+	}
+	vector.remove(0);
+	vector.remove_unordered(0);
+	vector.erase(50);
+
+	return vector.size() == 97 && vector[0] == 99 && vector[1] == 2 && vector.find(50) == -1 && vector.find(51) == 49;
+}
+
+bool test_clear_keeps_memory() {
+	LocalVector<int> vector;
+	vector.resize(64);
+	vector.clear();
+	uint32_t capacity = vector.get_capacity();
+	vector.reset();
+
+	return capacity >= 64 && vector.get_capacity() == 0 && vector.empty();
+}
+
+bool test_non_trivial_elements() {
+	LocalVector<String> vector;
+	for (int i = 0; i < 20; i++) {
+		vector.push_back(itos(i));
+	}
+	vector.remove(3);
+
+	LocalVector<String> copy = vector;
+	copy.push_back("last");
+	vector.invert();
+
+	return vector.size() == 19 && copy.size() == 20 && vector[0] == "19" && copy[3] == "4" && copy[19] == "last";
+}
+
+bool test_move() {
+	LocalVector<String> from;
+	from.push_back("Godot");
+	const String *data = from.ptr();
+
+	LocalVector<String> to(static_cast<LocalVector<String> &&>(from));
+
+	return to.ptr() == data && to.size() == 1 && to[0] == "Godot" && from.empty();
+}
+
+bool test_inline_capacity_does_not_allocate() {
+	uint64_t usage = Memory::get_mem_usage();
+
+	LocalVector<int, 8> vector;
+	for (int i = 0; i < 8; i++) {
+		vector.push_back(i);
+	}
+
+	bool no_alloc = Memory::get_mem_usage() == usage;
+
+	// Growing past the inline storage moves to the heap and keeps the elements.
+	for (int i = 8; i < 32; i++) {
+		vector.push_back(i);
+	}
+
+	return no_alloc && vector.get_capacity() >= 32 && vector[7] == 7 && vector[31] == 31;
+}
+
+bool test_inline_move() {
+	LocalVector<String, 4> from;
+	from.push_back("a");
+	from.push_back("b");
+
+	LocalVector<String, 4> to;
+	to = static_cast<LocalVector<String, 4> &&>(from);
+
+	return to.size() == 2 && to[1] == "b" && from.empty() && from.get_capacity() == 4;
+}
+
+bool test_to_vector() {
+	LocalVector<int, 4> local;
+	local.push_back(3);
+	local.push_back(1);
+	local.push_back(2);
+	local.sort();
+
+	Vector<int> vector = local;
+
+	return vector.size() == 3 && vector[0] == 1 && vector[2] == 3;
+}
+
+// Pushing one of the vector's own elements when it is full must copy it before reallocating.
+bool test_push_back_own_element() {
+	LocalVector<String> vector;
+	vector.push_back("first");
+	while (vector.size() < vector.get_capacity()) {
+		vector.push_back("filler");
+	}
+	vector.push_back(vector[0]);
+
+	LocalVector<int, 2> inline_vector;
+	inline_vector.push_back(7);
+	inline_vector.push_back(8);
+	inline_vector.push_back(inline_vector[0]);
+
+	return vector[vector.size() - 1] == "first" && inline_vector.size() == 3 && inline_vector[2] == 7;
+}
+
+typedef bool (*TestFunc)(void);
+
+TestFunc test_funcs[] = {
+
+	test_push_back_and_remove,
+	test_clear_keeps_memory,
+	test_non_trivial_elements,
+	test_move,
+	test_inline_capacity_does_not_allocate,
+	test_inline_move,
+	test_to_vector,
+	test_push_back_own_element,
+	0
+
+};
+
+MainLoop *test() {
+
+	int count = 0;
+	int passed = 0;
+
+	while (true) {
+		if (!test_funcs[count])
+			break;
+		bool pass = test_funcs[count]();
+		if (pass)
+			passed++;
+		OS::get_singleton()->print("\t%s\n", pass ? "PASS" : "FAILED");
+
+		count++;
+	}
+
+	OS::get_singleton()->print("\n\n\n");
+	OS::get_singleton()->print("*************\n");
+	OS::get_singleton()->print("***TOTALS!***\n");
+	OS::get_singleton()->print("*************\n");
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestLocalVector
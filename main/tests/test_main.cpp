@@ -34,16 +34,24 @@
 #ifdef DEBUG_ENABLED
 
 #include "test_astar.h"
+#include "test_bvh.h"
+#include "test_class_db.h"
 #include "test_gdscript.h"
 #include "test_gui.h"
+#include "test_local_vector.h"
 #include "test_math.h"
+#include "test_memory.h"
 #include "test_oa_hash_map.h"
+#include "test_occlusion.h"
 #include "test_ordered_hash_map.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_radix_sort.h"
 #include "test_render.h"
 #include "test_shader_lang.h"
 #include "test_string.h"
+#include "test_string_name.h"
+#include "test_worker_thread_pool.h"
 
 const char **tests_get_names() {
 
@@ -51,7 +59,9 @@ const char **tests_get_names() {
 		"string",
 		"math",
 		"physics",
+		"physics_broad_phase",
 		"physics_2d",
+		"physics_2d_broad_phase",
 		"render",
 		"oa_hash_map",
 		"gui",
@@ -60,8 +70,17 @@ const char **tests_get_names() {
 		"gd_parser",
 		"gd_compiler",
 		"gd_bytecode",
+		"gd_inline_cache",
 		"ordered_hash_map",
 		"astar",
+		"memory",
+		"local_vector",
+		"string_name",
+		"bvh",
+		"occlusion",
+		"radix_sort",
+		"worker_thread_pool",
+		"class_db",
 		NULL
 	};
 
@@ -85,11 +104,21 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestPhysics::test();
 	}
 
+	if (p_test == "physics_broad_phase") {
+
+		return TestPhysics::test_broad_phase();
+	}
+
 	if (p_test == "physics_2d") {
 
 		return TestPhysics2D::test();
 	}
 
+	if (p_test == "physics_2d_broad_phase") {
+
+		return TestPhysics2D::test_broad_phase();
+	}
+
 	if (p_test == "render") {
 
 		return TestRender::test();
@@ -132,6 +161,11 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestGDScript::test(TestGDScript::TEST_BYTECODE);
 	}
 
+	if (p_test == "gd_inline_cache") {
+
+		return TestGDScript::test(TestGDScript::TEST_INLINE_CACHE);
+	}
+
 	if (p_test == "ordered_hash_map") {
 
 		return TestOrderedHashMap::test();
@@ -142,6 +176,46 @@ MainLoop *test_main(String p_test, const List<String> &p_args) {
 		return TestAStar::test();
 	}
 
+	if (p_test == "memory") {
+
+		return TestMemory::test();
+	}
+
+	if (p_test == "local_vector") {
+
+		return TestLocalVector::test();
+	}
+
+	if (p_test == "string_name") {
+
+		return TestStringName::test();
+	}
+
+	if (p_test == "bvh") {
+
+		return TestBVH::test();
+	}
+
+	if (p_test == "occlusion") {
+
+		return TestOcclusion::test();
+	}
+
+	if (p_test == "radix_sort") {
+
+		return TestRadixSort::test();
+	}
+
+	if (p_test == "worker_thread_pool") {
+
+		return TestWorkerThreadPool::test();
+	}
+
+	if (p_test == "class_db") {
+
+		return TestClassDB::test();
+	}
+
 	print_line("Unknown test: " + p_test);
 	return NULL;
 }
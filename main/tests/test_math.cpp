@@ -30,10 +30,14 @@
 
 #include "test_math.h"
 
+#include "core/math/aabb4.h"
 #include "core/math/basis.h"
+#include "core/math/bulk_math.h"
 #include "core/math/camera_matrix.h"
 #include "core/math/math_funcs.h"
+#include "core/math/random_pcg.h"
 #include "core/math/transform.h"
+#include "core/math/transform_2d.h"
 #include "core/os/file_access.h"
 #include "core/os/keyboard.h"
 #include "core/os/os.h"
@@ -402,8 +406,393 @@ uint32_t ihash3(uint32_t a) {
 	return a;
 }
 
+enum BulkOp {
+	BULK_ADD,
+	BULK_MULTIPLY,
+	BULK_MULTIPLY_ADD,
+	BULK_CLAMP,
+	BULK_LERP,
+	BULK_OP_MAX
+};
+
+const char *bulk_op_names[BULK_OP_MAX] = { "add", "multiply", "multiply_add", "clamp", "lerp" };
+
+// Results can differ in the last bits from the scalar code, for instance if
+// the compiler fuses a multiply and an add there.
+bool bulk_equal(real_t p_a, real_t p_b, real_t p_scale = 1) {
+
+	return Math::abs(p_a - p_b) <= 1e-5 * MAX(p_scale, Math::abs(p_b));
+}
+
+// Runs an element-wise BulkMath operation on an array of p_count elements of
+// p_width components, and checks it against the same arithmetic done one
+// component at a time. Sizes around the SIMD block test the scalar tails.
+bool check_bulk_op(int p_op, int p_width, int p_count, bool p_array) {
+
+	const int guard = 4;
+	int size = p_count * p_width;
+
+	RandomPCG rng(p_op * 1000 + p_count * 8 + p_width * 2 + (p_array ? 1 : 0));
+	Vector<real_t> a;
+	Vector<real_t> b;
+	Vector<real_t> c;
+	for (int i = 0; i < size; i++) {
+		a.push_back(rng.randf() * 20 - 10);
+		b.push_back(rng.randf() * 20 - 10);
+		c.push_back(b[i] + rng.randf() * 10); // clamp needs min <= max
+	}
+	real_t single_b[4];
+	real_t single_c[4];
+	for (int i = 0; i < 4; i++) {
+		single_b[i] = rng.randf() * 20 - 10;
+		single_c[i] = single_b[i] + rng.randf() * 10;
+	}
+	real_t weight = 0.3;
+
+	Vector<real_t> result = a;
+	for (int i = 0; i < guard; i++) {
+		result.push_back(12345);
+	}
+
+	BulkMath::Operand<real_t> operand_b(p_array ? b.ptr() : single_b, p_array);
+	BulkMath::Operand<real_t> operand_c(p_array ? c.ptr() : single_c, p_array);
+
+	switch (p_op) {
+		case BULK_ADD: BulkMath::add(result.ptrw(), p_count, p_width, operand_b); break;
+		case BULK_MULTIPLY: BulkMath::multiply(result.ptrw(), p_count, p_width, operand_b); break;
+		case BULK_MULTIPLY_ADD: BulkMath::multiply_add(result.ptrw(), p_count, p_width, operand_b, operand_c); break;
+		case BULK_CLAMP: BulkMath::clamp(result.ptrw(), p_count, p_width, operand_b, operand_c); break;
+		case BULK_LERP: BulkMath::lerp(result.ptrw(), p_count, p_width, operand_b, weight); break;
+	}
+
+	for (int i = 0; i < size; i++) {
+
+		real_t vb = p_array ? b[i] : single_b[i % p_width];
+		real_t vc = p_array ? c[i] : single_c[i % p_width];
+		real_t expected = 0;
+		switch (p_op) {
+			case BULK_ADD: expected = a[i] + vb; break;
+			case BULK_MULTIPLY: expected = a[i] * vb; break;
+			case BULK_MULTIPLY_ADD: expected = a[i] * vb + vc; break;
+			case BULK_CLAMP: expected = CLAMP(a[i], vb, vc); break;
+			case BULK_LERP: expected = a[i] + (vb - a[i]) * weight; break;
+		}
+
+		if (!bulk_equal(result[i], expected)) {
+			OS::get_singleton()->print("BulkMath %s, width %d, %d elements, %s operand: component %d is %f, expected %f\tFAILED\n", bulk_op_names[p_op], p_width, p_count, p_array ? "array" : "single", i, result[i], expected);
+			return false;
+		}
+	}
+	for (int i = 0; i < guard; i++) {
+		if (result[size + i] != 12345) {
+			OS::get_singleton()->print("BulkMath %s, width %d, %d elements: wrote past the end\tFAILED\n", bulk_op_names[p_op], p_width, p_count);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool check_bulk_reduce(int p_width, int p_count) {
+
+	int size = p_count * p_width;
+
+	RandomPCG rng(p_count * 8 + p_width);
+	Vector<real_t> a;
+	for (int i = 0; i < size; i++) {
+		a.push_back(rng.randf() * 20 - 10);
+	}
+
+	real_t sum[4];
+	real_t min[4];
+	real_t max[4];
+	BulkMath::sum(a.ptr(), p_count, p_width, sum);
+	if (p_count > 0) {
+		BulkMath::min(a.ptr(), p_count, p_width, min);
+		BulkMath::max(a.ptr(), p_count, p_width, max);
+	}
+
+	for (int j = 0; j < p_width; j++) {
+
+		real_t expected_sum = 0;
+		real_t magnitude = 0;
+		real_t expected_min = 1e10;
+		real_t expected_max = -1e10;
+		for (int i = j; i < size; i += p_width) {
+			expected_sum += a[i];
+			magnitude += Math::abs(a[i]);
+			expected_min = MIN(expected_min, a[i]);
+			expected_max = MAX(expected_max, a[i]);
+		}
+
+		// Lanes are summed apart, so rounding depends on the order.
+		bool pass = bulk_equal(sum[j], expected_sum, magnitude);
+		if (p_count > 0) {
+			pass = pass && min[j] == expected_min && max[j] == expected_max;
+		}
+		if (!pass) {
+			OS::get_singleton()->print("BulkMath reductions, width %d, %d elements: component %d sum %f min %f max %f, expected %f %f %f\tFAILED\n", p_width, p_count, j, sum[j], p_count ? min[j] : 0, p_count ? max[j] : 0, expected_sum, expected_min, expected_max);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Transforms points apart and in place, for counts around the SIMD steps.
+bool check_bulk_transform(int p_count) {
+
+	const int guard = 4;
+
+	RandomPCG rng(p_count);
+	Vector<Vector3> points3;
+	Vector<Vector2> points2;
+	for (int i = 0; i < p_count; i++) {
+		points3.push_back(Vector3(rng.randf() * 20 - 10, rng.randf() * 20 - 10, rng.randf() * 20 - 10));
+		points2.push_back(Vector2(rng.randf() * 20 - 10, rng.randf() * 20 - 10));
+	}
+
+	Transform xform3(Basis(Vector3(0.3, -1.2, 0.7)).scaled(Vector3(1.5, 0.5, 2)), Vector3(4, -2, 9));
+	Transform2D xform2(0.8, Vector2(-3, 5));
+	xform2.scale(Vector2(2, 0.5));
+
+	Vector<Vector3> out3;
+	Vector<Vector2> out2;
+	out3.resize(p_count + guard);
+	out2.resize(p_count + guard);
+	for (int i = 0; i < p_count + guard; i++) {
+		out3.write[i] = Vector3(12345, 12345, 12345);
+		out2.write[i] = Vector2(12345, 12345);
+	}
+	BulkMath::transform(points3.ptr(), out3.ptrw(), p_count, xform3);
+	BulkMath::transform(points2.ptr(), out2.ptrw(), p_count, xform2);
+
+	Vector<Vector3> in_place3 = points3;
+	Vector<Vector2> in_place2 = points2;
+	BulkMath::transform(in_place3.ptr(), in_place3.ptrw(), p_count, xform3);
+	BulkMath::transform(in_place2.ptr(), in_place2.ptrw(), p_count, xform2);
+
+	for (int i = 0; i < p_count; i++) {
+
+		Vector3 expected3 = xform3.xform(points3[i]);
+		Vector2 expected2 = xform2.xform(points2[i]);
+		bool pass = true;
+		for (int j = 0; j < 3; j++) {
+			pass = pass && bulk_equal(out3[i][j], expected3[j], 10) && bulk_equal(in_place3[i][j], expected3[j], 10);
+		}
+		for (int j = 0; j < 2; j++) {
+			pass = pass && bulk_equal(out2[i][j], expected2[j], 10) && bulk_equal(in_place2[i][j], expected2[j], 10);
+		}
+		if (!pass) {
+			OS::get_singleton()->print("BulkMath transform, %d points: point %d is %s and %s (%s and %s in place), expected %s and %s\tFAILED\n", p_count, i, String(out3[i]).utf8().get_data(), String(out2[i]).utf8().get_data(), String(in_place3[i]).utf8().get_data(), String(in_place2[i]).utf8().get_data(), String(expected3).utf8().get_data(), String(expected2).utf8().get_data());
+			return false;
+		}
+	}
+	for (int i = p_count; i < p_count + guard; i++) {
+		if (out3[i] != Vector3(12345, 12345, 12345) || out2[i] != Vector2(12345, 12345)) {
+			OS::get_singleton()->print("BulkMath transform, %d points: wrote past the end\tFAILED\n", p_count);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool test_bulk_math() {
+
+	bool pass = true;
+
+	// Up to a few whole SIMD blocks (12 floats) and the tails after them.
+	for (int op = 0; op < BULK_OP_MAX; op++) {
+		bool op_pass = true;
+		for (int width = 1; width <= 4; width++) {
+			for (int count = 0; count < 30; count++) {
+				op_pass = check_bulk_op(op, width, count, true) && op_pass;
+				op_pass = check_bulk_op(op, width, count, false) && op_pass;
+			}
+		}
+		OS::get_singleton()->print("BulkMath %s\t%s\n", bulk_op_names[op], op_pass ? "PASS" : "FAILED");
+		pass = pass && op_pass;
+	}
+
+	bool reduce_pass = true;
+	for (int width = 1; width <= 4; width++) {
+		for (int count = 0; count < 30; count++) {
+			reduce_pass = check_bulk_reduce(width, count) && reduce_pass;
+		}
+	}
+	OS::get_singleton()->print("BulkMath sum, min and max\t%s\n", reduce_pass ? "PASS" : "FAILED");
+
+	bool transform_pass = true;
+	for (int count = 0; count < 20; count++) {
+		transform_pass = check_bulk_transform(count) && transform_pass;
+	}
+	OS::get_singleton()->print("BulkMath transform\t%s\n", transform_pass ? "PASS" : "FAILED");
+
+	return pass && reduce_pass && transform_pass;
+}
+
+// Checks AABB4::intersects_convex_shape() box by box against the one box
+// AABB functions, on the planes that p_plane_mask selects, for every count
+// of boxes a group can have.
+bool check_convex_cull(const Vector<AABB> &p_aabbs, const Vector<Plane> &p_planes, uint32_t p_plane_mask, const String &p_name) {
+
+	Vector<Plane> selected;
+	for (int i = 0; i < p_planes.size(); i++) {
+		if (i >= 32 || (p_plane_mask & (1U << i))) {
+			selected.push_back(p_planes[i]);
+		}
+	}
+
+	// Lanes past the count hold a box that passes every test, so they show
+	// up if they leak into the results.
+	AABB everywhere(Vector3(-1e6, -1e6, -1e6), Vector3(2e6, 2e6, 2e6));
+
+	int intersecting = 0;
+	int inside = 0;
+
+	for (int i = 0; i < p_aabbs.size(); i += 4) {
+
+		int available = MIN(4, p_aabbs.size() - i);
+
+		for (int count = 1; count <= available; count++) {
+
+			AABB4 packed;
+			for (int j = 0; j < 4; j++) {
+				packed.set(j, j < count ? p_aabbs[i + j] : everywhere);
+			}
+
+			uint32_t expected = 0;
+			uint32_t expected_inside = 0;
+			for (int j = 0; j < count; j++) {
+				if (p_aabbs[i + j].intersects_convex_shape(selected.ptr(), selected.size())) {
+					expected |= 1 << j;
+				}
+				if (p_aabbs[i + j].inside_convex_shape(selected.ptr(), selected.size())) {
+					expected_inside |= 1 << j;
+				}
+			}
+
+			uint32_t result_inside = 0;
+			uint32_t result = packed.intersects_convex_shape(p_planes.ptr(), p_planes.size(), count, p_plane_mask, &result_inside);
+			uint32_t result_only = packed.intersects_convex_shape(p_planes.ptr(), p_planes.size(), count, p_plane_mask);
+
+			if (result != expected || result_only != expected || result_inside != expected_inside) {
+				OS::get_singleton()->print("Convex cull, %s: boxes %d to %d: intersecting %x (%x without inside test), inside %x, expected %x and %x\tFAILED\n", p_name.utf8().get_data(), i, i + count - 1, result, result_only, result_inside, expected, expected_inside);
+				return false;
+			}
+
+			if (count == available) {
+				intersecting += (result & 1) + ((result >> 1) & 1) + ((result >> 2) & 1) + ((result >> 3) & 1);
+				inside += (result_inside & 1) + ((result_inside >> 1) & 1) + ((result_inside >> 2) & 1) + ((result_inside >> 3) & 1);
+			}
+		}
+	}
+
+	OS::get_singleton()->print("Convex cull, %s: %d of %d intersecting, %d inside\tPASS\n", p_name.utf8().get_data(), intersecting, p_aabbs.size(), inside);
+	return true;
+}
+
+bool test_convex_cull_results() {
+
+	RandomPCG rng(2);
+
+	// Boxes of all sizes, flat and empty ones included, around the shapes so
+	// that some are outside, some cross the planes and some are inside.
+	Vector<AABB> aabbs;
+	for (int i = 0; i < 1003; i++) {
+		Vector3 position(rng.randf() * 80 - 40, rng.randf() * 80 - 40, rng.randf() * 80 - 40);
+		Vector3 size(rng.randf() * 8, rng.randf() * 8, rng.randf() * 8);
+		if (i % 7 == 0) {
+			size.y = 0;
+		}
+		if (i % 11 == 0) {
+			size = Vector3();
+		}
+		aabbs.push_back(AABB(position, size));
+	}
+
+	CameraMatrix cm;
+	cm.set_perspective(70, 16.0 / 9.0, 0.05, 30);
+	Vector<Plane> frustum = cm.get_projection_planes(Transform().looking_at(Vector3(1, 0.2, -1), Vector3(0, 1, 0)));
+
+	// More than 32 planes, only the first 32 can be masked out.
+	Vector<Plane> polytope;
+	for (int i = 0; i < 40; i++) {
+		Vector3 normal(rng.randf() * 2 - 1, rng.randf() * 2 - 1, rng.randf() * 2 - 1);
+		polytope.push_back(Plane(normal.normalized(), 15 + rng.randf() * 10));
+	}
+
+	bool pass = true;
+	pass = check_convex_cull(aabbs, frustum, 0xFFFFFFFF, "frustum") && pass;
+	pass = check_convex_cull(aabbs, frustum, 0x2D, "frustum, planes 1 and 4 masked out") && pass;
+	pass = check_convex_cull(aabbs, frustum, 0, "frustum, all planes masked out") && pass;
+	pass = check_convex_cull(aabbs, polytope, 0xFFFFFFFF, "40 planes") && pass;
+	pass = check_convex_cull(aabbs, polytope, 0x0F0F0F0F, "40 planes, half of the first 32 masked out") && pass;
+	pass = check_convex_cull(aabbs, Vector<Plane>(), 0xFFFFFFFF, "no planes") && pass;
+	return pass;
+}
+
+// Culls boxes spread around a camera with its frustum, one box at a time
+// and four at a time, which is how the BVH tests the leaves it reaches.
+void test_convex_cull() {
+
+	const int count = 100000;
+	const int rounds = 20;
+
+	RandomPCG rng(1);
+	Vector<AABB> aabbs;
+	aabbs.resize(count);
+	for (int i = 0; i < count; i++) {
+		Vector3 position(rng.randf() * 200 - 100, rng.randf() * 200 - 100, rng.randf() * 200 - 100);
+		aabbs.write[i] = AABB(position, Vector3(1, 1, 1) * (rng.randf() * 2 + 0.5));
+	}
+
+	Vector<AABB4> packed;
+	packed.resize(count / 4);
+	for (int i = 0; i < count; i++) {
+		packed.write[i / 4].set(i % 4, aabbs[i]);
+	}
+
+	CameraMatrix cm;
+	cm.set_perspective(70, 16.0 / 9.0, 0.05, 100);
+	Vector<Plane> planes = cm.get_projection_planes(Transform().looking_at(Vector3(1, 0.2, -1), Vector3(0, 1, 0)));
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	int scalar_inside = 0;
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < count; i++) {
+			if (aabbs[i].intersects_convex_shape(planes.ptr(), planes.size())) {
+				scalar_inside++;
+			}
+		}
+	}
+	uint64_t scalar_usec = (OS::get_singleton()->get_ticks_usec() - from) / rounds;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	int packed_inside = 0;
+	for (int r = 0; r < rounds; r++) {
+		for (int i = 0; i < packed.size(); i++) {
+			uint32_t inside = packed[i].intersects_convex_shape(planes.ptr(), planes.size());
+			packed_inside += (inside & 1) + ((inside >> 1) & 1) + ((inside >> 2) & 1) + ((inside >> 3) & 1);
+		}
+	}
+	uint64_t packed_usec = (OS::get_singleton()->get_ticks_usec() - from) / rounds;
+
+	print_line("Convex cull of " + itos(count) + " AABBs: " + itos(scalar_usec) + " usec one by one, " + itos(packed_usec) + " usec four at a time, " + itos(scalar_inside / rounds) + " and " + itos(packed_inside / rounds) + " intersecting");
+}
+
 MainLoop *test() {
 
+	bool pass = true;
+	pass = test_convex_cull_results() && pass;
+	pass = test_bulk_math() && pass;
+	if (!pass) {
+		OS::get_singleton()->set_exit_code(1);
+	}
+
+	test_convex_cull();
+
 	{
 		float r = 1;
 		float g = 0.5;
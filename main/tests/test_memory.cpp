@@ -0,0 +1,183 @@
+/*************************************************************************/
+/*  test_memory.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_memory.h"
+
+#include "core/dictionary.h"
+#include "core/list.h"
+#include "core/map.h"
+#include "core/os/memory.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/variant.h"
+#include "scene/main/node.h"
+
+#ifdef FAST_ALLOC_ENABLED
+#include "core/os/fast_alloc.h"
+#endif
+
+// Allocator micro benchmarks. Run them on builds with and without
+// use_fast_alloc=yes to compare.
+
+namespace TestMemory {
+
+enum {
+	DICTIONARY_ROUNDS = 2000,
+	DICTIONARY_KEYS = 64,
+	MAP_LIST_ROUNDS = 2000,
+	MAP_LIST_ELEMENTS = 256,
+	NODE_ROUNDS = 200,
+	NODE_CHILDREN = 100,
+	CROSS_THREAD_BLOCKS = 100000,
+};
+
+static uint64_t _dictionary_churn() {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < DICTIONARY_ROUNDS; i++) {
+		Dictionary d;
+		for (int j = 0; j < DICTIONARY_KEYS; j++) {
+			d[j] = String::num(j);
+			d[String::num(j)] = Array();
+		}
+		for (int j = 0; j < DICTIONARY_KEYS; j += 2) {
+			d.erase(j);
+		}
+	}
+
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+// Map and List allocate one small block per element, which is where the
+// allocator shows the most.
+static uint64_t _map_list_churn() {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < MAP_LIST_ROUNDS; i++) {
+		Map<int, int> map;
+		List<int> list;
+		for (int j = 0; j < MAP_LIST_ELEMENTS; j++) {
+			map[(j * 37) % MAP_LIST_ELEMENTS] = j;
+			list.push_back(j);
+		}
+		for (int j = 0; j < MAP_LIST_ELEMENTS; j += 2) {
+			map.erase(j);
+			list.pop_front();
+		}
+	}
+
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+static uint64_t _node_instancing() {
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < NODE_ROUNDS; i++) {
+		Node *root = memnew(Node);
+		for (int j = 0; j < NODE_CHILDREN; j++) {
+			Node *child = memnew(Node);
+			child->set_name("child" + itos(j));
+			root->add_child(child);
+		}
+		memdelete(root);
+	}
+
+	return OS::get_singleton()->get_ticks_usec() - begin;
+}
+
+static void **cross_thread_blocks = NULL;
+
+static void _cross_thread_alloc(void *p_userdata) {
+
+	for (int i = 0; i < CROSS_THREAD_BLOCKS; i++) {
+		cross_thread_blocks[i] = memalloc(16 + (i % 31) * 16);
+		*(int *)cross_thread_blocks[i] = i;
+	}
+}
+
+static bool _cross_thread_free() {
+
+	cross_thread_blocks = memnew_arr(void *, CROSS_THREAD_BLOCKS);
+
+	// Allocate on a thread, free on this one, for a few rounds so returned blocks get reused.
+	bool ok = true;
+	for (int round = 0; round < 4; round++) {
+		Thread *thread = Thread::create(_cross_thread_alloc, NULL);
+		Thread::wait_to_finish(thread);
+		memdelete(thread);
+
+		for (int i = 0; i < CROSS_THREAD_BLOCKS; i++) {
+			if (*(int *)cross_thread_blocks[i] != i) {
+				ok = false;
+			}
+			memfree(cross_thread_blocks[i]);
+		}
+	}
+
+	memdelete_arr(cross_thread_blocks);
+	cross_thread_blocks = NULL;
+	return ok;
+}
+
+MainLoop *test() {
+
+#ifdef FAST_ALLOC_ENABLED
+	OS::get_singleton()->print("Allocator: FastAlloc\n");
+#else
+	OS::get_singleton()->print("Allocator: system\n");
+#endif
+
+	uint64_t usage_before = Memory::get_mem_usage();
+
+	uint64_t dictionary_time = _dictionary_churn();
+	OS::get_singleton()->print("Dictionary churn (%d x %d keys): %.2f ms\n", DICTIONARY_ROUNDS, DICTIONARY_KEYS * 2, dictionary_time / 1000.0);
+
+	uint64_t map_list_time = _map_list_churn();
+	OS::get_singleton()->print("Map/List churn (%d x %d elements): %.2f ms\n", MAP_LIST_ROUNDS, MAP_LIST_ELEMENTS, map_list_time / 1000.0);
+
+	uint64_t node_time = _node_instancing();
+	OS::get_singleton()->print("Node instancing (%d x %d children): %.2f ms\n", NODE_ROUNDS, NODE_CHILDREN, node_time / 1000.0);
+
+	bool cross_thread_ok = _cross_thread_free();
+	OS::get_singleton()->print("Cross thread free: %s\n", cross_thread_ok ? "OK" : "FAILED");
+
+	uint64_t usage_after = Memory::get_mem_usage();
+	OS::get_singleton()->print("Static memory usage: %d KiB before, %d KiB after\n", int(usage_before / 1024), int(usage_after / 1024));
+
+#ifdef FAST_ALLOC_ENABLED
+	OS::get_singleton()->print("FastAlloc: %d KiB reserved, %d thread caches\n", int(FastAlloc::get_reserved() / 1024), int(FastAlloc::get_thread_cache_count()));
+#endif
+
+	return NULL;
+}
+} // namespace TestMemory
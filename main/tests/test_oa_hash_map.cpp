@@ -32,10 +32,93 @@
 
 #include "core/os/os.h"
 
+#include "core/hash_map.h"
+#include "core/map.h"
 #include "core/oa_hash_map.h"
+#include "core/oa_ordered_hash_map.h"
 
 namespace TestOAHashMap {
 
+template <class M>
+static void _bench_oa(const char *p_name, const uint32_t *p_keys, int p_count) {
+
+	M map;
+	int value = 0;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		map.set(p_keys[i], i);
+	}
+	uint64_t insert_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	int found = 0;
+	for (int i = 0; i < p_count; i++) {
+		found += map.lookup(p_keys[i], value) ? 1 : 0;
+	}
+	uint64_t lookup_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		map.remove(p_keys[i]);
+	}
+	uint64_t remove_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("%-18s insert %6d usec, lookup %6d usec (%d found), remove %6d usec\n", p_name, int(insert_usec), int(lookup_usec), found, int(remove_usec));
+}
+
+static void _bench_map(const uint32_t *p_keys, int p_count) {
+
+	Map<uint32_t, int> map;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		map[p_keys[i]] = i;
+	}
+	uint64_t insert_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	int found = 0;
+	for (int i = 0; i < p_count; i++) {
+		found += map.has(p_keys[i]) ? 1 : 0;
+	}
+	uint64_t lookup_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		map.erase(p_keys[i]);
+	}
+	uint64_t remove_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("%-18s insert %6d usec, lookup %6d usec (%d found), remove %6d usec\n", "Map", int(insert_usec), int(lookup_usec), found, int(remove_usec));
+}
+
+static void _bench_hash_map(const uint32_t *p_keys, int p_count) {
+
+	HashMap<uint32_t, int> map;
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		map[p_keys[i]] = i;
+	}
+	uint64_t insert_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	int found = 0;
+	for (int i = 0; i < p_count; i++) {
+		found += map.has(p_keys[i]) ? 1 : 0;
+	}
+	uint64_t lookup_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_count; i++) {
+		map.erase(p_keys[i]);
+	}
+	uint64_t remove_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("%-18s insert %6d usec, lookup %6d usec (%d found), remove %6d usec\n", "HashMap", int(insert_usec), int(lookup_usec), found, int(remove_usec));
+}
+
 MainLoop *test() {
 
 	OS::get_singleton()->print("\n\n\nHello from test\n");
@@ -153,6 +236,74 @@ MainLoop *test() {
 		map.set(5, 1);
 	}
 
+	// lookup_ptr and lookup_or_insert
+	{
+		OAHashMap<int, int> map;
+
+		if (map.lookup_ptr(7) != NULL) {
+			OS::get_singleton()->print("lookup_ptr found a key in an empty map!\n");
+		}
+
+		*map.lookup_or_insert(7, 0) += 3;
+		*map.lookup_or_insert(7, 0) += 4;
+
+		int *value = map.lookup_ptr(7);
+		OS::get_singleton()->print("map[7] = %d == 7, elements %d == 1\n", value ? *value : -1, map.get_num_elements());
+	}
+
+	// ordered map keeps insertion order across removals and growth
+	{
+		OAOrderedHashMap<int, int> map;
+		const int N = 1000;
+
+		for (int i = 0; i < N; i++) {
+			map.set((i * 7919) % N, i);
+		}
+
+		// remove every other element while iterating, which must be safe
+		int idx = 0;
+		for (OAOrderedHashMap<int, int>::Iterator it = map.iter(); it.valid; it = map.next_iter(it)) {
+			if (idx++ % 2) {
+				map.remove(*it.key);
+			}
+		}
+
+		for (int i = N; i < 2 * N; i++) {
+			map.set(i, i);
+		}
+
+		bool ordered = true;
+		int expected = 0;
+		for (OAOrderedHashMap<int, int>::Iterator it = map.iter(); it.valid; it = map.next_iter(it)) {
+			if (*it.value != expected) {
+				ordered = false;
+				break;
+			}
+			expected += expected < N ? 2 : 1;
+		}
+
+		OS::get_singleton()->print("ordered map: elements %d == %d, insertion order %s\n", map.get_num_elements(), N / 2 + N, ordered ? "kept" : "BROKEN");
+	}
+
+	// benchmarks
+	{
+		const int N = 200000;
+		uint32_t *keys = memnew_arr(uint32_t, N);
+
+		Math::seed(0);
+		for (int i = 0; i < N; i++) {
+			keys[i] = Math::rand();
+		}
+
+		OS::get_singleton()->print("\n%d random int keys:\n", N);
+		_bench_oa<OAHashMap<uint32_t, int> >("OAHashMap", keys, N);
+		_bench_oa<OAOrderedHashMap<uint32_t, int> >("OAOrderedHashMap", keys, N);
+		_bench_hash_map(keys, N);
+		_bench_map(keys, N);
+
+		memdelete_arr(keys);
+	}
+
 	return NULL;
 }
 } // namespace TestOAHashMap
@@ -0,0 +1,211 @@
+/*************************************************************************/
+/*  test_occlusion.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_occlusion.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "servers/visual/occlusion_buffer.h"
+
+namespace TestOcclusion {
+
+struct Box {
+	AABB aabb;
+	bool occluded; // expected
+	const char *name;
+};
+
+// Two triangles spanning a quad, as Occluder sends them to the server.
+static void _add_quad(Vector<Vector3> &r_faces, const Vector3 &p_a, const Vector3 &p_b, const Vector3 &p_c, const Vector3 &p_d) {
+
+	r_faces.push_back(p_a);
+	r_faces.push_back(p_b);
+	r_faces.push_back(p_c);
+	r_faces.push_back(p_a);
+	r_faces.push_back(p_c);
+	r_faces.push_back(p_d);
+}
+
+static AABB _box(const Vector3 &p_center, const Vector3 &p_size) {
+
+	return AABB(p_center - p_size * 0.5, p_size);
+}
+
+static void _add_box(Vector<Box> &r_boxes, const Vector3 &p_center, const Vector3 &p_size, bool p_occluded, const char *p_name) {
+
+	Box box;
+	box.aabb = _box(p_center, p_size);
+	box.occluded = p_occluded;
+	box.name = p_name;
+	r_boxes.push_back(box);
+}
+
+static bool _check(const char *p_scene, OcclusionBuffer &p_buffer, const Vector<Box> &p_boxes, int p_expected_culled) {
+
+	int culled = 0;
+	bool pass = true;
+
+	for (int i = 0; i < p_boxes.size(); i++) {
+
+		bool occluded = p_buffer.is_occluded(p_boxes[i].aabb);
+		if (occluded) {
+			culled++;
+		}
+		if (occluded != p_boxes[i].occluded) {
+			OS::get_singleton()->print("\t%s: box '%s' %s\n", p_scene, p_boxes[i].name, occluded ? "culled but visible" : "visible but hidden");
+			pass = false;
+		}
+	}
+
+	pass = pass && culled == p_expected_culled;
+	OS::get_singleton()->print("%s: %d of %d boxes culled, %d triangles drawn\t%s\n", p_scene, culled, p_boxes.size(), p_buffer.get_triangles_drawn(), pass ? "PASS" : "FAILED");
+	return pass;
+}
+
+// A wall in front of the camera, with boxes behind it, beside it, in front
+// of it and around the camera.
+static bool _test_wall(bool p_orthogonal) {
+
+	CameraMatrix projection;
+	if (p_orthogonal) {
+		projection.set_orthogonal(14, 16.0 / 9.0, 0.05, 100);
+	} else {
+		projection.set_perspective(70, 16.0 / 9.0, 0.05, 100);
+	}
+
+	OcclusionBuffer buffer;
+	buffer.set_size(256, 144);
+	buffer.begin(projection, Transform());
+
+	// built around the origin and moved in place, both sides are drawn
+	Vector<Vector3> faces;
+	_add_quad(faces, Vector3(-5, -3, 0), Vector3(5, -3, 0), Vector3(5, 3, 0), Vector3(-5, 3, 0));
+	buffer.draw_triangles(Transform(Basis(Vector3(0, 1, 0), Math_PI), Vector3(0, 0, -10)), faces.ptr(), faces.size());
+	buffer.end();
+
+	Vector<Box> boxes;
+	_add_box(boxes, Vector3(0, 0, -20), Vector3(2, 2, 2), true, "behind");
+	_add_box(boxes, Vector3(2, 1, -12), Vector3(1, 1, 1), true, "behind, off center");
+	_add_box(boxes, Vector3(0, 0, -60), Vector3(8, 4, 8), true, "far behind");
+	_add_box(boxes, Vector3(0, 0, -10.5), Vector3(8, 4, 0.5), true, "just behind");
+	_add_box(boxes, Vector3(12, 0, -20), Vector3(2, 2, 2), false, "beside");
+	_add_box(boxes, Vector3(0, 0, -5), Vector3(2, 2, 2), false, "in front");
+	_add_box(boxes, Vector3(0, 0, -10), Vector3(2, 2, 2), false, "through");
+	_add_box(boxes, Vector3(0, 0, -20), Vector3(30, 2, 2), false, "sticking out");
+	_add_box(boxes, Vector3(0, 0, 0), Vector3(2, 2, 2), false, "around the camera");
+	_add_box(boxes, Vector3(0, 0, 20), Vector3(2, 2, 2), false, "behind the camera");
+
+	return _check(p_orthogonal ? "orthogonal wall" : "perspective wall", buffer, boxes, 4);
+}
+
+// A slope running under the camera, so it has to be clipped by the near plane.
+static bool _test_near_clip() {
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 16.0 / 9.0, 0.05, 100);
+
+	OcclusionBuffer buffer;
+	buffer.set_size(256, 144);
+	buffer.begin(projection, Transform());
+
+	Vector<Vector3> faces;
+	_add_quad(faces, Vector3(-100, -100, 5), Vector3(100, -100, 5), Vector3(100, 100, -15), Vector3(-100, 100, -15));
+	buffer.draw_triangles(Transform(), faces.ptr(), faces.size());
+	buffer.end();
+
+	Vector<Box> boxes;
+	_add_box(boxes, Vector3(0, 0, -40), Vector3(1, 1, 1), true, "behind the slope");
+	_add_box(boxes, Vector3(-10, -5, -40), Vector3(4, 4, 4), true, "behind the slope, off center");
+	_add_box(boxes, Vector3(0, 0, -2), Vector3(1, 1, 1), false, "in front of the slope");
+
+	return _check("near clipped slope", buffer, boxes, 2);
+}
+
+// Random occluders and boxes, only timed.
+static void _bench() {
+
+	const int triangle_count = 1000;
+	const int box_count = 100000;
+
+	CameraMatrix projection;
+	projection.set_perspective(70, 16.0 / 9.0, 0.05, 100);
+
+	RandomPCG rng(1);
+	Vector<Vector3> faces;
+	for (int i = 0; i < triangle_count; i++) {
+		Vector3 center(rng.randf() * 60 - 30, rng.randf() * 30 - 15, -5 - rng.randf() * 50);
+		for (int j = 0; j < 3; j++) {
+			faces.push_back(center + Vector3(rng.randf() - 0.5, rng.randf() - 0.5, rng.randf() - 0.5) * 4);
+		}
+	}
+
+	Vector<AABB> aabbs;
+	for (int i = 0; i < box_count; i++) {
+		aabbs.push_back(_box(Vector3(rng.randf() * 80 - 40, rng.randf() * 40 - 20, -5 - rng.randf() * 90), Vector3(1, 1, 1)));
+	}
+
+	OcclusionBuffer buffer;
+	buffer.set_size(256, 144);
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	buffer.begin(projection, Transform());
+	buffer.draw_triangles(Transform(), faces.ptr(), faces.size());
+	buffer.end();
+	uint64_t draw_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	int culled = 0;
+	for (int i = 0; i < box_count; i++) {
+		culled += buffer.is_occluded(aabbs[i]) ? 1 : 0;
+	}
+	uint64_t test_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("%d triangles drawn in %d usec, %d boxes tested in %d usec, %d culled\n", triangle_count, int(draw_usec), box_count, int(test_usec), culled);
+}
+
+MainLoop *test() {
+
+	int passed = 0;
+	int count = 0;
+
+	passed += _test_wall(false) ? 1 : 0;
+	count++;
+	passed += _test_wall(true) ? 1 : 0;
+	count++;
+	passed += _test_near_clip() ? 1 : 0;
+	count++;
+
+	_bench();
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestOcclusion
@@ -33,9 +33,13 @@
 #include "core/map.h"
 #include "core/math/math_funcs.h"
 #include "core/math/quick_hull.h"
+#include "core/math/random_pcg.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
 #include "core/print_string.h"
+#include "servers/physics/body_sw.h"
+#include "servers/physics/broad_phase_bvh.h"
+#include "servers/physics/broad_phase_octree.h"
 #include "servers/physics_server.h"
 #include "servers/visual_server.h"
 
@@ -435,4 +439,110 @@ MainLoop *test() {
 
 	return memnew(TestPhysicsMainLoop);
 }
+
+/* BROAD PHASE BENCHMARK */
+
+static void *_broad_phase_pair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_userdata) {
+
+	(*(int *)p_userdata)++;
+	return NULL;
+}
+
+static void _broad_phase_unpair(CollisionObjectSW *A, int p_subindex_A, CollisionObjectSW *B, int p_subindex_B, void *p_data, void *p_userdata) {
+
+	(*(int *)p_userdata)--;
+}
+
+static void _benchmark_broad_phase(const char *p_name, BroadPhaseSW *p_broad_phase, const Vector<BodySW *> &p_bodies) {
+
+	enum {
+		FRAMES = 30
+	};
+
+	int count = p_bodies.size();
+	int pairs = 0;
+	p_broad_phase->set_pair_callback(_broad_phase_pair, &pairs);
+	p_broad_phase->set_unpair_callback(_broad_phase_unpair, &pairs);
+
+	// Unit boxes at a constant density, a fifth of them static, the others moving around every frame.
+	real_t extent = Math::pow((real_t)count, (real_t)(1.0 / 3.0)) * 3.0;
+	RandomPCG rng(count);
+
+	Vector<BroadPhaseSW::ID> ids;
+	Vector<AABB> aabbs;
+	Vector<Vector3> velocities;
+	ids.resize(count);
+	aabbs.resize(count);
+	velocities.resize(count);
+
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < count; i++) {
+		ids.write[i] = p_broad_phase->create(p_bodies[i]);
+		aabbs.write[i] = AABB(Vector3(rng.random(0.0f, extent), rng.random(0.0f, extent), rng.random(0.0f, extent)), Vector3(1, 1, 1));
+		p_broad_phase->move(ids[i], aabbs[i]);
+		p_broad_phase->set_static(ids[i], i % 5 == 0);
+		if (i % 5 != 0) {
+			velocities.write[i] = Vector3(rng.random(-0.2f, 0.2f), rng.random(-0.2f, 0.2f), rng.random(-0.2f, 0.2f));
+		}
+	}
+	p_broad_phase->update();
+
+	uint64_t insert_time = OS::get_singleton()->get_ticks_usec() - begin;
+	uint64_t total_pairs = 0;
+	begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int f = 0; f < FRAMES; f++) {
+		for (int i = 0; i < count; i++) {
+			if (i % 5 == 0) {
+				continue;
+			}
+			AABB &aabb = aabbs.write[i];
+			aabb.position += velocities[i];
+			for (int j = 0; j < 3; j++) {
+				if (aabb.position[j] < 0 || aabb.position[j] > extent) {
+					velocities.write[i][j] = -velocities[i][j];
+				}
+			}
+			p_broad_phase->move(ids[i], aabb);
+		}
+		p_broad_phase->update();
+		total_pairs += pairs;
+	}
+
+	uint64_t frame_time = (OS::get_singleton()->get_ticks_usec() - begin) / FRAMES;
+
+	for (int i = 0; i < count; i++) {
+		p_broad_phase->remove(ids[i]);
+	}
+
+	OS::get_singleton()->print("%8s %6d bodies: insert %8.2f ms, frame %8.2f ms, %7d pairs, %10.0f pairs/s\n", p_name, count, insert_time / 1000.0, frame_time / 1000.0, pairs, frame_time ? (total_pairs / (double)FRAMES) * 1000000.0 / frame_time : 0.0);
+}
+
+MainLoop *test_broad_phase() {
+
+	static const int counts[] = { 1000, 10000, 50000 };
+
+	for (int i = 0; i < 3; i++) {
+
+		Vector<BodySW *> bodies;
+		for (int j = 0; j < counts[i]; j++) {
+			bodies.push_back(memnew(BodySW));
+		}
+
+		BroadPhaseSW *octree = BroadPhaseOctree::_create();
+		_benchmark_broad_phase("Octree", octree, bodies);
+		memdelete(octree);
+
+		BroadPhaseSW *bvh = BroadPhaseBVH::_create();
+		_benchmark_broad_phase("BVH", bvh, bodies);
+		memdelete(bvh);
+
+		for (int j = 0; j < bodies.size(); j++) {
+			memdelete(bodies[j]);
+		}
+	}
+
+	return NULL;
+}
 } // namespace TestPhysics
@@ -36,6 +36,7 @@
 namespace TestPhysics {
 
 MainLoop *test();
+MainLoop *test_broad_phase();
 }
 
 #endif
@@ -31,10 +31,14 @@
 #include "test_physics_2d.h"
 
 #include "core/map.h"
+#include "core/math/random_pcg.h"
 #include "core/os/main_loop.h"
 #include "core/os/os.h"
 #include "core/print_string.h"
 #include "scene/resources/texture.h"
+#include "servers/physics_2d/body_2d_sw.h"
+#include "servers/physics_2d/broad_phase_2d_bvh.h"
+#include "servers/physics_2d/broad_phase_2d_hash_grid.h"
 #include "servers/physics_2d_server.h"
 #include "servers/visual_server.h"
 
@@ -432,4 +436,249 @@ MainLoop *test() {
 
 	return memnew(TestPhysics2DMainLoop);
 }
+
+/* BROAD PHASE REPLAY */
+
+// A recorded stream of broadphase calls, replayed the same way into every broadphase.
+struct BroadPhaseOp {
+
+	enum Type {
+		CREATE,
+		MOVE,
+		SET_STATIC,
+		REMOVE,
+		UPDATE
+	};
+
+	Type type;
+	int element;
+	Rect2 rect;
+	bool _static;
+};
+
+struct BroadPhaseReplayResult {
+
+	uint64_t time;
+	int pairs;
+	uint64_t checksum; // Order independent hash of the pairs overlapping after each update.
+};
+
+struct BroadPhaseReplayPairs {
+
+	int count;
+	uint64_t hash;
+};
+
+static _FORCE_INLINE_ uint64_t _broad_phase_pair_hash(int p_a, int p_b) {
+
+	uint64_t key = p_a < p_b ? (uint64_t(p_a) << 32) | p_b : (uint64_t(p_b) << 32) | p_a;
+	key = (key ^ (key >> 31)) * 0x7fb5d329728ea185ULL;
+	return key ^ (key >> 27);
+}
+
+// Subindices are used as element indices, to identify pairs in the same way for every broadphase.
+static void *_broad_phase_pair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_userdata) {
+
+	BroadPhaseReplayPairs *pairs = (BroadPhaseReplayPairs *)p_userdata;
+	pairs->count++;
+	pairs->hash += _broad_phase_pair_hash(p_subindex_A, p_subindex_B);
+	return NULL;
+}
+
+static void _broad_phase_unpair(CollisionObject2DSW *A, int p_subindex_A, CollisionObject2DSW *B, int p_subindex_B, void *p_data, void *p_userdata) {
+
+	BroadPhaseReplayPairs *pairs = (BroadPhaseReplayPairs *)p_userdata;
+	pairs->count--;
+	pairs->hash -= _broad_phase_pair_hash(p_subindex_A, p_subindex_B);
+}
+
+static BroadPhaseReplayResult _replay_broad_phase(BroadPhase2DSW *p_broad_phase, const Vector<BroadPhaseOp> &p_ops, const Vector<Body2DSW *> &p_bodies) {
+
+	BroadPhaseReplayPairs pairs;
+	pairs.count = 0;
+	pairs.hash = 0;
+	p_broad_phase->set_pair_callback(_broad_phase_pair, &pairs);
+	p_broad_phase->set_unpair_callback(_broad_phase_unpair, &pairs);
+
+	Vector<BroadPhase2DSW::ID> ids;
+	ids.resize(p_bodies.size());
+
+	BroadPhaseReplayResult result;
+	result.checksum = 0;
+
+	const BroadPhaseOp *ops = p_ops.ptr();
+	BroadPhase2DSW::ID *id = ids.ptrw();
+	uint64_t begin = OS::get_singleton()->get_ticks_usec();
+
+	for (int i = 0; i < p_ops.size(); i++) {
+
+		const BroadPhaseOp &op = ops[i];
+		switch (op.type) {
+			case BroadPhaseOp::CREATE: {
+				id[op.element] = p_broad_phase->create(p_bodies[op.element], op.element);
+			} break;
+			case BroadPhaseOp::MOVE: {
+				p_broad_phase->move(id[op.element], op.rect);
+			} break;
+			case BroadPhaseOp::SET_STATIC: {
+				p_broad_phase->set_static(id[op.element], op._static);
+			} break;
+			case BroadPhaseOp::REMOVE: {
+				p_broad_phase->remove(id[op.element]);
+			} break;
+			case BroadPhaseOp::UPDATE: {
+				p_broad_phase->update();
+				result.checksum = result.checksum * 31 + pairs.hash + pairs.count;
+			} break;
+		}
+	}
+
+	result.time = OS::get_singleton()->get_ticks_usec() - begin;
+	result.pairs = pairs.count;
+	return result;
+}
+
+static void _record_op(Vector<BroadPhaseOp> &r_ops, BroadPhaseOp::Type p_type, int p_element, const Rect2 &p_rect = Rect2(), bool p_static = false) {
+
+	BroadPhaseOp op;
+	op.type = p_type;
+	op.element = p_element;
+	op.rect = p_rect;
+	op._static = p_static;
+	r_ops.push_back(op);
+}
+
+// Records a level mixing a few huge static walls, mid-sized bodies and many tiny bullets,
+// which are fired across the world and expire (removed and created again) when they leave it.
+static Vector<BroadPhaseOp> _record_broad_phase_stream(real_t p_extent, int p_walls, int p_bodies, int p_bullets, int p_frames, int &r_elements) {
+
+	RandomPCG rng(p_walls + p_bodies + p_bullets);
+	Vector<BroadPhaseOp> ops;
+
+	int count = p_walls + p_bodies + p_bullets;
+	Vector<Rect2> rects;
+	Vector<Vector2> velocities;
+	rects.resize(count);
+	velocities.resize(count);
+
+	for (int i = 0; i < count; i++) {
+
+		Rect2 &rect = rects.write[i];
+		Vector2 &velocity = velocities.write[i];
+
+		if (i < p_walls) {
+			real_t length = rng.random(p_extent * 0.01f, p_extent * 0.5f);
+			Vector2 size = i % 2 ? Vector2(length, 32) : Vector2(32, length);
+			rect = Rect2(Vector2(rng.random(0.0f, p_extent), rng.random(0.0f, p_extent)), size);
+			velocity = Vector2();
+		} else if (i < p_walls + p_bodies) {
+			real_t size = rng.random(16.0f, 128.0f);
+			rect = Rect2(Vector2(rng.random(0.0f, p_extent), rng.random(0.0f, p_extent)), Vector2(size, size));
+			velocity = Vector2(rng.random(-4.0f, 4.0f), rng.random(-4.0f, 4.0f));
+		} else {
+			rect = Rect2(Vector2(rng.random(0.0f, p_extent), rng.random(0.0f, p_extent)), Vector2(4, 4));
+			velocity = Vector2(rng.random(-32.0f, 32.0f), rng.random(-32.0f, 32.0f));
+		}
+
+		_record_op(ops, BroadPhaseOp::CREATE, i);
+		_record_op(ops, BroadPhaseOp::MOVE, i, rect);
+		_record_op(ops, BroadPhaseOp::SET_STATIC, i, Rect2(), i < p_walls);
+	}
+	_record_op(ops, BroadPhaseOp::UPDATE, -1);
+
+	for (int f = 0; f < p_frames; f++) {
+
+		for (int i = p_walls; i < count; i++) {
+
+			Rect2 &rect = rects.write[i];
+			Vector2 &velocity = velocities.write[i];
+			rect.position += velocity;
+
+			bool outside = rect.position.x < 0 || rect.position.y < 0 || rect.position.x > p_extent || rect.position.y > p_extent;
+
+			if (outside && i >= p_walls + p_bodies) {
+				// Expired bullet, fire a new one.
+				_record_op(ops, BroadPhaseOp::REMOVE, i);
+				rect.position = Vector2(rng.random(0.0f, p_extent), rng.random(0.0f, p_extent));
+				_record_op(ops, BroadPhaseOp::CREATE, i);
+				_record_op(ops, BroadPhaseOp::MOVE, i, rect);
+				_record_op(ops, BroadPhaseOp::SET_STATIC, i, Rect2(), false);
+				continue;
+			}
+
+			if (outside) {
+				velocity = -velocity;
+			}
+			_record_op(ops, BroadPhaseOp::MOVE, i, rect);
+		}
+
+		_record_op(ops, BroadPhaseOp::UPDATE, -1);
+	}
+
+	for (int i = 0; i < count; i++) {
+		_record_op(ops, BroadPhaseOp::REMOVE, i);
+	}
+
+	r_elements = count;
+	return ops;
+}
+
+MainLoop *test_broad_phase() {
+
+	struct Level {
+		const char *name;
+		real_t extent;
+		int walls;
+		int bodies;
+		int bullets;
+	};
+
+	static const Level levels[] = {
+		{ "small", 4096, 20, 500, 1000 },
+		{ "large", 65536, 200, 5000, 10000 },
+		{ "sparse", 1048576, 200, 2000, 2000 },
+	};
+
+	enum {
+		FRAMES = 60
+	};
+
+	bool success = true;
+
+	for (int i = 0; i < 3; i++) {
+
+		const Level &level = levels[i];
+		int count;
+		Vector<BroadPhaseOp> ops = _record_broad_phase_stream(level.extent, level.walls, level.bodies, level.bullets, FRAMES, count);
+
+		Vector<Body2DSW *> bodies;
+		for (int j = 0; j < count; j++) {
+			bodies.push_back(memnew(Body2DSW));
+		}
+
+		BroadPhase2DSW *hash_grid = BroadPhase2DHashGrid::_create();
+		BroadPhaseReplayResult hash_grid_result = _replay_broad_phase(hash_grid, ops, bodies);
+		memdelete(hash_grid);
+
+		BroadPhase2DSW *bvh = BroadPhase2DBVH::_create();
+		BroadPhaseReplayResult bvh_result = _replay_broad_phase(bvh, ops, bodies);
+		memdelete(bvh);
+
+		OS::get_singleton()->print("%6s level, %5d objects, %7d ops: HashGrid %8.2f ms, BVH %8.2f ms\n", level.name, count, ops.size(), hash_grid_result.time / 1000.0, bvh_result.time / 1000.0);
+
+		// Both must report the same pairs after every update, and none once everything is removed.
+		if (hash_grid_result.checksum != bvh_result.checksum || hash_grid_result.pairs != 0 || bvh_result.pairs != 0) {
+			OS::get_singleton()->print("\tFAIL: pairs differ between HashGrid and BVH.\n");
+			success = false;
+		}
+
+		for (int j = 0; j < bodies.size(); j++) {
+			memdelete(bodies[j]);
+		}
+	}
+
+	OS::get_singleton()->print("Broad phase replay %s\n", success ? "OK" : "FAILED");
+
+	return NULL;
+}
 } // namespace TestPhysics2D
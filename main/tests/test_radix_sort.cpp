@@ -0,0 +1,241 @@
+/*************************************************************************/
+/*  test_radix_sort.cpp                                                  */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_radix_sort.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/radix_sort.h"
+#include "core/sort_array.h"
+#include "core/vector.h"
+
+namespace TestRadixSort {
+
+// Stands in for a render list element, index records the insertion order.
+struct Element {
+	uint64_t sort_key;
+	uint32_t depth_key;
+	int index;
+};
+
+struct SortKey {
+	_FORCE_INLINE_ uint64_t operator()(const Element *A) const { return A->sort_key; }
+};
+
+struct DepthKey {
+	_FORCE_INLINE_ uint64_t operator()(const Element *A) const { return A->depth_key; }
+};
+
+// Insertion order breaks ties, so the result is what a stable sort gives.
+struct SortByKeyStable {
+	_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const {
+		return A->sort_key == B->sort_key ? A->index < B->index : A->sort_key < B->sort_key;
+	}
+};
+
+struct SortByDepthAndKeyStable {
+	_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const {
+		if (A->depth_key != B->depth_key) {
+			return A->depth_key < B->depth_key;
+		}
+		return A->sort_key == B->sort_key ? A->index < B->index : A->sort_key < B->sort_key;
+	}
+};
+
+// Keys laid out like the GLES3 render list: a priority, a few shading flags,
+// material and geometry indices, with lots of repeats.
+static uint64_t _render_list_key(RandomPCG &p_rng) {
+
+	uint64_t key = uint64_t(128 + p_rng.rand() % 2) << 56;
+	key |= uint64_t(p_rng.rand() % 4) << 44;
+	key |= uint64_t(p_rng.rand() % 40) << 28;
+	key |= uint64_t(p_rng.rand() % 200) << 8;
+	key |= p_rng.rand() % 4;
+	return key;
+}
+
+static void _make_elements(Vector<Element> &r_elements, int p_count, bool p_render_list_keys, RandomPCG &p_rng) {
+
+	r_elements.resize(p_count);
+	for (int i = 0; i < p_count; i++) {
+		Element &e = r_elements.write[i];
+		if (p_render_list_keys) {
+			e.sort_key = _render_list_key(p_rng);
+		} else {
+			e.sort_key = (uint64_t(p_rng.rand()) << 32) | p_rng.rand();
+		}
+		e.depth_key = p_rng.rand() % 8;
+		e.index = i;
+	}
+}
+
+static void _make_pointers(Vector<Element> &p_elements, Vector<Element *> &r_pointers) {
+
+	r_pointers.resize(p_elements.size());
+	for (int i = 0; i < p_elements.size(); i++) {
+		r_pointers.write[i] = &p_elements.write[i];
+	}
+}
+
+static bool _test_sort(const char *p_name, int p_count, bool p_render_list_keys, bool p_depth) {
+
+	RandomPCG rng(p_count + 1);
+	Vector<Element> elements;
+	_make_elements(elements, p_count, p_render_list_keys, rng);
+
+	Vector<Element *> expected;
+	_make_pointers(elements, expected);
+	if (p_depth) {
+		SortArray<Element *, SortByDepthAndKeyStable> sorter;
+		sorter.sort(expected.ptrw(), expected.size());
+	} else {
+		SortArray<Element *, SortByKeyStable> sorter;
+		sorter.sort(expected.ptrw(), expected.size());
+	}
+
+	Vector<Element *> sorted;
+	_make_pointers(elements, sorted);
+	Vector<Element *> tmp;
+	tmp.resize(p_count);
+
+	RadixSort<Element *, SortKey> key_sorter;
+	key_sorter.sort(sorted.ptrw(), sorted.size(), tmp.ptrw());
+	if (p_depth) {
+		RadixSort<Element *, DepthKey> depth_sorter;
+		depth_sorter.sort(sorted.ptrw(), sorted.size(), tmp.ptrw());
+	}
+
+	bool pass = true;
+	for (int i = 0; i < p_count; i++) {
+		if (sorted[i] != expected[i]) {
+			OS::get_singleton()->print("\t%s: mismatch at %d\n", p_name, i);
+			pass = false;
+			break;
+		}
+	}
+
+	OS::get_singleton()->print("%s, %d elements\t%s\n", p_name, p_count, pass ? "PASS" : "FAILED");
+	return pass;
+}
+
+// Plain integers through the default key.
+static bool _test_integers() {
+
+	RandomPCG rng(7);
+	Vector<uint32_t> values;
+	for (int i = 0; i < 1000; i++) {
+		values.push_back(rng.rand());
+	}
+	Vector<uint32_t> tmp;
+	tmp.resize(values.size());
+
+	RadixSort<uint32_t> sorter;
+	sorter.sort(values.ptrw(), values.size(), tmp.ptrw());
+
+	bool pass = true;
+	for (int i = 1; i < values.size(); i++) {
+		if (values[i - 1] > values[i]) {
+			pass = false;
+			break;
+		}
+	}
+
+	OS::get_singleton()->print("integers\t%s\n", pass ? "PASS" : "FAILED");
+	return pass;
+}
+
+// Compares against SortArray, as used by the render lists below the radix sort threshold.
+static void _bench(int p_count) {
+
+	const int iterations = MAX(1, 1000000 / p_count);
+
+	RandomPCG rng(3);
+	Vector<Element> elements;
+	_make_elements(elements, p_count, true, rng);
+
+	Vector<Element *> pointers;
+	_make_pointers(elements, pointers);
+	Vector<Element *> work;
+	work.resize(p_count);
+	Vector<Element *> tmp;
+	tmp.resize(p_count);
+
+	struct SortByKey {
+		_FORCE_INLINE_ bool operator()(const Element *A, const Element *B) const { return A->sort_key < B->sort_key; }
+	};
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		work = pointers;
+		SortArray<Element *, SortByKey> sorter;
+		sorter.sort(work.ptrw(), p_count);
+	}
+	uint64_t sort_array_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < iterations; i++) {
+		work = pointers;
+		RadixSort<Element *, SortKey> sorter;
+		sorter.sort(work.ptrw(), p_count, tmp.ptrw());
+	}
+	uint64_t radix_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	OS::get_singleton()->print("%d elements: SortArray %.2f usec, RadixSort %.2f usec\n", p_count, double(sort_array_usec) / iterations, double(radix_usec) / iterations);
+}
+
+MainLoop *test() {
+
+	int passed = 0;
+	int count = 0;
+
+	static const int sizes[] = { 0, 1, 2, 17, 256, 1000, 65536 };
+	for (int i = 0; i < 7; i++) {
+		passed += _test_sort("random keys", sizes[i], false, false) ? 1 : 0;
+		count++;
+		passed += _test_sort("render list keys", sizes[i], true, false) ? 1 : 0;
+		count++;
+		passed += _test_sort("depth then render list keys", sizes[i], true, true) ? 1 : 0;
+		count++;
+	}
+
+	passed += _test_integers() ? 1 : 0;
+	count++;
+
+	_bench(256);
+	_bench(1024);
+	_bench(2048);
+	_bench(4096);
+	_bench(65536);
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestRadixSort
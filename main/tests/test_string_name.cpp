@@ -0,0 +1,216 @@
+/*************************************************************************/
+/*  test_string_name.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_string_name.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_name.h"
+#include "core/vector.h"
+
+namespace TestStringName {
+
+enum {
+	NAME_COUNT = 4096,
+	ITERATIONS = 200000,
+	MAX_THREADS = 8,
+	CHURN_NAMES = 16384,
+	CHURN_ROUNDS = 8
+};
+
+struct ThreadData {
+	const Vector<String> *names;
+	int offset;
+	StringName first;
+	StringName last;
+};
+
+// Mixes lookups of names that already exist (the common case) with names
+// that are created and released again on every iteration.
+static void _create_names(void *p_userdata) {
+
+	ThreadData *data = (ThreadData *)p_userdata;
+	const Vector<String> &names = *data->names;
+
+	for (int i = 0; i < ITERATIONS; i++) {
+
+		StringName name = names[(data->offset + i) % NAME_COUNT];
+		if ((i & 7) == 0) {
+			StringName unique = String("_tmp_") + itos(data->offset) + "_" + itos(i & 255);
+		}
+		if (i == 0) {
+			data->first = name;
+		}
+		data->last = name;
+	}
+}
+
+static bool _bench(const Vector<String> &p_names, int p_threads) {
+
+	ThreadData data[MAX_THREADS];
+	Thread *threads[MAX_THREADS];
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_threads; i++) {
+		data[i].names = &p_names;
+		data[i].offset = i * 97;
+		threads[i] = Thread::create(_create_names, &data[i]);
+	}
+	for (int i = 0; i < p_threads; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	// Every thread must get the same interned names.
+	bool pass = true;
+	for (int i = 0; i < p_threads; i++) {
+		pass = pass && data[i].first == StringName(p_names[data[i].offset % NAME_COUNT]);
+		pass = pass && data[i].last == StringName(p_names[(data[i].offset + ITERATIONS - 1) % NAME_COUNT]);
+	}
+
+	OS::get_singleton()->print("%d thread(s): %7d usec, %6d names/msec\t%s\n", p_threads, int(usec), int(uint64_t(ITERATIONS) * p_threads * 1000 / MAX(usec, (uint64_t)1)), pass ? "PASS" : "FAILED");
+	return pass;
+}
+
+struct ChurnData {
+	int offset;
+	Vector<StringName> kept;
+	bool pass;
+};
+
+static String _churn_name(int p_idx) {
+
+	return "_churn_" + itos(p_idx);
+}
+
+// Every thread creates the same set of names, each starting at a different
+// point, and drops them again at the end of the round. The names don't exist
+// beforehand, so threads race on creating them, on releasing the last
+// reference while others look them up, and on growing the shards. The last
+// round is kept so the main thread can check all threads share the entries.
+static void _churn_names(void *p_userdata) {
+
+	ChurnData *data = (ChurnData *)p_userdata;
+	data->pass = true;
+
+	for (int round = 0; round < CHURN_ROUNDS; round++) {
+
+		Vector<StringName> held;
+		held.resize(CHURN_NAMES);
+		for (int i = 0; i < CHURN_NAMES; i++) {
+			int idx = (data->offset + i * 7) % CHURN_NAMES;
+			held.write[idx] = _churn_name(idx);
+		}
+		for (int i = 0; i < CHURN_NAMES; i++) {
+			if (held[i] != _churn_name(i)) {
+				data->pass = false;
+			}
+		}
+		if (round == CHURN_ROUNDS - 1) {
+			data->kept = held;
+		}
+	}
+}
+
+static bool _churn(int p_threads) {
+
+	ChurnData data[MAX_THREADS];
+	Thread *threads[MAX_THREADS];
+
+	uint64_t from = OS::get_singleton()->get_ticks_usec();
+	for (int i = 0; i < p_threads; i++) {
+		data[i].offset = i * (CHURN_NAMES / MAX_THREADS);
+		threads[i] = Thread::create(_churn_names, &data[i]);
+	}
+	for (int i = 0; i < p_threads; i++) {
+		Thread::wait_to_finish(threads[i]);
+		memdelete(threads[i]);
+	}
+	uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+
+	bool pass = true;
+	for (int i = 0; i < p_threads; i++) {
+		pass = pass && data[i].pass && data[i].kept.size() == CHURN_NAMES;
+	}
+	// Names alive at the same time must be the same entry everywhere.
+	for (int i = 0; pass && i < CHURN_NAMES; i++) {
+		StringName name = StringName::search(_churn_name(i));
+		for (int j = 0; j < p_threads; j++) {
+			pass = pass && data[j].kept[i] == name;
+		}
+	}
+
+	for (int i = 0; i < p_threads; i++) {
+		data[i].kept.clear();
+	}
+	// Once the last reference is gone the name must not be found anymore.
+	for (int i = 0; pass && i < CHURN_NAMES; i++) {
+		pass = StringName::search(_churn_name(i)) == StringName();
+	}
+
+	OS::get_singleton()->print("%d thread(s): %7d usec churning %d names\t%s\n", p_threads, int(usec), int(CHURN_NAMES), pass ? "PASS" : "FAILED");
+	return pass;
+}
+
+MainLoop *test() {
+
+	Vector<String> names;
+	for (int i = 0; i < NAME_COUNT; i++) {
+		names.push_back("name_" + itos(i));
+	}
+
+	// Keep the shared names alive, as engine code holding them would.
+	Vector<StringName> held;
+	for (int i = 0; i < NAME_COUNT; i++) {
+		held.push_back(names[i]);
+	}
+
+	OS::get_singleton()->print("StringName creation, %d per thread\n", int(ITERATIONS));
+
+	int passed = 0;
+	int count = 0;
+	for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		passed += _bench(names, threads) ? 1 : 0;
+		count++;
+	}
+
+	OS::get_singleton()->print("StringName create and release, %d rounds per thread\n", int(CHURN_ROUNDS));
+
+	for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+		passed += _churn(threads) ? 1 : 0;
+		count++;
+	}
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestStringName
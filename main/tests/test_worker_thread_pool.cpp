@@ -0,0 +1,151 @@
+/*************************************************************************/
+/*  test_worker_thread_pool.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_worker_thread_pool.h"
+
+#include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/safe_refcount.h"
+
+namespace TestWorkerThreadPool {
+
+enum {
+	GROUP_ELEMENTS = 64,
+	GROUP_SLICES = 4,
+	ROUNDS = 50,
+};
+
+struct GroupState {
+	uint32_t done[GROUP_ELEMENTS];
+	uint32_t done_count;
+	uint32_t seen_by_dependent;
+};
+
+static void _group_element(void *p_userdata, uint32_t p_index) {
+
+	GroupState *state = (GroupState *)p_userdata;
+	OS::get_singleton()->delay_usec(100 + (p_index % 3) * 100);
+	atomic_increment(&state->done[p_index]);
+	atomic_increment(&state->done_count);
+}
+
+static void _dependent(void *p_userdata) {
+
+	GroupState *state = (GroupState *)p_userdata;
+	state->seen_by_dependent = atomic_add(&state->done_count, 0);
+}
+
+// Each element runs exactly once and a dependent only starts once all of them
+// have returned, including the ones run by the thread waiting for the group.
+static bool _test_group_dependency(WorkerThreadPool *p_pool) {
+
+	for (int round = 0; round < ROUNDS; round++) {
+
+		GroupState state;
+		for (int i = 0; i < GROUP_ELEMENTS; i++) {
+			state.done[i] = 0;
+		}
+		state.done_count = 0;
+		state.seen_by_dependent = 0;
+
+		WorkerThreadPool::TaskID group = p_pool->add_native_group_task(_group_element, &state, GROUP_ELEMENTS, GROUP_SLICES);
+		Vector<WorkerThreadPool::TaskID> dependencies;
+		dependencies.push_back(group);
+		WorkerThreadPool::TaskID dependent = p_pool->add_native_task(_dependent, &state, dependencies);
+
+		p_pool->wait_for_task_completion(group);
+		p_pool->wait_for_task_completion(dependent);
+
+		if (state.seen_by_dependent != GROUP_ELEMENTS) {
+			OS::get_singleton()->print("\tround %d: dependent started after %d of %d elements\n", round, state.seen_by_dependent, GROUP_ELEMENTS);
+			return false;
+		}
+		for (int i = 0; i < GROUP_ELEMENTS; i++) {
+			if (state.done[i] != 1) {
+				OS::get_singleton()->print("\tround %d: element %d ran %d times\n", round, i, state.done[i]);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// An empty group still completes and releases its dependents.
+static bool _test_empty_group(WorkerThreadPool *p_pool) {
+
+	GroupState state;
+	state.done_count = 0;
+	state.seen_by_dependent = 1;
+
+	WorkerThreadPool::TaskID group = p_pool->add_native_group_task(_group_element, &state, 0, GROUP_SLICES);
+	Vector<WorkerThreadPool::TaskID> dependencies;
+	dependencies.push_back(group);
+	WorkerThreadPool::TaskID dependent = p_pool->add_native_task(_dependent, &state, dependencies);
+
+	p_pool->wait_for_task_completion(dependent);
+	p_pool->wait_for_task_completion(group);
+
+	return state.seen_by_dependent == 0;
+}
+
+MainLoop *test() {
+
+	// Use the engine pool when there is one, it can't be replaced while running.
+	WorkerThreadPool *own_pool = NULL;
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	if (!pool) {
+		own_pool = memnew(WorkerThreadPool);
+		own_pool->init(4);
+		pool = own_pool;
+	}
+
+	int passed = 0;
+	int count = 0;
+
+	bool pass = _test_group_dependency(pool);
+	OS::get_singleton()->print("group completes after all its elements\t%s\n", pass ? "PASS" : "FAILED");
+	passed += pass ? 1 : 0;
+	count++;
+
+	pass = _test_empty_group(pool);
+	OS::get_singleton()->print("empty group\t%s\n", pass ? "PASS" : "FAILED");
+	passed += pass ? 1 : 0;
+	count++;
+
+	if (own_pool) {
+		memdelete(own_pool);
+	}
+
+	OS::get_singleton()->print("Passed %i of %i tests\n", passed, count);
+
+	return NULL;
+}
+} // namespace TestWorkerThreadPool
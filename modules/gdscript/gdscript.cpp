@@ -31,13 +31,16 @@
 #include "gdscript.h"
 
 #include "core/core_string_names.h"
+#include "core/crypto/crypto_core.h"
 #include "core/engine.h"
 #include "core/global_constants.h"
 #include "core/io/file_access_encrypted.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/project_settings.h"
+#include "gdscript_compiled_cache.h"
 #include "gdscript_compiler.h"
+#include "gdscript_sampling_profiler.h"
 
 ///////////////////////////
 
@@ -566,6 +569,16 @@ Error GDScript::reload(bool p_keep_state) {
 	}
 
 	valid = false;
+
+	bool use_compiled_cache = !p_keep_state && GDScriptCompiledCache::is_enabled() && path.begins_with("res://");
+	Vector<uint8_t> source_hash;
+	if (use_compiled_cache) {
+		source_hash = source.md5_buffer();
+		if (_load_compiled_cache(source_hash)) {
+			return OK;
+		}
+	}
+
 	GDScriptParser parser;
 	Error err = parser.parse(source, basedir, false, path);
 	if (err) {
@@ -580,6 +593,7 @@ Error GDScript::reload(bool p_keep_state) {
 
 	GDScriptCompiler compiler;
 	err = compiler.compile(&parser, this, p_keep_state);
+	GDScriptFunction::invalidate_inline_caches();
 
 	if (err) {
 
@@ -610,9 +624,29 @@ Error GDScript::reload(bool p_keep_state) {
 		_set_subclass_path(E->get(), path);
 	}
 
+	if (use_compiled_cache) {
+		GDScriptCompiledCache::save(this, source_hash);
+	}
+
 	return OK;
 }
 
+bool GDScript::_load_compiled_cache(const Vector<uint8_t> &p_source_hash) {
+
+	if (GDScriptCompiledCache::load(this, p_source_hash) != OK) {
+		return false;
+	}
+
+	valid = true;
+
+	for (Map<StringName, Ref<GDScript> >::Element *E = subclasses.front(); E; E = E->next()) {
+
+		_set_subclass_path(E->get(), path);
+	}
+
+	return true;
+}
+
 ScriptLanguage *GDScript::get_language() const {
 
 	return GDScriptLanguage::get_singleton();
@@ -771,6 +805,17 @@ Error GDScript::load_byte_code(const String &p_path) {
 		basedir = basedir.get_base_dir();
 
 	valid = false;
+
+	bool use_compiled_cache = GDScriptCompiledCache::is_enabled() && path.begins_with("res://");
+	Vector<uint8_t> source_hash;
+	if (use_compiled_cache) {
+		source_hash.resize(16);
+		CryptoCore::md5(bytecode.ptr(), bytecode.size(), source_hash.ptrw());
+		if (_load_compiled_cache(source_hash)) {
+			return OK;
+		}
+	}
+
 	GDScriptParser parser;
 	Error err = parser.parse_bytecode(bytecode, basedir, get_path());
 	if (err) {
@@ -793,6 +838,10 @@ Error GDScript::load_byte_code(const String &p_path) {
 		_set_subclass_path(E->get(), path);
 	}
 
+	if (use_compiled_cache) {
+		GDScriptCompiledCache::save(this, source_hash);
+	}
+
 	return OK;
 }
 
@@ -916,6 +965,8 @@ GDScript::GDScript() :
 }
 
 GDScript::~GDScript() {
+	GDScriptFunction::invalidate_inline_caches();
+
 	for (Map<StringName, GDScriptFunction *>::Element *E = member_functions.front(); E; E = E->next()) {
 		memdelete(E->get());
 	}
@@ -1412,6 +1463,9 @@ void GDScriptLanguage::init() {
 
 		_add_global(E->get().name, E->get().ptr);
 	}
+
+	GDScriptCompiledCache::initialize();
+	GDScriptSamplingProfiler::initialize();
 }
 
 String GDScriptLanguage::get_type() const {
@@ -1428,6 +1482,8 @@ Error GDScriptLanguage::execute_file(const String &p_path) {
 	return OK;
 }
 void GDScriptLanguage::finish() {
+
+	GDScriptSamplingProfiler::finish();
 }
 
 void GDScriptLanguage::profiling_start() {
@@ -2136,6 +2192,8 @@ GDScriptLanguage::GDScriptLanguage() {
 		_call_stack = NULL;
 	}
 
+	GLOBAL_DEF("gdscript/compiled_cache/enabled", true);
+
 #ifdef DEBUG_ENABLED
 	GLOBAL_DEF("debug/gdscript/warnings/enable", true);
 	GLOBAL_DEF("debug/gdscript/warnings/treat_warnings_as_errors", false);
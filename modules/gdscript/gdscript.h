@@ -72,6 +72,7 @@ class GDScript : public Script {
 	friend class GDScriptCompiler;
 	friend class GDScriptFunctions;
 	friend class GDScriptLanguage;
+	friend class GDScriptCompiledCache;
 
 	Variant _static_ref; //used for static call
 	Ref<GDScriptNativeClass> native;
@@ -116,6 +117,7 @@ class GDScript : public Script {
 	GDScriptInstance *_create_instance(const Variant **p_args, int p_argcount, Object *p_owner, bool p_isref, Variant::CallError &r_error);
 
 	void _set_subclass_path(Ref<GDScript> &p_sc, const String &p_path);
+	bool _load_compiled_cache(const Vector<uint8_t> &p_source_hash);
 
 #ifdef TOOLS_ENABLED
 	Set<PlaceHolderScriptInstance *> placeholders;
@@ -350,6 +352,7 @@ class GDScriptLanguage : public ScriptLanguage {
 	friend class GDScriptFunction;
 
 	SelfList<GDScriptFunction>::List function_list;
+	friend class GDScriptSamplingProfiler;
 	bool profiling;
 	uint64_t script_frame_time;
 
@@ -359,27 +362,35 @@ public:
 	bool debug_break(const String &p_error, bool p_allow_continue = true);
 	bool debug_break_parse(const String &p_file, int p_line, const String &p_error);
 
+	// The call stack is tracked for the debugger and the sampling profiler.
+	_FORCE_INLINE_ bool is_tracking_call_stack() const { return _call_stack != NULL; }
+
 	_FORCE_INLINE_ void enter_function(GDScriptInstance *p_instance, GDScriptFunction *p_function, Variant *p_stack, int *p_ip, int *p_line) {
 
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() + 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() + 1);
 
 		if (_debug_call_stack_pos >= _debug_max_call_stack) {
 			//stack overflow
 			_debug_error = "Stack Overflow (Stack Size: " + itos(_debug_max_call_stack) + ")";
-			ScriptDebugger::get_singleton()->debug(this);
+			if (debugger)
+				debugger->debug(this);
 			return;
 		}
 
 		_call_stack[_debug_call_stack_pos].stack = p_stack;
 		_call_stack[_debug_call_stack_pos].instance = p_instance;
-		_call_stack[_debug_call_stack_pos].function = p_function;
+		atomic_store_release(&_call_stack[_debug_call_stack_pos].function, p_function);
 		_call_stack[_debug_call_stack_pos].ip = p_ip;
 		_call_stack[_debug_call_stack_pos].line = p_line;
-		_debug_call_stack_pos++;
+		// The sampling profiler reads the stack from its own thread, only make
+		// the level visible to it once it's filled in.
+		atomic_store_release((volatile uint32_t *)&_debug_call_stack_pos, _debug_call_stack_pos + 1);
 	}
 
 	_FORCE_INLINE_ void exit_function() {
@@ -387,17 +398,20 @@ public:
 		if (Thread::get_main_id() != Thread::get_caller_id())
 			return; //no support for other threads than main for now
 
-		if (ScriptDebugger::get_singleton()->get_lines_left() > 0 && ScriptDebugger::get_singleton()->get_depth() >= 0)
-			ScriptDebugger::get_singleton()->set_depth(ScriptDebugger::get_singleton()->get_depth() - 1);
+		ScriptDebugger *debugger = ScriptDebugger::get_singleton();
+
+		if (debugger && debugger->get_lines_left() > 0 && debugger->get_depth() >= 0)
+			debugger->set_depth(debugger->get_depth() - 1);
 
 		if (_debug_call_stack_pos == 0) {
 
 			_debug_error = "Stack Underflow (Engine Bug)";
-			ScriptDebugger::get_singleton()->debug(this);
+			if (debugger)
+				debugger->debug(this);
 			return;
 		}
 
-		_debug_call_stack_pos--;
+		atomic_store_release((volatile uint32_t *)&_debug_call_stack_pos, _debug_call_stack_pos - 1);
 	}
 
 	virtual Vector<StackInfo> debug_get_current_stack_info() {
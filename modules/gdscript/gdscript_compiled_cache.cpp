@@ -0,0 +1,988 @@
+/*************************************************************************/
+/*  gdscript_compiled_cache.cpp                                          */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_compiled_cache.h"
+
+#include "core/crypto/crypto_core.h"
+#include "core/engine.h"
+#include "core/io/marshalls.h"
+#include "core/io/resource_loader.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/project_settings.h"
+#include "core/version.h"
+#include "gdscript.h"
+
+#define CACHE_DIR "user://gdscript_cache"
+
+const char *GDScriptCompiledCache::EXPORT_ID_PATH = "res://.gdscript_export_id";
+
+bool GDScriptCompiledCache::enabled = false;
+String GDScriptCompiledCache::export_id;
+
+static uint32_t _get_build_flags() {
+
+	uint32_t flags = 0;
+#ifdef DEBUG_ENABLED
+	flags |= 1;
+#endif
+#ifdef TOOLS_ENABLED
+	flags |= 2;
+#endif
+	// Stack debug info and profiler signatures are only generated with a debugger.
+	if (ScriptDebugger::get_singleton()) {
+		flags |= 4;
+	}
+	return flags;
+}
+
+// Compiled code refers to globals (native classes, singletons, constants) by
+// their index in the global table, which depends on the engine build and the
+// project's autoloads.
+static uint32_t _get_globals_hash() {
+
+	const Map<StringName, int> &globals = GDScriptLanguage::get_singleton()->get_global_map();
+	uint32_t hash = hash_djb2_one_32(globals.size());
+	for (const Map<StringName, int>::Element *E = globals.front(); E; E = E->next()) {
+		hash = hash_djb2_one_32(E->key().hash(), hash);
+		hash = hash_djb2_one_32(E->get(), hash);
+	}
+	return hash;
+}
+
+static String _get_cache_path(const String &p_script_path) {
+
+	return String(CACHE_DIR).plus_file(p_script_path.md5_text() + ".gdcache");
+}
+
+static bool _has_objects(const Variant &p_value) {
+
+	switch (p_value.get_type()) {
+		case Variant::OBJECT: {
+			return true;
+		} break;
+		case Variant::ARRAY: {
+			Array array = p_value;
+			for (int i = 0; i < array.size(); i++) {
+				if (_has_objects(array[i])) {
+					return true;
+				}
+			}
+		} break;
+		case Variant::DICTIONARY: {
+			Dictionary dict = p_value;
+			List<Variant> keys;
+			dict.get_key_list(&keys);
+			for (List<Variant>::Element *E = keys.front(); E; E = E->next()) {
+				if (_has_objects(E->get()) || _has_objects(dict[E->get()])) {
+					return true;
+				}
+			}
+		} break;
+		default: {
+		}
+	}
+	return false;
+}
+
+/* WRITING */
+
+void GDScriptCompiledCache::_put_8(uint8_t p_value) {
+
+	_put_buffer(&p_value, 1);
+}
+
+void GDScriptCompiledCache::_put_32(uint32_t p_value) {
+
+	uint8_t buf[4];
+	encode_uint32(p_value, buf);
+	_put_buffer(buf, 4);
+}
+
+void GDScriptCompiledCache::_put_buffer(const void *p_data, int p_size) {
+
+	if (pos + p_size > buffer.size()) {
+		buffer.resize(MAX(buffer.size() * 2, pos + p_size));
+	}
+	copymem(buffer.ptrw() + pos, p_data, p_size);
+	pos += p_size;
+}
+
+void GDScriptCompiledCache::_put_string(const String &p_string) {
+
+	CharString utf8 = p_string.utf8();
+	_put_32(utf8.length());
+	_put_buffer(utf8.get_data(), utf8.length());
+}
+
+bool GDScriptCompiledCache::_put_value(const Variant &p_value) {
+
+	if (p_value.get_type() != Variant::OBJECT) {
+
+		// Objects inside containers can't be referred to.
+		if (_has_objects(p_value)) {
+			return false;
+		}
+
+		int len;
+		Error err = encode_variant(p_value, NULL, len);
+		if (err != OK) {
+			return false;
+		}
+		Vector<uint8_t> data;
+		data.resize(len);
+		encode_variant(p_value, data.ptrw(), len);
+
+		_put_8(VALUE_VARIANT);
+		_put_32(len);
+		_put_buffer(data.ptr(), len);
+		return true;
+	}
+
+	Object *obj = p_value;
+	if (!obj) {
+		_put_8(VALUE_NULL_OBJECT);
+		return true;
+	}
+
+	GDScriptNativeClass *native = Object::cast_to<GDScriptNativeClass>(obj);
+	if (native) {
+		_put_8(VALUE_NATIVE_CLASS);
+		_put_string(native->get_name());
+		return true;
+	}
+
+	GDScript *gdscript = Object::cast_to<GDScript>(obj);
+	if (gdscript) {
+
+		Vector<StringName> names;
+		GDScript *root = gdscript;
+		while (root->_owner) {
+			names.push_back(root->name);
+			root = root->_owner;
+		}
+
+		// Classes from the script being stored are looked up in it, others are loaded.
+		String root_path;
+		if (root != script) {
+			root_path = root->get_path();
+			if (!root_path.begins_with("res://") || root_path.find("::") != -1) {
+				return false;
+			}
+		}
+
+		_put_8(VALUE_CLASS);
+		_put_string(root_path);
+		_put_32(names.size());
+		for (int i = names.size() - 1; i >= 0; i--) {
+			_put_string(names[i]);
+		}
+		return true;
+	}
+
+	Resource *res = Object::cast_to<Resource>(obj);
+	if (res && res->get_path().begins_with("res://") && res->get_path().find("::") == -1) {
+		_put_8(VALUE_RESOURCE);
+		_put_string(res->get_path());
+		return true;
+	}
+
+	return false;
+}
+
+bool GDScriptCompiledCache::_put_data_type(const GDScriptDataType &p_type) {
+
+	_put_8(p_type.has_type);
+	_put_8(p_type.kind);
+	_put_8(p_type.builtin_type);
+	_put_string(p_type.native_type);
+	if (p_type.kind == GDScriptDataType::SCRIPT || p_type.kind == GDScriptDataType::GDSCRIPT) {
+		return _put_value(p_type.script_type);
+	}
+	return true;
+}
+
+void GDScriptCompiledCache::_put_tree(const GDScript *p_class) {
+
+	_put_32(p_class->subclasses.size());
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_class->subclasses.front(); E; E = E->next()) {
+		_put_string(E->key());
+		_put_tree(E->get().ptr());
+	}
+}
+
+bool GDScriptCompiledCache::_put_function(const GDScriptFunction *p_function) {
+
+	_put_string(p_function->name);
+	_put_8(p_function->_static);
+	_put_32(p_function->rpc_mode);
+	_put_32(p_function->_argument_count);
+	_put_32(p_function->_stack_size);
+	_put_32(p_function->_call_size);
+	_put_32(p_function->_iterate_lock_count);
+	_put_32(p_function->_initial_line);
+
+	_put_32(p_function->argument_types.size());
+	for (int i = 0; i < p_function->argument_types.size(); i++) {
+		if (!_put_data_type(p_function->argument_types[i])) {
+			return false;
+		}
+	}
+	if (!_put_data_type(p_function->return_type)) {
+		return false;
+	}
+
+	_put_32(p_function->constants.size());
+	for (int i = 0; i < p_function->constants.size(); i++) {
+		if (!_put_value(p_function->constants[i])) {
+			return false;
+		}
+	}
+
+	_put_32(p_function->global_names.size());
+	for (int i = 0; i < p_function->global_names.size(); i++) {
+		_put_string(p_function->global_names[i]);
+	}
+
+	_put_32(p_function->builtin_methods.size());
+	for (int i = 0; i < p_function->builtin_methods.size(); i++) {
+		_put_8(p_function->builtin_methods[i].type);
+		_put_string(p_function->builtin_methods[i].name);
+	}
+
+	_put_32(p_function->inline_caches.size());
+
+#ifdef TOOLS_ENABLED
+	_put_32(p_function->named_globals.size());
+	for (int i = 0; i < p_function->named_globals.size(); i++) {
+		_put_string(p_function->named_globals[i]);
+	}
+
+	_put_32(p_function->arg_names.size());
+	for (int i = 0; i < p_function->arg_names.size(); i++) {
+		_put_string(p_function->arg_names[i]);
+	}
+#endif
+
+	_put_32(p_function->default_arguments.size());
+	for (int i = 0; i < p_function->default_arguments.size(); i++) {
+		_put_32(p_function->default_arguments[i]);
+	}
+
+	_put_32(p_function->code.size());
+	for (int i = 0; i < p_function->code.size(); i++) {
+		_put_32(p_function->code[i]);
+	}
+
+	_put_32(p_function->stack_debug.size());
+	for (const List<GDScriptFunction::StackDebug>::Element *E = p_function->stack_debug.front(); E; E = E->next()) {
+		_put_32(E->get().line);
+		_put_32(E->get().pos);
+		_put_8(E->get().added);
+		_put_string(E->get().identifier);
+	}
+
+#ifdef DEBUG_ENABLED
+	_put_string(p_function->profile.signature);
+#endif
+	return true;
+}
+
+bool GDScriptCompiledCache::_put_class(const GDScript *p_class) {
+
+	_put_8(p_class->tool);
+	_put_string(p_class->name);
+
+	if (p_class->base.is_valid()) {
+		_put_8(1);
+		if (!_put_value(p_class->base)) {
+			return false;
+		}
+	} else {
+		ERR_FAIL_COND_V(p_class->native.is_null(), false);
+		_put_8(0);
+		_put_string(p_class->native->get_name());
+	}
+
+	_put_32(p_class->member_indices.size());
+	for (const Map<StringName, GDScript::MemberInfo>::Element *E = p_class->member_indices.front(); E; E = E->next()) {
+		const GDScript::MemberInfo &minfo = E->get();
+		_put_string(E->key());
+		_put_32(minfo.index);
+		_put_string(minfo.setter);
+		_put_string(minfo.getter);
+		_put_32(minfo.rpc_mode);
+		if (!_put_data_type(minfo.data_type)) {
+			return false;
+		}
+	}
+
+	_put_32(p_class->members.size());
+	for (const Set<StringName>::Element *E = p_class->members.front(); E; E = E->next()) {
+		_put_string(E->get());
+	}
+
+	_put_32(p_class->constants.size());
+	for (const Map<StringName, Variant>::Element *E = p_class->constants.front(); E; E = E->next()) {
+		_put_string(E->key());
+		if (!_put_value(E->get())) {
+			return false;
+		}
+	}
+
+	_put_32(p_class->_signals.size());
+	for (const Map<StringName, Vector<StringName> >::Element *E = p_class->_signals.front(); E; E = E->next()) {
+		_put_string(E->key());
+		_put_32(E->get().size());
+		for (int i = 0; i < E->get().size(); i++) {
+			_put_string(E->get()[i]);
+		}
+	}
+
+	_put_32(p_class->member_info.size());
+	for (const Map<StringName, PropertyInfo>::Element *E = p_class->member_info.front(); E; E = E->next()) {
+		const PropertyInfo &pinfo = E->get();
+		_put_string(E->key());
+		_put_8(pinfo.type);
+		_put_string(pinfo.name);
+		_put_string(pinfo.class_name);
+		_put_32(pinfo.hint);
+		_put_string(pinfo.hint_string);
+		_put_32(pinfo.usage);
+	}
+
+#ifdef TOOLS_ENABLED
+	_put_32(p_class->member_lines.size());
+	for (const Map<StringName, int>::Element *E = p_class->member_lines.front(); E; E = E->next()) {
+		_put_string(E->key());
+		_put_32(E->get());
+	}
+
+	_put_32(p_class->member_default_values.size());
+	for (const Map<StringName, Variant>::Element *E = p_class->member_default_values.front(); E; E = E->next()) {
+		_put_string(E->key());
+		if (!_put_value(E->get())) {
+			return false;
+		}
+	}
+#endif
+
+	_put_32(p_class->member_functions.size());
+	for (const Map<StringName, GDScriptFunction *>::Element *E = p_class->member_functions.front(); E; E = E->next()) {
+		if (!_put_function(E->get())) {
+			return false;
+		}
+	}
+
+	for (const Map<StringName, Ref<GDScript> >::Element *E = p_class->subclasses.front(); E; E = E->next()) {
+		_put_string(E->key());
+		if (!_put_class(E->get().ptr())) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void GDScriptCompiledCache::_put_header(const Vector<uint8_t> &p_source_hash) {
+
+	_put_buffer("GDCC", 4);
+	_put_32(FORMAT_VERSION);
+	_put_string(VERSION_FULL_BUILD);
+	_put_32(_get_build_flags());
+	_put_string(export_id);
+	_put_32(_get_globals_hash());
+	_put_32(p_source_hash.size());
+	_put_buffer(p_source_hash.ptr(), p_source_hash.size());
+}
+
+/* READING */
+
+uint8_t GDScriptCompiledCache::_get_8() {
+
+	uint8_t value = 0;
+	_get_buffer(&value, 1);
+	return value;
+}
+
+uint32_t GDScriptCompiledCache::_get_32() {
+
+	uint8_t buf[4];
+	if (!_get_buffer(buf, 4)) {
+		return 0;
+	}
+	return decode_uint32(buf);
+}
+
+int GDScriptCompiledCache::_get_count() {
+
+	// Every element takes at least a byte, anything larger is corrupt.
+	uint32_t count = _get_32();
+	if (count > (uint32_t)(buffer.size() - pos)) {
+		error = true;
+		return 0;
+	}
+	return count;
+}
+
+bool GDScriptCompiledCache::_get_buffer(void *p_data, int p_size) {
+
+	if (error || p_size < 0 || p_size > buffer.size() - pos) {
+		error = true;
+		return false;
+	}
+	copymem(p_data, buffer.ptr() + pos, p_size);
+	pos += p_size;
+	return true;
+}
+
+String GDScriptCompiledCache::_get_string() {
+
+	int len = _get_count();
+	if (error) {
+		return String();
+	}
+	String ret;
+	ret.parse_utf8((const char *)buffer.ptr() + pos, len);
+	pos += len;
+	return ret;
+}
+
+bool GDScriptCompiledCache::_get_value(Variant &r_value) {
+
+	switch (_get_8()) {
+		case VALUE_VARIANT: {
+
+			int len = _get_count();
+			if (error) {
+				return false;
+			}
+			Error err = decode_variant(r_value, buffer.ptr() + pos, len);
+			pos += len;
+			return err == OK;
+		} break;
+		case VALUE_NULL_OBJECT: {
+
+			r_value = (Object *)NULL;
+			return true;
+		} break;
+		case VALUE_NATIVE_CLASS: {
+
+			StringName name = _get_string();
+			const Map<StringName, int>::Element *E = GDScriptLanguage::get_singleton()->get_global_map().find(name);
+			if (error || !E) {
+				return false;
+			}
+			Ref<GDScriptNativeClass> native = GDScriptLanguage::get_singleton()->get_global_array()[E->get()];
+			if (native.is_null()) {
+				return false;
+			}
+			r_value = native;
+			return true;
+		} break;
+		case VALUE_RESOURCE: {
+
+			String path = _get_string();
+			if (error) {
+				return false;
+			}
+			RES res = ResourceLoader::load(path);
+			if (res.is_null()) {
+				return false;
+			}
+			r_value = res;
+			return true;
+		} break;
+		case VALUE_CLASS: {
+
+			String path = _get_string();
+			if (error) {
+				return false;
+			}
+			Ref<GDScript> gdscript;
+			if (path.empty()) {
+				gdscript = Ref<GDScript>(script);
+			} else {
+				gdscript = ResourceLoader::load(path);
+			}
+
+			int count = _get_count();
+			for (int i = 0; i < count && gdscript.is_valid(); i++) {
+				StringName name = _get_string();
+				Map<StringName, Ref<GDScript> >::Element *E = gdscript->subclasses.find(name);
+				gdscript = E ? E->get() : Ref<GDScript>();
+			}
+			if (error || gdscript.is_null()) {
+				return false;
+			}
+			r_value = gdscript;
+			return true;
+		} break;
+	}
+
+	error = true;
+	return false;
+}
+
+bool GDScriptCompiledCache::_get_data_type(GDScriptDataType &r_type) {
+
+	r_type.has_type = _get_8();
+	r_type.kind = (GDScriptDataType::Kind)_get_8();
+	r_type.builtin_type = (Variant::Type)_get_8();
+	r_type.native_type = _get_string();
+	if (r_type.kind == GDScriptDataType::SCRIPT || r_type.kind == GDScriptDataType::GDSCRIPT) {
+		Variant script_type;
+		if (!_get_value(script_type)) {
+			return false;
+		}
+		r_type.script_type = script_type;
+	}
+	return !error && r_type.kind <= GDScriptDataType::GDSCRIPT && r_type.builtin_type < Variant::VARIANT_MAX;
+}
+
+void GDScriptCompiledCache::_get_tree(GDScript *p_class) {
+
+	p_class->subclasses.clear();
+
+	int count = _get_count();
+	for (int i = 0; i < count && !error; i++) {
+		StringName name = _get_string();
+
+		Ref<GDScript> subclass;
+		subclass.instance();
+		subclass->_owner = p_class;
+		p_class->subclasses.insert(name, subclass);
+
+		_get_tree(subclass.ptr());
+	}
+}
+
+GDScriptFunction *GDScriptCompiledCache::_get_function(GDScript *p_class) {
+
+	GDScriptFunction *function = memnew(GDScriptFunction);
+
+	function->name = _get_string();
+	function->_static = _get_8();
+	function->rpc_mode = (MultiplayerAPI::RPCMode)_get_32();
+	function->_argument_count = _get_32();
+	function->_stack_size = _get_32();
+	function->_call_size = _get_32();
+	function->_iterate_lock_count = _get_32();
+	function->_initial_line = _get_32();
+
+	function->argument_types.resize(_get_count());
+	for (int i = 0; i < function->argument_types.size(); i++) {
+		if (!_get_data_type(function->argument_types.write[i])) {
+			memdelete(function);
+			return NULL;
+		}
+	}
+	if (!_get_data_type(function->return_type)) {
+		memdelete(function);
+		return NULL;
+	}
+
+	function->constants.resize(_get_count());
+	for (int i = 0; i < function->constants.size(); i++) {
+		if (!_get_value(function->constants.write[i])) {
+			memdelete(function);
+			return NULL;
+		}
+	}
+
+	function->global_names.resize(_get_count());
+	for (int i = 0; i < function->global_names.size(); i++) {
+		function->global_names.write[i] = _get_string();
+	}
+
+	function->builtin_methods.resize(_get_count());
+	for (int i = 0; i < function->builtin_methods.size(); i++) {
+		GDScriptFunction::BuiltInMethodInfo &info = function->builtin_methods.write[i];
+		info.type = (Variant::Type)_get_8();
+		info.name = _get_string();
+		info.method = error || info.type >= Variant::VARIANT_MAX ? NULL : Variant::get_builtin_method(info.type, info.name);
+		if (!info.method) {
+			memdelete(function);
+			return NULL;
+		}
+	}
+
+	function->inline_caches.resize(_get_count());
+
+#ifdef TOOLS_ENABLED
+	function->named_globals.resize(_get_count());
+	for (int i = 0; i < function->named_globals.size(); i++) {
+		function->named_globals.write[i] = _get_string();
+	}
+
+	function->arg_names.resize(_get_count());
+	for (int i = 0; i < function->arg_names.size(); i++) {
+		function->arg_names.write[i] = _get_string();
+	}
+#endif
+
+	function->default_arguments.resize(_get_count());
+	for (int i = 0; i < function->default_arguments.size(); i++) {
+		function->default_arguments.write[i] = _get_32();
+	}
+
+	function->code.resize(_get_count());
+	for (int i = 0; i < function->code.size(); i++) {
+		function->code.write[i] = _get_32();
+	}
+
+	int stack_debug_count = _get_count();
+	for (int i = 0; i < stack_debug_count && !error; i++) {
+		GDScriptFunction::StackDebug sd;
+		sd.line = _get_32();
+		sd.pos = _get_32();
+		sd.added = _get_8();
+		sd.identifier = _get_string();
+		function->stack_debug.push_back(sd);
+	}
+
+#ifdef DEBUG_ENABLED
+	function->profile.signature = _get_string();
+#endif
+
+	if (error) {
+		memdelete(function);
+		return NULL;
+	}
+
+	// Same layout the compiler leaves the function in.
+	function->_constants_ptr = function->constants.size() ? function->constants.ptrw() : NULL;
+	function->_constant_count = function->constants.size();
+	function->_global_names_ptr = function->global_names.size() ? function->global_names.ptr() : NULL;
+	function->_global_names_count = function->global_names.size();
+	function->_builtin_methods_ptr = function->builtin_methods.size() ? function->builtin_methods.ptr() : NULL;
+	function->_builtin_methods_count = function->builtin_methods.size();
+	function->_inline_caches_ptr = function->inline_caches.size() ? function->inline_caches.ptrw() : NULL;
+	function->_inline_caches_count = function->inline_caches.size();
+#ifdef TOOLS_ENABLED
+	function->_named_globals_ptr = function->named_globals.size() ? function->named_globals.ptr() : NULL;
+	function->_named_globals_count = function->named_globals.size();
+#endif
+	function->_code_ptr = function->code.size() ? function->code.ptr() : NULL;
+	function->_code_size = function->code.size();
+	function->_default_arg_ptr = function->default_arguments.size() ? function->default_arguments.ptr() : NULL;
+	function->_default_arg_count = function->default_arguments.size() ? function->default_arguments.size() - 1 : 0;
+
+	function->_script = p_class;
+	function->source = script->get_path();
+#ifdef DEBUG_ENABLED
+	function->func_cname = (String(function->source) + " - " + String(function->name)).utf8();
+	function->_func_cname = function->func_cname.get_data();
+#endif
+
+	return function;
+}
+
+bool GDScriptCompiledCache::_get_class(GDScript *p_class) {
+
+	p_class->native = Ref<GDScriptNativeClass>();
+	p_class->base = Ref<GDScript>();
+	p_class->_base = NULL;
+	p_class->members.clear();
+	p_class->constants.clear();
+	for (Map<StringName, GDScriptFunction *>::Element *E = p_class->member_functions.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+	p_class->member_functions.clear();
+	p_class->member_indices.clear();
+	p_class->member_info.clear();
+	p_class->_signals.clear();
+	p_class->initializer = NULL;
+#ifdef TOOLS_ENABLED
+	p_class->member_lines.clear();
+	p_class->member_default_values.clear();
+#endif
+
+	p_class->tool = _get_8();
+	p_class->name = _get_string();
+
+	if (_get_8()) {
+		Variant base;
+		if (!_get_value(base)) {
+			return false;
+		}
+		p_class->base = base;
+		if (p_class->base.is_null()) {
+			return false;
+		}
+		p_class->_base = p_class->base.ptr();
+	} else {
+		StringName native_name = _get_string();
+		const Map<StringName, int>::Element *E = GDScriptLanguage::get_singleton()->get_global_map().find(native_name);
+		if (error || !E) {
+			return false;
+		}
+		p_class->native = GDScriptLanguage::get_singleton()->get_global_array()[E->get()];
+		if (p_class->native.is_null()) {
+			return false;
+		}
+	}
+
+	int member_count = _get_count();
+	for (int i = 0; i < member_count && !error; i++) {
+		StringName name = _get_string();
+		GDScript::MemberInfo minfo;
+		minfo.index = _get_32();
+		minfo.setter = _get_string();
+		minfo.getter = _get_string();
+		minfo.rpc_mode = (MultiplayerAPI::RPCMode)_get_32();
+		if (!_get_data_type(minfo.data_type)) {
+			return false;
+		}
+		p_class->member_indices[name] = minfo;
+	}
+
+	int own_member_count = _get_count();
+	for (int i = 0; i < own_member_count && !error; i++) {
+		p_class->members.insert(_get_string());
+	}
+
+	int constant_count = _get_count();
+	for (int i = 0; i < constant_count && !error; i++) {
+		StringName name = _get_string();
+		Variant value;
+		if (!_get_value(value)) {
+			return false;
+		}
+		p_class->constants[name] = value;
+	}
+
+	int signal_count = _get_count();
+	for (int i = 0; i < signal_count && !error; i++) {
+		StringName name = _get_string();
+		Vector<StringName> arguments;
+		arguments.resize(_get_count());
+		for (int j = 0; j < arguments.size(); j++) {
+			arguments.write[j] = _get_string();
+		}
+		p_class->_signals[name] = arguments;
+	}
+
+	int info_count = _get_count();
+	for (int i = 0; i < info_count && !error; i++) {
+		StringName name = _get_string();
+		PropertyInfo pinfo;
+		pinfo.type = (Variant::Type)_get_8();
+		pinfo.name = _get_string();
+		pinfo.class_name = _get_string();
+		pinfo.hint = (PropertyHint)_get_32();
+		pinfo.hint_string = _get_string();
+		pinfo.usage = _get_32();
+		p_class->member_info[name] = pinfo;
+	}
+
+#ifdef TOOLS_ENABLED
+	int line_count = _get_count();
+	for (int i = 0; i < line_count && !error; i++) {
+		StringName name = _get_string();
+		p_class->member_lines[name] = _get_32();
+	}
+
+	int default_count = _get_count();
+	for (int i = 0; i < default_count && !error; i++) {
+		StringName name = _get_string();
+		Variant value;
+		if (!_get_value(value)) {
+			return false;
+		}
+		p_class->member_default_values[name] = value;
+	}
+#endif
+
+	int function_count = _get_count();
+	for (int i = 0; i < function_count && !error; i++) {
+		GDScriptFunction *function = _get_function(p_class);
+		if (!function) {
+			return false;
+		}
+		if (p_class->member_functions.has(function->name)) {
+			memdelete(p_class->member_functions[function->name]);
+		}
+		p_class->member_functions[function->name] = function;
+	}
+
+	Map<StringName, GDScriptFunction *>::Element *init = p_class->member_functions.find("_init");
+	p_class->initializer = init ? init->get() : NULL;
+
+	for (int i = 0; i < p_class->subclasses.size() && !error; i++) {
+		StringName name = _get_string();
+		Map<StringName, Ref<GDScript> >::Element *E = p_class->subclasses.find(name);
+		if (!E || !_get_class(E->get().ptr())) {
+			return false;
+		}
+	}
+
+	if (error) {
+		return false;
+	}
+
+	p_class->valid = true;
+	return true;
+}
+
+bool GDScriptCompiledCache::_check_header(const Vector<uint8_t> &p_source_hash) {
+
+	uint8_t magic[4];
+	if (!_get_buffer(magic, 4) || magic[0] != 'G' || magic[1] != 'D' || magic[2] != 'C' || magic[3] != 'C') {
+		return false;
+	}
+	if (_get_32() != FORMAT_VERSION || _get_string() != VERSION_FULL_BUILD || _get_32() != _get_build_flags()) {
+		return false;
+	}
+	if (_get_string() != export_id || _get_32() != _get_globals_hash()) {
+		return false;
+	}
+
+	int hash_size = _get_count();
+	if (error || hash_size != p_source_hash.size()) {
+		return false;
+	}
+	pos += hash_size;
+	return memcmp(buffer.ptr() + pos - hash_size, p_source_hash.ptr(), hash_size) == 0;
+}
+
+/* API */
+
+void GDScriptCompiledCache::initialize() {
+
+	enabled = false;
+	export_id = String();
+
+	if (Engine::get_singleton()->is_editor_hint() || !GLOBAL_GET("gdscript/compiled_cache/enabled")) {
+		return;
+	}
+
+	// Scripts can change freely in a project that isn't exported, and compiled
+	// code depends on the other scripts it references.
+	FileAccessRef f = FileAccess::open(EXPORT_ID_PATH, FileAccess::READ);
+	if (!f) {
+		return;
+	}
+	export_id = f->get_line().strip_edges();
+	if (export_id.empty()) {
+		return;
+	}
+
+	DirAccessRef da = DirAccess::create(DirAccess::ACCESS_USERDATA);
+	if (!da->dir_exists(CACHE_DIR) && da->make_dir_recursive(CACHE_DIR) != OK) {
+		return;
+	}
+
+	enabled = true;
+}
+
+Vector<uint8_t> GDScriptCompiledCache::serialize(const GDScript *p_script, const Vector<uint8_t> &p_source_hash) {
+
+	GDScriptCompiledCache cache;
+	cache.script = const_cast<GDScript *>(p_script);
+
+	cache._put_header(p_source_hash);
+	cache._put_tree(p_script);
+	if (!cache._put_class(p_script)) {
+		return Vector<uint8_t>();
+	}
+
+	unsigned char checksum[16];
+	CryptoCore::md5(cache.buffer.ptr(), cache.pos, checksum);
+	cache._put_buffer(checksum, 16);
+
+	cache.buffer.resize(cache.pos);
+	return cache.buffer;
+}
+
+Error GDScriptCompiledCache::deserialize(GDScript *p_script, const Vector<uint8_t> &p_buffer, const Vector<uint8_t> &p_source_hash) {
+
+	ERR_FAIL_COND_V(p_buffer.size() < 16, ERR_FILE_CORRUPT);
+
+	GDScriptCompiledCache cache;
+	cache.script = p_script;
+	cache.buffer = p_buffer;
+	cache.buffer.resize(p_buffer.size() - 16);
+
+	unsigned char checksum[16];
+	CryptoCore::md5(cache.buffer.ptr(), cache.buffer.size(), checksum);
+	ERR_FAIL_COND_V(memcmp(checksum, p_buffer.ptr() + cache.buffer.size(), 16) != 0, ERR_FILE_CORRUPT);
+
+	if (!cache._check_header(p_source_hash)) {
+		return ERR_FILE_UNRECOGNIZED;
+	}
+
+	p_script->_owner = NULL;
+	p_script->valid = false;
+	cache._get_tree(p_script);
+	if (!cache._get_class(p_script)) {
+		p_script->valid = false;
+		return ERR_FILE_CORRUPT;
+	}
+
+	return OK;
+}
+
+Error GDScriptCompiledCache::load(GDScript *p_script, const Vector<uint8_t> &p_source_hash) {
+
+	Error err;
+	FileAccessRef f = FileAccess::open(_get_cache_path(p_script->get_path()), FileAccess::READ, &err);
+	if (!f) {
+		return err;
+	}
+
+	Vector<uint8_t> data;
+	data.resize(f->get_len());
+	if (f->get_buffer(data.ptrw(), data.size()) != data.size()) {
+		return ERR_FILE_CORRUPT;
+	}
+	f->close();
+
+	return deserialize(p_script, data, p_source_hash);
+}
+
+void GDScriptCompiledCache::save(const GDScript *p_script, const Vector<uint8_t> &p_source_hash) {
+
+	Vector<uint8_t> data = serialize(p_script, p_source_hash);
+	if (data.empty()) {
+		return;
+	}
+
+	FileAccessRef f = FileAccess::open(_get_cache_path(p_script->get_path()), FileAccess::WRITE);
+	if (f) {
+		f->store_buffer(data.ptr(), data.size());
+	}
+}
+
+GDScriptCompiledCache::GDScriptCompiledCache() :
+		script(NULL),
+		pos(0),
+		error(false) {
+}
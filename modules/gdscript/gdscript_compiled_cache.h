@@ -0,0 +1,114 @@
+/*************************************************************************/
+/*  gdscript_compiled_cache.h                                            */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_COMPILED_CACHE_H
+#define GDSCRIPT_COMPILED_CACHE_H
+
+#include "core/ustring.h"
+#include "core/variant.h"
+#include "core/vector.h"
+
+class GDScript;
+class GDScriptFunction;
+struct GDScriptDataType;
+
+// Stores the compiled form of a script file (every class in it, with the
+// bytecode, constants, global names and line data of its functions) in
+// user://, so later launches of an exported project can skip parsing and
+// compiling scripts whose source didn't change.
+//
+// A cache file is only used by the same engine build, with the same global
+// table, for the same export of the project and the same source; anything
+// else falls back to compiling the script. Compiled code also depends on
+// the other scripts it references, which can't change within an export.
+class GDScriptCompiledCache {
+
+	enum {
+		FORMAT_VERSION = 2
+	};
+
+	enum ValueType {
+		VALUE_VARIANT,
+		VALUE_NULL_OBJECT,
+		VALUE_NATIVE_CLASS,
+		VALUE_RESOURCE,
+		VALUE_CLASS, // a GDScript class, possibly inner, by file path and class names
+	};
+
+	static bool enabled;
+	static String export_id;
+
+	GDScript *script;
+	Vector<uint8_t> buffer;
+	int pos;
+	bool error;
+
+	void _put_8(uint8_t p_value);
+	void _put_32(uint32_t p_value);
+	void _put_buffer(const void *p_data, int p_size);
+	void _put_string(const String &p_string);
+	bool _put_value(const Variant &p_value);
+	bool _put_data_type(const GDScriptDataType &p_type);
+	void _put_tree(const GDScript *p_class);
+	bool _put_function(const GDScriptFunction *p_function);
+	bool _put_class(const GDScript *p_class);
+
+	uint8_t _get_8();
+	uint32_t _get_32();
+	int _get_count();
+	bool _get_buffer(void *p_data, int p_size);
+	String _get_string();
+	bool _get_value(Variant &r_value);
+	bool _get_data_type(GDScriptDataType &r_type);
+	void _get_tree(GDScript *p_class);
+	GDScriptFunction *_get_function(GDScript *p_class);
+	bool _get_class(GDScript *p_class);
+
+	void _put_header(const Vector<uint8_t> &p_source_hash);
+	bool _check_header(const Vector<uint8_t> &p_source_hash);
+
+	GDScriptCompiledCache();
+
+public:
+	// Written by the export, the cache is only used when this file exists.
+	static const char *EXPORT_ID_PATH;
+
+	static void initialize();
+	static bool is_enabled() { return enabled; }
+
+	// Empty when the script refers to values that can't be stored.
+	static Vector<uint8_t> serialize(const GDScript *p_script, const Vector<uint8_t> &p_source_hash);
+	static Error deserialize(GDScript *p_script, const Vector<uint8_t> &p_buffer, const Vector<uint8_t> &p_source_hash);
+
+	static Error load(GDScript *p_script, const Vector<uint8_t> &p_source_hash);
+	static void save(const GDScript *p_script, const Vector<uint8_t> &p_source_hash);
+};
+
+#endif // GDSCRIPT_COMPILED_CACHE_H
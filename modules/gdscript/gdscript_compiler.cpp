@@ -74,6 +74,28 @@ void GDScriptCompiler::_set_error(const String &p_error, const GDScriptParser::N
 	}
 }
 
+static Variant::Type _get_builtin_type(const GDScriptParser::Node *p_node) {
+
+	GDScriptParser::DataType datatype = p_node->get_datatype();
+	if (!datatype.has_type || datatype.is_meta_type || datatype.kind != GDScriptParser::DataType::BUILTIN) {
+		return Variant::NIL;
+	}
+	return datatype.builtin_type;
+}
+
+// Typed prefix for an operator whose operands are known to be numbers. The VM checks
+// the types again before taking the fast path, so a wrong guess only costs the check.
+static int _get_typed_operator_prefix(Variant::Type p_type_a, Variant::Type p_type_b) {
+
+	if (p_type_a == Variant::INT && p_type_b == Variant::INT) {
+		return GDScriptFunction::OPCODE_OPERATOR_INT;
+	}
+	if ((p_type_a == Variant::INT || p_type_a == Variant::REAL) && (p_type_b == Variant::INT || p_type_b == Variant::REAL)) {
+		return GDScriptFunction::OPCODE_OPERATOR_REAL;
+	}
+	return -1;
+}
+
 bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptParser::OperatorNode *on, Variant::Operator op, int p_stack_level) {
 
 	ERR_FAIL_COND_V(on->arguments.size() != 1, false);
@@ -82,6 +104,13 @@ bool GDScriptCompiler::_create_unary_operator(CodeGen &codegen, const GDScriptPa
 	if (src_address_a < 0)
 		return false;
 
+	if (op == Variant::OP_NEGATE) {
+		Variant::Type type = _get_builtin_type(on->arguments[0]);
+		int prefix = _get_typed_operator_prefix(type, type);
+		if (prefix >= 0)
+			codegen.opcodes.push_back(prefix);
+	}
+
 	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
@@ -104,6 +133,18 @@ bool GDScriptCompiler::_create_binary_operator(CodeGen &codegen, const GDScriptP
 	if (src_address_b < 0)
 		return false;
 
+	switch (op) {
+		case Variant::OP_SHIFT_LEFT:
+		case Variant::OP_SHIFT_RIGHT:
+		case Variant::OP_IN:
+			break;
+		default: {
+			int prefix = _get_typed_operator_prefix(_get_builtin_type(on->arguments[0]), _get_builtin_type(on->arguments[1]));
+			if (prefix >= 0)
+				codegen.opcodes.push_back(prefix);
+		}
+	}
+
 	codegen.opcodes.push_back(GDScriptFunction::OPCODE_OPERATOR); // perform operator
 	codegen.opcodes.push_back(op); //which operator
 	codegen.opcodes.push_back(src_address_a); // argument 1
@@ -239,6 +280,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 			// TRY CLASS MEMBER
 			if (_is_class_member_property(codegen, identifier)) {
 				//get property
+				codegen.push_inline_cache();
 				codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_MEMBER); // perform operator
 				codegen.opcodes.push_back(codegen.get_name_map_pos(identifier)); // argument 2 (unary only takes one parameter)
 				int dst_addr = (p_stack_level) | (GDScriptFunction::ADDR_TYPE_STACK << GDScriptFunction::ADDR_BITS);
@@ -656,6 +698,18 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							arguments.push_back(ret);
 						}
 
+						Variant::Type base_type = _get_builtin_type(instance);
+						if (base_type != Variant::NIL && base_type != Variant::OBJECT && instance->type != GDScriptParser::Node::TYPE_SELF) {
+							const GDScriptParser::IdentifierNode *id = static_cast<const GDScriptParser::IdentifierNode *>(on->arguments[1]);
+							const Variant::BuiltInMethod *method = Variant::get_builtin_method(base_type, id->name);
+							if (method) {
+								codegen.opcodes.push_back(GDScriptFunction::OPCODE_CALL_BUILTIN_TYPE);
+								codegen.opcodes.push_back(codegen.get_builtin_method_pos(base_type, id->name, method));
+							}
+						} else if ((base_type == Variant::NIL || base_type == Variant::OBJECT) && (arguments[0] >> GDScriptFunction::ADDR_BITS) != GDScriptFunction::ADDR_TYPE_CLASS) {
+							codegen.push_inline_cache();
+						}
+
 						codegen.opcodes.push_back(p_root ? GDScriptFunction::OPCODE_CALL : GDScriptFunction::OPCODE_CALL_RETURN); // perform operator
 						codegen.opcodes.push_back(on->arguments.size() - 2);
 						codegen.alloc_call(on->arguments.size() - 2);
@@ -747,6 +801,27 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 						}
 					}
 
+					Variant::Type base_type = _get_builtin_type(on->arguments[0]);
+					if (named && on->op == GDScriptParser::OperatorNode::OP_INDEX_NAMED && (base_type == Variant::VECTOR2 || base_type == Variant::VECTOR3)) {
+						const StringName &name = static_cast<const GDScriptParser::IdentifierNode *>(on->arguments[1])->name;
+						int component = -1;
+						if (name == "x") {
+							component = 0;
+						} else if (name == "y") {
+							component = 1;
+						} else if (name == "z" && base_type == Variant::VECTOR3) {
+							component = 2;
+						}
+						if (component >= 0) {
+							codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_NAMED_VECTOR);
+							codegen.opcodes.push_back(component);
+						}
+					} else if (!named && base_type == Variant::ARRAY && _get_builtin_type(on->arguments[1]) == Variant::INT) {
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_GET_ARRAY);
+					} else if (named && (base_type == Variant::NIL || base_type == Variant::OBJECT)) {
+						codegen.push_inline_cache();
+					}
+
 					codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET); // perform operator
 					codegen.opcodes.push_back(from); // argument 1
 					codegen.opcodes.push_back(index); // argument 2 (unary only takes one parameter)
@@ -1017,6 +1092,8 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							setchain.push_back(prev_pos);
 							setchain.push_back(codegen.get_name_map_pos(assign_property));
 							setchain.push_back(GDScriptFunction::OPCODE_SET_MEMBER);
+							setchain.push_back(codegen.inline_cache_count++);
+							setchain.push_back(GDScriptFunction::OPCODE_INLINE_CACHE);
 						}
 
 						for (List<GDScriptParser::OperatorNode *>::Element *E = chain.back(); E; E = E->prev()) {
@@ -1049,6 +1126,9 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 							if (key_idx < 0) //error
 								return key_idx;
 
+							if (named) {
+								codegen.push_inline_cache();
+							}
 							codegen.opcodes.push_back(named ? GDScriptFunction::OPCODE_GET_NAMED : GDScriptFunction::OPCODE_GET);
 							codegen.opcodes.push_back(prev_pos);
 							codegen.opcodes.push_back(key_idx);
@@ -1118,6 +1198,7 @@ int GDScriptCompiler::_parse_expression(CodeGen &codegen, const GDScriptParser::
 
 						StringName name = static_cast<GDScriptParser::IdentifierNode *>(on->arguments[0])->name;
 
+						codegen.push_inline_cache();
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_SET_MEMBER);
 						codegen.opcodes.push_back(codegen.get_name_map_pos(name));
 						codegen.opcodes.push_back(src_address);
@@ -1411,25 +1492,40 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(ret2);
 
+						int lock_slot = codegen.iterate_lock_level++;
+						if (codegen.iterate_lock_level > codegen.iterate_lock_max)
+							codegen.iterate_lock_max = codegen.iterate_lock_level;
+
 						//begin loop
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_TYPED);
+						codegen.opcodes.push_back(lock_slot);
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_BEGIN);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
-						codegen.opcodes.push_back(codegen.opcodes.size() + 4);
+						int begin_end_addr = codegen.opcodes.size();
+						codegen.opcodes.push_back(0);
 						codegen.opcodes.push_back(iterator_pos);
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
-						codegen.opcodes.push_back(codegen.opcodes.size() + 8);
-						//break loop
+						int body_addr = codegen.opcodes.size();
+						codegen.opcodes.push_back(0);
+						//break loop, releasing the pool array lock if one was taken
 						int break_pos = codegen.opcodes.size();
+						codegen.opcodes.write[begin_end_addr] = break_pos;
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_RELEASE);
+						codegen.opcodes.push_back(lock_slot);
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP); //skip code for next
+						int end_addr = codegen.opcodes.size();
 						codegen.opcodes.push_back(0); //skip code for next
 						//next loop
 						int continue_pos = codegen.opcodes.size();
+						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE_TYPED);
+						codegen.opcodes.push_back(lock_slot);
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_ITERATE);
 						codegen.opcodes.push_back(counter_pos);
 						codegen.opcodes.push_back(container_pos);
 						codegen.opcodes.push_back(break_pos);
 						codegen.opcodes.push_back(iterator_pos);
+						codegen.opcodes.write[body_addr] = codegen.opcodes.size();
 
 						Error err = _parse_block(codegen, cf->body, slevel, break_pos, continue_pos);
 						if (err)
@@ -1437,8 +1533,9 @@ Error GDScriptCompiler::_parse_block(CodeGen &codegen, const GDScriptParser::Blo
 
 						codegen.opcodes.push_back(GDScriptFunction::OPCODE_JUMP);
 						codegen.opcodes.push_back(continue_pos);
-						codegen.opcodes.write[break_pos + 1] = codegen.opcodes.size();
+						codegen.opcodes.write[end_addr] = codegen.opcodes.size();
 
+						codegen.iterate_lock_level--;
 						codegen.pop_stack_identifiers();
 
 					} break;
@@ -1575,6 +1672,9 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	codegen.script = p_script;
 	codegen.function_node = p_func;
 	codegen.stack_max = 0;
+	codegen.inline_cache_count = 0;
+	codegen.iterate_lock_level = 0;
+	codegen.iterate_lock_max = 0;
 	codegen.current_line = 0;
 	codegen.call_max = 0;
 	codegen.debug_stack = ScriptDebugger::get_singleton() != NULL;
@@ -1723,6 +1823,28 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 		gdfunc->_global_names_ptr = NULL;
 		gdfunc->_global_names_count = 0;
 	}
+	//typed builtin method calls
+	if (codegen.builtin_methods.size()) {
+
+		gdfunc->builtin_methods = codegen.builtin_methods;
+		gdfunc->_builtin_methods_ptr = gdfunc->builtin_methods.ptr();
+		gdfunc->_builtin_methods_count = gdfunc->builtin_methods.size();
+
+	} else {
+		gdfunc->_builtin_methods_ptr = NULL;
+		gdfunc->_builtin_methods_count = 0;
+	}
+	//inline caches
+	if (codegen.inline_cache_count) {
+
+		gdfunc->inline_caches.resize(codegen.inline_cache_count);
+		gdfunc->_inline_caches_ptr = gdfunc->inline_caches.ptrw();
+		gdfunc->_inline_caches_count = gdfunc->inline_caches.size();
+
+	} else {
+		gdfunc->_inline_caches_ptr = NULL;
+		gdfunc->_inline_caches_count = 0;
+	}
 
 #ifdef TOOLS_ENABLED
 	// Named globals
@@ -1761,6 +1883,7 @@ Error GDScriptCompiler::_parse_function(GDScript *p_script, const GDScriptParser
 	gdfunc->_argument_count = p_func ? p_func->arguments.size() : 0;
 	gdfunc->_stack_size = codegen.stack_max;
 	gdfunc->_call_size = codegen.call_max;
+	gdfunc->_iterate_lock_count = codegen.iterate_lock_max;
 	gdfunc->name = func_name;
 #ifdef DEBUG_ENABLED
 	if (ScriptDebugger::get_singleton()) {
@@ -121,6 +121,34 @@ class GDScriptCompiler {
 			return pos;
 		}
 
+		Vector<GDScriptFunction::BuiltInMethodInfo> builtin_methods;
+
+		int get_builtin_method_pos(Variant::Type p_type, const StringName &p_name, const Variant::BuiltInMethod *p_method) {
+			for (int i = 0; i < builtin_methods.size(); i++) {
+				if (builtin_methods[i].method == p_method)
+					return i;
+			}
+			GDScriptFunction::BuiltInMethodInfo info;
+			info.type = p_type;
+			info.name = p_name;
+			info.method = p_method;
+			builtin_methods.push_back(info);
+			return builtin_methods.size() - 1;
+		}
+
+		int inline_cache_count;
+
+		// Prefix the next instruction with a fresh inline cache slot.
+		void push_inline_cache() {
+			opcodes.push_back(GDScriptFunction::OPCODE_INLINE_CACHE);
+			opcodes.push_back(inline_cache_count++);
+		}
+
+		// Nesting level of the 'for' loop being compiled, which picks its
+		// pool array lock slot, and the deepest level seen.
+		int iterate_lock_level;
+		int iterate_lock_max;
+
 		Vector<int> opcodes;
 		void alloc_stack(int p_level) {
 			if (p_level >= stack_max) stack_max = p_level + 1;
@@ -30,7 +30,12 @@
 
 #include "gdscript_function.h"
 
+#include "core/class_db.h"
+#include "core/core_string_names.h"
+#include "core/method_bind.h"
 #include "core/os/os.h"
+#include "core/safe_refcount.h"
+#include "core/variant_internal.h"
 #include "gdscript.h"
 #include "gdscript_functions.h"
 
@@ -189,6 +194,240 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 	return err_text;
 }
 
+// Fast paths for the typed operator prefixes. They return false when they
+// can't produce exactly what Variant::evaluate() would, like on a division
+// by zero, so the generic instruction runs and reports it.
+static _FORCE_INLINE_ bool _evaluate_int(Variant::Operator p_op, int64_t a, int64_t b, Variant *r_dst) {
+
+	switch (p_op) {
+		case Variant::OP_ADD: VariantInternal::set_int(r_dst, a + b); return true;
+		case Variant::OP_SUBTRACT: VariantInternal::set_int(r_dst, a - b); return true;
+		case Variant::OP_MULTIPLY: VariantInternal::set_int(r_dst, a * b); return true;
+		case Variant::OP_DIVIDE: {
+			if (b == 0)
+				return false;
+			VariantInternal::set_int(r_dst, a / b);
+			return true;
+		}
+		case Variant::OP_MODULE: {
+			if (b == 0)
+				return false;
+			VariantInternal::set_int(r_dst, a % b);
+			return true;
+		}
+		case Variant::OP_NEGATE: VariantInternal::set_int(r_dst, -a); return true;
+		case Variant::OP_BIT_AND: VariantInternal::set_int(r_dst, a & b); return true;
+		case Variant::OP_BIT_OR: VariantInternal::set_int(r_dst, a | b); return true;
+		case Variant::OP_BIT_XOR: VariantInternal::set_int(r_dst, a ^ b); return true;
+		case Variant::OP_EQUAL: VariantInternal::set_bool(r_dst, a == b); return true;
+		case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(r_dst, a != b); return true;
+		case Variant::OP_LESS: VariantInternal::set_bool(r_dst, a < b); return true;
+		case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(r_dst, a <= b); return true;
+		case Variant::OP_GREATER: VariantInternal::set_bool(r_dst, a > b); return true;
+		case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(r_dst, a >= b); return true;
+		default: return false;
+	}
+}
+
+static _FORCE_INLINE_ bool _evaluate_real(Variant::Operator p_op, double a, double b, Variant *r_dst) {
+
+	switch (p_op) {
+		case Variant::OP_ADD: VariantInternal::set_real(r_dst, a + b); return true;
+		case Variant::OP_SUBTRACT: VariantInternal::set_real(r_dst, a - b); return true;
+		case Variant::OP_MULTIPLY: VariantInternal::set_real(r_dst, a * b); return true;
+		case Variant::OP_DIVIDE: {
+			if (b == 0)
+				return false;
+			VariantInternal::set_real(r_dst, a / b);
+			return true;
+		}
+		case Variant::OP_NEGATE: VariantInternal::set_real(r_dst, -a); return true;
+		case Variant::OP_EQUAL: VariantInternal::set_bool(r_dst, a == b); return true;
+		case Variant::OP_NOT_EQUAL: VariantInternal::set_bool(r_dst, a != b); return true;
+		case Variant::OP_LESS: VariantInternal::set_bool(r_dst, a < b); return true;
+		case Variant::OP_LESS_EQUAL: VariantInternal::set_bool(r_dst, a <= b); return true;
+		case Variant::OP_GREATER: VariantInternal::set_bool(r_dst, a > b); return true;
+		case Variant::OP_GREATER_EQUAL: VariantInternal::set_bool(r_dst, a >= b); return true;
+		default: return false;
+	}
+}
+
+static _FORCE_INLINE_ double _get_num(const Variant *p_value) {
+
+	return p_value->get_type() == Variant::REAL ? *VariantInternal::get_real(p_value) : double(*VariantInternal::get_int(p_value));
+}
+
+/* Inline caches */
+
+uint32_t GDScriptFunction::inline_cache_generation = 1;
+
+void GDScriptFunction::invalidate_inline_caches() {
+
+	atomic_increment(&inline_cache_generation);
+}
+
+static _FORCE_INLINE_ Object *_get_inline_cache_receiver(const Variant *p_value) {
+
+	if (p_value->get_type() != Variant::OBJECT) {
+		return NULL;
+	}
+
+	Object *obj = VariantInternal::get_object(p_value);
+#ifdef DEBUG_ENABLED
+	// Same check Variant does before using the object, the generic path reports the error.
+	if (obj && ScriptDebugger::get_singleton() && !p_value->is_ref() && !ObjectDB::instance_validate(obj)) {
+		return NULL;
+	}
+#endif
+	return obj;
+}
+
+const GDScript *GDScriptFunction::_get_inline_cache_script(Object *p_object, bool &r_cacheable) {
+
+	ScriptInstance *si = p_object->get_script_instance();
+	if (!si) {
+		r_cacheable = true;
+		return NULL;
+	}
+
+	// Other languages may resolve names differently on every call.
+	r_cacheable = !si->is_placeholder() && si->get_language() == GDScriptLanguage::get_singleton();
+	return r_cacheable ? static_cast<GDScriptInstance *>(si)->script.ptr() : NULL;
+}
+
+const GDScriptFunction::InlineCacheEntry *GDScriptFunction::_find_inline_cache_entry(const InlineCache &p_cache, const StringName &p_class_name, const GDScript *p_script) {
+
+	for (int i = 0; i < INLINE_CACHE_ENTRIES; i++) {
+		const InlineCacheEntry &entry = p_cache.entries[i];
+		if (entry.class_name == p_class_name && entry.script == p_script && entry.generation == inline_cache_generation) {
+			return &entry;
+		}
+	}
+	return NULL;
+}
+
+GDScriptFunction::InlineCacheEntry *GDScriptFunction::_add_inline_cache_entry(InlineCache &p_cache, const StringName &p_class_name, const GDScript *p_script) {
+
+	InlineCacheEntry &entry = p_cache.entries[p_cache.next % INLINE_CACHE_ENTRIES];
+	p_cache.next++;
+
+	entry.class_name = p_class_name;
+	entry.script = p_script;
+	entry.generation = inline_cache_generation;
+	entry.kind = INLINE_CACHE_GENERIC;
+	entry.method = NULL;
+	entry.property_index = -1;
+	entry.ptrcall = false;
+	return &entry;
+}
+
+const GDScriptFunction::InlineCacheEntry *GDScriptFunction::_fill_inline_cache_get_named(InlineCache &p_cache, Object *p_object, const GDScript *p_script, const StringName &p_name) {
+
+	const StringName &class_name = p_object->get_class_name();
+
+	// Same lookup order as Object::get(), script first.
+	if (p_script) {
+
+		const Map<StringName, GDScript::MemberInfo>::Element *E = p_script->member_indices.find(p_name);
+		if (E) {
+			InlineCacheEntry *entry = _add_inline_cache_entry(p_cache, class_name, p_script);
+			if (E->get().getter) {
+				return entry;
+			}
+
+			entry->kind = INLINE_CACHE_SCRIPT_MEMBER;
+			entry->member_index = E->get().index;
+			return entry;
+		}
+
+		for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+			if (sptr->constants.has(p_name) || sptr->member_functions.has(GDScriptLanguage::get_singleton()->strings._get)) {
+				return _add_inline_cache_entry(p_cache, class_name, p_script);
+			}
+		}
+	}
+
+	// Indexed getters go through Object::call(), leave them to the generic path.
+	const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(class_name, p_name);
+	InlineCacheEntry *entry = _add_inline_cache_entry(p_cache, class_name, p_script);
+	if (psg && psg->_getptr && psg->index < 0) {
+		entry->kind = INLINE_CACHE_METHOD_BIND;
+		entry->method = psg->_getptr;
+	}
+	return entry;
+}
+
+const GDScriptFunction::InlineCacheEntry *GDScriptFunction::_fill_inline_cache_member(InlineCache &p_cache, Object *p_object, const StringName &p_name, bool p_setter) {
+
+	const ClassDB::PropertySetGet *psg = ClassDB::get_property_setget(p_object->get_class_name(), p_name);
+
+	MethodBind *method = NULL;
+	if (psg && p_setter) {
+		method = psg->setter ? psg->_setptr : NULL;
+	} else if (psg) {
+		method = psg->index < 0 ? psg->_getptr : NULL;
+	}
+
+	// Native properties don't depend on the script, so members are keyed by class only.
+	InlineCacheEntry *entry = _add_inline_cache_entry(p_cache, p_object->get_class_name(), NULL);
+	if (method) {
+		entry->kind = INLINE_CACHE_METHOD_BIND;
+		entry->method = method;
+		entry->property_index = psg->index;
+	}
+	return entry;
+}
+
+#ifdef PTRCALL_ENABLED
+// ptrcall() takes objects as raw pointers without checking their class, and
+// returns them either raw or referenced depending on the binding, so methods
+// that take or return objects keep going through MethodBind::call().
+static bool _can_ptrcall(const MethodBind *p_method) {
+
+	for (int i = -1; i < p_method->get_argument_count(); i++) {
+		if (p_method->get_argument_type(i) == Variant::OBJECT) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#endif
+const GDScriptFunction::InlineCacheEntry *GDScriptFunction::_fill_inline_cache_call(InlineCache &p_cache, Object *p_object, const GDScript *p_script, const StringName &p_method) {
+
+	const StringName &class_name = p_object->get_class_name();
+
+	// Scripts override Object::call() for their static functions.
+	if (p_method == CoreStringNames::get_singleton()->_free || Object::cast_to<Script>(p_object)) {
+		return _add_inline_cache_entry(p_cache, class_name, p_script);
+	}
+
+	// Same lookup order as Object::call(), script first.
+	for (const GDScript *sptr = p_script; sptr; sptr = sptr->_base) {
+
+		const Map<StringName, GDScriptFunction *>::Element *E = sptr->member_functions.find(p_method);
+		if (E) {
+			InlineCacheEntry *entry = _add_inline_cache_entry(p_cache, class_name, p_script);
+			entry->kind = INLINE_CACHE_SCRIPT_FUNCTION;
+			entry->function = E->get();
+			return entry;
+		}
+	}
+
+	// Vararg methods may fail after doing their work, so their errors couldn't be
+	// reported by running the generic call again.
+	MethodBind *method = ClassDB::get_method(class_name, p_method);
+	InlineCacheEntry *entry = _add_inline_cache_entry(p_cache, class_name, p_script);
+	if (method && !method->is_vararg()) {
+		entry->kind = INLINE_CACHE_METHOD_BIND;
+		entry->method = method;
+#ifdef PTRCALL_ENABLED
+		entry->ptrcall = _can_ptrcall(method);
+#endif
+	}
+	return entry;
+}
+
 #if defined(__GNUC__)
 #define OPCODES_TABLE                         \
 	static const void *switch_table_ops[] = { \
@@ -228,9 +467,17 @@ String GDScriptFunction::_get_call_error(const Variant::CallError &p_err, const
 		&&OPCODE_RETURN,                      \
 		&&OPCODE_ITERATE_BEGIN,               \
 		&&OPCODE_ITERATE,                     \
+		&&OPCODE_ITERATE_RELEASE,             \
 		&&OPCODE_ASSERT,                      \
 		&&OPCODE_BREAKPOINT,                  \
 		&&OPCODE_LINE,                        \
+		&&OPCODE_OPERATOR_INT,                \
+		&&OPCODE_OPERATOR_REAL,               \
+		&&OPCODE_GET_NAMED_VECTOR,            \
+		&&OPCODE_GET_ARRAY,                   \
+		&&OPCODE_CALL_BUILTIN_TYPE,           \
+		&&OPCODE_ITERATE_TYPED,               \
+		&&OPCODE_INLINE_CACHE,                \
 		&&OPCODE_END                          \
 	};
 
@@ -387,9 +634,20 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 
 	String err_text;
 
+	// Inline caches are only read and filled from the main thread, so they need no locking.
+	bool use_inline_caches = _inline_caches_count && Thread::get_caller_id() == Thread::get_main_id();
+
+	IterateLock *iterate_locks = NULL;
+	if (_iterate_lock_count) {
+		iterate_locks = (IterateLock *)alloca(sizeof(IterateLock) * _iterate_lock_count);
+		for (int i = 0; i < _iterate_lock_count; i++) {
+			memnew_placement(&iterate_locks[i], IterateLock);
+		}
+	}
+
 #ifdef DEBUG_ENABLED
 
-	if (ScriptDebugger::get_singleton())
+	if (GDScriptLanguage::get_singleton()->is_tracking_call_stack())
 		GDScriptLanguage::get_singleton()->enter_function(p_instance, this, stack, &ip, &line);
 
 #define GD_ERR_BREAK(m_cond)                                                                                           \
@@ -1473,6 +1731,18 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_ITERATE_RELEASE) {
+
+				CHECK_SPACE(2);
+
+				int slot = _code_ptr[ip + 1];
+				GD_ERR_BREAK(slot < 0 || slot >= _iterate_lock_count);
+
+				iterate_locks[slot].release();
+				ip += 2;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_ASSERT) {
 				CHECK_SPACE(3);
 
@@ -1536,6 +1806,521 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 			}
 			DISPATCH_OPCODE;
 
+			OPCODE(OPCODE_OPERATOR_INT) {
+
+				// Followed by OPCODE_OPERATOR.
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(a, 3);
+				GET_VARIANT_PTR(b, 4);
+
+				if (likely(a->get_type() == Variant::INT && b->get_type() == Variant::INT)) {
+					GET_VARIANT_PTR(dst, 5);
+					if (likely(_evaluate_int((Variant::Operator)_code_ptr[ip + 2], *VariantInternal::get_int(a), *VariantInternal::get_int(b), dst))) {
+						ip += 6;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				ip += 1;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_OPERATOR_REAL) {
+
+				// Followed by OPCODE_OPERATOR.
+				CHECK_SPACE(6);
+
+				GET_VARIANT_PTR(a, 3);
+				GET_VARIANT_PTR(b, 4);
+
+				// Two ints must stay an int operation, leave them to the generic path.
+				if (likely(a->is_num() && b->is_num() && (a->get_type() == Variant::REAL || b->get_type() == Variant::REAL))) {
+					GET_VARIANT_PTR(dst, 5);
+					if (likely(_evaluate_real((Variant::Operator)_code_ptr[ip + 2], _get_num(a), _get_num(b), dst))) {
+						ip += 6;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				ip += 1;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_NAMED_VECTOR) {
+
+				// Component index, followed by OPCODE_GET_NAMED.
+				CHECK_SPACE(6);
+
+				int component = _code_ptr[ip + 1];
+				GET_VARIANT_PTR(src, 3);
+
+				if (src->get_type() == Variant::VECTOR3) {
+					real_t value = (*VariantInternal::get_vector3(src))[component];
+					GET_VARIANT_PTR(dst, 5);
+					VariantInternal::set_real(dst, value);
+					ip += 6;
+					DISPATCH_OPCODE;
+				} else if (src->get_type() == Variant::VECTOR2 && component < 2) {
+					real_t value = (*VariantInternal::get_vector2(src))[component];
+					GET_VARIANT_PTR(dst, 5);
+					VariantInternal::set_real(dst, value);
+					ip += 6;
+					DISPATCH_OPCODE;
+				}
+
+				ip += 2;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_GET_ARRAY) {
+
+				// Followed by OPCODE_GET.
+				CHECK_SPACE(5);
+
+				GET_VARIANT_PTR(src, 2);
+				GET_VARIANT_PTR(index, 3);
+
+				if (likely(src->get_type() == Variant::ARRAY && index->get_type() == Variant::INT)) {
+					const Array *array = VariantInternal::get_array(src);
+					int64_t idx = *VariantInternal::get_int(index);
+					if (likely(idx >= 0 && idx < array->size())) {
+						GET_VARIANT_PTR(dst, 4);
+						// dst may be the array itself, copy the element out first.
+						Variant value = (*array)[idx];
+						*dst = value;
+						ip += 5;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				ip += 1;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_CALL_BUILTIN_TYPE) {
+
+				// Builtin method index, followed by OPCODE_CALL or OPCODE_CALL_RETURN.
+				CHECK_SPACE(6);
+
+				int method_idx = _code_ptr[ip + 1];
+				GD_ERR_BREAK(method_idx < 0 || method_idx >= _builtin_methods_count);
+				const BuiltInMethodInfo &method = _builtin_methods_ptr[method_idx];
+
+				GET_VARIANT_PTR(base, 4);
+
+				if (likely(base->get_type() == method.type)) {
+
+					bool call_ret = _code_ptr[ip + 2] == OPCODE_CALL_RETURN;
+					int argc = _code_ptr[ip + 3];
+					GD_ERR_BREAK(argc < 0);
+					CHECK_SPACE(6 + argc + 1);
+
+					Variant **argptrs = call_args;
+					for (int i = 0; i < argc; i++) {
+						GET_VARIANT_PTR(v, 6 + i);
+						argptrs[i] = v;
+					}
+
+					Variant *ret = NULL;
+					if (call_ret) {
+						GET_VARIANT_PTR(dst, 6 + argc);
+						ret = dst;
+					}
+
+#ifdef DEBUG_ENABLED
+					uint64_t call_time = 0;
+
+					if (GDScriptLanguage::get_singleton()->profiling) {
+						call_time = OS::get_singleton()->get_ticks_usec();
+					}
+
+#endif
+					Variant::CallError err;
+					base->call_builtin_method(method.method, (const Variant **)argptrs, argc, ret, err);
+#ifdef DEBUG_ENABLED
+					if (GDScriptLanguage::get_singleton()->profiling) {
+						function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+					}
+#endif
+
+					// Arguments are validated before calling, so on error the generic call runs to report it.
+					if (likely(err.error == Variant::CallError::CALL_OK)) {
+						ip += 6 + argc + 1;
+						DISPATCH_OPCODE;
+					}
+				}
+
+				ip += 2;
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_ITERATE_TYPED) {
+
+				// Lock slot, followed by the ITERATE_BEGIN or ITERATE it runs.
+				CHECK_SPACE(7);
+
+				int slot = _code_ptr[ip + 1];
+				GD_ERR_BREAK(slot < 0 || slot >= _iterate_lock_count);
+				IterateLock &lock = iterate_locks[slot];
+
+				ip += 2;
+				bool begin = _code_ptr[ip] == OPCODE_ITERATE_BEGIN;
+
+				GET_VARIANT_PTR(counter, 1);
+				GET_VARIANT_PTR(container, 2);
+				GET_VARIANT_PTR(iterator, 4);
+
+				// Same iteration as Variant::iter_init() and iter_next(); other
+				// containers run the generic instruction. The container is a
+				// copy only the loop sees, so pool arrays can't change under it.
+				int64_t idx = begin ? 0 : *VariantInternal::get_int(counter) + 1;
+				bool more;
+
+				switch (container->get_type()) {
+					case Variant::INT: {
+						more = idx < *VariantInternal::get_int(container);
+						if (more) {
+							VariantInternal::set_int(iterator, idx);
+						}
+					} break;
+					case Variant::VECTOR2: {
+						const Vector2 *range = VariantInternal::get_vector2(container);
+						if (begin) {
+							idx = range->x;
+						}
+						more = idx < (int64_t)range->y;
+						if (more) {
+							VariantInternal::set_int(iterator, idx);
+						}
+					} break;
+					case Variant::VECTOR3: {
+						const Vector3 *range = VariantInternal::get_vector3(container);
+						int64_t to = range->y;
+						int64_t step = range->z;
+						if (begin) {
+							idx = range->x;
+							more = idx != to && (idx < to ? step > 0 : step < 0);
+						} else {
+							idx = *VariantInternal::get_int(counter) + step;
+							more = step < 0 ? idx > to : idx < to;
+						}
+						if (more) {
+							VariantInternal::set_int(iterator, idx);
+						}
+					} break;
+					case Variant::ARRAY: {
+						const Array *array = VariantInternal::get_array(container);
+						more = idx < array->size();
+						if (more) {
+							*iterator = array->get(idx);
+						}
+					} break;
+					case Variant::POOL_INT_ARRAY: {
+						if (begin || !lock.int_read.ptr()) {
+							PoolVector<int> pool = *container;
+							lock.int_read = pool.read();
+							lock.size = pool.size();
+						}
+						more = idx < lock.size;
+						if (more) {
+							VariantInternal::set_int(iterator, lock.int_read[idx]);
+						}
+					} break;
+					case Variant::POOL_REAL_ARRAY: {
+						if (begin || !lock.real_read.ptr()) {
+							PoolVector<real_t> pool = *container;
+							lock.real_read = pool.read();
+							lock.size = pool.size();
+						}
+						more = idx < lock.size;
+						if (more) {
+							VariantInternal::set_real(iterator, lock.real_read[idx]);
+						}
+					} break;
+					case Variant::POOL_VECTOR2_ARRAY: {
+						if (begin || !lock.vector2_read.ptr()) {
+							PoolVector<Vector2> pool = *container;
+							lock.vector2_read = pool.read();
+							lock.size = pool.size();
+						}
+						more = idx < lock.size;
+						if (more) {
+							VariantInternal::set_vector2(iterator, lock.vector2_read[idx]);
+						}
+					} break;
+					case Variant::POOL_VECTOR3_ARRAY: {
+						if (begin || !lock.vector3_read.ptr()) {
+							PoolVector<Vector3> pool = *container;
+							lock.vector3_read = pool.read();
+							lock.size = pool.size();
+						}
+						more = idx < lock.size;
+						if (more) {
+							VariantInternal::set_vector3(iterator, lock.vector3_read[idx]);
+						}
+					} break;
+					default: {
+						DISPATCH_OPCODE;
+					}
+				}
+
+				if (more) {
+					VariantInternal::set_int(counter, idx);
+					ip += 5;
+				} else {
+					int jumpto = _code_ptr[ip + 3];
+					GD_ERR_BREAK(jumpto < 0 || jumpto > _code_size);
+					ip = jumpto;
+				}
+			}
+			DISPATCH_OPCODE;
+
+			OPCODE(OPCODE_INLINE_CACHE) {
+
+				// Cache slot, followed by the instruction it caches.
+				CHECK_SPACE(3);
+
+				int slot = _code_ptr[ip + 1];
+				GD_ERR_BREAK(slot < 0 || slot >= _inline_caches_count);
+
+				if (likely(use_inline_caches)) {
+
+					InlineCache &cache = _inline_caches_ptr[slot];
+					int cached_op = _code_ptr[ip + 2];
+
+					if (cached_op == OPCODE_GET_NAMED) {
+
+						CHECK_SPACE(6);
+						GET_VARIANT_PTR(src, 3);
+
+						Object *obj = _get_inline_cache_receiver(src);
+						bool cacheable = false;
+						const GDScript *receiver_script = obj ? _get_inline_cache_script(obj, cacheable) : NULL;
+
+						if (cacheable) {
+
+							int indexname = _code_ptr[ip + 4];
+							GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+
+							const InlineCacheEntry *entry = _find_inline_cache_entry(cache, obj->get_class_name(), receiver_script);
+							if (!entry) {
+								entry = _fill_inline_cache_get_named(cache, obj, receiver_script, _global_names_ptr[indexname]);
+							}
+
+							if (entry->kind != INLINE_CACHE_GENERIC) {
+								// dst may be the same stack position as src.
+								Variant value;
+								Variant::CallError err;
+								err.error = Variant::CallError::CALL_OK;
+								if (entry->kind == INLINE_CACHE_SCRIPT_MEMBER) {
+									value = static_cast<GDScriptInstance *>(obj->get_script_instance())->members[entry->member_index];
+								} else {
+									value = entry->method->call(obj, NULL, 0, err);
+								}
+
+								// Getters take no arguments, so on error the generic get runs to report it.
+								if (likely(err.error == Variant::CallError::CALL_OK)) {
+									GET_VARIANT_PTR(dst, 5);
+									*dst = value;
+									ip += 6;
+									DISPATCH_OPCODE;
+								}
+							}
+						}
+
+					} else if (cached_op == OPCODE_SET_MEMBER || cached_op == OPCODE_GET_MEMBER) {
+
+						CHECK_SPACE(5);
+
+						int indexname = _code_ptr[ip + 3];
+						GD_ERR_BREAK(indexname < 0 || indexname >= _global_names_count);
+
+						Object *owner = p_instance->owner;
+						bool setter = cached_op == OPCODE_SET_MEMBER;
+
+						const InlineCacheEntry *entry = _find_inline_cache_entry(cache, owner->get_class_name(), NULL);
+						if (!entry) {
+							entry = _fill_inline_cache_member(cache, owner, _global_names_ptr[indexname], setter);
+						}
+
+						if (entry->kind != INLINE_CACHE_GENERIC) {
+
+							Variant::CallError err;
+							if (setter) {
+								GET_VARIANT_PTR(src, 4);
+								if (entry->property_index >= 0) {
+									Variant index = entry->property_index;
+									const Variant *args[2] = { &index, src };
+									entry->method->call(owner, args, 2, err);
+								} else {
+									const Variant *args[1] = { src };
+									entry->method->call(owner, args, 1, err);
+								}
+							} else {
+								GET_VARIANT_PTR(dst, 4);
+								*dst = entry->method->call(owner, NULL, 0, err);
+							}
+
+							// Arguments are validated before calling, so on error the generic path runs to report it.
+							if (likely(err.error == Variant::CallError::CALL_OK)) {
+								ip += 5;
+								DISPATCH_OPCODE;
+							}
+						}
+
+					} else if (cached_op == OPCODE_CALL || cached_op == OPCODE_CALL_RETURN) {
+
+						CHECK_SPACE(6);
+
+						int argc = _code_ptr[ip + 3];
+						GD_ERR_BREAK(argc < 0);
+						CHECK_SPACE(6 + argc + 1);
+
+						GET_VARIANT_PTR(base, 4);
+
+						Object *obj = _get_inline_cache_receiver(base);
+						bool cacheable = false;
+						const GDScript *receiver_script = obj ? _get_inline_cache_script(obj, cacheable) : NULL;
+
+						if (cacheable) {
+
+							int nameg = _code_ptr[ip + 5];
+							GD_ERR_BREAK(nameg < 0 || nameg >= _global_names_count);
+
+							const InlineCacheEntry *entry = _find_inline_cache_entry(cache, obj->get_class_name(), receiver_script);
+							if (!entry) {
+								entry = _fill_inline_cache_call(cache, obj, receiver_script, _global_names_ptr[nameg]);
+							}
+
+#ifdef PTRCALL_ENABLED
+							if (entry->ptrcall && argc == entry->method->get_argument_count()) {
+
+								// Arguments that already have the exact type the method takes are passed
+								// straight from the stack, without converting them to and from Variant.
+								const void **ptrargs = (const void **)call_args;
+								bool typed = true;
+								for (int i = 0; i < argc && typed; i++) {
+									GET_VARIANT_PTR(v, 6 + i);
+									Variant::Type arg_type = entry->method->get_argument_type(i);
+									if (arg_type == Variant::NIL) {
+										ptrargs[i] = v;
+									} else if (v->get_type() == arg_type) {
+										ptrargs[i] = VariantInternal::get_opaque_pointer(v);
+									} else {
+										typed = false;
+									}
+								}
+
+								if (typed) {
+
+									Variant *dst = NULL;
+									if (cached_op == OPCODE_CALL_RETURN) {
+										GET_VARIANT_PTR(ret_dst, 6 + argc);
+										dst = ret_dst;
+									}
+
+									// The return value is written in place when dst already has its type,
+									// it's only read after the arguments were consumed.
+									Variant ret;
+									void *ret_ptr = NULL;
+									bool ret_in_dst = false;
+									if (entry->method->has_return()) {
+										Variant::Type ret_type = entry->method->get_argument_type(-1);
+										if (ret_type == Variant::NIL) {
+											ret_ptr = dst ? dst : &ret;
+											ret_in_dst = dst != NULL;
+										} else if (dst && dst->get_type() == ret_type) {
+											ret_ptr = VariantInternal::get_opaque_pointer(dst);
+											ret_in_dst = true;
+										} else {
+											Variant::CallError ce;
+											ret = Variant::construct(ret_type, NULL, 0, ce);
+											ret_ptr = VariantInternal::get_opaque_pointer(&ret);
+										}
+									}
+
+#ifdef DEBUG_ENABLED
+									uint64_t call_time = 0;
+
+									if (GDScriptLanguage::get_singleton()->profiling) {
+										call_time = OS::get_singleton()->get_ticks_usec();
+									}
+
+#endif
+									{
+#ifdef DEBUG_ENABLED
+										_ObjectDebugLock debug_lock(obj);
+#endif
+										entry->method->ptrcall(obj, ptrargs, ret_ptr);
+									}
+#ifdef DEBUG_ENABLED
+									if (GDScriptLanguage::get_singleton()->profiling) {
+										function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+									}
+#endif
+
+									if (dst && !ret_in_dst) {
+										*dst = ret;
+									}
+									ip += 6 + argc + 1;
+									DISPATCH_OPCODE;
+								}
+							}
+#endif
+
+							if (entry->kind != INLINE_CACHE_GENERIC) {
+
+								Variant **argptrs = call_args;
+								for (int i = 0; i < argc; i++) {
+									GET_VARIANT_PTR(v, 6 + i);
+									argptrs[i] = v;
+								}
+
+#ifdef DEBUG_ENABLED
+								uint64_t call_time = 0;
+
+								if (GDScriptLanguage::get_singleton()->profiling) {
+									call_time = OS::get_singleton()->get_ticks_usec();
+								}
+
+#endif
+								Variant::CallError err;
+								Variant ret;
+								{
+#ifdef DEBUG_ENABLED
+									_ObjectDebugLock debug_lock(obj);
+#endif
+									if (entry->kind == INLINE_CACHE_SCRIPT_FUNCTION) {
+										ret = entry->function->call(static_cast<GDScriptInstance *>(obj->get_script_instance()), (const Variant **)argptrs, argc, err);
+									} else {
+										ret = entry->method->call(obj, (const Variant **)argptrs, argc, err);
+									}
+								}
+#ifdef DEBUG_ENABLED
+								if (GDScriptLanguage::get_singleton()->profiling) {
+									function_call_time += OS::get_singleton()->get_ticks_usec() - call_time;
+								}
+#endif
+
+								// Arguments are validated before calling, so on error the generic call runs to report it.
+								if (likely(err.error == Variant::CallError::CALL_OK)) {
+									if (cached_op == OPCODE_CALL_RETURN) {
+										GET_VARIANT_PTR(dst, 6 + argc);
+										*dst = ret;
+									}
+									ip += 6 + argc + 1;
+									DISPATCH_OPCODE;
+								}
+							}
+						}
+					}
+				}
+
+				ip += 2;
+			}
+			DISPATCH_OPCODE;
+
 			OPCODE(OPCODE_END) {
 #ifdef DEBUG_ENABLED
 				exit_ok = true;
@@ -1585,6 +2370,11 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	}
 
 	OPCODES_OUT
+
+	for (int i = 0; i < _iterate_lock_count; i++) {
+		iterate_locks[i].~IterateLock();
+	}
+
 #ifdef DEBUG_ENABLED
 	if (GDScriptLanguage::get_singleton()->profiling) {
 		uint64_t time_taken = OS::get_singleton()->get_ticks_usec() - function_start_time;
@@ -1600,7 +2390,7 @@ Variant GDScriptFunction::call(GDScriptInstance *p_instance, const Variant **p_a
 	// When it's the last resume it will postpone the exit from stack,
 	// so the debugger knows which function triggered the resume of the next function (if any)
 	if (!p_state || yielded) {
-		if (ScriptDebugger::get_singleton())
+		if (GDScriptLanguage::get_singleton()->is_tracking_call_stack())
 			GDScriptLanguage::get_singleton()->exit_function();
 #endif
 
@@ -1742,6 +2532,7 @@ GDScriptFunction::GDScriptFunction() :
 
 	_stack_size = 0;
 	_call_size = 0;
+	_iterate_lock_count = 0;
 	rpc_mode = MultiplayerAPI::RPC_MODE_DISABLED;
 	name = "<anonymous>";
 #ifdef DEBUG_ENABLED
@@ -1869,7 +2660,7 @@ Variant GDScriptFunctionState::resume(const Variant &p_arg) {
 		}
 
 #ifdef DEBUG_ENABLED
-		if (ScriptDebugger::get_singleton())
+		if (GDScriptLanguage::get_singleton()->is_tracking_call_stack())
 			GDScriptLanguage::get_singleton()->exit_function();
 		if (state.stack_size) {
 			//free stack
@@ -40,11 +40,12 @@
 #include "core/variant.h"
 
 class GDScriptInstance;
+class MethodBind;
 class GDScript;
 
 struct GDScriptDataType {
 	bool has_type;
-	enum {
+	enum Kind {
 		UNINITIALIZED,
 		BUILTIN,
 		NATIVE,
@@ -183,9 +184,25 @@ public:
 		OPCODE_RETURN,
 		OPCODE_ITERATE_BEGIN,
 		OPCODE_ITERATE,
+		OPCODE_ITERATE_RELEASE,
 		OPCODE_ASSERT,
 		OPCODE_BREAKPOINT,
 		OPCODE_LINE,
+		// Typed prefixes, emitted in front of the generic instruction they
+		// specialize when the compiler knows the operand types. If the
+		// runtime types don't match, the VM skips the prefix and runs the
+		// generic instruction instead.
+		OPCODE_OPERATOR_INT,
+		OPCODE_OPERATOR_REAL,
+		OPCODE_GET_NAMED_VECTOR,
+		OPCODE_GET_ARRAY,
+		OPCODE_CALL_BUILTIN_TYPE,
+		// Prefix for OPCODE_ITERATE_BEGIN and OPCODE_ITERATE, iterating
+		// arrays, pool arrays and ranges without Variant::iter_*().
+		OPCODE_ITERATE_TYPED,
+		// Inline cache prefix for OPCODE_GET_NAMED, OPCODE_SET_MEMBER,
+		// OPCODE_GET_MEMBER and OPCODE_CALL(_RETURN) on objects.
+		OPCODE_INLINE_CACHE,
 		OPCODE_END
 	};
 
@@ -205,6 +222,83 @@ public:
 		ADDR_TYPE_NIL = 9
 	};
 
+	struct BuiltInMethodInfo {
+
+		Variant::Type type;
+		StringName name;
+		const Variant::BuiltInMethod *method;
+	};
+
+	enum {
+		INLINE_CACHE_ENTRIES = 4
+	};
+
+	enum InlineCacheKind {
+		INLINE_CACHE_EMPTY,
+		INLINE_CACHE_GENERIC, // can't be cached, run the generic instruction
+		INLINE_CACHE_METHOD_BIND, // native getter, setter or method
+		INLINE_CACHE_SCRIPT_MEMBER, // GDScript member variable without getter
+		INLINE_CACHE_SCRIPT_FUNCTION, // GDScript member function
+	};
+
+	// What a call site resolved to for one receiver, keyed by its native class
+	// and its GDScript (NULL when it has no script instance). The class name is
+	// held, so comparing it is a pointer comparison that can't match a name
+	// freed and created again.
+	struct InlineCacheEntry {
+
+		StringName class_name;
+		const GDScript *script;
+		uint32_t generation;
+		InlineCacheKind kind;
+		union {
+			MethodBind *method;
+			GDScriptFunction *function;
+			int member_index;
+		};
+		int property_index;
+		bool ptrcall; // the method can take its arguments straight from the stack
+
+		InlineCacheEntry() :
+				script(NULL),
+				generation(0),
+				kind(INLINE_CACHE_EMPTY),
+				method(NULL),
+				property_index(-1),
+				ptrcall(false) {}
+	};
+
+	struct InlineCache {
+
+		InlineCacheEntry entries[INLINE_CACHE_ENTRIES];
+		uint32_t next;
+
+		InlineCache() :
+				next(0) {}
+	};
+
+	// Read locks of the pool arrays iterated by the 'for' loops of a call, one
+	// per nesting level. A loop takes its lock once and keeps it until it ends
+	// or the call returns or yields; resuming takes it again.
+	struct IterateLock {
+
+		PoolVector<int>::Read int_read;
+		PoolVector<real_t>::Read real_read;
+		PoolVector<Vector2>::Read vector2_read;
+		PoolVector<Vector3>::Read vector3_read;
+		int size;
+
+		void release() {
+			int_read.release();
+			real_read.release();
+			vector2_read.release();
+			vector3_read.release();
+		}
+
+		IterateLock() :
+				size(0) {}
+	};
+
 	struct StackDebug {
 
 		int line;
@@ -215,6 +309,7 @@ public:
 
 private:
 	friend class GDScriptCompiler;
+	friend class GDScriptCompiledCache;
 
 	StringName source;
 
@@ -223,6 +318,11 @@ private:
 	int _constant_count;
 	const StringName *_global_names_ptr;
 	int _global_names_count;
+	const BuiltInMethodInfo *_builtin_methods_ptr;
+	int _builtin_methods_count;
+	InlineCache *_inline_caches_ptr;
+	int _inline_caches_count;
+	int _iterate_lock_count;
 #ifdef TOOLS_ENABLED
 	const StringName *_named_globals_ptr;
 	int _named_globals_count;
@@ -243,6 +343,8 @@ private:
 	StringName name;
 	Vector<Variant> constants;
 	Vector<StringName> global_names;
+	Vector<BuiltInMethodInfo> builtin_methods;
+	Vector<InlineCache> inline_caches;
 #ifdef TOOLS_ENABLED
 	Vector<StringName> named_globals;
 #endif
@@ -260,6 +362,15 @@ private:
 	_FORCE_INLINE_ Variant *_get_variant(int p_address, GDScriptInstance *p_instance, GDScript *p_script, Variant &self, Variant *p_stack, String &r_error) const;
 	_FORCE_INLINE_ String _get_call_error(const Variant::CallError &p_err, const String &p_where, const Variant **argptrs) const;
 
+	static uint32_t inline_cache_generation;
+
+	static const GDScript *_get_inline_cache_script(Object *p_object, bool &r_cacheable);
+	_FORCE_INLINE_ static const InlineCacheEntry *_find_inline_cache_entry(const InlineCache &p_cache, const StringName &p_class_name, const GDScript *p_script);
+	static InlineCacheEntry *_add_inline_cache_entry(InlineCache &p_cache, const StringName &p_class_name, const GDScript *p_script);
+	static const InlineCacheEntry *_fill_inline_cache_get_named(InlineCache &p_cache, Object *p_object, const GDScript *p_script, const StringName &p_name);
+	static const InlineCacheEntry *_fill_inline_cache_member(InlineCache &p_cache, Object *p_object, const StringName &p_name, bool p_setter);
+	static const InlineCacheEntry *_fill_inline_cache_call(InlineCache &p_cache, Object *p_object, const GDScript *p_script, const StringName &p_method);
+
 	friend class GDScriptLanguage;
 
 	SelfList<GDScriptFunction> function_list;
@@ -298,6 +409,9 @@ public:
 		Variant result;
 	};
 
+	// Drops every resolution made by the inline caches, called when scripts are reloaded or freed.
+	static void invalidate_inline_caches();
+
 	_FORCE_INLINE_ bool is_static() const { return _static; }
 
 	const int *get_code() const; //used for debug
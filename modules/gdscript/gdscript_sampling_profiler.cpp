@@ -0,0 +1,292 @@
+/*************************************************************************/
+/*  gdscript_sampling_profiler.cpp                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "gdscript_sampling_profiler.h"
+
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/project_settings.h"
+#include "gdscript.h"
+
+GDScriptSamplingProfiler *GDScriptSamplingProfiler::singleton = NULL;
+
+void GDScriptSamplingProfiler::_thread_func(void *p_self) {
+
+	GDScriptSamplingProfiler *self = (GDScriptSamplingProfiler *)p_self;
+
+	while (!self->exit_thread) {
+		OS::get_singleton()->delay_usec(self->interval_usec);
+		self->_take_sample();
+	}
+}
+
+int GDScriptSamplingProfiler::_get_frame_id(const String &p_name) {
+
+	const int *id = frame_ids.getptr(p_name);
+	if (id) {
+		return *id;
+	}
+
+	int new_id = frames.size();
+	frames.push_back(p_name);
+	frame_ids[p_name] = new_id;
+	return new_id;
+}
+
+void GDScriptSamplingProfiler::_take_sample() {
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+
+	Vector<int> sample_frames;
+	String key;
+
+	// The main thread fills in a call level before publishing the new stack
+	// position (release), so every level below the position loaded here
+	// (acquire) holds a function that was called. The main thread keeps
+	// running meanwhile, so a level may already belong to a later call and
+	// the sample may be a few calls off. Functions on the stack can't be
+	// destroyed, and those that leave it block in their destructor on the
+	// language lock, so holding it keeps every function read here valid.
+	if (language->lock) {
+		language->lock->lock();
+	}
+
+	int depth = MIN((int)atomic_load_acquire((volatile uint32_t *)&language->_debug_call_stack_pos), language->_debug_max_call_stack);
+	for (int i = 0; i < depth; i++) {
+
+		GDScriptFunction *function = atomic_load_acquire(&language->_call_stack[i].function);
+		if (!function) {
+			continue;
+		}
+
+		int id = _get_frame_id(String(function->get_source()) + ":" + String(function->get_name()));
+		sample_frames.push_back(id);
+		key += itos(id) + ";";
+	}
+
+	if (language->lock) {
+		language->lock->unlock();
+	}
+
+	Sample sample;
+	sample.time = OS::get_singleton()->get_ticks_usec() - start_time;
+	sample.stack = -1;
+
+	sample_count++;
+	if (sample_frames.empty()) {
+		idle_samples++;
+	} else {
+		int *id = stack_ids.getptr(key);
+		if (id) {
+			sample.stack = *id;
+			stacks.write[*id].count++;
+		} else {
+			Stack stack;
+			stack.frames = sample_frames;
+			stack.count = 1;
+			sample.stack = stacks.size();
+			stacks.push_back(stack);
+			stack_ids[key] = sample.stack;
+		}
+	}
+
+	if (trace) {
+		samples.push_back(sample);
+	}
+}
+
+Error GDScriptSamplingProfiler::_save_collapsed(const String &p_path) const {
+
+	Error err;
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot write GDScript sampling profile to '" + p_path + "'.");
+
+	// Spaces separate the count and semicolons the frames, so neither can
+	// appear in frame names.
+	Vector<String> names;
+	names.resize(frames.size());
+	for (int i = 0; i < frames.size(); i++) {
+		names.write[i] = frames[i].replace(" ", "_").replace(";", "_");
+	}
+
+	for (int i = 0; i < stacks.size(); i++) {
+
+		const Stack &stack = stacks[i];
+
+		String line;
+		for (int j = 0; j < stack.frames.size(); j++) {
+			if (j > 0) {
+				line += ";";
+			}
+			line += names[stack.frames[j]];
+		}
+		line += " " + itos(stack.count);
+		f->store_line(line);
+	}
+
+	return OK;
+}
+
+Error GDScriptSamplingProfiler::_save_trace(const String &p_path) const {
+
+	Error err;
+	FileAccessRef f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+	ERR_FAIL_COND_V_MSG(err != OK, err, "Cannot write GDScript sampling profile to '" + p_path + "'.");
+
+	f->store_string("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	Vector<String> names;
+	names.resize(frames.size());
+	for (int i = 0; i < frames.size(); i++) {
+		names.write[i] = frames[i].json_escape();
+	}
+
+	// Consecutive samples sharing the bottom of their stacks are merged into
+	// one complete ("X") event per frame, which trace viewers show as a
+	// flame chart over time.
+	Vector<int> open_frames;
+	Vector<uint64_t> open_times;
+	bool first = true;
+
+	for (int i = 0; i <= samples.size(); i++) {
+
+		uint64_t time = i < samples.size() ? samples[i].time : (samples.size() ? samples[samples.size() - 1].time + interval_usec : 0);
+		const Vector<int> *sample_frames = (i < samples.size() && samples[i].stack >= 0) ? &stacks[samples[i].stack].frames : NULL;
+
+		int common = 0;
+		if (sample_frames) {
+			while (common < open_frames.size() && common < sample_frames->size() && open_frames[common] == (*sample_frames)[common]) {
+				common++;
+			}
+		}
+
+		for (int j = open_frames.size() - 1; j >= common; j--) {
+			String event = first ? "" : ",\n";
+			event += "{\"name\":\"" + names[open_frames[j]] + "\",\"cat\":\"gdscript\",\"ph\":\"X\",\"pid\":1,\"tid\":1";
+			event += ",\"ts\":" + itos(open_times[j]) + ",\"dur\":" + itos(time - open_times[j]) + "}";
+			f->store_string(event);
+			first = false;
+		}
+		open_frames.resize(common);
+		open_times.resize(common);
+
+		if (sample_frames) {
+			for (int j = common; j < sample_frames->size(); j++) {
+				open_frames.push_back((*sample_frames)[j]);
+				open_times.push_back(time);
+			}
+		}
+	}
+
+	f->store_string("\n]}\n");
+
+	return OK;
+}
+
+void GDScriptSamplingProfiler::initialize() {
+
+	String path;
+
+	List<String> args = OS::get_singleton()->get_cmdline_args();
+	for (List<String>::Element *E = args.front(); E; E = E->next()) {
+
+		if (E->get() == "--gdscript-sample-profile" && E->next()) {
+			path = E->next()->get();
+		}
+	}
+
+	if (path == String()) {
+		return;
+	}
+
+#if !defined(DEBUG_ENABLED) || defined(NO_THREADS)
+	ERR_FAIL_MSG("The GDScript sampling profiler requires a build with debugging and thread support.");
+#else
+	int rate = 1000;
+	for (List<String>::Element *E = args.front(); E; E = E->next()) {
+
+		if (E->get() == "--gdscript-sample-rate" && E->next()) {
+			rate = E->next()->get().to_int();
+		}
+	}
+
+	ERR_FAIL_COND_MSG(rate <= 0, "Invalid GDScript sampling rate: " + itos(rate) + ".");
+
+	GDScriptLanguage *language = GDScriptLanguage::get_singleton();
+	if (!language->_call_stack) {
+		// Without the debugger the call stack isn't tracked by default.
+		language->_debug_max_call_stack = GLOBAL_GET("debug/settings/gdscript/max_call_stack");
+		language->_call_stack = memnew_arr(GDScriptLanguage::CallLevel, language->_debug_max_call_stack + 1);
+	}
+
+	singleton = memnew(GDScriptSamplingProfiler);
+	singleton->output_path = path;
+	singleton->trace = path.get_extension().to_lower() == "json";
+	singleton->interval_usec = 1000000 / rate;
+	singleton->start_time = OS::get_singleton()->get_ticks_usec();
+	singleton->thread = Thread::create(_thread_func, singleton);
+
+	print_verbose("GDScript: Sampling profiler started, writing to '" + path + "' on exit.");
+#endif
+}
+
+void GDScriptSamplingProfiler::finish() {
+
+	if (!singleton) {
+		return;
+	}
+
+	singleton->exit_thread = true;
+	Thread::wait_to_finish(singleton->thread);
+	memdelete(singleton->thread);
+	singleton->thread = NULL;
+
+	print_verbose("GDScript: Sampling profiler took " + itos(singleton->sample_count) + " samples, " + itos(singleton->idle_samples) + " outside of scripts.");
+
+	if (singleton->trace) {
+		singleton->_save_trace(singleton->output_path);
+	} else {
+		singleton->_save_collapsed(singleton->output_path);
+	}
+
+	memdelete(singleton);
+	singleton = NULL;
+}
+
+GDScriptSamplingProfiler::GDScriptSamplingProfiler() {
+
+	thread = NULL;
+	exit_thread = false;
+	interval_usec = 1000;
+	start_time = 0;
+	trace = false;
+	sample_count = 0;
+	idle_samples = 0;
+}
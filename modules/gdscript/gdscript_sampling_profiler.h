@@ -0,0 +1,88 @@
+/*************************************************************************/
+/*  gdscript_sampling_profiler.h                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef GDSCRIPT_SAMPLING_PROFILER_H
+#define GDSCRIPT_SAMPLING_PROFILER_H
+
+#include "core/hash_map.h"
+#include "core/os/thread.h"
+#include "core/ustring.h"
+#include "core/vector.h"
+
+// Periodically samples the GDScript call stack of the main thread from a
+// separate thread, so scripts can be profiled without the debugger (e.g. on
+// headless servers). Enabled from the command line; the samples are written
+// on shutdown, either as collapsed stacks (one "frame;frame;frame count"
+// line per stack, as used by flame graph tools) or, if the output path ends
+// in ".json", as a Chrome trace.
+class GDScriptSamplingProfiler {
+
+	struct Sample {
+		uint64_t time;
+		int stack; // -1 when no script was running.
+	};
+
+	struct Stack {
+		Vector<int> frames;
+		uint64_t count;
+	};
+
+	Thread *thread;
+	volatile bool exit_thread;
+	uint64_t interval_usec;
+	uint64_t start_time;
+	String output_path;
+	bool trace;
+
+	Vector<String> frames;
+	HashMap<String, int> frame_ids;
+	Vector<Stack> stacks;
+	HashMap<String, int> stack_ids;
+	Vector<Sample> samples;
+	uint64_t sample_count;
+	uint64_t idle_samples;
+
+	static GDScriptSamplingProfiler *singleton;
+
+	static void _thread_func(void *p_self);
+	void _take_sample();
+	int _get_frame_id(const String &p_name);
+
+	Error _save_collapsed(const String &p_path) const;
+	Error _save_trace(const String &p_path) const;
+
+public:
+	static void initialize();
+	static void finish();
+
+	GDScriptSamplingProfiler();
+};
+
+#endif // GDSCRIPT_SAMPLING_PROFILER_H
@@ -34,7 +34,9 @@
 #include "core/io/resource_loader.h"
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
+#include "core/os/os.h"
 #include "gdscript.h"
+#include "gdscript_compiled_cache.h"
 #include "gdscript_tokenizer.h"
 
 GDScriptLanguage *script_language_gd = NULL;
@@ -58,6 +60,17 @@ class EditorExportGDScript : public EditorExportPlugin {
 	GDCLASS(EditorExportGDScript, EditorExportPlugin);
 
 public:
+	virtual void _export_begin(const Set<String> &p_features, bool p_debug, const String &p_path, int p_flags) {
+
+		// Identifies this export, so compiled script caches from previous exports aren't used.
+		String export_id = itos(OS::get_singleton()->get_unix_time()) + "-" + itos(OS::get_singleton()->get_ticks_usec());
+		CharString utf8 = export_id.utf8();
+		Vector<uint8_t> data;
+		data.resize(utf8.length());
+		copymem(data.ptrw(), utf8.get_data(), utf8.length());
+		add_file(GDScriptCompiledCache::EXPORT_ID_PATH, data, false);
+	}
+
 	virtual void _export_file(const String &p_path, const String &p_type, const Set<String> &p_features) {
 
 		int script_mode = EditorExportPreset::MODE_SCRIPT_COMPILED;
@@ -0,0 +1,127 @@
+/*************************************************************************/
+/*  occluder.cpp                                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "occluder.h"
+
+#include "core/core_string_names.h"
+#include "scene/scene_string_names.h"
+
+void Occluder::_mesh_changed() {
+
+	PoolVector<Vector3> vertices;
+	aabb = AABB();
+
+	if (mesh.is_valid()) {
+
+		PoolVector<Face3> faces = mesh->get_faces();
+		int count = faces.size();
+		vertices.resize(count * 3);
+
+		PoolVector<Face3>::Read r = faces.read();
+		PoolVector<Vector3>::Write w = vertices.write();
+
+		for (int i = 0; i < count; i++) {
+			for (int j = 0; j < 3; j++) {
+				w[i * 3 + j] = r[i].vertex[j];
+				if (i == 0 && j == 0) {
+					aabb.position = r[i].vertex[j];
+				} else {
+					aabb.expand_to(r[i].vertex[j]);
+				}
+			}
+		}
+	}
+
+	VS::get_singleton()->occluder_set_faces(occluder, vertices);
+	update_gizmo();
+}
+
+void Occluder::set_mesh(const Ref<Mesh> &p_mesh) {
+
+	if (mesh == p_mesh)
+		return;
+
+	if (mesh.is_valid()) {
+		mesh->disconnect(CoreStringNames::get_singleton()->changed, this, SceneStringNames::get_singleton()->_mesh_changed);
+	}
+
+	mesh = p_mesh;
+
+	if (mesh.is_valid()) {
+		mesh->connect(CoreStringNames::get_singleton()->changed, this, SceneStringNames::get_singleton()->_mesh_changed);
+	}
+
+	_mesh_changed();
+	_change_notify();
+	update_configuration_warning();
+}
+
+Ref<Mesh> Occluder::get_mesh() const {
+
+	return mesh;
+}
+
+AABB Occluder::get_aabb() const {
+
+	return aabb;
+}
+
+PoolVector<Face3> Occluder::get_faces(uint32_t p_usage_flags) const {
+
+	return PoolVector<Face3>();
+}
+
+String Occluder::get_configuration_warning() const {
+
+	if (mesh.is_null()) {
+		return TTR("A mesh must be provided for this node to hide anything.\nThe viewports rendering it also need occlusion culling enabled.");
+	}
+	return String();
+}
+
+void Occluder::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("set_mesh", "mesh"), &Occluder::set_mesh);
+	ClassDB::bind_method(D_METHOD("get_mesh"), &Occluder::get_mesh);
+	ClassDB::bind_method(D_METHOD("_mesh_changed"), &Occluder::_mesh_changed);
+
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mesh", PROPERTY_HINT_RESOURCE_TYPE, "Mesh"), "set_mesh", "get_mesh");
+}
+
+Occluder::Occluder() {
+
+	occluder = VisualServer::get_singleton()->occluder_create();
+	set_base(occluder);
+}
+
+Occluder::~Occluder() {
+
+	VS::get_singleton()->free(occluder);
+}
@@ -268,6 +268,7 @@ private:
 
 	bool disable_3d;
 	bool keep_3d_linear;
+	bool use_occlusion_culling;
 	UpdateMode update_mode;
 	RID texture_rid;
 	uint32_t texture_flags;
@@ -512,6 +513,9 @@ public:
 	void set_keep_3d_linear(bool p_keep_3d_linear);
 	bool get_keep_3d_linear() const;
 
+	void set_use_occlusion_culling(bool p_enable);
+	bool is_using_occlusion_culling() const;
+
 	void set_attach_to_screen_rect(const Rect2 &p_rect);
 	Rect2 get_attach_to_screen_rect() const;
 
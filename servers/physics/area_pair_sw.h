@@ -44,6 +44,8 @@ class AreaPairSW : public ConstraintSW {
 	bool colliding;
 
 public:
+	virtual bool can_setup_in_parallel() const { return false; } // Modifies the area.
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -60,6 +62,8 @@ class Area2PairSW : public ConstraintSW {
 	bool colliding;
 
 public:
+	virtual bool can_setup_in_parallel() const { return false; } // Modifies both areas.
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
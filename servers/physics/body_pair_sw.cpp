@@ -219,8 +219,23 @@ real_t combine_friction(BodySW *A, BodySW *B) {
 	return ABS(MIN(A->get_friction(), B->get_friction()));
 }
 
+bool BodyPairSW::can_setup_in_parallel() const {
+
+	// Contacts reported to static or kinematic bodies are shared between islands.
+	if (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->can_report_contacts())
+		return false;
+	if (B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->can_report_contacts())
+		return false;
+
+	return !space->is_debugging_contacts();
+}
+
 bool BodyPairSW::setup(real_t p_step) {
 
+	// impulses on static and kinematic bodies have no effect, skip them so bodies shared between islands are never written
+	dynamic_A = A->get_mode() > PhysicsServer::BODY_MODE_KINEMATIC;
+	dynamic_B = B->get_mode() > PhysicsServer::BODY_MODE_KINEMATIC;
+
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && B->get_mode() <= PhysicsServer::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
@@ -334,8 +349,10 @@ bool BodyPairSW::setup(real_t p_step) {
 		c.depth = depth;
 
 		Vector3 j_vec = c.normal * c.acc_normal_impulse + c.acc_tangent_impulse;
-		A->apply_impulse(c.rA + A->get_center_of_mass(), -j_vec);
-		B->apply_impulse(c.rB + B->get_center_of_mass(), j_vec);
+		if (dynamic_A)
+			A->apply_impulse(c.rA + A->get_center_of_mass(), -j_vec);
+		if (dynamic_B)
+			B->apply_impulse(c.rB + B->get_center_of_mass(), j_vec);
 		c.acc_bias_impulse = 0;
 		c.acc_bias_impulse_center_of_mass = 0;
 
@@ -382,8 +399,10 @@ void BodyPairSW::solve(real_t p_step) {
 
 			Vector3 jb = c.normal * (c.acc_bias_impulse - jbnOld);
 
-			A->apply_bias_impulse(c.rA + A->get_center_of_mass(), -jb, MAX_BIAS_ROTATION / p_step);
-			B->apply_bias_impulse(c.rB + B->get_center_of_mass(), jb, MAX_BIAS_ROTATION / p_step);
+			if (dynamic_A)
+				A->apply_bias_impulse(c.rA + A->get_center_of_mass(), -jb, MAX_BIAS_ROTATION / p_step);
+			if (dynamic_B)
+				B->apply_bias_impulse(c.rB + B->get_center_of_mass(), jb, MAX_BIAS_ROTATION / p_step);
 
 			crbA = A->get_biased_angular_velocity().cross(c.rA);
 			crbB = B->get_biased_angular_velocity().cross(c.rB);
@@ -399,8 +418,10 @@ void BodyPairSW::solve(real_t p_step) {
 
 				Vector3 jb_com = c.normal * (c.acc_bias_impulse_center_of_mass - jbnOld_com);
 
-				A->apply_bias_impulse(A->get_center_of_mass(), -jb_com, 0.0f);
-				B->apply_bias_impulse(B->get_center_of_mass(), jb_com, 0.0f);
+				if (dynamic_A)
+					A->apply_bias_impulse(A->get_center_of_mass(), -jb_com, 0.0f);
+				if (dynamic_B)
+					B->apply_bias_impulse(B->get_center_of_mass(), jb_com, 0.0f);
 			}
 
 			c.active = true;
@@ -421,8 +442,10 @@ void BodyPairSW::solve(real_t p_step) {
 
 			Vector3 j = c.normal * (c.acc_normal_impulse - jnOld);
 
-			A->apply_impulse(c.rA + A->get_center_of_mass(), -j);
-			B->apply_impulse(c.rB + B->get_center_of_mass(), j);
+			if (dynamic_A)
+				A->apply_impulse(c.rA + A->get_center_of_mass(), -j);
+			if (dynamic_B)
+				B->apply_impulse(c.rB + B->get_center_of_mass(), j);
 
 			c.active = true;
 		}
@@ -466,8 +489,10 @@ void BodyPairSW::solve(real_t p_step) {
 
 			jt = c.acc_tangent_impulse - jtOld;
 
-			A->apply_impulse(c.rA + A->get_center_of_mass(), -jt);
-			B->apply_impulse(c.rB + B->get_center_of_mass(), jt);
+			if (dynamic_A)
+				A->apply_impulse(c.rA + A->get_center_of_mass(), -jt);
+			if (dynamic_B)
+				B->apply_impulse(c.rB + B->get_center_of_mass(), jt);
 
 			c.active = true;
 		}
@@ -486,6 +511,8 @@ BodyPairSW::BodyPairSW(BodySW *p_A, int p_shape_A, BodySW *p_B, int p_shape_B) :
 	B->add_constraint(this, 1);
 	contact_count = 0;
 	collided = false;
+	dynamic_A = false;
+	dynamic_B = false;
 }
 
 BodyPairSW::~BodyPairSW() {
@@ -76,6 +76,8 @@ class BodyPairSW : public ConstraintSW {
 	Contact contacts[MAX_CONTACTS];
 	int contact_count;
 	bool collided;
+	bool dynamic_A;
+	bool dynamic_B;
 
 	static void _contact_added_callback(const Vector3 &p_point_A, const Vector3 &p_point_B, void *p_userdata);
 
@@ -87,6 +89,8 @@ class BodyPairSW : public ConstraintSW {
 	SpaceSW *space;
 
 public:
+	virtual bool can_setup_in_parallel() const;
+
 	bool setup(real_t p_step);
 	void solve(real_t p_step);
 
@@ -76,6 +76,11 @@ public:
 	_FORCE_INLINE_ void disable_collisions_between_bodies(const bool p_disabled) { disabled_collisions_between_bodies = p_disabled; }
 	_FORCE_INLINE_ bool is_disabled_collisions_between_bodies() const { return disabled_collisions_between_bodies; }
 
+	// Islands are stepped in parallel when their constraints only write to themselves
+	// and to the rigid and character bodies of their own island.
+	virtual bool can_setup_in_parallel() const { return true; }
+	virtual bool can_solve_in_parallel() const { return true; }
+
 	virtual bool setup(real_t p_step) = 0;
 	virtual void solve(real_t p_step) = 0;
 
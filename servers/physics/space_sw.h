@@ -111,6 +111,8 @@ private:
 	real_t body_time_to_sleep;
 	real_t body_angular_velocity_damp_ratio;
 
+	bool parallel_islands;
+
 	bool locked;
 
 	int island_count;
@@ -162,6 +164,7 @@ public:
 	_FORCE_INLINE_ real_t get_body_angular_velocity_sleep_threshold() const { return body_angular_velocity_sleep_threshold; }
 	_FORCE_INLINE_ real_t get_body_time_to_sleep() const { return body_time_to_sleep; }
 	_FORCE_INLINE_ real_t get_body_angular_velocity_damp_ratio() const { return body_angular_velocity_damp_ratio; }
+	_FORCE_INLINE_ bool is_parallel_islands_enabled() const { return parallel_islands; }
 
 	void update();
 	void setup();
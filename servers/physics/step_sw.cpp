@@ -32,6 +32,7 @@
 #include "joints_sw.h"
 
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 
 void StepSW::_populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island) {
 
@@ -69,6 +70,27 @@ void StepSW::_setup_island(ConstraintSW *p_island, real_t p_delta) {
 	}
 }
 
+void StepSW::_setup_island_serial_constraints(ConstraintSW *p_island, real_t p_delta) {
+
+	ConstraintSW *ci = p_island;
+	while (ci) {
+		if (!ci->can_setup_in_parallel())
+			ci->setup(p_delta);
+		ci = ci->get_island_next();
+	}
+}
+
+bool StepSW::_can_solve_island_in_parallel(ConstraintSW *p_island) const {
+
+	ConstraintSW *ci = p_island;
+	while (ci) {
+		if (!ci->can_solve_in_parallel())
+			return false;
+		ci = ci->get_island_next();
+	}
+	return true;
+}
+
 void StepSW::_solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta) {
 
 	int at_priority = 1;
@@ -144,6 +166,27 @@ void StepSW::_check_suspend(BodySW *p_island, real_t p_delta) {
 	}
 }
 
+void StepSW::_integrate_forces_task(uint32_t p_index, void *p_userdata) {
+
+	parallel_bodies[p_index]->integrate_forces(_delta);
+}
+
+void StepSW::_setup_island_task(uint32_t p_index, void *p_userdata) {
+
+	// The other constraints were already set up by _setup_island_serial_constraints().
+	ConstraintSW *ci = parallel_islands[p_index];
+	while (ci) {
+		if (ci->can_setup_in_parallel())
+			ci->setup(_delta);
+		ci = ci->get_island_next();
+	}
+}
+
+void StepSW::_solve_island_task(uint32_t p_index, void *p_userdata) {
+
+	_solve_island(parallel_islands[p_index], _iterations, _delta);
+}
+
 void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
@@ -152,6 +195,14 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	const SelfList<BodySW>::List *body_list = &p_space->get_active_body_list();
 
+	WorkerThreadPool *pool = NULL;
+	if (p_space->is_parallel_islands_enabled() && WorkerThreadPool::get_singleton() && WorkerThreadPool::get_singleton()->get_thread_count() > 0) {
+		pool = WorkerThreadPool::get_singleton();
+	}
+
+	_delta = p_delta;
+	_iterations = p_iterations;
+
 	/* INTEGRATE FORCES */
 
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
@@ -160,11 +211,46 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 	int active_count = 0;
 
 	const SelfList<BodySW> *b = body_list->first();
-	while (b) {
 
-		b->self()->integrate_forces(p_delta);
-		b = b->next();
-		active_count++;
+	if (pool) {
+
+		while (b) {
+			active_count++;
+			b = b->next();
+		}
+
+		if ((int)parallel_bodies.size() < active_count)
+			parallel_bodies.resize(active_count);
+
+		BodySW **bodies = parallel_bodies.ptr();
+		int parallel_count = 0;
+
+		b = body_list->first();
+		while (b) {
+
+			BodySW *body = b->self();
+			// Kinematic and continuous bodies update their shapes in the broadphase, keep them on this thread.
+			if (body->get_mode() == PhysicsServer::BODY_MODE_KINEMATIC || body->is_continuous_collision_detection_enabled()) {
+				body->integrate_forces(p_delta);
+			} else {
+				bodies[parallel_count++] = body;
+			}
+			b = b->next();
+		}
+
+		if (parallel_count) {
+			WorkerThreadPool::TaskID task = pool->add_template_group_task(this, &StepSW::_integrate_forces_task, (void *)NULL, parallel_count);
+			pool->wait_for_task_completion(task);
+		}
+
+	} else {
+
+		while (b) {
+
+			b->self()->integrate_forces(p_delta);
+			b = b->next();
+			active_count++;
+		}
 	}
 
 	p_space->set_active_objects(active_count);
@@ -230,6 +316,52 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
+	int parallel_island_count = 0;
+
+	if (pool) {
+
+		// Move the islands that can be stepped in parallel to their own array,
+		// the ones left in the list (and their order) are processed as usual.
+		int total_count = 0;
+		ConstraintSW *ci = constraint_island_list;
+		while (ci) {
+			total_count++;
+			ci = ci->get_island_list_next();
+		}
+
+		if ((int)parallel_islands.size() < total_count)
+			parallel_islands.resize(total_count);
+
+		ConstraintSW **islands = parallel_islands.ptr();
+		ConstraintSW *prev = NULL;
+
+		ci = constraint_island_list;
+		while (ci) {
+			ConstraintSW *next = ci->get_island_list_next();
+			if (_can_solve_island_in_parallel(ci)) {
+				islands[parallel_island_count++] = ci;
+				if (prev) {
+					prev->set_island_list_next(next);
+				} else {
+					constraint_island_list = next;
+				}
+			} else {
+				prev = ci;
+			}
+			ci = next;
+		}
+
+		// Constraints that modify shared objects (areas, contacts reported to static bodies) are set up first, in order.
+		for (int i = 0; i < parallel_island_count; i++) {
+			_setup_island_serial_constraints(islands[i], p_delta);
+		}
+
+		if (parallel_island_count) {
+			WorkerThreadPool::TaskID task = pool->add_template_group_task(this, &StepSW::_setup_island_task, (void *)NULL, parallel_island_count);
+			pool->wait_for_task_completion(task);
+		}
+	}
+
 	{
 		ConstraintSW *ci = constraint_island_list;
 		while (ci) {
@@ -247,6 +379,11 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
+	if (parallel_island_count) {
+		WorkerThreadPool::TaskID task = pool->add_template_group_task(this, &StepSW::_solve_island_task, (void *)NULL, parallel_island_count);
+		pool->wait_for_task_completion(task);
+	}
+
 	{
 		ConstraintSW *ci = constraint_island_list;
 		while (ci) {
@@ -296,4 +433,6 @@ void StepSW::step(SpaceSW *p_space, real_t p_delta, int p_iterations) {
 StepSW::StepSW() {
 
 	_step = 1;
+	_delta = 0;
+	_iterations = 0;
 }
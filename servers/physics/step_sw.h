@@ -31,17 +31,30 @@
 #ifndef STEP_SW_H
 #define STEP_SW_H
 
+#include "core/local_vector.h"
 #include "space_sw.h"
 
 class StepSW {
 
 	uint64_t _step;
 
+	// Work shared with the worker thread pool when islands are processed in parallel.
+	real_t _delta;
+	int _iterations;
+	LocalVector<BodySW *> parallel_bodies;
+	LocalVector<ConstraintSW *> parallel_islands;
+
 	void _populate_island(BodySW *p_body, BodySW **p_island, ConstraintSW **p_constraint_island);
+	bool _can_solve_island_in_parallel(ConstraintSW *p_island) const;
 	void _setup_island(ConstraintSW *p_island, real_t p_delta);
+	void _setup_island_serial_constraints(ConstraintSW *p_island, real_t p_delta);
 	void _solve_island(ConstraintSW *p_island, int p_iterations, real_t p_delta);
 	void _check_suspend(BodySW *p_island, real_t p_delta);
 
+	void _integrate_forces_task(uint32_t p_index, void *p_userdata);
+	void _setup_island_task(uint32_t p_index, void *p_userdata);
+	void _solve_island_task(uint32_t p_index, void *p_userdata);
+
 public:
 	void step(SpaceSW *p_space, real_t p_delta, int p_iterations);
 	StepSW();
@@ -548,11 +548,11 @@ void Body2DSW::integrate_velocities(real_t p_step) {
 	if (mode == Physics2DServer::BODY_MODE_STATIC)
 		return;
 
-	if (fi_callback)
-		get_space()->body_add_to_state_query_list(&direct_state_query_list);
-
 	if (mode == Physics2DServer::BODY_MODE_KINEMATIC) {
 
+		if (fi_callback)
+			get_space()->body_add_to_state_query_list(&direct_state_query_list);
+
 		_set_transform(new_transform, false);
 		_set_inv_transform(new_transform.affine_inverse());
 		if (contacts.size() == 0 && linear_velocity == Vector2() && angular_velocity == 0)
@@ -560,13 +560,19 @@ void Body2DSW::integrate_velocities(real_t p_step) {
 		return;
 	}
 
+	integrate_transform(p_step);
+	finish_integrate_velocities();
+}
+
+void Body2DSW::integrate_transform(real_t p_step) {
+
 	real_t total_angular_velocity = angular_velocity + biased_angular_velocity;
 	Vector2 total_linear_velocity = linear_velocity + biased_linear_velocity;
 
 	real_t angle = get_transform().get_rotation() + total_angular_velocity * p_step;
 	Vector2 pos = get_transform().get_origin() + total_linear_velocity * p_step;
 
-	_set_transform(Transform2D(angle, pos), continuous_cd_mode == Physics2DServer::CCD_MODE_DISABLED);
+	_set_transform(Transform2D(angle, pos), false);
 	_set_inv_transform(get_transform().inverse());
 
 	if (continuous_cd_mode != Physics2DServer::CCD_MODE_DISABLED)
@@ -575,6 +581,15 @@ void Body2DSW::integrate_velocities(real_t p_step) {
 	//_update_inertia_tensor();
 }
 
+void Body2DSW::finish_integrate_velocities() {
+
+	if (fi_callback)
+		get_space()->body_add_to_state_query_list(&direct_state_query_list);
+
+	if (continuous_cd_mode == Physics2DServer::CCD_MODE_DISABLED)
+		_update_shapes();
+}
+
 void Body2DSW::wakeup_neighbours() {
 
 	for (Map<Constraint2DSW *, int>::Element *E = constraint_map.front(); E; E = E->next()) {
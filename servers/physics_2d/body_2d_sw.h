@@ -276,6 +276,11 @@ public:
 	void integrate_forces(real_t p_step);
 	void integrate_velocities(real_t p_step);
 
+	// integrate_velocities() for rigid and character bodies, split in two: the first part
+	// only touches the body so it can run in parallel, the second one updates the space.
+	void integrate_transform(real_t p_step);
+	void finish_integrate_velocities();
+
 	_FORCE_INLINE_ Vector2 get_motion() const {
 
 		if (mode > Physics2DServer::BODY_MODE_KINEMATIC) {
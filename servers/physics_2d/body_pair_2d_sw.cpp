@@ -227,8 +227,27 @@ real_t combine_friction(Body2DSW *A, Body2DSW *B) {
 	return ABS(MIN(A->get_friction(), B->get_friction()));
 }
 
+bool BodyPair2DSW::can_setup_in_parallel() const {
+
+	// Contacts reported to static or kinematic bodies are shared between islands.
+	if (A->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && A->can_report_contacts())
+		return false;
+	if (B->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && B->can_report_contacts())
+		return false;
+
+#ifdef DEBUG_ENABLED
+	if (space->is_debugging_contacts())
+		return false;
+#endif
+	return true;
+}
+
 bool BodyPair2DSW::setup(real_t p_step) {
 
+	// impulses on static and kinematic bodies have no effect, skip them so bodies shared between islands are never written
+	dynamic_A = A->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+	dynamic_B = B->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC;
+
 	//cannot collide
 	if (!A->test_collision_mask(B) || A->has_exception(B->get_self()) || B->has_exception(A->get_self()) || (A->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && B->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC && A->get_max_contacts_reported() == 0 && B->get_max_contacts_reported() == 0)) {
 		collided = false;
@@ -434,8 +453,10 @@ bool BodyPair2DSW::setup(real_t p_step) {
 			// Apply normal + friction impulse
 			Vector2 P = c.acc_normal_impulse * c.normal + c.acc_tangent_impulse * tangent;
 
-			A->apply_impulse(c.rA, -P);
-			B->apply_impulse(c.rB, P);
+			if (dynamic_A)
+				A->apply_impulse(c.rA, -P);
+			if (dynamic_B)
+				B->apply_impulse(c.rB, P);
 		}
 
 #endif
@@ -489,8 +510,10 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 jb = c.normal * (c.acc_bias_impulse - jbnOld);
 
-		A->apply_bias_impulse(c.rA, -jb);
-		B->apply_bias_impulse(c.rB, jb);
+		if (dynamic_A)
+			A->apply_bias_impulse(c.rA, -jb);
+		if (dynamic_B)
+			B->apply_bias_impulse(c.rB, jb);
 
 		real_t jn = -(c.bounce + vn) * c.mass_normal;
 		real_t jnOld = c.acc_normal_impulse;
@@ -505,8 +528,10 @@ void BodyPair2DSW::solve(real_t p_step) {
 
 		Vector2 j = c.normal * (c.acc_normal_impulse - jnOld) + tangent * (c.acc_tangent_impulse - jtOld);
 
-		A->apply_impulse(c.rA, -j);
-		B->apply_impulse(c.rB, j);
+		if (dynamic_A)
+			A->apply_impulse(c.rA, -j);
+		if (dynamic_B)
+			B->apply_impulse(c.rB, j);
 	}
 }
 
@@ -523,6 +548,8 @@ BodyPair2DSW::BodyPair2DSW(Body2DSW *p_A, int p_shape_A, Body2DSW *p_B, int p_sh
 	contact_count = 0;
 	collided = false;
 	oneway_disabled = false;
+	dynamic_A = false;
+	dynamic_B = false;
 }
 
 BodyPair2DSW::~BodyPair2DSW() {
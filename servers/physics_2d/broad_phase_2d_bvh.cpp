@@ -0,0 +1,489 @@
+/*************************************************************************/
+/*  broad_phase_2d_bvh.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "broad_phase_2d_bvh.h"
+#include "collision_object_2d_sw.h"
+
+Rect2 BroadPhase2DBVH::_get_fat_aabb(const Rect2 &p_aabb, const Vector2 &p_motion) const {
+
+	Rect2 aabb = p_aabb.grow(aabb_margin);
+
+	// Predict continuous motion, but not teleports, which would leave huge leaves behind.
+	// Small fast objects (bullets) travel further than their size every step, so allow some slack.
+	Vector2 motion = p_motion * 2.0;
+	real_t max_motion = MAX(p_aabb.size.length(), aabb_margin * 32.0);
+	if (p_motion.length_squared() < max_motion * max_motion) {
+		if (motion.x < 0) {
+			aabb.position.x += motion.x;
+			aabb.size.x -= motion.x;
+		} else {
+			aabb.size.x += motion.x;
+		}
+		if (motion.y < 0) {
+			aabb.position.y += motion.y;
+			aabb.size.y -= motion.y;
+		} else {
+			aabb.size.y += motion.y;
+		}
+	}
+
+	return aabb;
+}
+
+void BroadPhase2DBVH::_mark_moved(ID p_id, Element *p_element, bool p_fat_aabb_changed) {
+
+	if (!p_element->moved) {
+		p_element->moved = true;
+		moved_elements.push_back(p_id);
+	}
+
+	if (p_fat_aabb_changed) {
+		p_element->fat_aabb_changed = true;
+	}
+}
+
+void BroadPhase2DBVH::_link_pair(Pair *p_pair, ID p_id, Element *p_element) {
+
+	int slot = p_pair->get_slot(p_id);
+	Pair *first = p_element->first_pair;
+
+	p_pair->prev[slot] = NULL;
+	p_pair->next[slot] = first;
+	if (first) {
+		first->prev[first->get_slot(p_id)] = p_pair;
+	}
+	p_element->first_pair = p_pair;
+}
+
+void BroadPhase2DBVH::_unlink_pair(Pair *p_pair, ID p_id, Element *p_element) {
+
+	int slot = p_pair->get_slot(p_id);
+	Pair *prev = p_pair->prev[slot];
+	Pair *next = p_pair->next[slot];
+
+	if (prev) {
+		prev->next[prev->get_slot(p_id)] = next;
+	} else {
+		p_element->first_pair = next;
+	}
+	if (next) {
+		next->prev[next->get_slot(p_id)] = prev;
+	}
+}
+
+void BroadPhase2DBVH::_add_pair(ID p_a, ID p_b) {
+
+	if (p_a > p_b) {
+		SWAP(p_a, p_b);
+	}
+
+	Element *a = elements[p_a];
+	Element *b = elements[p_b];
+
+	Pair *pair;
+	if (free_pairs) {
+		pair = free_pairs;
+		free_pairs = pair->next[0];
+	} else {
+		pair = memnew(Pair);
+	}
+
+	pair->a = p_a;
+	pair->b = p_b;
+	pair->ud = NULL;
+	pair->overlapping = false;
+	_link_pair(pair, p_a, a);
+	_link_pair(pair, p_b, b);
+	pair_map.insert(_get_pair_key(p_a, p_b), pair);
+}
+
+void BroadPhase2DBVH::_remove_pair(Pair *p_pair) {
+
+	Element *a = elements[p_pair->a];
+	Element *b = elements[p_pair->b];
+
+	_set_pair_overlapping(p_pair, false);
+
+	_unlink_pair(p_pair, p_pair->a, a);
+	_unlink_pair(p_pair, p_pair->b, b);
+	pair_map.remove(_get_pair_key(p_pair->a, p_pair->b));
+
+	p_pair->next[0] = free_pairs;
+	free_pairs = p_pair;
+}
+
+void BroadPhase2DBVH::_set_pair_overlapping(Pair *p_pair, bool p_overlapping) {
+
+	if (p_pair->overlapping == p_overlapping) {
+		return;
+	}
+
+	p_pair->overlapping = p_overlapping;
+
+	const Element *a = elements[p_pair->a];
+	const Element *b = elements[p_pair->b];
+
+	if (p_overlapping) {
+		p_pair->ud = pair_callback ? pair_callback(a->owner, a->subindex, b->owner, b->subindex, pair_userdata) : NULL;
+	} else {
+		if (unpair_callback) {
+			unpair_callback(a->owner, a->subindex, b->owner, b->subindex, p_pair->ud, unpair_userdata);
+		}
+		p_pair->ud = NULL;
+	}
+}
+
+BroadPhase2DSW::ID BroadPhase2DBVH::create(CollisionObject2DSW *p_object, int p_subindex) {
+
+	ERR_FAIL_COND_V(p_object == NULL, 0);
+
+	ID id;
+	if (free_ids.size()) {
+		id = free_ids[free_ids.size() - 1];
+		free_ids.resize(free_ids.size() - 1);
+	} else {
+		id = elements.size();
+		elements.push_back(NULL);
+	}
+
+	Element *e = memnew(Element);
+	e->owner = p_object;
+	e->subindex = p_subindex;
+	e->_static = false;
+	e->moved = false;
+	e->fat_aabb_changed = false;
+	e->leaf = NODE_NULL; // Inserted on the first move.
+	e->first_pair = NULL;
+	elements.write[id] = e;
+
+	return id;
+}
+
+void BroadPhase2DBVH::move(ID p_id, const Rect2 &p_aabb) {
+
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+
+	bool fat_aabb_changed = true;
+
+	if (e->leaf == NODE_NULL) {
+
+		e->leaf = tree.insert(_get_fat_aabb(p_aabb, Vector2()), p_id);
+
+	} else if (!tree.get_node(e->leaf).aabb.encloses(p_aabb)) {
+
+		tree.move(e->leaf, _get_fat_aabb(p_aabb, p_aabb.position - e->aabb.position));
+
+	} else {
+		fat_aabb_changed = false;
+	}
+
+	e->aabb = p_aabb;
+	_mark_moved(p_id, e, fat_aabb_changed);
+}
+
+void BroadPhase2DBVH::set_static(ID p_id, bool p_static) {
+
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+
+	if (e->_static == p_static) {
+		return;
+	}
+
+	e->_static = p_static;
+	_mark_moved(p_id, e, true); // Pairs need to be looked for again.
+}
+
+void BroadPhase2DBVH::remove(ID p_id) {
+
+	Element *e = _get_element(p_id);
+	ERR_FAIL_COND(!e);
+
+	//unpair must be done immediately on removal to avoid potential invalid pointers
+	while (e->first_pair) {
+		_remove_pair(e->first_pair);
+	}
+
+	if (e->leaf != NODE_NULL) {
+		tree.remove(e->leaf);
+	}
+
+	memdelete(e);
+	elements.write[p_id] = NULL;
+	removed_ids.push_back(p_id);
+}
+
+CollisionObject2DSW *BroadPhase2DBVH::get_object(ID p_id) const {
+
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, NULL);
+	return e->owner;
+}
+
+bool BroadPhase2DBVH::is_static(ID p_id) const {
+
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, false);
+	return e->_static;
+}
+
+int BroadPhase2DBVH::get_subindex(ID p_id) const {
+
+	const Element *e = _get_element(p_id);
+	ERR_FAIL_COND_V(!e, -1);
+	return e->subindex;
+}
+
+struct BroadPhase2DBVHCullSegment {
+
+	Vector2 from;
+	Vector2 to;
+	_FORCE_INLINE_ bool test(const Rect2 &p_aabb) const { return p_aabb.intersects_segment(from, to); }
+};
+
+struct BroadPhase2DBVHCullAABB {
+
+	Rect2 aabb;
+	_FORCE_INLINE_ bool test(const Rect2 &p_aabb) const { return p_aabb.intersects(aabb); }
+};
+
+template <class Q>
+struct BroadPhase2DBVH::_Cull {
+
+	const BroadPhase2DBVH *broad_phase;
+	const Q &query;
+	CollisionObject2DSW **results;
+	int *result_indices;
+	int max_results;
+	int result_count;
+
+	_FORCE_INLINE_ bool test(const Tree::Node &p_node) const { return query.test(p_node.aabb); }
+
+	bool leaf(ID p_element) {
+
+		const Element *e = broad_phase->elements[p_element];
+		if (!query.test(e->aabb)) {
+			return true;
+		}
+
+		results[result_count] = e->owner;
+		if (result_indices) {
+			result_indices[result_count] = e->subindex;
+		}
+		result_count++;
+		return result_count < max_results;
+	}
+
+	_Cull(const BroadPhase2DBVH *p_broad_phase, const Q &p_query) :
+			broad_phase(p_broad_phase),
+			query(p_query) {}
+};
+
+template <class Q>
+int BroadPhase2DBVH::_cull(const Q &p_query, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) {
+
+	if (p_max_results <= 0) {
+		return 0;
+	}
+
+	_Cull<Q> cull(this, p_query);
+	cull.results = p_results;
+	cull.result_indices = p_result_indices;
+	cull.max_results = p_max_results;
+	cull.result_count = 0;
+
+	tree.cull(tree.get_root(), cull);
+	return cull.result_count;
+}
+
+int BroadPhase2DBVH::cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) {
+
+	BroadPhase2DBVHCullSegment query;
+	query.from = p_from;
+	query.to = p_to;
+	return _cull(query, p_results, p_max_results, p_result_indices);
+}
+
+int BroadPhase2DBVH::cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) {
+
+	BroadPhase2DBVHCullAABB query;
+	query.aabb = p_aabb;
+	return _cull(query, p_results, p_max_results, p_result_indices);
+}
+
+void BroadPhase2DBVH::set_pair_callback(PairCallback p_pair_callback, void *p_userdata) {
+
+	pair_callback = p_pair_callback;
+	pair_userdata = p_userdata;
+}
+
+void BroadPhase2DBVH::set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) {
+
+	unpair_callback = p_unpair_callback;
+	unpair_userdata = p_userdata;
+}
+
+// Looks for the new pairs of an element whose fat Rect2 changed.
+struct BroadPhase2DBVH::_PairSearch {
+
+	BroadPhase2DBVH *broad_phase;
+	ID id;
+	const Element *element;
+	Rect2 fat_aabb;
+
+	_FORCE_INLINE_ bool test(const Tree::Node &p_node) const { return p_node.aabb.intersects(fat_aabb); }
+
+	bool leaf(ID p_other) {
+
+		if (p_other == id) {
+			return true;
+		}
+
+		// When both changed, only the one with the lowest ID looks for the pair.
+		const Element *other = broad_phase->elements[p_other];
+		if ((other->fat_aabb_changed && p_other < id) || !broad_phase->_can_pair(element, other)) {
+			return true;
+		}
+
+		if (!broad_phase->pair_map.has(_get_pair_key(id, p_other))) {
+			broad_phase->_add_pair(id, p_other);
+		}
+		return true;
+	}
+};
+
+void BroadPhase2DBVH::update() {
+
+	const ID *moved = moved_elements.ptr();
+	int moved_count = moved_elements.size();
+
+	// Update the cached pairs of the elements whose fat Rect2 changed.
+	_PairSearch search;
+	search.broad_phase = this;
+
+	for (int i = 0; i < moved_count; i++) {
+
+		ID id = moved[i];
+		Element *e = _get_element(id);
+		if (!e || !e->fat_aabb_changed || e->leaf == NODE_NULL) {
+			continue; // Removed after moving, or still inside its fat AABB.
+		}
+
+		const Rect2 fat_aabb = tree.get_node(e->leaf).aabb;
+
+		Pair *pair = e->first_pair;
+		while (pair) {
+			Pair *next = pair->next[pair->get_slot(id)];
+			const Element *other = elements[pair->a == id ? pair->b : pair->a];
+			if (!_can_pair(e, other) || !fat_aabb.intersects(tree.get_node(other->leaf).aabb)) {
+				_remove_pair(pair);
+			}
+			pair = next;
+		}
+
+		search.id = id;
+		search.element = e;
+		search.fat_aabb = fat_aabb;
+		tree.cull(tree.get_root(), search);
+	}
+
+	// Report the pairs whose exact AABBs started or stopped overlapping.
+	for (int i = 0; i < moved_count; i++) {
+
+		ID id = moved[i];
+		Element *e = _get_element(id);
+		if (!e) {
+			continue;
+		}
+
+		Pair *pair = e->first_pair;
+		while (pair) {
+			const Element *other = elements[pair->a == id ? pair->b : pair->a];
+			_set_pair_overlapping(pair, e->aabb.intersects(other->aabb));
+			pair = pair->next[pair->get_slot(id)];
+		}
+	}
+
+	for (int i = 0; i < moved_count; i++) {
+		Element *e = _get_element(moved[i]);
+		if (e) {
+			e->moved = false;
+			e->fat_aabb_changed = false;
+		}
+	}
+	moved_elements.resize(0);
+
+	for (int i = 0; i < removed_ids.size(); i++) {
+		free_ids.push_back(removed_ids[i]);
+	}
+	removed_ids.resize(0);
+}
+
+BroadPhase2DSW *BroadPhase2DBVH::_create() {
+
+	return memnew(BroadPhase2DBVH);
+}
+
+BroadPhase2DBVH::BroadPhase2DBVH() {
+
+	free_pairs = NULL;
+	aabb_margin = 2.0; // In pixels.
+
+	elements.push_back(NULL); // 0 is an invalid ID.
+
+	pair_callback = NULL;
+	pair_userdata = NULL;
+	unpair_callback = NULL;
+	unpair_userdata = NULL;
+}
+
+BroadPhase2DBVH::~BroadPhase2DBVH() {
+
+	for (int i = 0; i < elements.size(); i++) {
+		Element *e = elements[i];
+		if (!e) {
+			continue;
+		}
+		while (e->first_pair) {
+			Pair *pair = e->first_pair;
+			_unlink_pair(pair, pair->a, elements[pair->a]);
+			_unlink_pair(pair, pair->b, elements[pair->b]);
+			memdelete(pair);
+		}
+		memdelete(e);
+	}
+
+	while (free_pairs) {
+		Pair *pair = free_pairs;
+		free_pairs = pair->next[0];
+		memdelete(pair);
+	}
+}
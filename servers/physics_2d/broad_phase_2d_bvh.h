@@ -0,0 +1,155 @@
+/*************************************************************************/
+/*  broad_phase_2d_bvh.h                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef BROAD_PHASE_2D_BVH_H
+#define BROAD_PHASE_2D_BVH_H
+
+#include "broad_phase_2d_sw.h"
+#include "core/math/bvh_tree.h"
+#include "core/oa_hash_map.h"
+#include "core/vector.h"
+
+/**
+ * @class BroadPhase2DBVH
+ * Dynamic AABB tree broadphase, the 2D counterpart of BroadPhaseBVH.
+ *
+ * Unlike BroadPhase2DHashGrid, it doesn't depend on a cell size, so it
+ * copes with worlds mixing tiny and huge objects, or spread over large
+ * sparse areas. It's built on BVHTree, like BroadPhaseBVH.
+ *
+ * Leaves store a fattened copy of the element rect. Pairs of overlapping
+ * fat rects are cached and only looked for again when the fat rect of an
+ * element changes. They are reported to the pair callback from update(),
+ * while the exact rects intersect.
+ */
+
+class BroadPhase2DBVH : public BroadPhase2DSW {
+
+	typedef BVHTree<Rect2, BVHTreeNoData, true> Tree;
+
+	enum {
+		NODE_NULL = Tree::NODE_NULL
+	};
+
+	// Pairs are linked in a list for each of their two elements, slot 0 is used by a, slot 1 by b.
+	struct Pair {
+
+		ID a;
+		ID b;
+		void *ud;
+		bool overlapping; // Reported to the pair callback.
+		Pair *prev[2];
+		Pair *next[2];
+
+		_FORCE_INLINE_ int get_slot(ID p_id) const { return a == p_id ? 0 : 1; }
+	};
+
+	struct Element {
+
+		CollisionObject2DSW *owner;
+		int subindex;
+		bool _static;
+		bool moved;
+		bool fat_aabb_changed;
+		Rect2 aabb;
+		uint32_t leaf;
+		Pair *first_pair;
+	};
+
+	Tree tree;
+
+	Vector<Element *> elements; // Indexed by ID, 0 is never used.
+	Vector<ID> free_ids;
+	Vector<ID> removed_ids; // Only reused after update(), as they may still be in moved_elements.
+	Vector<ID> moved_elements;
+
+	OAHashMap<uint64_t, Pair *> pair_map;
+	Pair *free_pairs;
+
+	real_t aabb_margin;
+
+	PairCallback pair_callback;
+	void *pair_userdata;
+	UnpairCallback unpair_callback;
+	void *unpair_userdata;
+
+	static _FORCE_INLINE_ uint64_t _get_pair_key(ID p_a, ID p_b) {
+		return p_a < p_b ? (uint64_t(p_a) << 32) | p_b : (uint64_t(p_b) << 32) | p_a;
+	}
+
+	_FORCE_INLINE_ Element *_get_element(ID p_id) const {
+		return p_id > 0 && p_id < (ID)elements.size() ? elements[p_id] : NULL;
+	}
+
+	_FORCE_INLINE_ bool _can_pair(const Element *p_a, const Element *p_b) const {
+		return p_a->owner != p_b->owner && (!p_a->_static || !p_b->_static);
+	}
+
+	Rect2 _get_fat_aabb(const Rect2 &p_aabb, const Vector2 &p_motion) const;
+
+	template <class Q>
+	struct _Cull;
+	struct _PairSearch;
+
+	template <class Q>
+	int _cull(const Q &p_query, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices);
+
+	void _mark_moved(ID p_id, Element *p_element, bool p_fat_aabb_changed);
+	void _link_pair(Pair *p_pair, ID p_id, Element *p_element);
+	void _unlink_pair(Pair *p_pair, ID p_id, Element *p_element);
+	void _add_pair(ID p_a, ID p_b);
+	void _remove_pair(Pair *p_pair);
+	void _set_pair_overlapping(Pair *p_pair, bool p_overlapping);
+
+public:
+	// 0 is an invalid ID
+	virtual ID create(CollisionObject2DSW *p_object, int p_subindex = 0);
+	virtual void move(ID p_id, const Rect2 &p_aabb);
+	virtual void set_static(ID p_id, bool p_static);
+	virtual void remove(ID p_id);
+
+	virtual CollisionObject2DSW *get_object(ID p_id) const;
+	virtual bool is_static(ID p_id) const;
+	virtual int get_subindex(ID p_id) const;
+
+	virtual int cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = NULL);
+	virtual int cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = NULL);
+
+	virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata);
+	virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata);
+
+	virtual void update();
+
+	static BroadPhase2DSW *_create();
+	BroadPhase2DBVH();
+	~BroadPhase2DBVH();
+};
+
+#endif // BROAD_PHASE_2D_BVH_H
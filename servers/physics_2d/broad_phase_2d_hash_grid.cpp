@@ -29,70 +29,75 @@
 /*************************************************************************/
 
 #include "broad_phase_2d_hash_grid.h"
+#include "core/local_vector.h"
 #include "core/project_settings.h"
 
 #define LARGE_ELEMENT_FI 1.01239812
 
 void BroadPhase2DHashGrid::_pair_attempt(Element *p_elem, Element *p_with) {
 
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+	PairData **E = p_elem->paired.lookup_ptr(p_with);
 
 	ERR_FAIL_COND(p_elem->_static && p_with->_static);
 
 	if (!E) {
 
 		PairData *pd = memnew(PairData);
-		p_elem->paired[p_with] = pd;
-		p_with->paired[p_elem] = pd;
+		p_elem->paired.insert(p_with, pd);
+		p_with->paired.insert(p_elem, pd);
 	} else {
-		E->get()->rc++;
+		(*E)->rc++;
 	}
 }
 
 void BroadPhase2DHashGrid::_unpair_attempt(Element *p_elem, Element *p_with) {
 
-	Map<Element *, PairData *>::Element *E = p_elem->paired.find(p_with);
+	PairData **E = p_elem->paired.lookup_ptr(p_with);
 
 	ERR_FAIL_COND(!E); //this should really be paired..
 
-	E->get()->rc--;
+	PairData *pd = *E;
+	pd->rc--;
 
-	if (E->get()->rc == 0) {
+	if (pd->rc == 0) {
 
-		if (E->get()->colliding) {
+		if (pd->colliding) {
 			//uncollide
 			if (unpair_callback) {
-				unpair_callback(p_elem->owner, p_elem->subindex, p_with->owner, p_with->subindex, E->get()->ud, unpair_userdata);
+				unpair_callback(p_elem->owner, p_elem->subindex, p_with->owner, p_with->subindex, pd->ud, unpair_userdata);
 			}
 		}
 
-		memdelete(E->get());
-		p_elem->paired.erase(E);
-		p_with->paired.erase(p_elem);
+		memdelete(pd);
+		p_elem->paired.remove(p_with);
+		p_with->paired.remove(p_elem);
 	}
 }
 
 void BroadPhase2DHashGrid::_check_motion(Element *p_elem) {
 
-	for (Map<Element *, PairData *>::Element *E = p_elem->paired.front(); E; E = E->next()) {
+	for (OAHashMap<Element *, PairData *>::Iterator it = p_elem->paired.iter(); it.valid; it = p_elem->paired.next_iter(it)) {
+
+		Element *with = *it.key;
+		PairData *pd = *it.value;
 
-		bool pairing = p_elem->aabb.intersects(E->key()->aabb);
+		bool pairing = p_elem->aabb.intersects(with->aabb);
 
-		if (pairing != E->get()->colliding) {
+		if (pairing != pd->colliding) {
 
 			if (pairing) {
 
 				if (pair_callback) {
-					E->get()->ud = pair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, pair_userdata);
+					pd->ud = pair_callback(p_elem->owner, p_elem->subindex, with->owner, with->subindex, pair_userdata);
 				}
 			} else {
 
 				if (unpair_callback) {
-					unpair_callback(p_elem->owner, p_elem->subindex, E->key()->owner, E->key()->subindex, E->get()->ud, unpair_userdata);
+					unpair_callback(p_elem->owner, p_elem->subindex, with->owner, with->subindex, pd->ud, unpair_userdata);
 				}
 			}
 
-			E->get()->colliding = pairing;
+			pd->colliding = pairing;
 		}
 	}
 }
@@ -102,15 +107,15 @@ void BroadPhase2DHashGrid::_enter_grid(Element *p_elem, const Rect2 &p_rect, boo
 	Vector2 sz = (p_rect.size / cell_size * LARGE_ELEMENT_FI); //use magic number to avoid floating point issues
 	if (sz.width * sz.height > large_object_min_surface) {
 		//large object, do not use grid, must check against all elements
-		for (Map<ID, Element>::Element *E = element_map.front(); E; E = E->next()) {
+		for (Map<ID, Element *>::Element *E = element_map.front(); E; E = E->next()) {
 			if (E->key() == p_elem->self)
 				continue; // do not pair against itself
-			if (E->get().owner == p_elem->owner)
+			if (E->get()->owner == p_elem->owner)
 				continue;
-			if (E->get()._static && p_static)
+			if (E->get()->_static && p_static)
 				continue;
 
-			_pair_attempt(p_elem, &E->get());
+			_pair_attempt(p_elem, E->get());
 		}
 
 		large_elements[p_elem].inc();
@@ -204,11 +209,14 @@ void BroadPhase2DHashGrid::_exit_grid(Element *p_elem, const Rect2 &p_rect, bool
 	if (sz.width * sz.height > large_object_min_surface) {
 
 		//unpair all elements, instead of checking all, just check what is already paired, so we at least save from checking static vs static
-		Map<Element *, PairData *>::Element *E = p_elem->paired.front();
-		while (E) {
-			Map<Element *, PairData *>::Element *next = E->next();
-			_unpair_attempt(p_elem, E->key());
-			E = next;
+		//unpairing removes from the hash map, which moves its entries, so gather them first
+		LocalVector<Element *> paired;
+		paired.reserve(p_elem->paired.get_num_elements());
+		for (OAHashMap<Element *, PairData *>::Iterator it = p_elem->paired.iter(); it.valid; it = p_elem->paired.next_iter(it)) {
+			paired.push_back(*it.key);
+		}
+		for (uint32_t i = 0; i < paired.size(); i++) {
+			_unpair_attempt(p_elem, paired[i]);
 		}
 
 		if (large_elements[p_elem].dec() == 0) {
@@ -321,12 +329,12 @@ BroadPhase2DHashGrid::ID BroadPhase2DHashGrid::create(CollisionObject2DSW *p_obj
 
 	current++;
 
-	Element e;
-	e.owner = p_object;
-	e._static = false;
-	e.subindex = p_subindex;
-	e.self = current;
-	e.pass = 0;
+	Element *e = memnew(Element);
+	e->owner = p_object;
+	e->_static = false;
+	e->subindex = p_subindex;
+	e->self = current;
+	e->pass = 0;
 
 	element_map[current] = e;
 	return current;
@@ -334,10 +342,10 @@ BroadPhase2DHashGrid::ID BroadPhase2DHashGrid::create(CollisionObject2DSW *p_obj
 
 void BroadPhase2DHashGrid::move(ID p_id, const Rect2 &p_aabb) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
+	Map<ID, Element *>::Element *E = element_map.find(p_id);
 	ERR_FAIL_COND(!E);
 
-	Element &e = E->get();
+	Element &e = *E->get();
 
 	if (p_aabb == e.aabb)
 		return;
@@ -360,10 +368,10 @@ void BroadPhase2DHashGrid::move(ID p_id, const Rect2 &p_aabb) {
 }
 void BroadPhase2DHashGrid::set_static(ID p_id, bool p_static) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
+	Map<ID, Element *>::Element *E = element_map.find(p_id);
 	ERR_FAIL_COND(!E);
 
-	Element &e = E->get();
+	Element &e = *E->get();
 
 	if (e._static == p_static)
 		return;
@@ -380,34 +388,35 @@ void BroadPhase2DHashGrid::set_static(ID p_id, bool p_static) {
 }
 void BroadPhase2DHashGrid::remove(ID p_id) {
 
-	Map<ID, Element>::Element *E = element_map.find(p_id);
+	Map<ID, Element *>::Element *E = element_map.find(p_id);
 	ERR_FAIL_COND(!E);
 
-	Element &e = E->get();
+	Element &e = *E->get();
 
 	if (e.aabb != Rect2())
 		_exit_grid(&e, e.aabb, e._static);
 
-	element_map.erase(p_id);
+	memdelete(E->get());
+	element_map.erase(E);
 }
 
 CollisionObject2DSW *BroadPhase2DHashGrid::get_object(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
+	const Map<ID, Element *>::Element *E = element_map.find(p_id);
 	ERR_FAIL_COND_V(!E, NULL);
-	return E->get().owner;
+	return E->get()->owner;
 }
 bool BroadPhase2DHashGrid::is_static(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
+	const Map<ID, Element *>::Element *E = element_map.find(p_id);
 	ERR_FAIL_COND_V(!E, false);
-	return E->get()._static;
+	return E->get()->_static;
 }
 int BroadPhase2DHashGrid::get_subindex(ID p_id) const {
 
-	const Map<ID, Element>::Element *E = element_map.find(p_id);
+	const Map<ID, Element *>::Element *E = element_map.find(p_id);
 	ERR_FAIL_COND_V(!E, -1);
-	return E->get().subindex;
+	return E->get()->subindex;
 }
 
 template <bool use_aabb, bool use_segment>
@@ -654,6 +663,10 @@ BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
 
 BroadPhase2DHashGrid::~BroadPhase2DHashGrid() {
 
+	for (Map<ID, Element *>::Element *E = element_map.front(); E; E = E->next()) {
+		memdelete(E->get());
+	}
+
 	for (uint32_t i = 0; i < hash_table_size; i++) {
 		while (hash_table[i]) {
 			PosBin *pb = hash_table[i];
@@ -33,6 +33,7 @@
 
 #include "broad_phase_2d_sw.h"
 #include "core/map.h"
+#include "core/oa_hash_map.h"
 
 class BroadPhase2DHashGrid : public BroadPhase2DSW {
 
@@ -56,7 +57,12 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		Rect2 aabb;
 		int subindex;
 		uint64_t pass;
-		Map<Element *, PairData *> paired;
+		// Looked up on every pair/unpair attempt, so hashed rather than ordered.
+		// Most elements only overlap a handful of others, keep it small.
+		OAHashMap<Element *, PairData *> paired;
+
+		Element() :
+				paired(8) {}
 	};
 
 	struct RC {
@@ -77,41 +83,13 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 		}
 	};
 
-	Map<ID, Element> element_map;
+	Map<ID, Element *> element_map;
 	Map<Element *, RC> large_elements;
 
 	ID current;
 
 	uint64_t pass;
 
-	struct PairKey {
-
-		union {
-			struct {
-				ID a;
-				ID b;
-			};
-			uint64_t key;
-		};
-
-		_FORCE_INLINE_ bool operator<(const PairKey &p_key) const {
-			return key < p_key.key;
-		}
-
-		PairKey() { key = 0; }
-		PairKey(ID p_a, ID p_b) {
-			if (p_a > p_b) {
-				a = p_b;
-				b = p_a;
-			} else {
-				a = p_a;
-				b = p_b;
-			}
-		}
-	};
-
-	Map<PairKey, PairData> pair_map;
-
 	int cell_size;
 	int large_object_min_surface;
 
@@ -51,6 +51,19 @@ public:
 	_FORCE_INLINE_ real_t get_max_bias() const { return max_bias; }
 
 	virtual Physics2DServer::JointType get_type() const = 0;
+
+	// Joints apply impulses to all their bodies, static and kinematic ones are shared between islands.
+	bool is_attached_to_dynamic_bodies_only() const {
+		for (int i = 0; i < get_body_count(); i++) {
+			if (get_body_ptr()[i]->get_mode() <= Physics2DServer::BODY_MODE_KINEMATIC)
+				return false;
+		}
+		return true;
+	}
+
+	virtual bool can_setup_in_parallel() const { return is_attached_to_dynamic_bodies_only(); }
+	virtual bool can_solve_in_parallel() const { return is_attached_to_dynamic_bodies_only(); }
+
 	Joint2DSW(Body2DSW **p_body_ptr = NULL, int p_body_count = 0) :
 			Constraint2DSW(p_body_ptr, p_body_count) {
 		bias = 0;
@@ -30,6 +30,7 @@
 
 #include "step_2d_sw.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
 
 void Step2DSW::_populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island) {
 
@@ -82,6 +83,41 @@ bool Step2DSW::_setup_island(Constraint2DSW *p_island, real_t p_delta) {
 	return removed_root;
 }
 
+Constraint2DSW *Step2DSW::_setup_island_constraints(Constraint2DSW *p_island, real_t p_delta, bool p_parallel) {
+
+	// Sets up the constraints that can (or can't) be set up in parallel, removing
+	// the ones that don't need processing. Returns the new root of the island.
+	Constraint2DSW *root = p_island;
+	Constraint2DSW *ci = p_island;
+	Constraint2DSW *prev_ci = NULL;
+	while (ci) {
+		Constraint2DSW *next = ci->get_island_next();
+
+		if (ci->can_setup_in_parallel() != p_parallel || ci->setup(p_delta)) {
+			prev_ci = ci;
+		} else if (prev_ci) {
+			prev_ci->set_island_next(next);
+		} else {
+			root = next;
+		}
+
+		ci = next;
+	}
+
+	return root;
+}
+
+bool Step2DSW::_can_solve_island_in_parallel(Constraint2DSW *p_island) const {
+
+	Constraint2DSW *ci = p_island;
+	while (ci) {
+		if (!ci->can_solve_in_parallel())
+			return false;
+		ci = ci->get_island_next();
+	}
+	return true;
+}
+
 void Step2DSW::_solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta) {
 
 	for (int i = 0; i < p_iterations; i++) {
@@ -131,6 +167,27 @@ void Step2DSW::_check_suspend(Body2DSW *p_island, real_t p_delta) {
 	}
 }
 
+void Step2DSW::_integrate_forces_task(uint32_t p_index, void *p_userdata) {
+
+	parallel_bodies[p_index]->integrate_forces(_delta);
+}
+
+void Step2DSW::_integrate_transform_task(uint32_t p_index, void *p_userdata) {
+
+	parallel_bodies[p_index]->integrate_transform(_delta);
+}
+
+void Step2DSW::_setup_island_task(uint32_t p_index, void *p_userdata) {
+
+	// The other constraints were already set up on the stepping thread.
+	parallel_islands[p_index] = _setup_island_constraints(parallel_islands[p_index], _delta, true);
+}
+
+void Step2DSW::_solve_island_task(uint32_t p_index, void *p_userdata) {
+
+	_solve_island(parallel_islands[p_index], _iterations, _delta);
+}
+
 void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	p_space->lock(); // can't access space during this
@@ -139,6 +196,14 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	const SelfList<Body2DSW>::List *body_list = &p_space->get_active_body_list();
 
+	WorkerThreadPool *pool = NULL;
+	if (p_space->is_parallel_islands_enabled() && WorkerThreadPool::get_singleton() && WorkerThreadPool::get_singleton()->get_thread_count() > 0) {
+		pool = WorkerThreadPool::get_singleton();
+	}
+
+	_delta = p_delta;
+	_iterations = p_iterations;
+
 	/* INTEGRATE FORCES */
 
 	uint64_t profile_begtime = OS::get_singleton()->get_ticks_usec();
@@ -147,11 +212,46 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 	int active_count = 0;
 
 	const SelfList<Body2DSW> *b = body_list->first();
-	while (b) {
 
-		b->self()->integrate_forces(p_delta);
-		b = b->next();
-		active_count++;
+	if (pool) {
+
+		while (b) {
+			active_count++;
+			b = b->next();
+		}
+
+		if ((int)parallel_bodies.size() < active_count)
+			parallel_bodies.resize(active_count);
+
+		Body2DSW **bodies = parallel_bodies.ptr();
+		int parallel_count = 0;
+
+		b = body_list->first();
+		while (b) {
+
+			Body2DSW *body = b->self();
+			// Kinematic and continuous bodies update their shapes in the broadphase, keep them on this thread.
+			if (body->get_mode() == Physics2DServer::BODY_MODE_KINEMATIC || body->get_continuous_collision_detection_mode() != Physics2DServer::CCD_MODE_DISABLED) {
+				body->integrate_forces(p_delta);
+			} else {
+				bodies[parallel_count++] = body;
+			}
+			b = b->next();
+		}
+
+		if (parallel_count) {
+			WorkerThreadPool::TaskID task = pool->add_template_group_task(this, &Step2DSW::_integrate_forces_task, (void *)NULL, parallel_count);
+			pool->wait_for_task_completion(task);
+		}
+
+	} else {
+
+		while (b) {
+
+			b->self()->integrate_forces(p_delta);
+			b = b->next();
+			active_count++;
+		}
 	}
 
 	p_space->set_active_objects(active_count);
@@ -217,6 +317,52 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SETUP CONSTRAINT ISLANDS */
 
+	int parallel_island_count = 0;
+
+	if (pool) {
+
+		// Move the islands that can be stepped in parallel to their own array,
+		// the ones left in the list (and their order) are processed as usual.
+		int total_count = 0;
+		Constraint2DSW *ci = constraint_island_list;
+		while (ci) {
+			total_count++;
+			ci = ci->get_island_list_next();
+		}
+
+		if ((int)parallel_islands.size() < total_count)
+			parallel_islands.resize(total_count);
+
+		Constraint2DSW **islands = parallel_islands.ptr();
+		Constraint2DSW *prev = NULL;
+
+		ci = constraint_island_list;
+		while (ci) {
+			Constraint2DSW *next = ci->get_island_list_next();
+			if (_can_solve_island_in_parallel(ci)) {
+				islands[parallel_island_count++] = ci;
+				if (prev) {
+					prev->set_island_list_next(next);
+				} else {
+					constraint_island_list = next;
+				}
+			} else {
+				prev = ci;
+			}
+			ci = next;
+		}
+
+		// Constraints that modify shared objects (areas, contacts reported to static bodies) are set up first, in order.
+		for (int i = 0; i < parallel_island_count; i++) {
+			islands[i] = _setup_island_constraints(islands[i], p_delta, false);
+		}
+
+		if (parallel_island_count) {
+			WorkerThreadPool::TaskID task = pool->add_template_group_task(this, &Step2DSW::_setup_island_task, (void *)NULL, parallel_island_count);
+			pool->wait_for_task_completion(task);
+		}
+	}
+
 	{
 		Constraint2DSW *ci = constraint_island_list;
 		Constraint2DSW *prev_ci = NULL;
@@ -263,6 +409,11 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* SOLVE CONSTRAINT ISLANDS */
 
+	if (parallel_island_count) {
+		WorkerThreadPool::TaskID task = pool->add_template_group_task(this, &Step2DSW::_solve_island_task, (void *)NULL, parallel_island_count);
+		pool->wait_for_task_completion(task);
+	}
+
 	{
 		Constraint2DSW *ci = constraint_island_list;
 		while (ci) {
@@ -280,12 +431,58 @@ void Step2DSW::step(Space2DSW *p_space, real_t p_delta, int p_iterations) {
 
 	/* INTEGRATE VELOCITIES */
 
-	b = body_list->first();
-	while (b) {
+	if (pool) {
 
-		const SelfList<Body2DSW> *n = b->next();
-		b->self()->integrate_velocities(p_delta);
-		b = n; // in case it shuts itself down
+		// Transforms are integrated in parallel, the broadphase and the space are updated afterwards in list order.
+		int parallel_count = 0;
+
+		b = body_list->first();
+		while (b) {
+			parallel_count++;
+			b = b->next();
+		}
+
+		if ((int)parallel_bodies.size() < parallel_count)
+			parallel_bodies.resize(parallel_count);
+
+		Body2DSW **bodies = parallel_bodies.ptr();
+		parallel_count = 0;
+
+		b = body_list->first();
+		while (b) {
+			Body2DSW *body = b->self();
+			if (body->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC)
+				bodies[parallel_count++] = body;
+			b = b->next();
+		}
+
+		if (parallel_count) {
+			WorkerThreadPool::TaskID task = pool->add_template_group_task(this, &Step2DSW::_integrate_transform_task, (void *)NULL, parallel_count);
+			pool->wait_for_task_completion(task);
+		}
+
+		b = body_list->first();
+		while (b) {
+
+			const SelfList<Body2DSW> *n = b->next();
+			Body2DSW *body = b->self();
+			if (body->get_mode() > Physics2DServer::BODY_MODE_KINEMATIC) {
+				body->finish_integrate_velocities();
+			} else {
+				body->integrate_velocities(p_delta);
+			}
+			b = n; // in case it shuts itself down
+		}
+
+	} else {
+
+		b = body_list->first();
+		while (b) {
+
+			const SelfList<Body2DSW> *n = b->next();
+			b->self()->integrate_velocities(p_delta);
+			b = n; // in case it shuts itself down
+		}
 	}
 
 	/* SLEEP / WAKE UP ISLANDS */
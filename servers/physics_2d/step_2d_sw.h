@@ -31,17 +31,31 @@
 #ifndef STEP_2D_SW_H
 #define STEP_2D_SW_H
 
+#include "core/local_vector.h"
 #include "space_2d_sw.h"
 
 class Step2DSW {
 
 	uint64_t _step;
 
+	// Work shared with the worker thread pool when islands are processed in parallel.
+	real_t _delta;
+	int _iterations;
+	LocalVector<Body2DSW *> parallel_bodies;
+	LocalVector<Constraint2DSW *> parallel_islands;
+
 	void _populate_island(Body2DSW *p_body, Body2DSW **p_island, Constraint2DSW **p_constraint_island);
+	bool _can_solve_island_in_parallel(Constraint2DSW *p_island) const;
 	bool _setup_island(Constraint2DSW *p_island, real_t p_delta);
+	Constraint2DSW *_setup_island_constraints(Constraint2DSW *p_island, real_t p_delta, bool p_parallel);
 	void _solve_island(Constraint2DSW *p_island, int p_iterations, real_t p_delta);
 	void _check_suspend(Body2DSW *p_island, real_t p_delta);
 
+	void _integrate_forces_task(uint32_t p_index, void *p_userdata);
+	void _integrate_transform_task(uint32_t p_index, void *p_userdata);
+	void _setup_island_task(uint32_t p_index, void *p_userdata);
+	void _solve_island_task(uint32_t p_index, void *p_userdata);
+
 public:
 	void step(Space2DSW *p_space, real_t p_delta, int p_iterations);
 	Step2DSW();
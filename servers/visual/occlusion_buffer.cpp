@@ -0,0 +1,380 @@
+/*************************************************************************/
+/*  occlusion_buffer.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "occlusion_buffer.h"
+
+#include "core/math/simd.h"
+
+OcclusionBuffer::Vertex OcclusionBuffer::_xform(const CameraMatrix &p_matrix, const Vector3 &p_point) {
+
+	Vertex v;
+	v.x = p_matrix.matrix[0][0] * p_point.x + p_matrix.matrix[1][0] * p_point.y + p_matrix.matrix[2][0] * p_point.z + p_matrix.matrix[3][0];
+	v.y = p_matrix.matrix[0][1] * p_point.x + p_matrix.matrix[1][1] * p_point.y + p_matrix.matrix[2][1] * p_point.z + p_matrix.matrix[3][1];
+	v.z = p_matrix.matrix[0][2] * p_point.x + p_matrix.matrix[1][2] * p_point.y + p_matrix.matrix[2][2] * p_point.z + p_matrix.matrix[3][2];
+	v.w = p_matrix.matrix[0][3] * p_point.x + p_matrix.matrix[1][3] * p_point.y + p_matrix.matrix[2][3] * p_point.z + p_matrix.matrix[3][3];
+	return v;
+}
+
+float OcclusionBuffer::_clip_distance(int p_plane, const Vertex &p_vertex) {
+
+	switch (p_plane) {
+		case 0: return p_vertex.z + p_vertex.w; // near
+		case 1: return p_vertex.w + p_vertex.x; // left
+		case 2: return p_vertex.w - p_vertex.x; // right
+		case 3: return p_vertex.w + p_vertex.y; // bottom
+		default: return p_vertex.w - p_vertex.y; // top
+	}
+}
+
+void OcclusionBuffer::set_size(int p_width, int p_height) {
+
+	ERR_FAIL_COND(p_width <= 0 || p_height <= 0);
+
+	if (get_width() == p_width && get_height() == p_height) {
+		return;
+	}
+
+	mips.clear();
+
+	int width = p_width;
+	int height = p_height;
+
+	while (true) {
+
+		Mip mip;
+		mip.width = width;
+		mip.height = height;
+		mip.stride = (width + 3) & ~3;
+		mips.push_back(mip);
+		mips[mips.size() - 1].depth.resize(mip.stride * height);
+
+		if (width == 1 && height == 1) {
+			break;
+		}
+
+		width = (width + 1) >> 1;
+		height = (height + 1) >> 1;
+	}
+
+	triangles_drawn = 0;
+}
+
+void OcclusionBuffer::begin(const CameraMatrix &p_projection, const Transform &p_camera_transform) {
+
+	ERR_FAIL_COND(mips.size() == 0);
+
+	view_projection = p_projection * CameraMatrix(p_camera_transform.affine_inverse());
+	triangles_drawn = 0;
+
+	LocalVector<float> &depth = mips[0].depth;
+	for (uint32_t i = 0; i < depth.size(); i++) {
+		depth[i] = 1.0;
+	}
+}
+
+void OcclusionBuffer::draw_triangles(const Transform &p_transform, const Vector3 *p_vertices, int p_vertex_count) {
+
+	ERR_FAIL_COND(mips.size() == 0);
+
+	CameraMatrix matrix = view_projection * CameraMatrix(p_transform);
+
+	for (int i = 0; i + 2 < p_vertex_count; i += 3) {
+
+		// Clip against the near plane and the sides of the screen, so the
+		// rasterizer only sees coordinates it can handle with float precision.
+		Vertex poly[2][3 + CLIP_PLANES];
+		int poly_count = 3;
+		int current = 0;
+		poly[0][0] = _xform(matrix, p_vertices[i + 0]);
+		poly[0][1] = _xform(matrix, p_vertices[i + 1]);
+		poly[0][2] = _xform(matrix, p_vertices[i + 2]);
+
+		for (int p = 0; p < CLIP_PLANES && poly_count >= 3; p++) {
+
+			const Vertex *src = poly[current];
+			Vertex *dst = poly[current ^ 1];
+			int dst_count = 0;
+
+			for (int j = 0; j < poly_count; j++) {
+
+				const Vertex &from = src[j];
+				const Vertex &to = src[(j + 1) % poly_count];
+				float from_dist = _clip_distance(p, from);
+				float to_dist = _clip_distance(p, to);
+
+				if (from_dist >= 0) {
+					dst[dst_count++] = from;
+				}
+				if ((from_dist >= 0) != (to_dist >= 0)) {
+					float t = from_dist / (from_dist - to_dist);
+					Vertex &c = dst[dst_count++];
+					c.x = from.x + (to.x - from.x) * t;
+					c.y = from.y + (to.y - from.y) * t;
+					c.z = from.z + (to.z - from.z) * t;
+					c.w = from.w + (to.w - from.w) * t;
+				}
+			}
+
+			poly_count = dst_count;
+			current ^= 1;
+		}
+
+		for (int j = 2; j < poly_count; j++) {
+			_draw_clipped_triangle(poly[current][0], poly[current][j - 1], poly[current][j]);
+		}
+	}
+}
+
+void OcclusionBuffer::_draw_clipped_triangle(const Vertex &p_a, const Vertex &p_b, const Vertex &p_c) {
+
+	if (p_a.w <= CMP_EPSILON || p_b.w <= CMP_EPSILON || p_c.w <= CMP_EPSILON) {
+		return;
+	}
+
+	const Mip &mip = mips[0];
+	float half_width = mip.width * 0.5;
+	float half_height = mip.height * 0.5;
+
+	float ia = 1.0 / p_a.w;
+	float ib = 1.0 / p_b.w;
+	float ic = 1.0 / p_c.w;
+
+	_rasterize_triangle(
+			(p_a.x * ia + 1.0) * half_width, (p_a.y * ia + 1.0) * half_height, p_a.z * ia,
+			(p_b.x * ib + 1.0) * half_width, (p_b.y * ib + 1.0) * half_height, p_b.z * ib,
+			(p_c.x * ic + 1.0) * half_width, (p_c.y * ic + 1.0) * half_height, p_c.z * ic);
+}
+
+void OcclusionBuffer::_rasterize_triangle(float p_ax, float p_ay, float p_az, float p_bx, float p_by, float p_bz, float p_cx, float p_cy, float p_cz) {
+
+	float area = (p_bx - p_ax) * (p_cy - p_ay) - (p_by - p_ay) * (p_cx - p_ax);
+	if (!(area != 0)) {
+		return; // degenerate (or NaN)
+	}
+
+	if (area < 0) {
+		// draw both sides
+		SWAP(p_bx, p_cx);
+		SWAP(p_by, p_cy);
+		SWAP(p_bz, p_cz);
+		area = -area;
+	}
+
+	Mip &mip = mips[0];
+
+	int min_x = MAX(0, (int)Math::floor(MIN(p_ax, MIN(p_bx, p_cx))));
+	int max_x = MIN(mip.width - 1, (int)Math::floor(MAX(p_ax, MAX(p_bx, p_cx))));
+	int min_y = MAX(0, (int)Math::floor(MIN(p_ay, MIN(p_by, p_cy))));
+	int max_y = MIN(mip.height - 1, (int)Math::floor(MAX(p_ay, MAX(p_by, p_cy))));
+
+	if (min_x > max_x || min_y > max_y) {
+		return;
+	}
+
+	triangles_drawn++;
+
+	// Edge functions, positive inside. A pixel is covered when its center
+	// is inside all three, so occluders never cover more than they should.
+	float a0 = p_ay - p_by, b0 = p_bx - p_ax, c0 = -(a0 * p_ax + b0 * p_ay); // a -> b
+	float a1 = p_by - p_cy, b1 = p_cx - p_bx, c1 = -(a1 * p_bx + b1 * p_by); // b -> c
+	float a2 = p_cy - p_ay, b2 = p_ax - p_cx, c2 = -(a2 * p_cx + b2 * p_cy); // c -> a
+
+	// Depth is linear in screen space, weighted by the opposite edges. It is
+	// pushed to the farthest value the triangle takes inside each pixel.
+	float inv_area = 1.0 / area;
+	float az = (a1 * p_az + a2 * p_bz + a0 * p_cz) * inv_area;
+	float bz = (b1 * p_az + b2 * p_bz + b0 * p_cz) * inv_area;
+	float cz = (c1 * p_az + c2 * p_bz + c0 * p_cz) * inv_area + (Math::abs(az) + Math::abs(bz)) * 0.5;
+
+	int start_x = min_x & ~3;
+
+	for (int y = min_y; y <= max_y; y++) {
+
+		float py = y + 0.5;
+		float *row = &mip.depth[y * mip.stride];
+
+#ifdef SIMD_ENABLED
+		static const float lane_offsets[4] = { 0.5, 1.5, 2.5, 3.5 };
+		SIMDFloat4 lanes = simd_load(lane_offsets);
+		SIMDFloat4 zero = simd_splat(0);
+		SIMDFloat4 va0 = simd_splat(a0), va1 = simd_splat(a1), va2 = simd_splat(a2), vaz = simd_splat(az);
+		SIMDFloat4 row0 = simd_splat(b0 * py + c0), row1 = simd_splat(b1 * py + c1), row2 = simd_splat(b2 * py + c2), rowz = simd_splat(bz * py + cz);
+
+		for (int x = start_x; x <= max_x; x += 4) {
+
+			SIMDFloat4 px = simd_add(simd_splat(x), lanes);
+			SIMDFloat4 e0 = simd_add(simd_mul(va0, px), row0);
+			SIMDFloat4 e1 = simd_add(simd_mul(va1, px), row1);
+			SIMDFloat4 e2 = simd_add(simd_mul(va2, px), row2);
+
+			SIMDFloat4 outside = simd_or(simd_greater(zero, e0), simd_or(simd_greater(zero, e1), simd_greater(zero, e2)));
+			if (simd_get_mask(outside) == 0xF) {
+				continue;
+			}
+
+			SIMDFloat4 old_depth = simd_load(row + x);
+			SIMDFloat4 depth = simd_min(old_depth, simd_add(simd_mul(vaz, px), rowz));
+			simd_store(row + x, simd_select(outside, old_depth, depth));
+		}
+#else
+		for (int x = min_x; x <= max_x; x++) {
+
+			float px = x + 0.5;
+			if (a0 * px + b0 * py + c0 < 0 || a1 * px + b1 * py + c1 < 0 || a2 * px + b2 * py + c2 < 0) {
+				continue;
+			}
+
+			float depth = az * px + bz * py + cz;
+			if (depth < row[x]) {
+				row[x] = depth;
+			}
+		}
+#endif
+	}
+}
+
+void OcclusionBuffer::end() {
+
+	for (uint32_t i = 1; i < mips.size(); i++) {
+
+		const Mip &src = mips[i - 1];
+		Mip &dst = mips[i];
+
+		for (int y = 0; y < dst.height; y++) {
+
+			const float *row_a = &src.depth[(y * 2) * src.stride];
+			const float *row_b = &src.depth[MIN(y * 2 + 1, src.height - 1) * src.stride];
+			float *row = &dst.depth[y * dst.stride];
+
+			for (int x = 0; x < dst.width; x++) {
+
+				int x_a = x * 2;
+				int x_b = MIN(x_a + 1, src.width - 1);
+				row[x] = MAX(MAX(row_a[x_a], row_a[x_b]), MAX(row_b[x_a], row_b[x_b]));
+			}
+		}
+	}
+}
+
+float OcclusionBuffer::get_depth(int p_x, int p_y) const {
+
+	ERR_FAIL_COND_V(mips.size() == 0, 1.0);
+	const Mip &mip = mips[0];
+	ERR_FAIL_INDEX_V(p_x, mip.width, 1.0);
+	ERR_FAIL_INDEX_V(p_y, mip.height, 1.0);
+	return mip.depth[p_y * mip.stride + p_x];
+}
+
+bool OcclusionBuffer::is_occluded(const AABB &p_aabb) const {
+
+	if (triangles_drawn == 0) {
+		return false;
+	}
+
+	float min_x = 1e20, min_y = 1e20, min_z = 1e20;
+	float max_x = -1e20, max_y = -1e20;
+
+	for (int i = 0; i < 8; i++) {
+
+		Vertex v = _xform(view_projection, p_aabb.get_endpoint(i));
+		if (v.w <= CMP_EPSILON || v.z < -v.w) {
+			return false; // crosses the near plane
+		}
+
+		float inv_w = 1.0 / v.w;
+		float x = v.x * inv_w;
+		float y = v.y * inv_w;
+		float z = v.z * inv_w;
+
+		min_x = MIN(min_x, x);
+		max_x = MAX(max_x, x);
+		min_y = MIN(min_y, y);
+		max_y = MAX(max_y, y);
+		min_z = MIN(min_z, z);
+	}
+
+	const Mip &base = mips[0];
+
+	float screen_min_x = (min_x + 1.0) * 0.5 * base.width;
+	float screen_max_x = (max_x + 1.0) * 0.5 * base.width;
+	float screen_min_y = (min_y + 1.0) * 0.5 * base.height;
+	float screen_max_y = (max_y + 1.0) * 0.5 * base.height;
+
+	if (screen_max_x < 0 || screen_max_y < 0 || screen_min_x >= base.width || screen_min_y >= base.height) {
+		return false; // off screen, leave it to the frustum cull
+	}
+
+	// Occluders cover the pixels whose center they cover, so they can reach
+	// half a pixel past their edges. Growing the rect by a pixel keeps boxes
+	// peeking out from behind them visible.
+	int x0 = MAX(0, (int)Math::floor(screen_min_x) - 1);
+	int x1 = MIN(base.width - 1, (int)Math::floor(screen_max_x) + 1);
+	int y0 = MAX(0, (int)Math::floor(screen_min_y) - 1);
+	int y1 = MIN(base.height - 1, (int)Math::floor(screen_max_y) + 1);
+
+	// Start at the level where the rect covers at most four by four texels.
+	// Texels around the edges reach past the box, so when that is not
+	// enough, retry on a couple of finer levels before giving up.
+	int level = 0;
+	while (level + 1 < (int)mips.size() && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3)) {
+		level++;
+	}
+
+	for (int finest = MAX(level - REFINE_LEVELS, 0); level >= finest; level--) {
+
+		if (_is_rect_behind(level, x0, y0, x1, y1, min_z)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool OcclusionBuffer::_is_rect_behind(int p_level, int p_x0, int p_y0, int p_x1, int p_y1, float p_depth) const {
+
+	const Mip &mip = mips[p_level];
+
+	for (int y = p_y0 >> p_level; y <= (p_y1 >> p_level); y++) {
+
+		const float *row = &mip.depth[y * mip.stride];
+		for (int x = p_x0 >> p_level; x <= (p_x1 >> p_level); x++) {
+			if (row[x] >= p_depth) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+OcclusionBuffer::OcclusionBuffer() {
+
+	triangles_drawn = 0;
+}
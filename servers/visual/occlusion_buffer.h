@@ -0,0 +1,97 @@
+/*************************************************************************/
+/*  occlusion_buffer.h                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md)    */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#ifndef OCCLUSION_BUFFER_H
+#define OCCLUSION_BUFFER_H
+
+#include "core/local_vector.h"
+#include "core/math/aabb.h"
+#include "core/math/camera_matrix.h"
+#include "core/math/transform.h"
+
+// Low resolution depth buffer the occluders are rasterized into on the CPU,
+// so instances hidden behind them can be dropped before rendering. Depths
+// are stored as normalized device z, and a max mip chain on top of it lets
+// a box be tested against a handful of texels.
+//
+// is_occluded() only reads, so once end() is called it can be used from
+// several threads at the same time.
+
+class OcclusionBuffer {
+
+	enum {
+		CLIP_PLANES = 5, // near and the four sides, the far plane is left to the depth test
+		REFINE_LEVELS = 2 // finer levels a box is retried on
+	};
+
+	struct Mip {
+		int width;
+		int height;
+		int stride; // width rounded up to a multiple of four
+		LocalVector<float> depth;
+	};
+
+	struct Vertex {
+		float x, y, z, w;
+	};
+
+	LocalVector<Mip> mips;
+	CameraMatrix view_projection;
+	int triangles_drawn;
+
+	_FORCE_INLINE_ static Vertex _xform(const CameraMatrix &p_matrix, const Vector3 &p_point);
+	_FORCE_INLINE_ static float _clip_distance(int p_plane, const Vertex &p_vertex);
+	void _draw_clipped_triangle(const Vertex &p_a, const Vertex &p_b, const Vertex &p_c);
+	bool _is_rect_behind(int p_level, int p_x0, int p_y0, int p_x1, int p_y1, float p_depth) const;
+	void _rasterize_triangle(float p_ax, float p_ay, float p_az, float p_bx, float p_by, float p_bz, float p_cx, float p_cy, float p_cz);
+
+public:
+	void set_size(int p_width, int p_height);
+	int get_width() const { return mips.size() ? mips[0].width : 0; }
+	int get_height() const { return mips.size() ? mips[0].height : 0; }
+
+	// Clears the buffer and sets the camera the occluders are drawn from.
+	void begin(const CameraMatrix &p_projection, const Transform &p_camera_transform);
+	// Draws a list of triangles, three vertices each. Both sides are drawn.
+	void draw_triangles(const Transform &p_transform, const Vector3 *p_vertices, int p_vertex_count);
+	// Builds the mip chain, must be called before testing.
+	void end();
+
+	bool is_empty() const { return triangles_drawn == 0; }
+	int get_triangles_drawn() const { return triangles_drawn; }
+	float get_depth(int p_x, int p_y) const;
+
+	// True when the box is fully behind what was drawn.
+	bool is_occluded(const AABB &p_aabb) const;
+
+	OcclusionBuffer();
+};
+
+#endif // OCCLUSION_BUFFER_H
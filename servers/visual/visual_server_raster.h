@@ -465,6 +465,7 @@ public:
 	BIND2(viewport_set_hide_canvas, RID, bool)
 	BIND2(viewport_set_disable_environment, RID, bool)
 	BIND2(viewport_set_disable_3d, RID, bool)
+	BIND2(viewport_set_use_occlusion_culling, RID, bool)
 	BIND2(viewport_set_keep_3d_linear, RID, bool)
 
 	BIND2(viewport_attach_camera, RID, RID)
@@ -530,6 +531,11 @@ public:
 	BIND3(scenario_set_reflection_atlas_size, RID, int, int)
 	BIND2(scenario_set_fallback_environment, RID, RID)
 
+	/* OCCLUDER API */
+
+	BIND0R(RID, occluder_create)
+	BIND2(occluder_set_faces, RID, const PoolVector<Vector3> &)
+
 	/* INSTANCING API */
 	// from can be mesh, light,  area and portal so far.
 	BIND0R(RID, instance_create)
@@ -30,6 +30,8 @@
 
 #include "visual_server_scene.h"
 #include "core/os/os.h"
+#include "core/os/worker_thread_pool.h"
+#include "core/project_settings.h"
 #include "visual_server_globals.h"
 #include "visual_server_raster.h"
 #include <new>
@@ -102,7 +104,7 @@ void VisualServerScene::camera_set_use_vertical_aspect(RID p_camera, bool p_enab
 
 /* SCENARIO API */
 
-void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int) {
+void *VisualServerScene::_instance_pair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -181,7 +183,7 @@ void *VisualServerScene::_instance_pair(void *p_self, OctreeElementID, Instance
 
 	return NULL;
 }
-void VisualServerScene::_instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *udata) {
+void VisualServerScene::_instance_unpair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int, void *udata) {
 
 	//VisualServerScene *self = (VisualServerScene*)p_self;
 	Instance *A = p_A;
@@ -257,8 +259,8 @@ RID VisualServerScene::scenario_create() {
 	RID scenario_rid = scenario_owner.make_rid(scenario);
 	scenario->self = scenario_rid;
 
-	scenario->octree.set_pair_callback(_instance_pair, this);
-	scenario->octree.set_unpair_callback(_instance_unpair, this);
+	scenario->bvh.set_pair_callback(_instance_pair, this);
+	scenario->bvh.set_unpair_callback(_instance_unpair, this);
 	scenario->reflection_probe_shadow_atlas = VSG::scene_render->shadow_atlas_create();
 	VSG::scene_render->shadow_atlas_set_size(scenario->reflection_probe_shadow_atlas, 1024); //make enough shadows for close distance, don't bother with rest
 	VSG::scene_render->shadow_atlas_set_quadrant_subdivision(scenario->reflection_probe_shadow_atlas, 0, 4);
@@ -299,6 +301,41 @@ void VisualServerScene::scenario_set_reflection_atlas_size(RID p_scenario, int p
 	VSG::scene_render->reflection_atlas_set_subdivision(scenario->reflection_atlas, p_subdiv);
 }
 
+/* OCCLUDER API */
+
+RID VisualServerScene::occluder_create() {
+
+	Occluder *occluder = memnew(Occluder);
+	ERR_FAIL_COND_V(!occluder, RID());
+	return occluder_owner.make_rid(occluder);
+}
+
+void VisualServerScene::occluder_set_faces(RID p_occluder, const PoolVector<Vector3> &p_faces) {
+
+	Occluder *occluder = occluder_owner.getornull(p_occluder);
+	ERR_FAIL_COND(!occluder);
+	ERR_FAIL_COND(p_faces.size() % 3);
+
+	int count = p_faces.size();
+	occluder->faces.resize(count);
+	occluder->aabb = AABB();
+
+	PoolVector<Vector3>::Read r = p_faces.read();
+	for (int i = 0; i < count; i++) {
+
+		occluder->faces[i] = r[i];
+		if (i == 0) {
+			occluder->aabb.position = r[i];
+		} else {
+			occluder->aabb.expand_to(r[i]);
+		}
+	}
+
+	for (Set<Instance *>::Element *E = occluder->users.front(); E; E = E->next()) {
+		_instance_queue_update(E->get(), true);
+	}
+}
+
 /* INSTANCING API */
 
 void VisualServerScene::_instance_queue_update(Instance *p_instance, bool p_update_aabb, bool p_update_materials) {
@@ -336,11 +373,13 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 	if (instance->base_type != VS::INSTANCE_NONE) {
 		//free anything related to that base
 
-		VSG::storage->instance_remove_dependency(instance->base, instance);
+		if (instance->base_type != VS::INSTANCE_OCCLUDER) {
+			VSG::storage->instance_remove_dependency(instance->base, instance);
+		}
 
 		if (instance->base_type == VS::INSTANCE_GI_PROBE) {
 			//if gi probe is baking, wait until done baking, else race condition may happen when removing it
-			//from octree
+			//from bvh
 			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(instance->base_data);
 
 			//make sure probes are done baking
@@ -355,9 +394,9 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 			}
 		}
 
-		if (scenario && instance->octree_id) {
-			scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (scenario && instance->bvh_id) {
+			scenario->bvh.erase(instance->bvh_id); //make dependencies generated by the bvh go away
+			instance->bvh_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -409,6 +448,13 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 				VSG::scene_render->free(gi_probe->probe_instance);
 
 			} break;
+			case VS::INSTANCE_OCCLUDER: {
+
+				Occluder *occluder = occluder_owner.getornull(instance->base);
+				if (occluder) {
+					occluder->users.erase(instance);
+				}
+			} break;
 			default: {
 			}
 		}
@@ -433,7 +479,8 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 
 	if (p_base.is_valid()) {
 
-		instance->base_type = VSG::storage->get_base_type(p_base);
+		// occluders are the only bases owned by the scene
+		instance->base_type = occluder_owner.owns(p_base) ? VS::INSTANCE_OCCLUDER : VSG::storage->get_base_type(p_base);
 		ERR_FAIL_COND(instance->base_type == VS::INSTANCE_NONE);
 
 		switch (instance->base_type) {
@@ -487,11 +534,17 @@ void VisualServerScene::instance_set_base(RID p_instance, RID p_base) {
 				gi_probe->probe_instance = VSG::scene_render->gi_probe_instance_create();
 
 			} break;
+			case VS::INSTANCE_OCCLUDER: {
+
+				occluder_owner.get(p_base)->users.insert(instance);
+			} break;
 			default: {
 			}
 		}
 
-		VSG::storage->instance_add_dependency(p_base, instance);
+		if (instance->base_type != VS::INSTANCE_OCCLUDER) {
+			VSG::storage->instance_add_dependency(p_base, instance);
+		}
 
 		instance->base = p_base;
 
@@ -508,9 +561,9 @@ void VisualServerScene::instance_set_scenario(RID p_instance, RID p_scenario) {
 
 		instance->scenario->instances.remove(&instance->scenario_item);
 
-		if (instance->octree_id) {
-			instance->scenario->octree.erase(instance->octree_id); //make dependencies generated by the octree go away
-			instance->octree_id = 0;
+		if (instance->bvh_id) {
+			instance->scenario->bvh.erase(instance->bvh_id); //make dependencies generated by the bvh go away
+			instance->bvh_id = 0;
 		}
 
 		switch (instance->base_type) {
@@ -662,26 +715,26 @@ void VisualServerScene::instance_set_visible(RID p_instance, bool p_visible) {
 
 	switch (instance->base_type) {
 		case VS::INSTANCE_LIGHT: {
-			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (VSG::storage->light_get_type(instance->base) != VS::LIGHT_DIRECTIONAL && instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_LIGHT, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_REFLECTION_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_REFLECTION_PROBE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_LIGHTMAP_CAPTURE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
+			if (instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_LIGHTMAP_CAPTURE, p_visible ? VS::INSTANCE_GEOMETRY_MASK : 0);
 			}
 
 		} break;
 		case VS::INSTANCE_GI_PROBE: {
-			if (instance->octree_id && instance->scenario) {
-				instance->scenario->octree.set_pairable(instance->octree_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
+			if (instance->bvh_id && instance->scenario) {
+				instance->scenario->bvh.set_pairable(instance->bvh_id, p_visible, 1 << VS::INSTANCE_GI_PROBE, p_visible ? (VS::INSTANCE_GEOMETRY_MASK | (1 << VS::INSTANCE_LIGHT)) : 0);
 			}
 
 		} break;
@@ -785,7 +838,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_aabb(const AABB &p_aabb, RID
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_aabb(p_aabb, cull, 1024);
+	culled = scenario->bvh.cull_aabb(p_aabb, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -808,7 +861,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_ray(const Vector3 &p_from, co
 
 	int culled = 0;
 	Instance *cull[1024];
-	culled = scenario->octree.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
+	culled = scenario->bvh.cull_segment(p_from, p_from + p_to * 10000, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 		Instance *instance = cull[i];
@@ -831,7 +884,7 @@ Vector<ObjectID> VisualServerScene::instances_cull_convex(const Vector<Plane> &p
 	int culled = 0;
 	Instance *cull[1024];
 
-	culled = scenario->octree.cull_convex(p_convex, cull, 1024);
+	culled = scenario->bvh.cull_convex(p_convex, cull, 1024);
 
 	for (int i = 0; i < culled; i++) {
 
@@ -960,7 +1013,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 		return;
 	}
 
-	if (p_instance->octree_id == 0) {
+	if (p_instance->bvh_id == 0) {
 
 		uint32_t base_type = 1 << p_instance->base_type;
 		uint32_t pairable_mask = 0;
@@ -978,8 +1031,8 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			pairable = true;
 		}
 
-		// not inside octree
-		p_instance->octree_id = p_instance->scenario->octree.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
+		// not inside bvh
+		p_instance->bvh_id = p_instance->scenario->bvh.create(p_instance, new_aabb, 0, pairable, base_type, pairable_mask);
 
 	} else {
 
@@ -988,7 +1041,7 @@ void VisualServerScene::_update_instance(Instance *p_instance) {
 			return;
 		*/
 
-		p_instance->scenario->octree.move(p_instance->octree_id, new_aabb);
+		p_instance->scenario->bvh.move(p_instance->bvh_id, new_aabb);
 	}
 }
 
@@ -1055,6 +1108,11 @@ void VisualServerScene::_update_instance_aabb(Instance *p_instance) {
 
 			new_aabb = VSG::storage->lightmap_capture_get_bounds(p_instance->base);
 
+		} break;
+		case VisualServer::INSTANCE_OCCLUDER: {
+
+			new_aabb = occluder_owner.get(p_instance->base)->aabb;
+
 		} break;
 		default: {
 		}
@@ -1300,15 +1358,35 @@ void VisualServerScene::_update_instance_lightmap_captures(Instance *p_instance)
 	}
 }
 
-bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario) {
+VisualServerScene::ShadowPass &VisualServerScene::_add_shadow_pass(Instance *p_light, int p_pass) {
+
+	if (shadow_pass_count == (int)shadow_passes.size()) {
+		shadow_passes.resize(shadow_pass_count + 1);
+	}
+
+	ShadowPass &pass = shadow_passes[shadow_pass_count++];
+	pass.light = p_light;
+	pass.pass = p_pass;
+	pass.plane_count = 0;
+	pass.camera = CameraMatrix();
+	pass.transform = Transform();
+	pass.far = 0;
+	pass.split = 0;
+	pass.bias_scale = 1.0;
+	pass.restore_dual_paraboloid = false;
+	pass.fit_to_casters = false;
+	pass.casters.clear();
+	pass.animated_material_found = false;
+	return pass;
+}
+
+void VisualServerScene::_light_instance_setup_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, const CullBatch &p_depth_range) {
 
 	InstanceLightData *light = static_cast<InstanceLightData *>(p_instance->base_data);
 
 	Transform light_transform = p_instance->transform;
 	light_transform.orthonormalize(); //scale does not count on lights
 
-	bool animated_material_found = false;
-
 	switch (VSG::storage->light_get_type(p_instance->base)) {
 
 		case VS::LIGHT_DIRECTIONAL: {
@@ -1324,44 +1402,10 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			VS::LightDirectionalShadowDepthRangeMode depth_range_mode = VSG::storage->light_directional_get_shadow_depth_range_mode(p_instance->base);
 
 			if (depth_range_mode == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
-				//optimize min/max
-				Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
-				int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-				Plane base(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
-				//check distance max and min
-
-				bool found_items = false;
-				float z_max = -1e20;
-				float z_min = 1e20;
-
-				for (int i = 0; i < cull_count; i++) {
-
-					Instance *instance = instance_shadow_cull_result[i];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						continue;
-					}
-
-					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-						animated_material_found = true;
-					}
-
-					float max, min;
-					instance->transformed_aabb.project_range_in_plane(base, min, max);
-
-					if (max > z_max) {
-						z_max = max;
-					}
-
-					if (min < z_min) {
-						z_min = min;
-					}
-
-					found_items = true;
-				}
-
-				if (found_items) {
-					min_distance = MAX(min_distance, z_min);
-					max_distance = MIN(max_distance, z_max);
+				//optimize min/max, the range of the casters was found along with the camera cull
+				if (p_depth_range.found_items) {
+					min_distance = MAX(min_distance, p_depth_range.z_min);
+					max_distance = MIN(max_distance, p_depth_range.z_max);
 				}
 			}
 
@@ -1509,61 +1553,34 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 					}
 				}
 
-				//now that we now all ranges, we can proceed to make the light frustum planes, for culling octree
+				//now that we now all ranges, we can proceed to make the light frustum planes, for culling bvh
 
-				Vector<Plane> light_frustum_planes;
-				light_frustum_planes.resize(6);
+				ShadowPass &pass = _add_shadow_pass(p_instance, i);
 
 				//right/left
-				light_frustum_planes.write[0] = Plane(x_vec, x_max);
-				light_frustum_planes.write[1] = Plane(-x_vec, -x_min);
+				pass.planes[0] = Plane(x_vec, x_max);
+				pass.planes[1] = Plane(-x_vec, -x_min);
 				//top/bottom
-				light_frustum_planes.write[2] = Plane(y_vec, y_max);
-				light_frustum_planes.write[3] = Plane(-y_vec, -y_min);
+				pass.planes[2] = Plane(y_vec, y_max);
+				pass.planes[3] = Plane(-y_vec, -y_min);
 				//near/far
-				light_frustum_planes.write[4] = Plane(z_vec, z_max + 1e6);
-				light_frustum_planes.write[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
-
-				int cull_count = p_scenario->octree.cull_convex(light_frustum_planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-
-				// a pre pass will need to be needed to determine the actual z-near to be used
-
-				Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
-
-				for (int j = 0; j < cull_count; j++) {
-
-					float min, max;
-					Instance *instance = instance_shadow_cull_result[j];
-					if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-						cull_count--;
-						SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-						j--;
-						continue;
-					}
-
-					instance->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-					if (max > z_max)
-						z_max = max;
-				}
-
-				{
-
-					CameraMatrix ortho_camera;
-					real_t half_x = (x_max_cam - x_min_cam) * 0.5;
-					real_t half_y = (y_max_cam - y_min_cam) * 0.5;
-
-					ortho_camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - z_min_cam));
-
-					Transform ortho_transform;
-					ortho_transform.basis = transform.basis;
-					ortho_transform.origin = x_vec * (x_min_cam + half_x) + y_vec * (y_min_cam + half_y) + z_vec * z_max;
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, ortho_camera, ortho_transform, 0, distances[i + 1], i, bias_scale);
-				}
-
-				VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+				pass.planes[4] = Plane(z_vec, z_max + 1e6);
+				pass.planes[5] = Plane(-z_vec, -z_min); // z_min is ok, since casters further than far-light plane are not needed
+				pass.plane_count = 6;
+
+				pass.near_plane = Plane(light_transform.origin, -light_transform.basis.get_axis(2));
+				pass.transform = transform;
+				pass.split = distances[i + 1];
+				pass.bias_scale = bias_scale;
+
+				// the ortho camera is set up once the casters are known, see _cull_shadow_pass_job()
+				pass.fit_to_casters = true;
+				pass.x_min = x_min_cam;
+				pass.x_max = x_max_cam;
+				pass.y_min = y_min_cam;
+				pass.y_max = y_max_cam;
+				pass.z_min = z_min_cam;
+				pass.z_max = z_max;
 			}
 
 		} break;
@@ -1580,36 +1597,17 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 					float radius = VSG::storage->light_get_param(p_instance->base, VS::LIGHT_PARAM_RANGE);
 
 					float z = i == 0 ? -1 : 1;
-					Vector<Plane> planes;
-					planes.resize(5);
-					planes.write[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
-					planes.write[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
-					planes.write[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
-					planes.write[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
-					planes.write[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
-
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
-					Plane near_plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
-
-					for (int j = 0; j < cull_count; j++) {
-
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-							j--;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-
-							instance->depth = near_plane.distance_to(instance->transform.origin);
-							instance->depth_layer = 0;
-						}
-					}
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, i);
-					VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					ShadowPass &pass = _add_shadow_pass(p_instance, i);
+					pass.planes[0] = light_transform.xform(Plane(Vector3(0, 0, z), radius));
+					pass.planes[1] = light_transform.xform(Plane(Vector3(1, 0, z).normalized(), radius));
+					pass.planes[2] = light_transform.xform(Plane(Vector3(-1, 0, z).normalized(), radius));
+					pass.planes[3] = light_transform.xform(Plane(Vector3(0, 1, z).normalized(), radius));
+					pass.planes[4] = light_transform.xform(Plane(Vector3(0, -1, z).normalized(), radius));
+					pass.plane_count = 5;
+
+					pass.near_plane = Plane(light_transform.origin, light_transform.basis.get_axis(2) * z);
+					pass.transform = light_transform;
+					pass.far = radius;
 				}
 			} else { //shadow cube
 
@@ -1640,33 +1638,22 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 
 					Transform xform = light_transform * Transform().looking_at(view_normals[i], view_up[i]);
 
-					Vector<Plane> planes = cm.get_projection_planes(xform);
-
-					int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+					LocalVector<Plane, 6> planes;
+					cm.get_projection_planes(xform, planes);
 
-					Plane near_plane(xform.origin, -xform.basis.get_axis(2));
-					for (int j = 0; j < cull_count; j++) {
-
-						Instance *instance = instance_shadow_cull_result[j];
-						if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-							cull_count--;
-							SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-							j--;
-						} else {
-							if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-								animated_material_found = true;
-							}
-							instance->depth = near_plane.distance_to(instance->transform.origin);
-							instance->depth_layer = 0;
-						}
+					ShadowPass &pass = _add_shadow_pass(p_instance, i);
+					for (uint32_t j = 0; j < planes.size(); j++) {
+						pass.planes[j] = planes[j];
 					}
-
-					VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, xform, radius, 0, i);
-					VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, i, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+					pass.plane_count = planes.size();
+
+					pass.near_plane = Plane(xform.origin, -xform.basis.get_axis(2));
+					pass.camera = cm;
+					pass.transform = xform;
+					pass.far = radius;
+					//restore the regular DP matrix after the last face
+					pass.restore_dual_paraboloid = i == 5;
 				}
-
-				//restore the regular DP matrix
-				VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, radius, 0, 0);
 			}
 
 		} break;
@@ -1678,36 +1665,258 @@ bool VisualServerScene::_light_instance_update_shadow(Instance *p_instance, cons
 			CameraMatrix cm;
 			cm.set_perspective(angle * 2.0, 1.0, 0.01, radius);
 
-			Vector<Plane> planes = cm.get_projection_planes(light_transform);
-			int cull_count = p_scenario->octree.cull_convex(planes, instance_shadow_cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+			LocalVector<Plane, 6> planes;
+			cm.get_projection_planes(light_transform, planes);
 
-			Plane near_plane(light_transform.origin, -light_transform.basis.get_axis(2));
-			for (int j = 0; j < cull_count; j++) {
-
-				Instance *instance = instance_shadow_cull_result[j];
-				if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
-					cull_count--;
-					SWAP(instance_shadow_cull_result[j], instance_shadow_cull_result[cull_count]);
-					j--;
-				} else {
-					if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
-						animated_material_found = true;
-					}
-					instance->depth = near_plane.distance_to(instance->transform.origin);
-					instance->depth_layer = 0;
-				}
+			ShadowPass &pass = _add_shadow_pass(p_instance, 0);
+			for (uint32_t j = 0; j < planes.size(); j++) {
+				pass.planes[j] = planes[j];
 			}
+			pass.plane_count = planes.size();
 
-			VSG::scene_render->light_instance_set_shadow_transform(light->instance, cm, light_transform, radius, 0, 0);
-			VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, 0, (RasterizerScene::InstanceBase **)instance_shadow_cull_result, cull_count);
+			pass.near_plane = Plane(light_transform.origin, -light_transform.basis.get_axis(2));
+			pass.camera = cm;
+			pass.transform = light_transform;
+			pass.far = radius;
 
 		} break;
 	}
+}
+
+void VisualServerScene::_cull_shadow_pass_job(uint32_t p_index, void *p_userdata) {
+
+	ShadowPass &pass = shadow_passes[p_index];
+	Instance **cull_result = _get_cull_buffer();
+
+	int cull_count = cull_scenario->bvh.cull_convex(pass.planes, pass.plane_count, cull_result, MAX_INSTANCE_CULL, VS::INSTANCE_GEOMETRY_MASK);
+
+	for (int j = 0; j < cull_count; j++) {
+
+		Instance *instance = cull_result[j];
+		if (!instance->visible || !((1 << instance->base_type) & VS::INSTANCE_GEOMETRY_MASK) || !static_cast<InstanceGeometryData *>(instance->base_data)->can_cast_shadows) {
+			continue;
+		}
+
+		if (static_cast<InstanceGeometryData *>(instance->base_data)->material_is_animated) {
+			pass.animated_material_found = true;
+		}
+
+		pass.casters.push_back(instance);
+	}
+
+	if (pass.fit_to_casters) {
+
+		Vector3 x_vec = pass.transform.basis.get_axis(Vector3::AXIS_X).normalized();
+		Vector3 y_vec = pass.transform.basis.get_axis(Vector3::AXIS_Y).normalized();
+		Vector3 z_vec = pass.transform.basis.get_axis(Vector3::AXIS_Z).normalized();
+
+		float z_max = pass.z_max;
+
+		for (uint32_t j = 0; j < pass.casters.size(); j++) {
+
+			float min, max;
+			pass.casters[j]->transformed_aabb.project_range_in_plane(Plane(z_vec, 0), min, max);
+			if (max > z_max)
+				z_max = max;
+		}
+
+		real_t half_x = (pass.x_max - pass.x_min) * 0.5;
+		real_t half_y = (pass.y_max - pass.y_min) * 0.5;
+
+		pass.camera.set_orthogonal(-half_x, half_x, -half_y, half_y, 0, (z_max - pass.z_min));
+		pass.transform.origin = x_vec * (pass.x_min + half_x) + y_vec * (pass.y_min + half_y) + z_vec * z_max;
+	}
+}
+
+void VisualServerScene::_render_shadow_passes(RID p_shadow_atlas) {
+
+	_run_cull_jobs(&VisualServerScene::_cull_shadow_pass_job, shadow_pass_count);
+
+	Instance *last_light = NULL;
+
+	for (int i = 0; i < shadow_pass_count; i++) {
+
+		ShadowPass &pass = shadow_passes[i];
+		InstanceLightData *light = static_cast<InstanceLightData *>(pass.light->base_data);
+
+		for (uint32_t j = 0; j < pass.casters.size(); j++) {
+
+			Instance *instance = pass.casters[j];
+			instance->depth = pass.near_plane.distance_to(instance->transform.origin);
+			instance->depth_layer = 0;
+		}
+
+		VSG::scene_render->light_instance_set_shadow_transform(light->instance, pass.camera, pass.transform, pass.far, pass.split, pass.pass, pass.bias_scale);
+		VSG::scene_render->render_shadow(light->instance, p_shadow_atlas, pass.pass, (RasterizerScene::InstanceBase **)pass.casters.ptr(), pass.casters.size());
+
+		if (pass.restore_dual_paraboloid) {
+			Transform light_transform = pass.light->transform;
+			light_transform.orthonormalize();
+			VSG::scene_render->light_instance_set_shadow_transform(light->instance, CameraMatrix(), light_transform, pass.far, 0, 0);
+		}
+
+		// omni and spot lights with animated casters are redrawn next frame
+		if (VSG::storage->light_get_type(pass.light->base) != VS::LIGHT_DIRECTIONAL) {
+			if (pass.light != last_light) {
+				light->shadow_dirty = false;
+			}
+			light->shadow_dirty = light->shadow_dirty || pass.animated_material_found;
+		}
+		last_light = pass.light;
+	}
+}
+
+VisualServerScene::Instance **VisualServerScene::_get_cull_buffer() {
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+	int thread = pool ? pool->get_thread_index() : -1;
+	if (thread < 0) {
+		return instance_shadow_cull_result; // jobs run by this thread
+	}
+
+	return cull_thread_buffers[thread];
+}
+
+void VisualServerScene::_run_cull_jobs(void (VisualServerScene::*p_method)(uint32_t, void *), uint32_t p_count) {
+
+	if (!p_count) {
+		return;
+	}
+
+	WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+
+	if (parallel_culling && pool && pool->get_thread_count() > 0 && p_count > 1) {
+
+		while ((int)cull_thread_buffers.size() < pool->get_thread_count()) {
+			cull_thread_buffers.push_back((Instance **)memalloc(sizeof(Instance *) * MAX_INSTANCE_CULL));
+		}
+
+		WorkerThreadPool::TaskID task = pool->add_template_group_task(this, p_method, (void *)NULL, p_count);
+		pool->wait_for_task_completion(task);
+
+	} else {
+
+		for (uint32_t i = 0; i < p_count; i++) {
+			(this->*p_method)(i, NULL);
+		}
+	}
+}
+
+void VisualServerScene::_cull_subtree_job(uint32_t p_index, void *p_userdata) {
+
+	Instance **cull_result = _get_cull_buffer();
+	int cull_count = cull_scenario->bvh.cull_convex(cull_subtrees[p_index], cull_planes, cull_plane_count, cull_result, MAX_INSTANCE_CULL);
+
+	LocalVector<Instance *> &result = cull_subtree_results[p_index];
+	result.resize(cull_count);
+	for (int i = 0; i < cull_count; i++) {
+		result[i] = cull_result[i];
+	}
+}
+
+void VisualServerScene::_cull_evaluate_job(uint32_t p_index, void *p_userdata) {
+
+	const CullEvaluate &evaluate = cull_evaluate;
+
+	int from = p_index * CULL_EVALUATE_BATCH;
+	int to = MIN(from + CULL_EVALUATE_BATCH, instance_cull_count);
+
+	CullBatch &batch = cull_batches[p_index];
+	batch.found_items = false;
+	batch.z_min = 1e20;
+	batch.z_max = -1e20;
+
+	for (int i = from; i < to; i++) {
+
+		Instance *ins = instance_cull_result[i];
+		bool geometry = ((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible;
+
+		if (evaluate.fit_depth_range && geometry && static_cast<InstanceGeometryData *>(ins->base_data)->can_cast_shadows) {
+
+			float max, min;
+			ins->transformed_aabb.project_range_in_plane(evaluate.depth_range_plane, min, max);
+
+			if (max > batch.z_max) {
+				batch.z_max = max;
+			}
+
+			if (min < batch.z_min) {
+				batch.z_min = min;
+			}
+
+			batch.found_items = true;
+		}
+
+		uint8_t flag = CULL_DROP;
+
+		if ((evaluate.camera_layer_mask & ins->layer_mask) == 0) {
+
+			//failure
+		} else if ((ins->base_type == VS::INSTANCE_LIGHT || ins->base_type == VS::INSTANCE_REFLECTION_PROBE || ins->base_type == VS::INSTANCE_GI_PROBE) && ins->visible) {
+
+			flag = CULL_PROCESS;
+
+		} else if (geometry && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY && !(evaluate.occlusion_culling && occlusion_buffer.is_occluded(ins->transformed_aabb))) {
+			// occluded geometry is dropped, but the depth range above still counts it as a caster
+
+			flag = (ins->redraw_if_visible || ins->base_type == VS::INSTANCE_PARTICLES) ? CULL_KEEP_PROCESS : CULL_KEEP;
+
+			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
+
+			if (geom->lighting_dirty) {
+				int l = 0;
+				//only called when lights AABB enter/exit this geometry
+				ins->light_instances.resize(geom->lighting.size());
+
+				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
+
+					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
+
+					ins->light_instances.write[l++] = light->instance;
+				}
+
+				geom->lighting_dirty = false;
+			}
+
+			if (geom->reflection_dirty) {
+				int l = 0;
+				//only called when reflection probe AABB enter/exit this geometry
+				ins->reflection_probe_instances.resize(geom->reflection_probes.size());
+
+				for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
+
+					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
+
+					ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
+				}
+
+				geom->reflection_dirty = false;
+			}
+
+			if (geom->gi_probes_dirty) {
+				int l = 0;
+				//only called when reflection probe AABB enter/exit this geometry
+				ins->gi_probe_instances.resize(geom->gi_probes.size());
+
+				for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
+
+					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
 
-	return animated_material_found;
+					ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
+				}
+
+				geom->gi_probes_dirty = false;
+			}
+
+			ins->depth = evaluate.near_plane.distance_to(ins->transform.origin);
+			ins->depth_layer = CLAMP(int(ins->depth * 16 / evaluate.z_far), 0, 15);
+		}
+
+		cull_flags[i] = flag;
+	}
 }
 
-void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas) {
+void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas, bool p_use_occlusion_culling) {
 // render to mono camera
 #ifndef _3D_DISABLED
 
@@ -1753,12 +1962,12 @@ void VisualServerScene::render_camera(RID p_camera, RID p_scenario, Size2 p_view
 		} break;
 	}
 
-	_prepare_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+	_prepare_scene(camera->transform, camera_matrix, ortho, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), p_use_occlusion_culling);
 	_render_scene(camera->transform, camera_matrix, ortho, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 #endif
 }
 
-void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInterface::Eyes p_eye, RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas) {
+void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInterface::Eyes p_eye, RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas, bool p_use_occlusion_culling) {
 	// render for AR/VR interface
 
 	Camera *camera = camera_owner.getornull(p_camera);
@@ -1832,17 +2041,47 @@ void VisualServerScene::render_camera(Ref<ARVRInterface> &p_interface, ARVRInter
 		mono_transform *= apply_z_shift;
 
 		// now prepare our scene with our adjusted transform projection matrix
-		_prepare_scene(mono_transform, combined_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+		// no occlusion culling, what hides an object from between the eyes may not hide it from both
+		_prepare_scene(mono_transform, combined_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), false);
 	} else if (p_eye == ARVRInterface::EYE_MONO) {
 		// For mono render, prepare as per usual
-		_prepare_scene(cam_transform, camera_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID());
+		_prepare_scene(cam_transform, camera_matrix, false, camera->env, camera->visible_layers, p_scenario, p_shadow_atlas, RID(), p_use_occlusion_culling);
 	}
 
 	// And render our scene...
 	_render_scene(cam_transform, camera_matrix, false, camera->env, p_scenario, p_shadow_atlas, RID(), -1);
 };
 
-void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe) {
+bool VisualServerScene::_draw_occluders(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, const Plane *p_planes, int p_plane_count, Scenario *p_scenario, uint32_t p_visible_layers) {
+
+	int occluder_count = p_scenario->bvh.cull_convex(p_planes, p_plane_count, occluder_cull_result, MAX_OCCLUDERS_CULLED, 1 << VS::INSTANCE_OCCLUDER);
+	if (occluder_count == 0) {
+		return false;
+	}
+
+	// same aspect as the camera, so pixels stay square
+	int width = MAX(occlusion_buffer_width, 1);
+	int height = MAX(int(width / p_cam_projection.get_aspect()), 1);
+	occlusion_buffer.set_size(width, height);
+	occlusion_buffer.begin(p_cam_projection, p_cam_transform);
+
+	for (int i = 0; i < occluder_count; i++) {
+
+		Instance *ins = occluder_cull_result[i];
+		if (!ins->visible || !(ins->layer_mask & p_visible_layers)) {
+			continue;
+		}
+
+		const Occluder *occluder = occluder_owner.get(ins->base);
+		occlusion_buffer.draw_triangles(ins->transform, occluder->faces.ptr(), occluder->faces.size());
+	}
+
+	occlusion_buffer.end();
+
+	return !occlusion_buffer.is_empty();
+}
+
+void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_use_occlusion_culling) {
 	// Note, in stereo rendering:
 	// - p_cam_transform will be a transform in the middle of our two eyes
 	// - p_cam_projection is a wider frustrum that encompasses both eyes
@@ -1856,13 +2095,35 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 	//rasterizer->set_camera(camera->transform, camera_matrix,ortho);
 
-	Vector<Plane> planes = p_cam_projection.get_projection_planes(p_cam_transform);
+	LocalVector<Plane, 6> planes;
+	p_cam_projection.get_projection_planes(p_cam_transform, planes);
 
 	Plane near_plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2).normalized());
 	float z_far = p_cam_projection.get_z_far();
 
 	/* STEP 2 - CULL */
-	instance_cull_count = scenario->octree.cull_convex(planes, instance_cull_result, MAX_INSTANCE_CULL);
+
+	// split in subtrees that are culled as separate jobs, then merged in order
+	cull_scenario = scenario;
+	cull_planes = planes.ptr();
+	cull_plane_count = planes.size();
+	scenario->bvh.get_subtrees(cull_subtrees, CULL_SUBTREES);
+	if (cull_subtree_results.size() < cull_subtrees.size()) {
+		cull_subtree_results.resize(cull_subtrees.size());
+	}
+
+	_run_cull_jobs(&VisualServerScene::_cull_subtree_job, cull_subtrees.size());
+
+	instance_cull_count = 0;
+	for (uint32_t i = 0; i < cull_subtrees.size(); i++) {
+
+		const LocalVector<Instance *> &result = cull_subtree_results[i];
+		int count = MIN((int)result.size(), MAX_INSTANCE_CULL - instance_cull_count);
+		for (int j = 0; j < count; j++) {
+			instance_cull_result[instance_cull_count++] = result[j];
+		}
+	}
+
 	light_cull_count = 0;
 
 	reflection_probe_cull_count = 0;
@@ -1870,10 +2131,9 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 	//light_samplers_culled=0;
 
 	/*
-	print_line("OT: "+rtos( (OS::get_singleton()->get_ticks_usec()-t)/1000.0));
-	print_line("OTO: "+itos(p_scenario->octree.get_octant_count()));
-	print_line("OTE: "+itos(p_scenario->octree.get_elem_count()));
-	print_line("OTP: "+itos(p_scenario->octree.get_pair_count()));
+	print_line("BVH: "+rtos( (OS::get_singleton()->get_ticks_usec()-t)/1000.0));
+	print_line("BVHE: "+itos(p_scenario->bvh.get_elem_count()));
+	print_line("BVHP: "+itos(p_scenario->bvh.get_pair_count()));
 	*/
 
 	/* STEP 3 - PROCESS PORTALS, VALIDATE ROOMS */
@@ -1881,16 +2141,54 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 	/* STEP 4 - REMOVE FURTHER CULLED OBJECTS, ADD LIGHTS */
 
+	// directional lights with an optimized depth range need the range of the casters in view
+	cull_evaluate.fit_depth_range = false;
+	if (p_shadow_atlas.is_valid()) {
+		for (List<Instance *>::Element *E = scenario->directional_lights.front(); E; E = E->next()) {
+
+			if (E->get()->visible && VSG::storage->light_has_shadow(E->get()->base) && VSG::storage->light_directional_get_shadow_depth_range_mode(E->get()->base) == VS::LIGHT_DIRECTIONAL_SHADOW_DEPTH_RANGE_OPTIMIZED) {
+				cull_evaluate.fit_depth_range = true;
+				break;
+			}
+		}
+	}
+
+	cull_evaluate.camera_layer_mask = camera_layer_mask;
+	cull_evaluate.near_plane = near_plane;
+	cull_evaluate.z_far = z_far;
+	cull_evaluate.depth_range_plane = Plane(p_cam_transform.origin, -p_cam_transform.basis.get_axis(2));
+	cull_evaluate.occlusion_culling = p_use_occlusion_culling && _draw_occluders(p_cam_transform, p_cam_projection, planes.ptr(), planes.size(), scenario, camera_layer_mask);
+
+	// the checks that only touch the instance itself run as jobs
+	uint32_t batch_count = (instance_cull_count + CULL_EVALUATE_BATCH - 1) / CULL_EVALUATE_BATCH;
+	cull_batches.resize(batch_count);
+	cull_flags.resize(instance_cull_count);
+
+	_run_cull_jobs(&VisualServerScene::_cull_evaluate_job, batch_count);
+
+	CullBatch depth_range;
+	depth_range.found_items = false;
+	depth_range.z_min = 1e20;
+	depth_range.z_max = -1e20;
+
+	for (uint32_t i = 0; i < batch_count; i++) {
+
+		const CullBatch &batch = cull_batches[i];
+		if (batch.found_items) {
+			depth_range.found_items = true;
+			depth_range.z_min = MIN(depth_range.z_min, batch.z_min);
+			depth_range.z_max = MAX(depth_range.z_max, batch.z_max);
+		}
+	}
+
 	for (int i = 0; i < instance_cull_count; i++) {
 
 		Instance *ins = instance_cull_result[i];
+		uint8_t flag = cull_flags[i];
 
-		bool keep = false;
+		bool keep = flag == CULL_KEEP || flag == CULL_KEEP_PROCESS;
 
-		if ((camera_layer_mask & ins->layer_mask) == 0) {
-
-			//failure
-		} else if (ins->base_type == VS::INSTANCE_LIGHT && ins->visible) {
+		if (flag == CULL_PROCESS && ins->base_type == VS::INSTANCE_LIGHT) {
 
 			if (light_cull_count < MAX_LIGHTS_CULLED) {
 
@@ -1907,7 +2205,7 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 					light_cull_count++;
 				}
 			}
-		} else if (ins->base_type == VS::INSTANCE_REFLECTION_PROBE && ins->visible) {
+		} else if (flag == CULL_PROCESS && ins->base_type == VS::INSTANCE_REFLECTION_PROBE) {
 
 			if (reflection_probe_cull_count < MAX_REFLECTION_PROBES_CULLED) {
 
@@ -1936,18 +2234,14 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 				}
 			}
 
-		} else if (ins->base_type == VS::INSTANCE_GI_PROBE && ins->visible) {
+		} else if (flag == CULL_PROCESS && ins->base_type == VS::INSTANCE_GI_PROBE) {
 
 			InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(ins->base_data);
 			if (!gi_probe->update_element.in_list()) {
 				gi_probe_update_list.add(&gi_probe->update_element);
 			}
 
-		} else if (((1 << ins->base_type) & VS::INSTANCE_GEOMETRY_MASK) && ins->visible && ins->cast_shadows != VS::SHADOW_CASTING_SETTING_SHADOWS_ONLY) {
-
-			keep = true;
-
-			InstanceGeometryData *geom = static_cast<InstanceGeometryData *>(ins->base_data);
+		} else if (flag == CULL_KEEP_PROCESS) {
 
 			if (ins->redraw_if_visible) {
 				VisualServerRaster::redraw_request();
@@ -1964,60 +2258,13 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 					VisualServerRaster::redraw_request();
 				}
 			}
-
-			if (geom->lighting_dirty) {
-				int l = 0;
-				//only called when lights AABB enter/exit this geometry
-				ins->light_instances.resize(geom->lighting.size());
-
-				for (List<Instance *>::Element *E = geom->lighting.front(); E; E = E->next()) {
-
-					InstanceLightData *light = static_cast<InstanceLightData *>(E->get()->base_data);
-
-					ins->light_instances.write[l++] = light->instance;
-				}
-
-				geom->lighting_dirty = false;
-			}
-
-			if (geom->reflection_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->reflection_probe_instances.resize(geom->reflection_probes.size());
-
-				for (List<Instance *>::Element *E = geom->reflection_probes.front(); E; E = E->next()) {
-
-					InstanceReflectionProbeData *reflection_probe = static_cast<InstanceReflectionProbeData *>(E->get()->base_data);
-
-					ins->reflection_probe_instances.write[l++] = reflection_probe->instance;
-				}
-
-				geom->reflection_dirty = false;
-			}
-
-			if (geom->gi_probes_dirty) {
-				int l = 0;
-				//only called when reflection probe AABB enter/exit this geometry
-				ins->gi_probe_instances.resize(geom->gi_probes.size());
-
-				for (List<Instance *>::Element *E = geom->gi_probes.front(); E; E = E->next()) {
-
-					InstanceGIProbeData *gi_probe = static_cast<InstanceGIProbeData *>(E->get()->base_data);
-
-					ins->gi_probe_instances.write[l++] = gi_probe->probe_instance;
-				}
-
-				geom->gi_probes_dirty = false;
-			}
-
-			ins->depth = near_plane.distance_to(ins->transform.origin);
-			ins->depth_layer = CLAMP(int(ins->depth * 16 / z_far), 0, 15);
 		}
 
 		if (!keep) {
 			// remove, no reason to keep
 			instance_cull_count--;
 			SWAP(instance_cull_result[i], instance_cull_result[instance_cull_count]);
+			SWAP(cull_flags[i], cull_flags[instance_cull_count]);
 			i--;
 			ins->last_render_pass = 0; // make invalid
 		} else {
@@ -2061,9 +2308,11 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 
 		VSG::scene_render->set_directional_shadow_count(directional_shadow_count);
 
+		shadow_pass_count = 0;
+
 		for (int i = 0; i < directional_shadow_count; i++) {
 
-			_light_instance_update_shadow(lights_with_shadow[i], p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
+			_light_instance_setup_shadow(lights_with_shadow[i], p_cam_transform, p_cam_projection, p_cam_orthogonal, depth_range);
 		}
 	}
 
@@ -2161,11 +2410,15 @@ void VisualServerScene::_prepare_scene(const Transform p_cam_transform, const Ca
 			bool redraw = VSG::scene_render->shadow_atlas_update_light(p_shadow_atlas, light->instance, coverage, light->last_version);
 
 			if (redraw) {
-				//must redraw!
-				light->shadow_dirty = _light_instance_update_shadow(ins, p_cam_transform, p_cam_projection, p_cam_orthogonal, p_shadow_atlas, scenario);
+				//must redraw! shadow_dirty is set again once the casters are known
+				_light_instance_setup_shadow(ins, p_cam_transform, p_cam_projection, p_cam_orthogonal, depth_range);
 			}
 		}
 	}
+
+	/* STEP 6 - CULL AND RENDER SHADOWS */
+
+	_render_shadow_passes(p_shadow_atlas);
 }
 
 void VisualServerScene::_render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass) {
@@ -2262,7 +2515,7 @@ bool VisualServerScene::_render_reflection_probe_step(Instance *p_instance, int
 			shadow_atlas = scenario->reflection_probe_shadow_atlas;
 		}
 
-		_prepare_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance);
+		_prepare_scene(xform, cm, false, RID(), VSG::storage->reflection_probe_get_cull_mask(p_instance->base), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, false);
 		_render_scene(xform, cm, false, RID(), p_instance->scenario->self, shadow_atlas, reflection_probe->instance, p_step);
 
 	} else {
@@ -3483,6 +3736,16 @@ bool VisualServerScene::free(RID p_rid) {
 		scenario_owner.free(p_rid);
 		memdelete(scenario);
 
+	} else if (occluder_owner.owns(p_rid)) {
+
+		Occluder *occluder = occluder_owner.get(p_rid);
+
+		while (occluder->users.size()) {
+			instance_set_base(occluder->users.front()->get()->self, RID());
+		}
+		occluder_owner.free(p_rid);
+		memdelete(occluder);
+
 	} else if (instance_owner.owns(p_rid)) {
 		// delete the instance
 
@@ -3520,6 +3783,14 @@ VisualServerScene::VisualServerScene() {
 
 	render_pass = 1;
 	singleton = this;
+
+	parallel_culling = GLOBAL_DEF("rendering/threads/parallel_culling", true);
+	occlusion_buffer_width = GLOBAL_DEF("rendering/quality/occlusion_culling/buffer_width", 256);
+	ProjectSettings::get_singleton()->set_custom_property_info("rendering/quality/occlusion_culling/buffer_width", PropertyInfo(Variant::INT, "rendering/quality/occlusion_culling/buffer_width", PROPERTY_HINT_RANGE, "64,1024"));
+	cull_scenario = NULL;
+	cull_planes = NULL;
+	cull_plane_count = 0;
+	shadow_pass_count = 0;
 }
 
 VisualServerScene::~VisualServerScene() {
@@ -3533,4 +3804,8 @@ VisualServerScene::~VisualServerScene() {
 	memdelete(probe_bake_mutex);
 
 #endif
+
+	for (uint32_t i = 0; i < cull_thread_buffers.size(); i++) {
+		memfree(cull_thread_buffers[i]);
+	}
 }
@@ -33,12 +33,13 @@
 
 #include "servers/visual/rasterizer.h"
 
+#include "core/math/bvh.h"
 #include "core/math/geometry.h"
-#include "core/math/octree.h"
 #include "core/os/semaphore.h"
 #include "core/os/thread.h"
 #include "core/self_list.h"
 #include "servers/arvr/arvr_interface.h"
+#include "servers/visual/occlusion_buffer.h"
 
 class VisualServerScene {
 public:
@@ -47,6 +48,7 @@ public:
 		MAX_INSTANCE_CULL = 65536,
 		MAX_LIGHTS_CULLED = 4096,
 		MAX_REFLECTION_PROBES_CULLED = 4096,
+		MAX_OCCLUDERS_CULLED = 1024,
 		MAX_ROOM_CULL = 32,
 		MAX_EXTERIOR_PORTALS = 128,
 	};
@@ -124,7 +126,7 @@ public:
 		VS::ScenarioDebugMode debug;
 		RID self;
 
-		Octree<Instance, true> octree;
+		BVH<Instance, true> bvh;
 
 		List<Instance *> directional_lights;
 		RID environment;
@@ -139,8 +141,8 @@ public:
 
 	mutable RID_Owner<Scenario> scenario_owner;
 
-	static void *_instance_pair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int);
-	static void _instance_unpair(void *p_self, OctreeElementID, Instance *p_A, int, OctreeElementID, Instance *p_B, int, void *);
+	static void *_instance_pair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int);
+	static void _instance_unpair(void *p_self, BVHElementID, Instance *p_A, int, BVHElementID, Instance *p_B, int, void *);
 
 	virtual RID scenario_create();
 
@@ -149,6 +151,22 @@ public:
 	virtual void scenario_set_fallback_environment(RID p_scenario, RID p_environment);
 	virtual void scenario_set_reflection_atlas_size(RID p_scenario, int p_size, int p_subdiv);
 
+	/* OCCLUDER API */
+
+	// Triangles drawn into the occlusion buffer of the viewports using it,
+	// they are never rendered.
+	struct Occluder : RID_Data {
+
+		LocalVector<Vector3> faces;
+		AABB aabb;
+		Set<Instance *> users;
+	};
+
+	mutable RID_Owner<Occluder> occluder_owner;
+
+	virtual RID occluder_create();
+	virtual void occluder_set_faces(RID p_occluder, const PoolVector<Vector3> &p_faces);
+
 	/* INSTANCING API */
 
 	struct InstanceBaseData {
@@ -160,7 +178,7 @@ public:
 
 		RID self;
 		//scenario stuff
-		OctreeElementID octree_id;
+		BVHElementID bvh_id;
 		Scenario *scenario;
 		SelfList<Instance> scenario_item;
 
@@ -203,7 +221,7 @@ public:
 				scenario_item(this),
 				update_item(this) {
 
-			octree_id = 0;
+			bvh_id = 0;
 			scenario = NULL;
 
 			update_aabb = false;
@@ -441,6 +459,7 @@ public:
 	int instance_cull_count;
 	Instance *instance_cull_result[MAX_INSTANCE_CULL];
 	Instance *instance_shadow_cull_result[MAX_INSTANCE_CULL]; //used for generating shadowmaps
+	Instance *occluder_cull_result[MAX_OCCLUDERS_CULLED];
 	Instance *light_cull_result[MAX_LIGHTS_CULLED];
 	RID light_instance_cull_result[MAX_LIGHTS_CULLED];
 	int light_cull_count;
@@ -448,6 +467,90 @@ public:
 	RID reflection_probe_instance_cull_result[MAX_REFLECTION_PROBES_CULLED];
 	int reflection_probe_cull_count;
 
+	/* PARALLEL CULLING */
+
+	// The camera cull, the per instance checks after it and the shadow culls
+	// run as jobs, on the worker pool when enabled and on this thread
+	// otherwise. Jobs only write to their own slots, which are merged in
+	// order, so the results don't depend on the number of threads.
+
+	enum {
+		CULL_SUBTREES = 32, // jobs the camera cull is split in
+		CULL_EVALUATE_BATCH = 512 // culled instances checked per job
+	};
+
+	enum CullFlag {
+		CULL_DROP,
+		CULL_KEEP,
+		CULL_KEEP_PROCESS, // kept, but also requests redraws or particle processing
+		CULL_PROCESS // lights and probes, added to their lists after the jobs
+	};
+
+	struct CullEvaluate {
+		uint32_t camera_layer_mask;
+		Plane near_plane;
+		float z_far;
+		// Range covered by the shadow casters culled, for directional lights
+		// with an optimized depth range.
+		bool fit_depth_range;
+		Plane depth_range_plane;
+		// Geometry hidden behind the occluders in view is dropped too.
+		bool occlusion_culling;
+	};
+
+	struct CullBatch {
+		bool found_items;
+		float z_min;
+		float z_max;
+	};
+
+	// One shadow map to render: a directional light split, an omni light side
+	// or cube face, or a spot light.
+	struct ShadowPass {
+		Instance *light;
+		int pass;
+		Plane planes[6];
+		int plane_count;
+		Plane near_plane; // casters get their depth from it
+
+		CameraMatrix camera;
+		Transform transform;
+		float far;
+		float split;
+		float bias_scale;
+		bool restore_dual_paraboloid; // last cube face, the light renders with the dual paraboloid matrix after
+
+		// Directional splits push the far plane to the casters found, so their
+		// camera is only known after the cull. These are the bounds along the
+		// light axes.
+		bool fit_to_casters;
+		float x_min, x_max, y_min, y_max, z_min, z_max;
+
+		LocalVector<Instance *> casters;
+		bool animated_material_found;
+	};
+
+	bool parallel_culling;
+	Scenario *cull_scenario;
+	const Plane *cull_planes;
+	int cull_plane_count;
+	LocalVector<BVH<Instance, true>::Subtree> cull_subtrees;
+	LocalVector<LocalVector<Instance *> > cull_subtree_results;
+	CullEvaluate cull_evaluate;
+	LocalVector<uint8_t> cull_flags;
+	LocalVector<CullBatch> cull_batches;
+	LocalVector<ShadowPass> shadow_passes; // never shrinks, so the caster lists keep their memory
+	int shadow_pass_count;
+	LocalVector<Instance **> cull_thread_buffers; // MAX_INSTANCE_CULL entries per pool thread
+	OcclusionBuffer occlusion_buffer;
+	int occlusion_buffer_width;
+
+	Instance **_get_cull_buffer();
+	void _run_cull_jobs(void (VisualServerScene::*p_method)(uint32_t, void *), uint32_t p_count);
+	void _cull_subtree_job(uint32_t p_index, void *p_userdata);
+	void _cull_evaluate_job(uint32_t p_index, void *p_userdata);
+	void _cull_shadow_pass_job(uint32_t p_index, void *p_userdata);
+
 	RID_Owner<Instance> instance_owner;
 
 	// from can be mesh, light,  area and portal so far.
@@ -487,14 +590,17 @@ public:
 	_FORCE_INLINE_ void _update_dirty_instance(Instance *p_instance);
 	_FORCE_INLINE_ void _update_instance_lightmap_captures(Instance *p_instance);
 
-	_FORCE_INLINE_ bool _light_instance_update_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_shadow_atlas, Scenario *p_scenario);
+	ShadowPass &_add_shadow_pass(Instance *p_light, int p_pass);
+	void _light_instance_setup_shadow(Instance *p_instance, const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, const CullBatch &p_depth_range);
+	void _render_shadow_passes(RID p_shadow_atlas);
 
-	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe);
+	bool _draw_occluders(const Transform &p_cam_transform, const CameraMatrix &p_cam_projection, const Plane *p_planes, int p_plane_count, Scenario *p_scenario, uint32_t p_visible_layers);
+	void _prepare_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, uint32_t p_visible_layers, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, bool p_use_occlusion_culling);
 	void _render_scene(const Transform p_cam_transform, const CameraMatrix &p_cam_projection, bool p_cam_orthogonal, RID p_force_environment, RID p_scenario, RID p_shadow_atlas, RID p_reflection_probe, int p_reflection_probe_pass);
 	void render_empty_scene(RID p_scenario, RID p_shadow_atlas);
 
-	void render_camera(RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas);
-	void render_camera(Ref<ARVRInterface> &p_interface, ARVRInterface::Eyes p_eye, RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas);
+	void render_camera(RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas, bool p_use_occlusion_culling);
+	void render_camera(Ref<ARVRInterface> &p_interface, ARVRInterface::Eyes p_eye, RID p_camera, RID p_scenario, Size2 p_viewport_size, RID p_shadow_atlas, bool p_use_occlusion_culling);
 	void update_dirty_instances();
 
 	//probes
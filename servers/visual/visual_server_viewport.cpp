@@ -69,9 +69,9 @@ void VisualServerViewport::_draw_3d(Viewport *p_viewport, ARVRInterface::Eyes p_
 	}
 
 	if (p_viewport->use_arvr && arvr_interface.is_valid()) {
-		VSG::scene->render_camera(arvr_interface, p_eye, p_viewport->camera, p_viewport->scenario, p_viewport->size, p_viewport->shadow_atlas);
+		VSG::scene->render_camera(arvr_interface, p_eye, p_viewport->camera, p_viewport->scenario, p_viewport->size, p_viewport->shadow_atlas, p_viewport->use_occlusion_culling);
 	} else {
-		VSG::scene->render_camera(p_viewport->camera, p_viewport->scenario, p_viewport->size, p_viewport->shadow_atlas);
+		VSG::scene->render_camera(p_viewport->camera, p_viewport->scenario, p_viewport->size, p_viewport->shadow_atlas, p_viewport->use_occlusion_culling);
 	}
 }
 
@@ -540,6 +540,14 @@ void VisualServerViewport::viewport_set_disable_3d(RID p_viewport, bool p_disabl
 	//this should be just for disabling rendering of 3D, to actually disable it, set usage
 }
 
+void VisualServerViewport::viewport_set_use_occlusion_culling(RID p_viewport, bool p_enable) {
+
+	Viewport *viewport = viewport_owner.getornull(p_viewport);
+	ERR_FAIL_COND(!viewport);
+
+	viewport->use_occlusion_culling = p_enable;
+}
+
 void VisualServerViewport::viewport_set_keep_3d_linear(RID p_viewport, bool p_keep_3d_linear) {
 
 	Viewport *viewport = viewport_owner.getornull(p_viewport);
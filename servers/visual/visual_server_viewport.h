@@ -66,6 +66,7 @@ public:
 		bool disable_3d;
 		bool disable_3d_by_usage;
 		bool keep_3d_linear;
+		bool use_occlusion_culling;
 
 		RID shadow_atlas;
 		int shadow_atlas_size;
@@ -119,6 +120,7 @@ public:
 			disable_3d = false;
 			disable_3d_by_usage = false;
 			keep_3d_linear = false;
+			use_occlusion_culling = false;
 			debug_draw = VS::VIEWPORT_DEBUG_DRAW_DISABLED;
 			for (int i = 0; i < VS::VIEWPORT_RENDER_INFO_MAX; i++) {
 				render_info[i] = 0;
@@ -174,6 +176,7 @@ public:
 	void viewport_set_hide_canvas(RID p_viewport, bool p_hide);
 	void viewport_set_disable_environment(RID p_viewport, bool p_disable);
 	void viewport_set_disable_3d(RID p_viewport, bool p_disable);
+	void viewport_set_use_occlusion_culling(RID p_viewport, bool p_enable);
 	void viewport_set_keep_3d_linear(RID p_viewport, bool p_keep_3d_linear);
 
 	void viewport_attach_camera(RID p_viewport, RID p_camera);
@@ -93,6 +93,8 @@ void VisualServerWrapMT::sync() {
 
 void VisualServerWrapMT::draw(bool p_swap_buffers, double frame_step) {
 
+	_update_frame_stats();
+
 	if (create_thread) {
 
 		atomic_increment(&draw_pending);
@@ -109,6 +111,10 @@ void VisualServerWrapMT::init() {
 
 		print_verbose("VisualServerWrapMT: Creating render thread");
 		OS::get_singleton()->release_rendering_thread();
+		if (GLOBAL_GET("rendering/threads/lock_free_command_queue")) {
+			// only the main thread pushes without locking, others wait for their commands to run
+			command_queue.set_single_producer(Thread::get_caller_id());
+		}
 		if (create_thread) {
 			thread = Thread::create(_thread_callback, this);
 			print_verbose("VisualServerWrapMT: Starting render thread");
@@ -155,6 +161,7 @@ void VisualServerWrapMT::finish() {
 	viewport_free_cached_ids();
 	environment_free_cached_ids();
 	scenario_free_cached_ids();
+	occluder_free_cached_ids();
 	instance_free_cached_ids();
 	canvas_free_cached_ids();
 	canvas_item_free_cached_ids();
@@ -162,6 +169,139 @@ void VisualServerWrapMT::finish() {
 	canvas_occluder_polygon_free_cached_ids();
 }
 
+void VisualServerWrapMT::_update_frame_stats() {
+
+	uint64_t command_count = command_queue.get_command_count();
+	uint64_t command_bytes = command_queue.get_command_bytes();
+	uint64_t sync_stall_count = command_queue.get_sync_stall_count();
+
+	frame_command_count = command_count - last_command_count;
+	frame_command_bytes = command_bytes - last_command_bytes;
+	frame_sync_stall_count = sync_stall_count - last_sync_stall_count;
+
+	last_command_count = command_count;
+	last_command_bytes = command_bytes;
+	last_sync_stall_count = sync_stall_count;
+}
+
+int VisualServerWrapMT::get_render_info(RenderInfo p_info) {
+
+	switch (p_info) {
+		case INFO_COMMANDS_IN_FRAME:
+			return frame_command_count;
+		case INFO_COMMAND_BYTES_IN_FRAME:
+			return frame_command_bytes;
+		case INFO_SYNC_STALLS_IN_FRAME:
+			return frame_sync_stall_count;
+		default:
+			return visual_server->get_render_info(p_info);
+	}
+}
+
+/* CACHED GETTERS */
+
+void VisualServerWrapMT::_invalidate_cache(RID p_rid) {
+
+	cache_mutex->lock();
+	viewport_texture_cache.erase(p_rid);
+	arvr_viewports.erase(p_rid);
+	if (test_cube_cache == p_rid) {
+		test_cube_cache = RID();
+	}
+	cache_mutex->unlock();
+}
+
+void VisualServerWrapMT::viewport_set_use_arvr(RID p_viewport, bool p_use_arvr) {
+
+	if (cache_sync_getters) {
+		cache_mutex->lock();
+		viewport_texture_cache.erase(p_viewport);
+		if (p_use_arvr) {
+			arvr_viewports.insert(p_viewport);
+		} else {
+			arvr_viewports.erase(p_viewport);
+		}
+		cache_mutex->unlock();
+	}
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(visual_server, &VisualServer::viewport_set_use_arvr, p_viewport, p_use_arvr);
+	} else {
+		visual_server->viewport_set_use_arvr(p_viewport, p_use_arvr);
+	}
+}
+
+RID VisualServerWrapMT::viewport_get_texture(RID p_viewport) const {
+
+	if (Thread::get_caller_id() == server_thread) {
+		return visual_server->viewport_get_texture(p_viewport);
+	}
+
+	if (cache_sync_getters) {
+		cache_mutex->lock();
+		const Map<RID, RID>::Element *E = viewport_texture_cache.find(p_viewport);
+		if (E) {
+			RID texture = E->get();
+			cache_mutex->unlock();
+			return texture;
+		}
+		cache_mutex->unlock();
+	}
+
+	RID ret;
+	command_queue.push_and_ret(visual_server, &VisualServer::viewport_get_texture, p_viewport, &ret);
+
+	if (cache_sync_getters && ret.is_valid()) {
+		cache_mutex->lock();
+		if (!arvr_viewports.has(p_viewport)) {
+			viewport_texture_cache[p_viewport] = ret;
+		}
+		cache_mutex->unlock();
+	}
+
+	return ret;
+}
+
+RID VisualServerWrapMT::get_test_cube() {
+
+	if (Thread::get_caller_id() == server_thread) {
+		return visual_server->get_test_cube();
+	}
+
+	if (cache_sync_getters) {
+		cache_mutex->lock();
+		RID test_cube = test_cube_cache;
+		cache_mutex->unlock();
+		if (test_cube.is_valid()) {
+			return test_cube;
+		}
+	}
+
+	RID ret;
+	command_queue.push_and_ret(visual_server, &VisualServer::get_test_cube, &ret);
+
+	if (cache_sync_getters) {
+		cache_mutex->lock();
+		test_cube_cache = ret;
+		cache_mutex->unlock();
+	}
+
+	return ret;
+}
+
+void VisualServerWrapMT::free(RID p_rid) {
+
+	if (cache_sync_getters) {
+		_invalidate_cache(p_rid);
+	}
+
+	if (Thread::get_caller_id() != server_thread) {
+		command_queue.push(visual_server, &VisualServer::free, p_rid);
+	} else {
+		visual_server->free(p_rid);
+	}
+}
+
 void VisualServerWrapMT::set_use_vsync_callback(bool p_enable) {
 
 	singleton_mt->call_set_use_vsync(p_enable);
@@ -183,6 +323,17 @@ VisualServerWrapMT::VisualServerWrapMT(VisualServer *p_contained, bool p_create_
 	alloc_mutex = Mutex::create();
 	pool_max_size = GLOBAL_GET("memory/limits/multithreaded_server/rid_pool_prealloc");
 
+	GLOBAL_DEF_RST("rendering/threads/lock_free_command_queue", false);
+	cache_sync_getters = GLOBAL_DEF("rendering/threads/cache_sync_getters", true);
+	cache_mutex = Mutex::create();
+
+	last_command_count = 0;
+	last_command_bytes = 0;
+	last_sync_stall_count = 0;
+	frame_command_count = 0;
+	frame_command_bytes = 0;
+	frame_sync_stall_count = 0;
+
 	if (!p_create_thread) {
 		server_thread = Thread::get_caller_id();
 	} else {
@@ -194,5 +345,6 @@ VisualServerWrapMT::~VisualServerWrapMT() {
 
 	memdelete(visual_server);
 	memdelete(alloc_mutex);
+	memdelete(cache_mutex);
 	//finish();
 }
@@ -32,7 +32,9 @@
 #define VISUAL_SERVER_WRAP_MT_H
 
 #include "core/command_queue_mt.h"
+#include "core/map.h"
 #include "core/os/thread.h"
+#include "core/set.h"
 #include "servers/visual_server.h"
 
 class VisualServerWrapMT : public VisualServer {
@@ -61,6 +63,26 @@ class VisualServerWrapMT : public VisualServer {
 
 	int pool_max_size;
 
+	// Results of sync getters that can't change behind our back, so asking
+	// again doesn't need a round trip to the render thread.
+	bool cache_sync_getters;
+	Mutex *cache_mutex;
+	mutable Map<RID, RID> viewport_texture_cache;
+	Set<RID> arvr_viewports; // their texture changes every frame, never cached
+	RID test_cube_cache;
+
+	void _invalidate_cache(RID p_rid);
+
+	// Command queue statistics of the last frame, see draw().
+	uint64_t last_command_count;
+	uint64_t last_command_bytes;
+	uint64_t last_sync_stall_count;
+	int frame_command_count;
+	int frame_command_bytes;
+	int frame_sync_stall_count;
+
+	void _update_frame_stats();
+
 	//#define DEBUG_SYNC
 
 	static VisualServerWrapMT *singleton_mt;
@@ -370,7 +392,7 @@ public:
 
 	FUNCRID(viewport)
 
-	FUNC2(viewport_set_use_arvr, RID, bool)
+	virtual void viewport_set_use_arvr(RID p_viewport, bool p_use_arvr);
 
 	FUNC3(viewport_set_size, RID, int, int)
 
@@ -386,12 +408,13 @@ public:
 	FUNC2(viewport_set_update_mode, RID, ViewportUpdateMode)
 	FUNC2(viewport_set_vflip, RID, bool)
 
-	FUNC1RC(RID, viewport_get_texture, RID)
+	virtual RID viewport_get_texture(RID p_viewport) const;
 
 	FUNC2(viewport_set_hide_scenario, RID, bool)
 	FUNC2(viewport_set_hide_canvas, RID, bool)
 	FUNC2(viewport_set_disable_environment, RID, bool)
 	FUNC2(viewport_set_disable_3d, RID, bool)
+	FUNC2(viewport_set_use_occlusion_culling, RID, bool)
 	FUNC2(viewport_set_keep_3d_linear, RID, bool)
 
 	FUNC2(viewport_attach_camera, RID, RID)
@@ -452,6 +475,11 @@ public:
 	FUNC3(scenario_set_reflection_atlas_size, RID, int, int)
 	FUNC2(scenario_set_fallback_environment, RID, RID)
 
+	/* OCCLUDER API */
+
+	FUNCRID(occluder)
+	FUNC2(occluder_set_faces, RID, const PoolVector<Vector3> &)
+
 	/* INSTANCING API */
 	// from can be mesh, light,  area and portal so far.
 	FUNCRID(instance)
@@ -583,7 +611,7 @@ public:
 
 	/* FREE */
 
-	FUNC1(free, RID)
+	virtual void free(RID p_rid);
 
 	/* EVENT QUEUING */
 
@@ -598,14 +626,12 @@ public:
 	/* RENDER INFO */
 
 	//this passes directly to avoid stalling
-	virtual int get_render_info(RenderInfo p_info) {
-		return visual_server->get_render_info(p_info);
-	}
+	virtual int get_render_info(RenderInfo p_info);
 
 	FUNC4(set_boot_image, const Ref<Image> &, const Color &, bool, bool)
 	FUNC1(set_default_clear_color, const Color &)
 
-	FUNC0R(RID, get_test_cube)
+	virtual RID get_test_cube();
 
 	FUNC1(set_debug_generate_wireframes, bool)
 
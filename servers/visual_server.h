@@ -637,6 +637,7 @@ public:
 	virtual void viewport_set_hide_canvas(RID p_viewport, bool p_hide) = 0;
 	virtual void viewport_set_disable_environment(RID p_viewport, bool p_disable) = 0;
 	virtual void viewport_set_disable_3d(RID p_viewport, bool p_disable) = 0;
+	virtual void viewport_set_use_occlusion_culling(RID p_viewport, bool p_enable) = 0;
 	virtual void viewport_set_keep_3d_linear(RID p_viewport, bool p_disable) = 0;
 
 	virtual void viewport_attach_camera(RID p_viewport, RID p_camera) = 0;
@@ -791,6 +792,11 @@ public:
 	virtual void scenario_set_reflection_atlas_size(RID p_scenario, int p_size, int p_subdiv) = 0;
 	virtual void scenario_set_fallback_environment(RID p_scenario, RID p_environment) = 0;
 
+	/* OCCLUDER API */
+
+	virtual RID occluder_create() = 0;
+	virtual void occluder_set_faces(RID p_occluder, const PoolVector<Vector3> &p_faces) = 0;
+
 	/* INSTANCING API */
 
 	enum InstanceType {
@@ -804,6 +810,7 @@ public:
 		INSTANCE_REFLECTION_PROBE,
 		INSTANCE_GI_PROBE,
 		INSTANCE_LIGHTMAP_CAPTURE,
+		INSTANCE_OCCLUDER,
 		INSTANCE_MAX,
 
 		INSTANCE_GEOMETRY_MASK = (1 << INSTANCE_MESH) | (1 << INSTANCE_MULTIMESH) | (1 << INSTANCE_IMMEDIATE) | (1 << INSTANCE_PARTICLES)
@@ -1014,6 +1021,12 @@ public:
 		INFO_VIDEO_MEM_USED,
 		INFO_TEXTURE_MEM_USED,
 		INFO_VERTEX_MEM_USED,
+		INFO_COMMANDS_IN_FRAME,
+		INFO_COMMAND_BYTES_IN_FRAME,
+		INFO_SYNC_STALLS_IN_FRAME,
+		INFO_VERTEX_ARRAY_CHANGES_IN_FRAME,
+		INFO_TEXTURE_CHANGES_IN_FRAME,
+		INFO_INSTANCING_MERGES_IN_FRAME,
 	};
 
 	virtual int get_render_info(RenderInfo p_info) = 0;